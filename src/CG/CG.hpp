@@ -150,6 +150,11 @@ double distancePointCone( array3D const &, array3D const &, array3D const &, dou
 std::vector<double> distanceCloudTriangle( std::vector<array3D> const &, array3D const &, array3D const &, array3D const &);
 std::vector<double> distanceCloudTriangle( std::vector<array3D> const &, array3D const &, array3D const &, array3D const &, std::vector<array3D> & );
 
+void projectPointsTriangle( std::size_t, double const *, array3D const &, array3D const &, array3D const &, double *, double *lambda = nullptr );
+void distancePointsTriangle( std::size_t, double const *, array3D const &, array3D const &, array3D const &, double *, double *lambda = nullptr );
+void projectPointTriangles( array3D const &, std::size_t, double const *, double *, double *lambda = nullptr );
+void distancePointTriangles( array3D const &, std::size_t, double const *, double *, double *lambda = nullptr );
+
 std::vector<double> distanceCloudPolygon( std::vector<array3D> const &, std::vector<array3D> const &, std::vector<array3D> &, std::vector<int> & );
 std::vector<double> distanceCloudPolygon( std::vector<array3D> const &, std::size_t, array3D const *, std::vector<array3D> &, std::vector<int> & );
 std::vector<double> distanceCloudPolygon( std::vector<array3D> const &, std::vector<array3D> const &);
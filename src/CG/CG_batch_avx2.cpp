@@ -0,0 +1,106 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+# include "CG.hpp"
+# include "CG_private.hpp"
+
+# if BITPIT_CG_ENABLE_X86_BATCH_KERNELS
+
+# pragma GCC push_options
+# pragma GCC target("avx2")
+
+# include <immintrin.h>
+
+# include "CG_batch_private.hpp"
+
+namespace bitpit{
+
+namespace CGElem{
+
+namespace {
+
+/*!
+ * \private
+ * Operations on AVX2 registers used by the batched kernels.
+ */
+struct _BatchAvx2Ops {
+
+    typedef __m256d Real;
+    typedef __m256d Mask;
+
+    static const std::size_t WIDTH = 4;
+
+    static Real load( double const *data ) { return _mm256_loadu_pd(data); }
+    static Real broadcast( double value ) { return _mm256_set1_pd(value); }
+    static void store( double *data, Real value ) { _mm256_storeu_pd(data, value); }
+
+    static Real add( Real a, Real b ) { return _mm256_add_pd(a, b); }
+    static Real sub( Real a, Real b ) { return _mm256_sub_pd(a, b); }
+    static Real mul( Real a, Real b ) { return _mm256_mul_pd(a, b); }
+    static Real div( Real a, Real b ) { return _mm256_div_pd(a, b); }
+    static Real sqrt( Real a ) { return _mm256_sqrt_pd(a); }
+
+    static Mask lessEqual( Real a, Real b ) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static Mask greaterEqual( Real a, Real b ) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static Mask logicalAnd( Mask a, Mask b ) { return _mm256_and_pd(a, b); }
+
+    static Real select( Mask mask, Real a, Real b ) { return _mm256_blendv_pd(b, a, mask); }
+
+};
+
+}
+
+/*!
+ * \private
+ * Evaluates the projections of a batch of points on a triangle using AVX2
+ * instructions.
+ *
+ * See _evalBatchPointsTriangle for the description of the arguments.
+ */
+void _evalBatchPointsTriangleAvx2( std::size_t nPoints, double const *points, double const *Q0, double const *Q1, double const *Q2,
+                                   double *distances, double *projections, double *lambda )
+{
+    _evalBatchPointsTriangle<_BatchAvx2Ops>(nPoints, points, Q0, Q1, Q2, distances, projections, lambda);
+}
+
+/*!
+ * \private
+ * Evaluates the projections of a point on a batch of triangles using AVX2
+ * instructions.
+ *
+ * See _evalBatchPointTriangles for the description of the arguments.
+ */
+void _evalBatchPointTrianglesAvx2( double const *point, std::size_t nTriangles, double const *vertices,
+                                   double *distances, double *projections, double *lambda )
+{
+    _evalBatchPointTriangles<_BatchAvx2Ops>(point, nTriangles, vertices, distances, projections, lambda);
+}
+
+}
+
+}
+
+# pragma GCC pop_options
+
+# endif
@@ -0,0 +1,371 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+# ifndef __BITPIT_CG_BATCH_PRIVATE_HPP__
+# define __BITPIT_CG_BATCH_PRIVATE_HPP__
+
+# include <cmath>
+# include <cstddef>
+
+namespace bitpit{
+
+namespace CGElem{
+
+// Kernels are compiled several times, each time targeting a different
+// instruction set. Internal linkage prevents the linker from merging
+// instantiations that use instructions not available on the host.
+namespace {
+
+/*!
+ * \private
+ * Operations on scalar values used by the batched kernels.
+ *
+ * Vectorized implementations of the kernels provide equivalent structures
+ * that work on SIMD registers. All implementations perform the same
+ * operations in the same order, hence results only differ because of
+ * contractions into fused multiply-add operations the compiler may apply.
+ */
+struct _BatchScalarOps {
+
+    typedef double Real;
+    typedef bool Mask;
+
+    static const std::size_t WIDTH = 1;
+
+    static Real load( double const *data ) { return *data; }
+    static Real broadcast( double value ) { return value; }
+    static void store( double *data, Real value ) { *data = value; }
+
+    static Real add( Real a, Real b ) { return a + b; }
+    static Real sub( Real a, Real b ) { return a - b; }
+    static Real mul( Real a, Real b ) { return a * b; }
+    static Real div( Real a, Real b ) { return a / b; }
+    static Real sqrt( Real a ) { return std::sqrt(a); }
+
+    static Mask lessEqual( Real a, Real b ) { return a <= b; }
+    static Mask greaterEqual( Real a, Real b ) { return a >= b; }
+    static Mask logicalAnd( Mask a, Mask b ) { return a && b; }
+
+    static Real select( Mask mask, Real a, Real b ) { return mask ? a : b; }
+
+};
+
+/*!
+ * \private
+ * Evaluates the closest points on a set of triangles to a set of points.
+ *
+ * The closest point is found identifying the Voronoi region of the triangle
+ * that contains the point (see Christer Ericson's Real-Time Collision
+ * Detection book). To allow vectorization, the closest point is evaluated
+ * for all the regions and the proper one is selected afterwards.
+ *
+ * \param[in] P coordinates of the points
+ * \param[in] V coordinates of the vertices of the triangles, the i-th
+ * coordinate of the k-th vertex is stored in V[3 * k + i]
+ * \param[out] lambda barycentric coordinates of the projection points
+ * \param[out] xP coordinates of the projection points
+ * \param[out] distance distances between the points and the triangles
+ */
+template<typename Ops>
+void _evalBatchTriangleProjection( typename Ops::Real const *P, typename Ops::Real const *V,
+                                   typename Ops::Real *lambda, typename Ops::Real *xP, typename Ops::Real &distance )
+{
+    typedef typename Ops::Real Real;
+    typedef typename Ops::Mask Mask;
+
+    const Real zero = Ops::broadcast(0.);
+    const Real one  = Ops::broadcast(1.);
+
+    Real ab[3];
+    Real ac[3];
+    Real ap[3];
+    Real bp[3];
+    Real cp[3];
+    for( int d=0; d<3; ++d){
+        ab[d] = Ops::sub(V[3 + d], V[d]);
+        ac[d] = Ops::sub(V[6 + d], V[d]);
+        ap[d] = Ops::sub(P[d], V[d]);
+        bp[d] = Ops::sub(P[d], V[3 + d]);
+        cp[d] = Ops::sub(P[d], V[6 + d]);
+    }
+
+    Real d1 = Ops::add(Ops::add(Ops::mul(ab[0], ap[0]), Ops::mul(ab[1], ap[1])), Ops::mul(ab[2], ap[2]));
+    Real d2 = Ops::add(Ops::add(Ops::mul(ac[0], ap[0]), Ops::mul(ac[1], ap[1])), Ops::mul(ac[2], ap[2]));
+    Real d3 = Ops::add(Ops::add(Ops::mul(ab[0], bp[0]), Ops::mul(ab[1], bp[1])), Ops::mul(ab[2], bp[2]));
+    Real d4 = Ops::add(Ops::add(Ops::mul(ac[0], bp[0]), Ops::mul(ac[1], bp[1])), Ops::mul(ac[2], bp[2]));
+    Real d5 = Ops::add(Ops::add(Ops::mul(ab[0], cp[0]), Ops::mul(ab[1], cp[1])), Ops::mul(ab[2], cp[2]));
+    Real d6 = Ops::add(Ops::add(Ops::mul(ac[0], cp[0]), Ops::mul(ac[1], cp[1])), Ops::mul(ac[2], cp[2]));
+
+    Real va = Ops::sub(Ops::mul(d3, d6), Ops::mul(d5, d4));
+    Real vb = Ops::sub(Ops::mul(d5, d2), Ops::mul(d1, d6));
+    Real vc = Ops::sub(Ops::mul(d1, d4), Ops::mul(d3, d2));
+
+    // Interior of the triangle
+    Real denom = Ops::add(Ops::add(va, vb), vc);
+    Real l1 = Ops::div(vb, denom);
+    Real l2 = Ops::div(vc, denom);
+    Real l0 = Ops::sub(Ops::sub(one, l1), l2);
+
+    // Regions are processed in reverse order of priority, each region
+    // overrides the coordinates evaluated for the previous ones.
+    Mask inside;
+    Real t;
+
+    // Edge BC
+    Real d43 = Ops::sub(d4, d3);
+    Real d56 = Ops::sub(d5, d6);
+    inside = Ops::logicalAnd(Ops::lessEqual(va, zero), Ops::logicalAnd(Ops::greaterEqual(d43, zero), Ops::greaterEqual(d56, zero)));
+    t  = Ops::div(d43, Ops::add(d43, d56));
+    l0 = Ops::select(inside, zero, l0);
+    l1 = Ops::select(inside, Ops::sub(one, t), l1);
+    l2 = Ops::select(inside, t, l2);
+
+    // Edge AC
+    inside = Ops::logicalAnd(Ops::lessEqual(vb, zero), Ops::logicalAnd(Ops::greaterEqual(d2, zero), Ops::lessEqual(d6, zero)));
+    t  = Ops::div(d2, Ops::sub(d2, d6));
+    l0 = Ops::select(inside, Ops::sub(one, t), l0);
+    l1 = Ops::select(inside, zero, l1);
+    l2 = Ops::select(inside, t, l2);
+
+    // Vertex C
+    inside = Ops::logicalAnd(Ops::greaterEqual(d6, zero), Ops::lessEqual(d5, d6));
+    l0 = Ops::select(inside, zero, l0);
+    l1 = Ops::select(inside, zero, l1);
+    l2 = Ops::select(inside, one, l2);
+
+    // Edge AB
+    inside = Ops::logicalAnd(Ops::lessEqual(vc, zero), Ops::logicalAnd(Ops::greaterEqual(d1, zero), Ops::lessEqual(d3, zero)));
+    t  = Ops::div(d1, Ops::sub(d1, d3));
+    l0 = Ops::select(inside, Ops::sub(one, t), l0);
+    l1 = Ops::select(inside, t, l1);
+    l2 = Ops::select(inside, zero, l2);
+
+    // Vertex B
+    inside = Ops::logicalAnd(Ops::greaterEqual(d3, zero), Ops::lessEqual(d4, d3));
+    l0 = Ops::select(inside, zero, l0);
+    l1 = Ops::select(inside, one, l1);
+    l2 = Ops::select(inside, zero, l2);
+
+    // Vertex A
+    inside = Ops::logicalAnd(Ops::lessEqual(d1, zero), Ops::lessEqual(d2, zero));
+    l0 = Ops::select(inside, one, l0);
+    l1 = Ops::select(inside, zero, l1);
+    l2 = Ops::select(inside, zero, l2);
+
+    // Projection and distance
+    lambda[0] = l0;
+    lambda[1] = l1;
+    lambda[2] = l2;
+
+    Real distance2 = zero;
+    for( int d=0; d<3; ++d){
+        xP[d] = Ops::add(Ops::add(Ops::mul(l0, V[d]), Ops::mul(l1, V[3 + d])), Ops::mul(l2, V[6 + d]));
+
+        Real delta = Ops::sub(P[d], xP[d]);
+        distance2 = Ops::add(distance2, Ops::mul(delta, delta));
+    }
+
+    distance = Ops::sqrt(distance2);
+}
+
+/*!
+ * \private
+ * Evaluates the projections of a batch of points on a triangle.
+ *
+ * Points, projections and barycentric coordinates are stored using a
+ * structure-of-arrays layout (e.g., the i-th coordinate of the n-th point
+ * is stored in points[i * nPoints + n]). Outputs that are not needed can be
+ * set to null.
+ *
+ * \param[in] nPoints number of points
+ * \param[in] points coordinates of the points
+ * \param[in] Q0 first triangle vertex
+ * \param[in] Q1 second triangle vertex
+ * \param[in] Q2 third triangle vertex
+ * \param[out] distances distances between the points and the triangle
+ * \param[out] projections coordinates of the projection points
+ * \param[out] lambda barycentric coordinates of the projection points
+ */
+template<typename Ops>
+void _evalBatchPointsTriangle( std::size_t nPoints, double const *points, double const *Q0, double const *Q1, double const *Q2,
+                               double *distances, double *projections, double *lambda )
+{
+    typedef typename Ops::Real Real;
+
+    Real V[9];
+    for( int d=0; d<3; ++d){
+        V[d]     = Ops::broadcast(Q0[d]);
+        V[3 + d] = Ops::broadcast(Q1[d]);
+        V[6 + d] = Ops::broadcast(Q2[d]);
+    }
+
+    std::size_t nBatchPoints = nPoints - nPoints % Ops::WIDTH;
+    for( std::size_t n=0; n<nBatchPoints; n+=Ops::WIDTH){
+        Real P[3];
+        for( int d=0; d<3; ++d){
+            P[d] = Ops::load(points + d * nPoints + n);
+        }
+
+        Real pointLambda[3];
+        Real pointProjection[3];
+        Real pointDistance;
+        _evalBatchTriangleProjection<Ops>(P, V, pointLambda, pointProjection, pointDistance);
+
+        if( distances ){
+            Ops::store(distances + n, pointDistance);
+        }
+
+        for( int d=0; d<3; ++d){
+            if( projections ){
+                Ops::store(projections + d * nPoints + n, pointProjection[d]);
+            }
+
+            if( lambda ){
+                Ops::store(lambda + d * nPoints + n, pointLambda[d]);
+            }
+        }
+    }
+
+    double scalarV[9];
+    for( int d=0; d<3; ++d){
+        scalarV[d]     = Q0[d];
+        scalarV[3 + d] = Q1[d];
+        scalarV[6 + d] = Q2[d];
+    }
+
+    for( std::size_t n=nBatchPoints; n<nPoints; ++n){
+        double P[3];
+        for( int d=0; d<3; ++d){
+            P[d] = points[d * nPoints + n];
+        }
+
+        double pointLambda[3];
+        double pointProjection[3];
+        double pointDistance;
+        _evalBatchTriangleProjection<_BatchScalarOps>(P, scalarV, pointLambda, pointProjection, pointDistance);
+
+        if( distances ){
+            distances[n] = pointDistance;
+        }
+
+        for( int d=0; d<3; ++d){
+            if( projections ){
+                projections[d * nPoints + n] = pointProjection[d];
+            }
+
+            if( lambda ){
+                lambda[d * nPoints + n] = pointLambda[d];
+            }
+        }
+    }
+}
+
+/*!
+ * \private
+ * Evaluates the projections of a point on a batch of triangles.
+ *
+ * Triangle vertices, projections and barycentric coordinates are stored
+ * using a structure-of-arrays layout (e.g., the i-th coordinate of the k-th
+ * vertex of the n-th triangle is stored in vertices[(3 * k + i) * nTriangles + n]).
+ * Outputs that are not needed can be set to null.
+ *
+ * \param[in] point coordinates of the point
+ * \param[in] nTriangles number of triangles
+ * \param[in] vertices coordinates of the vertices of the triangles
+ * \param[out] distances distances between the point and the triangles
+ * \param[out] projections coordinates of the projection points
+ * \param[out] lambda barycentric coordinates of the projection points
+ */
+template<typename Ops>
+void _evalBatchPointTriangles( double const *point, std::size_t nTriangles, double const *vertices,
+                               double *distances, double *projections, double *lambda )
+{
+    typedef typename Ops::Real Real;
+
+    Real P[3];
+    for( int d=0; d<3; ++d){
+        P[d] = Ops::broadcast(point[d]);
+    }
+
+    std::size_t nBatchTriangles = nTriangles - nTriangles % Ops::WIDTH;
+    for( std::size_t n=0; n<nBatchTriangles; n+=Ops::WIDTH){
+        Real V[9];
+        for( int k=0; k<9; ++k){
+            V[k] = Ops::load(vertices + k * nTriangles + n);
+        }
+
+        Real triangleLambda[3];
+        Real triangleProjection[3];
+        Real triangleDistance;
+        _evalBatchTriangleProjection<Ops>(P, V, triangleLambda, triangleProjection, triangleDistance);
+
+        if( distances ){
+            Ops::store(distances + n, triangleDistance);
+        }
+
+        for( int d=0; d<3; ++d){
+            if( projections ){
+                Ops::store(projections + d * nTriangles + n, triangleProjection[d]);
+            }
+
+            if( lambda ){
+                Ops::store(lambda + d * nTriangles + n, triangleLambda[d]);
+            }
+        }
+    }
+
+    for( std::size_t n=nBatchTriangles; n<nTriangles; ++n){
+        double V[9];
+        for( int k=0; k<9; ++k){
+            V[k] = vertices[k * nTriangles + n];
+        }
+
+        double triangleLambda[3];
+        double triangleProjection[3];
+        double triangleDistance;
+        _evalBatchTriangleProjection<_BatchScalarOps>(point, V, triangleLambda, triangleProjection, triangleDistance);
+
+        if( distances ){
+            distances[n] = triangleDistance;
+        }
+
+        for( int d=0; d<3; ++d){
+            if( projections ){
+                projections[d * nTriangles + n] = triangleProjection[d];
+            }
+
+            if( lambda ){
+                lambda[d * nTriangles + n] = triangleLambda[d];
+            }
+        }
+    }
+}
+
+}
+
+}
+
+}
+
+# endif
@@ -33,6 +33,7 @@
 
 # include "CG.hpp"
 # include "CG_private.hpp"
+# include "CG_batch_private.hpp"
 
 
 namespace bitpit{
@@ -1435,6 +1436,159 @@ std::vector<double> distanceCloudTriangle( std::vector<array3D> const &cloud, ar
     return d;
 }
 
+/*!
+ * \private
+ * Evaluates the projections of a batch of points on a triangle, using the
+ * most efficient kernel supported by the processor.
+ *
+ * See _evalBatchPointsTriangle for the description of the arguments.
+ */
+void _evalBatchPointsTriangle( std::size_t nPoints, double const *points, array3D const &Q0, array3D const &Q1, array3D const &Q2,
+                               double *distances, double *projections, double *lambda )
+{
+    typedef void (*Kernel)( std::size_t, double const *, double const *, double const *, double const *, double *, double *, double * );
+
+    static const Kernel kernel = []() -> Kernel {
+# if BITPIT_CG_ENABLE_X86_BATCH_KERNELS
+        if( __builtin_cpu_supports("avx512f") ){
+            return _evalBatchPointsTriangleAvx512;
+        } else if( __builtin_cpu_supports("avx2") ){
+            return _evalBatchPointsTriangleAvx2;
+        }
+# endif
+        return _evalBatchPointsTriangle<_BatchScalarOps>;
+    }();
+
+    (*kernel)(nPoints, points, Q0.data(), Q1.data(), Q2.data(), distances, projections, lambda);
+}
+
+/*!
+ * \private
+ * Evaluates the projections of a point on a batch of triangles, using the
+ * most efficient kernel supported by the processor.
+ *
+ * See _evalBatchPointTriangles for the description of the arguments.
+ */
+void _evalBatchPointTriangles( array3D const &P, std::size_t nTriangles, double const *vertices,
+                               double *distances, double *projections, double *lambda )
+{
+    typedef void (*Kernel)( double const *, std::size_t, double const *, double *, double *, double * );
+
+    static const Kernel kernel = []() -> Kernel {
+# if BITPIT_CG_ENABLE_X86_BATCH_KERNELS
+        if( __builtin_cpu_supports("avx512f") ){
+            return _evalBatchPointTrianglesAvx512;
+        } else if( __builtin_cpu_supports("avx2") ){
+            return _evalBatchPointTrianglesAvx2;
+        }
+# endif
+        return _evalBatchPointTriangles<_BatchScalarOps>;
+    }();
+
+    (*kernel)(P.data(), nTriangles, vertices, distances, projections, lambda);
+}
+
+/*!
+ * Computes projections of a batch of points on a triangle.
+ *
+ * Points, projections and barycentric coordinates are stored using a
+ * structure-of-arrays layout: the i-th coordinate of the n-th point is
+ * stored in points[i * nPoints + n]. Buffers should be allocated by the
+ * caller and no dynamic memory allocation is performed. The projections
+ * are evaluated using vectorized instructions when they are supported by
+ * the processor.
+ *
+ * \param[in] nPoints number of points
+ * \param[in] points coordinates of the points
+ * \param[in] Q0 first triangle vertex
+ * \param[in] Q1 second triangle vertex
+ * \param[in] Q2 third triangle vertex
+ * \param[out] projections coordinates of the projection points
+ * \param[out] lambda if not null, on output will contain the barycentric
+ * coordinates of the projection points
+ */
+void projectPointsTriangle( std::size_t nPoints, double const *points, array3D const &Q0, array3D const &Q1, array3D const &Q2,
+                            double *projections, double *lambda )
+{
+    assert( validTriangle(Q0,Q1,Q2) );
+
+    _evalBatchPointsTriangle(nPoints, points, Q0, Q1, Q2, nullptr, projections, lambda);
+}
+
+/*!
+ * Computes distances of a batch of points from a triangle.
+ *
+ * Points and barycentric coordinates are stored using a structure-of-arrays
+ * layout: the i-th coordinate of the n-th point is stored in
+ * points[i * nPoints + n]. Buffers should be allocated by the caller and
+ * no dynamic memory allocation is performed. The distances are evaluated
+ * using vectorized instructions when they are supported by the processor.
+ *
+ * \param[in] nPoints number of points
+ * \param[in] points coordinates of the points
+ * \param[in] Q0 first triangle vertex
+ * \param[in] Q1 second triangle vertex
+ * \param[in] Q2 third triangle vertex
+ * \param[out] distances distances between the points and the triangle
+ * \param[out] lambda if not null, on output will contain the barycentric
+ * coordinates of the projection points
+ */
+void distancePointsTriangle( std::size_t nPoints, double const *points, array3D const &Q0, array3D const &Q1, array3D const &Q2,
+                             double *distances, double *lambda )
+{
+    assert( validTriangle(Q0,Q1,Q2) );
+
+    _evalBatchPointsTriangle(nPoints, points, Q0, Q1, Q2, distances, nullptr, lambda);
+}
+
+/*!
+ * Computes projections of a point on a batch of triangles.
+ *
+ * Triangle vertices, projections and barycentric coordinates are stored
+ * using a structure-of-arrays layout: the i-th coordinate of the k-th vertex
+ * of the n-th triangle is stored in vertices[(3 * k + i) * nTriangles + n]
+ * and the i-th coordinate of the projection on the n-th triangle is stored
+ * in projections[i * nTriangles + n]. Buffers should be allocated by the
+ * caller and no dynamic memory allocation is performed. The projections
+ * are evaluated using vectorized instructions when they are supported by
+ * the processor.
+ *
+ * \param[in] P point coordinates
+ * \param[in] nTriangles number of triangles
+ * \param[in] vertices coordinates of the vertices of the triangles
+ * \param[out] projections coordinates of the projection points
+ * \param[out] lambda if not null, on output will contain the barycentric
+ * coordinates of the projection points
+ */
+void projectPointTriangles( array3D const &P, std::size_t nTriangles, double const *vertices,
+                            double *projections, double *lambda )
+{
+    _evalBatchPointTriangles(P, nTriangles, vertices, nullptr, projections, lambda);
+}
+
+/*!
+ * Computes distances of a point from a batch of triangles.
+ *
+ * Triangle vertices and barycentric coordinates are stored using a
+ * structure-of-arrays layout: the i-th coordinate of the k-th vertex of
+ * the n-th triangle is stored in vertices[(3 * k + i) * nTriangles + n].
+ * Buffers should be allocated by the caller and no dynamic memory
+ * allocation is performed. The distances are evaluated using vectorized
+ * instructions when they are supported by the processor.
+ *
+ * \param[in] P point coordinates
+ * \param[in] nTriangles number of triangles
+ * \param[in] vertices coordinates of the vertices of the triangles
+ * \param[out] distances distances between the point and the triangles
+ * \param[out] lambda if not null, on output will contain the barycentric
+ * coordinates of the projection points
+ */
+void distancePointTriangles( array3D const &P, std::size_t nTriangles, double const *vertices,
+                             double *distances, double *lambda )
+{
+    _evalBatchPointTriangles(P, nTriangles, vertices, distances, nullptr, lambda);
+}
+
 /*!
  * Computes distances of point to a convex polygon
  * \param[in] P point coordinates
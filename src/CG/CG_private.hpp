@@ -27,6 +27,15 @@
 
 # include <array>
 # include <vector>
+# include <cstddef>
+
+// Vectorized batched kernels are compiled for x86 processors only, the
+// instruction set to use is selected at runtime.
+# if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+# define BITPIT_CG_ENABLE_X86_BATCH_KERNELS 1
+# else
+# define BITPIT_CG_ENABLE_X86_BATCH_KERNELS 0
+# endif
 
 namespace bitpit{
 
@@ -39,6 +48,13 @@ bool _intersectSegmentBox( array3D const &, array3D const &, array3D const &, ar
 bool _intersectPlaneBox( array3D const &, array3D const &, array3D const &, array3D const &, std::vector<array3D> *, int dim=3, const double tolerance = DEFAULT_DISTANCE_TOLERANCE );
 bool _intersectBoxTriangle( array3D const &, array3D const &, array3D const &, array3D const &, array3D const &, bool, bool, bool, std::vector<array3D> *, std::vector<int> *, int dim=3, const double tolerance = DEFAULT_DISTANCE_TOLERANCE ) ;
 bool _intersectBoxPolygon( array3D const &, array3D const &, std::size_t, array3D const *, bool, bool, bool, std::vector<array3D> *, std::vector<int> *, int dim=3, const double tolerance = DEFAULT_DISTANCE_TOLERANCE );
+# if BITPIT_CG_ENABLE_X86_BATCH_KERNELS
+void _evalBatchPointsTriangleAvx2( std::size_t, double const *, double const *, double const *, double const *, double *, double *, double * );
+void _evalBatchPointTrianglesAvx2( double const *, std::size_t, double const *, double *, double *, double * );
+void _evalBatchPointsTriangleAvx512( std::size_t, double const *, double const *, double const *, double const *, double *, double *, double * );
+void _evalBatchPointTrianglesAvx512( double const *, std::size_t, double const *, double *, double *, double * );
+# endif
+
 BITPIT_DEPRECATED( bool _intersectBoxSimplex( array3D const &, array3D const &, std::vector<array3D> const &, bool, bool, bool, std::vector<array3D> *, std::vector<int> *, int dim=3 ) );
 
 }
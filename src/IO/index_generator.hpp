@@ -49,6 +49,7 @@ public:
     IndexGenerator();
 
     id_type generate();
+    id_type generate(std::size_t count);
     bool isAssigned(id_type id);
     void setAssigned(id_type id);
     void trash(id_type id);
@@ -74,6 +74,38 @@ typename IndexGenerator<id_t>::id_type IndexGenerator<id_t>::generate()
     return m_latest;
 }
 
+/*!
+    Generates a range of contiguous unique indexes.
+
+    Indexes are always generated after the highest assigned index, the
+    trash is not used to generate the range.
+
+    \param count is the number of indexes that will be generated
+    \return The first index of the range, the other indexes of the range
+    follow contiguously. If no indexes are requested, NULL_ID is returned.
+*/
+template<typename id_t>
+typename IndexGenerator<id_t>::id_type IndexGenerator<id_t>::generate(std::size_t count)
+{
+    if (count == 0) {
+        return NULL_ID;
+    }
+
+    id_type first;
+    if (m_highest == NULL_ID) {
+        first     = 0;
+        m_lowest  = 0;
+        m_highest = static_cast<id_type>(count - 1);
+    } else {
+        assert(static_cast<std::size_t>(std::numeric_limits<id_type>::max() - m_highest) >= count);
+        first      = m_highest + 1;
+        m_highest += static_cast<id_type>(count);
+    }
+    m_latest = m_highest;
+
+    return first;
+}
+
 /*!
     Gets the latest assigned id.
 
@@ -46,6 +46,7 @@
 # include <vector>
 # include <cmath>
 # include <array>
+# include <utility>
 # include <iostream>
 
 # include "bitpit_operators.hpp"
@@ -146,6 +147,47 @@ int solveLU(                                                                  //
     int                                         *                             // (output) Pivot indeces of the permutation matrix
 );
 
+template<size_t m>
+int factorizeLU(                                                              // LU decomposition of a fixed-size matrix
+    std::array<double, m * m>                   &,                            // (input/output) Input matrix (linear, row major) / L and U factors
+    std::array<int, m>                          &                             // (output) Pivot indeces of the permutation matrix
+);
+
+template<size_t m>
+int solveLU(                                                                  // Solve fixed-size linear system using LU factorization
+    std::array<double, m * m>                   &,                            // (input/output) Input coeffs. matrix (linear, row major) / L and U factors
+    std::array<double, m>                       &                             // (input/output) Source term / Solution
+);
+
+template<size_t m>
+int solveCholesky(                                                            // Solve fixed-size s.p.d. linear system using Cholesky factorization
+    std::array<double, m * m>                   &,                            // (input/output) Input coeffs. matrix (linear, row major) / Cholesky factor
+    std::array<double, m>                       &                             // (input/output) Source term / Solution
+);
+
+template<size_t m, size_t n>
+int solveQR(                                                                  // Solve fixed-size least squares problem using QR factorization
+    std::array<double, m * n>                   &,                            // (input/output) Input coeffs. matrix (linear, row major) / Householder factors
+    std::array<double, m>                       &,                            // (input/output) Source term / Q^T times source term
+    std::array<double, n>                       &                             // (output) Solution
+);
+
+template<size_t m>
+void solveLU(                                                                 // Solve a batch of fixed-size linear systems using LU factorization
+    std::size_t                                  ,                            // (input) Number of systems
+    const double                                *,                            // (input) Pointer to input coeffs. matrices (linear, structure of arrays)
+    double                                      *,                            // (input/output) Pointer to source terms / solutions (structure of arrays)
+    int                                         *                             // (output) Pointer to execution information of each system
+);
+
+template<size_t m>
+void solveCholesky(                                                           // Solve a batch of fixed-size s.p.d. linear systems using Cholesky factorization
+    std::size_t                                  ,                            // (input) Number of systems
+    const double                                *,                            // (input) Pointer to input coeffs. matrices (linear, structure of arrays)
+    double                                      *,                            // (input/output) Pointer to source terms / solutions (structure of arrays)
+    int                                         *                             // (output) Pointer to execution information of each system
+);
+
 }
 
 }
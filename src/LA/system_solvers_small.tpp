@@ -22,6 +22,15 @@
  *
 \*---------------------------------------------------------------------------*/
 
+// Loops of the kernels for batches of systems have small constant trip
+// counts, they need to be completely unrolled for the compiler to be able
+// to vectorize them.
+# if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 8)
+# define BITPIT_LA_UNROLL_LOOP _Pragma("GCC unroll 16")
+# else
+# define BITPIT_LA_UNROLL_LOOP
+# endif
+
 namespace bitpit{
 namespace linearalgebra{
 /*!
@@ -425,8 +434,689 @@ backwardSubstitution(U, z, x);
 
 return; };
 
+// -------------------------------------------------------------------------- //
+/*!
+    Compute the LU factorization (with partial pivoting) of a fixed-size
+    matrix stored in row major order.
+
+    The factorization is computed in place and follows the conventions of
+    the LAPACK function dgetrf: on output the strictly lower part of the
+    matrix stores the factor L (unit diagonal entries are not stored) and
+    the upper part stores the factor U. Since the size of the matrix is a
+    compile-time constant, loops can be fully unrolled by the compiler and
+    no memory is allocated.
+
+    \param[in,out] A in input the coefficients of the matrix, in output the
+    factors L and U, A = P * L * U
+    \param[out] ipiv the pivot indices that define the permutation matrix P,
+    row i of the matrix was interchanged with row ipiv[i] (indices are zero
+    based)
+    \result returns 0 on success, otherwise returns k+1 if the k-th diagonal
+    entry of U is exactly zero (the factorization is not completed)
+*/
+template<size_t m>
+int factorizeLU(
+    std::array<double, m * m>                   &A,
+    std::array<int, m>                          &ipiv
+) {
+
+    for (std::size_t k = 0; k < m; ++k) {
+        // Pivoting
+        std::size_t pivotRow = k;
+        double pivot = std::abs(A[k * m + k]);
+        for (std::size_t i = k + 1; i < m; ++i) {
+            double pivotTrial = std::abs(A[i * m + k]);
+            if (pivotTrial > pivot) {
+                pivot    = pivotTrial;
+                pivotRow = i;
+            }
+        }
+
+        ipiv[k] = static_cast<int>(pivotRow);
+        if (pivot == 0.) {
+            return static_cast<int>(k + 1);
+        }
+
+        if (pivotRow != k) {
+            for (std::size_t j = 0; j < m; ++j) {
+                std::swap(A[k * m + j], A[pivotRow * m + j]);
+            }
+        }
+
+        // Gauss elimination
+        double pivotInverse = 1. / A[k * m + k];
+        for (std::size_t i = k + 1; i < m; ++i) {
+            double factor = A[i * m + k] * pivotInverse;
+            A[i * m + k] = factor;
+            for (std::size_t j = k + 1; j < m; ++j) {
+                A[i * m + j] -= factor * A[k * m + j];
+            }
+        }
+    }
+
+    return 0;
+};
+
+// -------------------------------------------------------------------------- //
+/*!
+    Solve a fixed-size linear system using partial pivoting and LU
+    factorization.
+
+    This is the fixed-size counterpart of the LAPACKE based solveLU: the
+    matrix is stored in row major order and the system is solved in place,
+    without any memory allocation. It is intended for small systems (e.g.,
+    up to a size of 6x6) that have to be solved many times, for which the
+    overhead of the calls to LAPACK dominates the cost of the solution.
+
+    \param[in,out] A in input the coefficients of the matrix, in output the
+    factors L and U (the pivot indices are not returned)
+    \param[in,out] B in input r.h.s. of the linear system, in output the
+    solution
+    \result returns 0 on success, otherwise returns k+1 if the k-th diagonal
+    entry of U is exactly zero, in this case the solution is not computed
+*/
+template<size_t m>
+int solveLU(
+    std::array<double, m * m>                   &A,
+    std::array<double, m>                       &B
+) {
+
+    // Factorization
+    std::array<int, m> ipiv;
+    int info = factorizeLU(A, ipiv);
+    if (info != 0) {
+        return info;
+    }
+
+    // Permutation of the r.h.s.
+    for (std::size_t k = 0; k < m; ++k) {
+        if (static_cast<std::size_t>(ipiv[k]) != k) {
+            std::swap(B[k], B[ipiv[k]]);
+        }
+    }
+
+    // Forward substitution (L has unit diagonal entries)
+    for (std::size_t i = 1; i < m; ++i) {
+        double sum = B[i];
+        for (std::size_t j = 0; j < i; ++j) {
+            sum -= A[i * m + j] * B[j];
+        }
+        B[i] = sum;
+    }
+
+    // Backward substitution
+    for (std::size_t n = m; n > 0; --n) {
+        std::size_t i = n - 1;
+        double sum = B[i];
+        for (std::size_t j = i + 1; j < m; ++j) {
+            sum -= A[i * m + j] * B[j];
+        }
+        B[i] = sum / A[i * m + i];
+    }
+
+    return 0;
+};
+
+// -------------------------------------------------------------------------- //
+/*!
+    Solve a fixed-size symmetric positive definite linear system using
+    Cholesky factorization.
+
+    The matrix is stored in row major order and only its lower triangular
+    part is accessed. The system is solved in place, following the
+    conventions of the LAPACK function dposv: on output the lower triangular
+    part of the matrix stores the Cholesky factor L, A = L * L^T.
+
+    \param[in,out] A in input the coefficients of the matrix, in output the
+    Cholesky factor L
+    \param[in,out] B in input r.h.s. of the linear system, in output the
+    solution
+    \result returns 0 on success, otherwise returns k+1 if the leading minor
+    of order k+1 is not positive definite, in this case the solution is not
+    computed
+*/
+template<size_t m>
+int solveCholesky(
+    std::array<double, m * m>                   &A,
+    std::array<double, m>                       &B
+) {
+
+    // Factorization
+    for (std::size_t j = 0; j < m; ++j) {
+        double diagonal = A[j * m + j];
+        for (std::size_t k = 0; k < j; ++k) {
+            diagonal -= A[j * m + k] * A[j * m + k];
+        }
+
+        if (!(diagonal > 0.)) {
+            return static_cast<int>(j + 1);
+        }
+
+        diagonal = std::sqrt(diagonal);
+        A[j * m + j] = diagonal;
+
+        double diagonalInverse = 1. / diagonal;
+        for (std::size_t i = j + 1; i < m; ++i) {
+            double sum = A[i * m + j];
+            for (std::size_t k = 0; k < j; ++k) {
+                sum -= A[i * m + k] * A[j * m + k];
+            }
+            A[i * m + j] = sum * diagonalInverse;
+        }
+    }
+
+    // Forward substitution
+    for (std::size_t i = 0; i < m; ++i) {
+        double sum = B[i];
+        for (std::size_t j = 0; j < i; ++j) {
+            sum -= A[i * m + j] * B[j];
+        }
+        B[i] = sum / A[i * m + i];
+    }
+
+    // Backward substitution with the transposed factor
+    for (std::size_t n = m; n > 0; --n) {
+        std::size_t i = n - 1;
+        double sum = B[i];
+        for (std::size_t j = i + 1; j < m; ++j) {
+            sum -= A[j * m + i] * B[j];
+        }
+        B[i] = sum / A[i * m + i];
+    }
+
+    return 0;
+};
+
+// -------------------------------------------------------------------------- //
+/*!
+    Solve a fixed-size, full rank, least squares problem using Householder
+    QR factorization.
+
+    The function finds the solution of the least squares problem min||B - Ax||,
+    where the matrix A has m rows and n columns (with m greater or equal to
+    n). The matrix is stored in row major order. When the matrix is square,
+    the solution of the linear system is computed.
+
+    \param[in,out] A in input the coefficients of the matrix, in output the
+    upper part of the matrix stores the off-diagonal entries of the factor R,
+    whereas the lower part stores the Householder vectors
+    \param[in,out] B in input r.h.s. of the problem, in output Q^T * B, its
+    last (m - n) entries give the residual of the solution
+    \param[out] x on output stores the solution of the problem
+    \result returns 0 on success, otherwise returns k+1 if the k-th diagonal
+    entry of R is exactly zero (i.e., the matrix is not full rank), in this
+    case the solution is not computed
+*/
+template<size_t m, size_t n>
+int solveQR(
+    std::array<double, m * n>                   &A,
+    std::array<double, m>                       &B,
+    std::array<double, n>                       &x
+) {
+
+    static_assert(m >= n, "The number of rows should be greater or equal to the number of columns");
+
+    // Factorization
+    std::array<double, n> diagonal;
+    for (std::size_t k = 0; k < n; ++k) {
+        // Householder reflector that zeroes the sub-diagonal entries of the
+        // k-th column
+        double norm2 = 0.;
+        for (std::size_t i = k; i < m; ++i) {
+            norm2 += A[i * n + k] * A[i * n + k];
+        }
+
+        if (norm2 == 0.) {
+            return static_cast<int>(k + 1);
+        }
+
+        double norm  = std::sqrt(norm2);
+        double alpha = (A[k * n + k] > 0.) ? -norm : norm;
+
+        A[k * n + k] -= alpha;
+        double householderFactor = 1. / (norm2 - alpha * (A[k * n + k] + alpha));
+        diagonal[k] = alpha;
+
+        // Apply the reflector to the remaining columns and to the r.h.s.
+        for (std::size_t j = k + 1; j < n; ++j) {
+            double dot = 0.;
+            for (std::size_t i = k; i < m; ++i) {
+                dot += A[i * n + k] * A[i * n + j];
+            }
+
+            double factor = householderFactor * dot;
+            for (std::size_t i = k; i < m; ++i) {
+                A[i * n + j] -= factor * A[i * n + k];
+            }
+        }
+
+        double dot = 0.;
+        for (std::size_t i = k; i < m; ++i) {
+            dot += A[i * n + k] * B[i];
+        }
+
+        double factor = householderFactor * dot;
+        for (std::size_t i = k; i < m; ++i) {
+            B[i] -= factor * A[i * n + k];
+        }
+    }
+
+    // Backward substitution
+    for (std::size_t l = n; l > 0; --l) {
+        std::size_t i = l - 1;
+        double sum = B[i];
+        for (std::size_t j = i + 1; j < n; ++j) {
+            sum -= A[i * n + j] * x[j];
+        }
+        x[i] = sum / diagonal[i];
+    }
+
+    return 0;
+};
+
+// -------------------------------------------------------------------------- //
+/*!
+    \private
+
+    Solve a block of fixed-size linear systems using partial pivoting and
+    LU factorization.
+
+    Systems of the block are processed simultaneously: every operation is
+    performed on all the systems of the block before moving to the next one
+    and pivoting is evaluated without branches. The innermost loops run over
+    the systems of the block and have a constant trip count, this allows the
+    compiler to vectorize them.
+
+    \param[in] nSystems is the total number of systems of the batch
+    \param[in] offset is the index of the first system of the block
+    \param[in] A is the pointer to the coefficients of the matrices
+    \param[in,out] B is the pointer to the r.h.s. / solutions
+    \param[out] info is the pointer to the execution information
+*/
+template<size_t m, size_t width>
+void _solveLUBlock(
+    std::size_t                                  nSystems,
+    std::size_t                                  offset,
+    const double                                *A,
+    double                                      *B,
+    int                                         *info
+) {
+
+    // Load the block
+    double a[m * m][width];
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t e = 0; e < m * m; ++e) {
+        const double *source = A + e * nSystems + offset;
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            a[e][s] = source[s];
+        }
+    }
+
+    double b[m][width];
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t i = 0; i < m; ++i) {
+        const double *source = B + i * nSystems + offset;
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            b[i][s] = source[s];
+        }
+    }
+
+    int blockInfo[width];
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t s = 0; s < width; ++s) {
+        blockInfo[s] = 0;
+    }
+
+    // Factorization and forward substitution
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t k = 0; k < m; ++k) {
+        // Pivoting, rows are swapped unconditionally (when no pivoting is
+        // needed the row is swapped with itself) to avoid branches.
+        double pivot[width];
+        std::size_t pivotRow[width];
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            pivot[s]    = std::abs(a[k * m + k][s]);
+            pivotRow[s] = k;
+        }
+
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t i = k + 1; i < m; ++i) {
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t s = 0; s < width; ++s) {
+                double pivotTrial = std::abs(a[i * m + k][s]);
+                bool isLarger = (pivotTrial > pivot[s]);
+                pivot[s]    = isLarger ? pivotTrial : pivot[s];
+                pivotRow[s] = isLarger ? i : pivotRow[s];
+            }
+        }
+
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            bool isSingular = (pivot[s] == 0.) && (blockInfo[s] == 0);
+            blockInfo[s] = isSingular ? static_cast<int>(k + 1) : blockInfo[s];
+        }
+
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            std::size_t p = pivotRow[s];
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t j = 0; j < m; ++j) {
+                double value = a[p * m + j][s];
+                a[p * m + j][s] = a[k * m + j][s];
+                a[k * m + j][s] = value;
+            }
+
+            double value = b[p][s];
+            b[p][s] = b[k][s];
+            b[k][s] = value;
+        }
+
+        // Gauss elimination, singular systems are processed using a unit
+        // pivot to avoid spurious floating point exceptions.
+        double pivotInverse[width];
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            pivotInverse[s] = 1. / ((pivot[s] == 0.) ? 1. : a[k * m + k][s]);
+        }
+
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t i = k + 1; i < m; ++i) {
+            double factor[width];
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t s = 0; s < width; ++s) {
+                factor[s] = a[i * m + k][s] * pivotInverse[s];
+            }
+
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t j = k + 1; j < m; ++j) {
+                BITPIT_LA_UNROLL_LOOP
+                for (std::size_t s = 0; s < width; ++s) {
+                    a[i * m + j][s] -= factor[s] * a[k * m + j][s];
+                }
+            }
+
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t s = 0; s < width; ++s) {
+                b[i][s] -= factor[s] * b[k][s];
+            }
+        }
+    }
+
+    // Backward substitution
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t n = m; n > 0; --n) {
+        std::size_t i = n - 1;
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t j = i + 1; j < m; ++j) {
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t s = 0; s < width; ++s) {
+                b[i][s] -= a[i * m + j][s] * b[j][s];
+            }
+        }
+
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            double diagonal = a[i * m + i][s];
+            b[i][s] /= (diagonal == 0.) ? 1. : diagonal;
+        }
+    }
+
+    // Store the solutions, the r.h.s. of singular systems is left untouched
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t i = 0; i < m; ++i) {
+        double *destination = B + i * nSystems + offset;
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            destination[s] = (blockInfo[s] == 0) ? b[i][s] : destination[s];
+        }
+    }
+
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t s = 0; s < width; ++s) {
+        info[offset + s] = blockInfo[s];
+    }
+};
+
+// -------------------------------------------------------------------------- //
+/*!
+    Solve a batch of fixed-size linear systems using partial pivoting and LU
+    factorization.
+
+    Matrices and r.h.s. are stored in structure of arrays layout: the entry
+    (i, j) of the matrix of the s-th system is stored in A[(i * m + j) * nSystems + s]
+    and the i-th entry of its r.h.s. is stored in B[i * nSystems + s]. Systems
+    are solved in blocks and the operations of all the systems of a block
+    are performed together, this way the solution of the systems can be
+    vectorized by the compiler.
+
+    \param[in] nSystems is the number of systems
+    \param[in] A is the pointer to the coefficients of the matrices, the
+    matrices are not modified
+    \param[in,out] B is the pointer to the r.h.s. of the systems, in output
+    the solutions (the r.h.s. of singular systems are not modified)
+    \param[out] info is the pointer to the execution information of each
+    system: 0 on success, otherwise k+1 if the k-th diagonal entry of the
+    factor U is exactly zero
+*/
+template<size_t m>
+void solveLU(
+    std::size_t                                  nSystems,
+    const double                                *A,
+    double                                      *B,
+    int                                         *info
+) {
+
+    const std::size_t BLOCK_SIZE = 4;
+
+    std::size_t offset = 0;
+    for (; offset + BLOCK_SIZE <= nSystems; offset += BLOCK_SIZE) {
+        _solveLUBlock<m, BLOCK_SIZE>(nSystems, offset, A, B, info);
+    }
+
+    for (; offset < nSystems; ++offset) {
+        _solveLUBlock<m, 1>(nSystems, offset, A, B, info);
+    }
+};
+
+// -------------------------------------------------------------------------- //
+/*!
+    \private
+
+    Solve a block of fixed-size symmetric positive definite linear systems
+    using Cholesky factorization.
+
+    Systems of the block are processed simultaneously, see _solveLUBlock
+    for details.
+
+    \param[in] nSystems is the total number of systems of the batch
+    \param[in] offset is the index of the first system of the block
+    \param[in] A is the pointer to the coefficients of the matrices
+    \param[in,out] B is the pointer to the r.h.s. / solutions
+    \param[out] info is the pointer to the execution information
+*/
+template<size_t m, size_t width>
+void _solveCholeskyBlock(
+    std::size_t                                  nSystems,
+    std::size_t                                  offset,
+    const double                                *A,
+    double                                      *B,
+    int                                         *info
+) {
+
+    // Load the lower triangular part of the block
+    double l[m * m][width];
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t i = 0; i < m; ++i) {
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t j = 0; j <= i; ++j) {
+            const double *source = A + (i * m + j) * nSystems + offset;
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t s = 0; s < width; ++s) {
+                l[i * m + j][s] = source[s];
+            }
+        }
+    }
+
+    double b[m][width];
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t i = 0; i < m; ++i) {
+        const double *source = B + i * nSystems + offset;
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            b[i][s] = source[s];
+        }
+    }
+
+    int blockInfo[width];
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t s = 0; s < width; ++s) {
+        blockInfo[s] = 0;
+    }
+
+    // Factorization, systems that are not positive definite are processed
+    // using a unit diagonal to avoid spurious floating point exceptions.
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t j = 0; j < m; ++j) {
+        double diagonal[width];
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            diagonal[s] = l[j * m + j][s];
+        }
+
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t k = 0; k < j; ++k) {
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t s = 0; s < width; ++s) {
+                diagonal[s] -= l[j * m + k][s] * l[j * m + k][s];
+            }
+        }
+
+        double diagonalInverse[width];
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            bool isPositive = (diagonal[s] > 0.);
+            blockInfo[s] = (!isPositive && blockInfo[s] == 0) ? static_cast<int>(j + 1) : blockInfo[s];
+
+            double factorDiagonal = std::sqrt(isPositive ? diagonal[s] : 1.);
+            l[j * m + j][s]    = factorDiagonal;
+            diagonalInverse[s] = 1. / factorDiagonal;
+        }
+
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t i = j + 1; i < m; ++i) {
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t k = 0; k < j; ++k) {
+                BITPIT_LA_UNROLL_LOOP
+                for (std::size_t s = 0; s < width; ++s) {
+                    l[i * m + j][s] -= l[i * m + k][s] * l[j * m + k][s];
+                }
+            }
+
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t s = 0; s < width; ++s) {
+                l[i * m + j][s] *= diagonalInverse[s];
+            }
+        }
+    }
+
+    // Forward substitution
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t i = 0; i < m; ++i) {
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t j = 0; j < i; ++j) {
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t s = 0; s < width; ++s) {
+                b[i][s] -= l[i * m + j][s] * b[j][s];
+            }
+        }
+
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            b[i][s] /= l[i * m + i][s];
+        }
+    }
+
+    // Backward substitution with the transposed factor
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t n = m; n > 0; --n) {
+        std::size_t i = n - 1;
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t j = i + 1; j < m; ++j) {
+            BITPIT_LA_UNROLL_LOOP
+            for (std::size_t s = 0; s < width; ++s) {
+                b[i][s] -= l[j * m + i][s] * b[j][s];
+            }
+        }
+
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            b[i][s] /= l[i * m + i][s];
+        }
+    }
+
+    // Store the solutions, the r.h.s. of systems that are not positive
+    // definite is left untouched
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t i = 0; i < m; ++i) {
+        double *destination = B + i * nSystems + offset;
+        BITPIT_LA_UNROLL_LOOP
+        for (std::size_t s = 0; s < width; ++s) {
+            destination[s] = (blockInfo[s] == 0) ? b[i][s] : destination[s];
+        }
+    }
+
+    BITPIT_LA_UNROLL_LOOP
+    for (std::size_t s = 0; s < width; ++s) {
+        info[offset + s] = blockInfo[s];
+    }
+};
+
+// -------------------------------------------------------------------------- //
+/*!
+    Solve a batch of fixed-size symmetric positive definite linear systems
+    using Cholesky factorization.
+
+    Matrices and r.h.s. are stored in structure of arrays layout, see the
+    batched solveLU for details. Only the lower triangular part of the
+    matrices is accessed.
+
+    \param[in] nSystems is the number of systems
+    \param[in] A is the pointer to the coefficients of the matrices, the
+    matrices are not modified
+    \param[in,out] B is the pointer to the r.h.s. of the systems, in output
+    the solutions (the r.h.s. of systems that are not positive definite are
+    not modified)
+    \param[out] info is the pointer to the execution information of each
+    system: 0 on success, otherwise k+1 if the leading minor of order k+1
+    is not positive definite
+*/
+template<size_t m>
+void solveCholesky(
+    std::size_t                                  nSystems,
+    const double                                *A,
+    double                                      *B,
+    int                                         *info
+) {
+
+    const std::size_t BLOCK_SIZE = 4;
+
+    std::size_t offset = 0;
+    for (; offset + BLOCK_SIZE <= nSystems; offset += BLOCK_SIZE) {
+        _solveCholeskyBlock<m, BLOCK_SIZE>(nSystems, offset, A, B, info);
+    }
+
+    for (; offset < nSystems; ++offset) {
+        _solveCholeskyBlock<m, 1>(nSystems, offset, A, B, info);
+    }
+};
+
 /*!
  * @}
  */
 }
 }
+
+# undef BITPIT_LA_UNROLL_LOOP
@@ -28,10 +28,52 @@
 #define __BITPIT_PABLO_DATA_LB_INTERFACE_HPP__
 
 #include <stdint.h>
+#include <type_traits>
+#include <utility>
 
 #include "bitpit_common.hpp"
 
 namespace bitpit {
+
+namespace PABLO {
+
+/*!
+ * \ingroup PABLO
+ *
+ * Check if a load balance communication class implements the gather of
+ * a range of elements.
+ */
+template<typename Impl, typename Buffer>
+auto has_range_gather_impl(int) -> decltype (
+    std::declval<Impl&>().gather(std::declval<Buffer&>(), std::declval<uint32_t>(), std::declval<uint32_t>()),
+    std::true_type{}
+);
+
+template<typename Impl, typename Buffer>
+std::false_type has_range_gather_impl(...);
+
+template<typename Impl, typename Buffer>
+using has_range_gather = decltype(has_range_gather_impl<Impl, Buffer>(0));
+
+/*!
+ * \ingroup PABLO
+ *
+ * Check if a load balance communication class implements the scatter of
+ * a range of elements.
+ */
+template<typename Impl, typename Buffer>
+auto has_range_scatter_impl(int) -> decltype (
+    std::declval<Impl&>().scatter(std::declval<Buffer&>(), std::declval<uint32_t>(), std::declval<uint32_t>()),
+    std::true_type{}
+);
+
+template<typename Impl, typename Buffer>
+std::false_type has_range_scatter_impl(...);
+
+template<typename Impl, typename Buffer>
+using has_range_scatter = decltype(has_range_scatter_impl<Impl, Buffer>(0));
+
+}
   
   /*!
     \ingroup		PABLO
@@ -65,6 +107,12 @@ namespace bitpit {
     Easily speaking, only the user knows his data and through the interface specialization
     he states the size of element data, how to write/read and move them
     in a communication buffer.
+
+    Data of contiguous elements are communicated in chunks: the user may
+    also implement the gather and the scatter of a range of elements, in
+    order to move data of the whole range with block copies. If the range
+    methods are not implemented, the data of each element of the range are
+    communicated using the single element methods.
   */
 template <class Impl>
 class DataLBInterface {
@@ -79,6 +127,12 @@ public:
 	template<class Buffer>
 	void scatter(Buffer & buff,const uint32_t e);
 
+	template<class Buffer>
+	void gather(Buffer & buff, const uint32_t begin, const uint32_t end);
+
+	template<class Buffer>
+	void scatter(Buffer & buff, const uint32_t begin, const uint32_t end);
+
 	void assign(uint32_t stride, uint32_t length);
 	void resize(uint32_t newSize);
 	void resizeGhost(uint32_t newSize);
@@ -92,6 +146,18 @@ private:
 	Impl& getImpl();
 	const Impl& getImpl() const;
 
+	template<class Buffer>
+	void gatherRange(Buffer & buff, const uint32_t begin, const uint32_t end, std::true_type);
+
+	template<class Buffer>
+	void gatherRange(Buffer & buff, const uint32_t begin, const uint32_t end, std::false_type);
+
+	template<class Buffer>
+	void scatterRange(Buffer & buff, const uint32_t begin, const uint32_t end, std::true_type);
+
+	template<class Buffer>
+	void scatterRange(Buffer & buff, const uint32_t begin, const uint32_t end, std::false_type);
+
 };
 
   /*!
@@ -114,6 +180,12 @@ public:
 	template<class Buffer>
 	void scatter(Buffer & buff,const uint32_t e);
 
+	template<class Buffer>
+	void gather(Buffer & buff, const uint32_t begin, const uint32_t end);
+
+	template<class Buffer>
+	void scatter(Buffer & buff, const uint32_t begin, const uint32_t end);
+
 	void assign(uint32_t stride, uint32_t length);
 	void resize(uint32_t newSize);
 	void resizeGhost(uint32_t newSize);
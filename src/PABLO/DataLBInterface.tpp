@@ -99,6 +99,54 @@ inline void DataLBInterface<Impl>::scatter(Buffer& buff, const uint32_t e) {
 	return getImpl().scatter(buff,e);
 }
 
+/*! Writes the data of the elements in the range [begin, end) to be
+ * communicated during the load balance in the buffer.
+ *
+ * If the user specification implements the gather of a range of elements,
+ * with the signature
+ * ~~~~~~~~~~~~~~~~~~~{.c}
+ * template<class Buffer>
+ * void gather(Buffer & buff, const uint32_t begin, const uint32_t end)
+ * ~~~~~~~~~~~~~~~~~~~
+ * the data of the whole range are written by that method, e.g., with a
+ * single block copy of a contiguous container
+ * ~~~~~~~~~~~~~~~~~~~{.c}
+ * buff.write(reinterpret_cast<const char *>(userdata.data() + begin), (end - begin) * sizeof(double))
+ * ~~~~~~~~~~~~~~~~~~~
+ * Otherwise the data are written calling the single element gather for
+ * each element of the range.
+ * \param[in] buff Output communication buffer
+ * \param[in] begin The local index of the first element of the range
+ * \param[in] end The local index past the last element of the range
+ */
+template<class Impl>
+template<class Buffer>
+inline void DataLBInterface<Impl>::gather(Buffer& buff, const uint32_t begin, const uint32_t end) {
+	gatherRange(buff, begin, end, PABLO::has_range_gather<Impl, Buffer>());
+}
+
+/*! Reads the data of the elements in the range [begin, end) from the
+ * communication buffer and store them in the user data container.
+ *
+ * If the user specification implements the scatter of a range of elements,
+ * with the signature
+ * ~~~~~~~~~~~~~~~~~~~{.c}
+ * template<class Buffer>
+ * void scatter(Buffer & buff, const uint32_t begin, const uint32_t end)
+ * ~~~~~~~~~~~~~~~~~~~
+ * the data of the whole range are read by that method, otherwise the data
+ * are read calling the single element scatter for each element of the
+ * range.
+ * \param[in] buff Input communication buffer
+ * \param[in] begin The local index of the first element of the range
+ * \param[in] end The local index past the last element of the range
+ */
+template<class Impl>
+template<class Buffer>
+inline void DataLBInterface<Impl>::scatter(Buffer& buff, const uint32_t begin, const uint32_t end) {
+	scatterRange(buff, begin, end, PABLO::has_range_scatter<Impl, Buffer>());
+}
+
 /*!  Its user specification extracts contiguous element from a data container.
  * 	This method is used during the very first load balance where the grid from being serial becomes parallel.
  * 	From the initial serial container, which is the same on every process, this method takes the data relatives to the process sub-domain, storing them in the same resized parallel local container.
@@ -144,6 +192,60 @@ inline const Impl& DataLBInterface<Impl>::getImpl() const {
 	return static_cast<const Impl &>(*this);
 }
 
+/*! Writes the data of a range of elements using the range gather of the
+ * user specification.
+ * \param[in] buff Output communication buffer
+ * \param[in] begin The local index of the first element of the range
+ * \param[in] end The local index past the last element of the range
+ */
+template<class Impl>
+template<class Buffer>
+inline void DataLBInterface<Impl>::gatherRange(Buffer& buff, const uint32_t begin, const uint32_t end, std::true_type) {
+	getImpl().gather(buff, begin, end);
+}
+
+/*! Writes the data of a range of elements using the single element gather
+ * of the user specification.
+ * \param[in] buff Output communication buffer
+ * \param[in] begin The local index of the first element of the range
+ * \param[in] end The local index past the last element of the range
+ */
+template<class Impl>
+template<class Buffer>
+inline void DataLBInterface<Impl>::gatherRange(Buffer& buff, const uint32_t begin, const uint32_t end, std::false_type) {
+	Impl &impl = getImpl();
+	for (uint32_t e = begin; e < end; ++e) {
+		impl.gather(buff, e);
+	}
+}
+
+/*! Reads the data of a range of elements using the range scatter of the
+ * user specification.
+ * \param[in] buff Input communication buffer
+ * \param[in] begin The local index of the first element of the range
+ * \param[in] end The local index past the last element of the range
+ */
+template<class Impl>
+template<class Buffer>
+inline void DataLBInterface<Impl>::scatterRange(Buffer& buff, const uint32_t begin, const uint32_t end, std::true_type) {
+	getImpl().scatter(buff, begin, end);
+}
+
+/*! Reads the data of a range of elements using the single element scatter
+ * of the user specification.
+ * \param[in] buff Input communication buffer
+ * \param[in] begin The local index of the first element of the range
+ * \param[in] end The local index past the last element of the range
+ */
+template<class Impl>
+template<class Buffer>
+inline void DataLBInterface<Impl>::scatterRange(Buffer& buff, const uint32_t begin, const uint32_t end, std::false_type) {
+	Impl &impl = getImpl();
+	for (uint32_t e = begin; e < end; ++e) {
+		impl.scatter(buff, e);
+	}
+}
+
 template<class Buffer>
 void DummyDataLBImpl::gather(Buffer & buff,const uint32_t e)
 {
@@ -162,4 +264,24 @@ void DummyDataLBImpl::scatter(Buffer & buff,const uint32_t e)
 	return;
 }
 
+template<class Buffer>
+void DummyDataLBImpl::gather(Buffer & buff, const uint32_t begin, const uint32_t end)
+{
+	BITPIT_UNUSED(buff);
+	BITPIT_UNUSED(begin);
+	BITPIT_UNUSED(end);
+
+	return;
+}
+
+template<class Buffer>
+void DummyDataLBImpl::scatter(Buffer & buff, const uint32_t begin, const uint32_t end)
+{
+	BITPIT_UNUSED(buff);
+	BITPIT_UNUSED(begin);
+	BITPIT_UNUSED(end);
+
+	return;
+}
+
 }
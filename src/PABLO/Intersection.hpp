@@ -58,6 +58,9 @@ namespace bitpit {
  *	- a flag stating if an owner is ghost;
  *	- a flag to communicate if the intersection is new after a mesh refinement.
  *
+ *	Face index, flags and dimension are stored as bit-fields packed after the
+ *	owners, this way an intersection takes little more memory than its owners.
+ *
  */
 class Intersection{
 
@@ -77,15 +80,15 @@ class Intersection{
 	// =================================================================================== //
 private:
 	uint32_t 	m_owners[2];		/**< Owner octants of the intersection (first is the internal octant) */
-	uint8_t   	m_iface;			/**< Index of the face of the outer owner */
-	bool		m_out;				/**< 0/1 octant with exiting normal (if boundary =0) */
-	bool		m_outisghost;		/**< 0/1 if octant with exiting normal is a ghost octant */
-	bool		m_finer;			/**< 0/1 finer octant (if same level =0) */
-	bool		m_isghost;			/**< The intersection has a member ghost */
-	bool		m_isnew;			/**< The intersection is new after a mesh adapting? */
-	bool		m_bound;			/**< The intersection is a boundary intersection of the whole domain */
-	bool		m_pbound;			/**< The intersection is a boundary intersection of a process domain */
-	uint8_t		m_dim;				/**< Dimension of intersection (2D/3D) */
+	uint8_t   	m_iface      : 3;	/**< Index of the face of the outer owner */
+	bool		m_out        : 1;	/**< 0/1 octant with exiting normal (if boundary =0) */
+	bool		m_outisghost : 1;	/**< 0/1 if octant with exiting normal is a ghost octant */
+	bool		m_finer      : 1;	/**< 0/1 finer octant (if same level =0) */
+	bool		m_isghost    : 1;	/**< The intersection has a member ghost */
+	bool		m_isnew      : 1;	/**< The intersection is new after a mesh adapting? */
+	bool		m_bound      : 1;	/**< The intersection is a boundary intersection of the whole domain */
+	bool		m_pbound     : 1;	/**< The intersection is a boundary intersection of a process domain */
+	uint8_t		m_dim        : 2;	/**< Dimension of intersection (2D/3D) */
 
 	// =================================================================================== //
 	// CONSTRUCTORS AND OPERATORS
@@ -28,8 +28,11 @@
 #include "bitpit_common.hpp"
 
 #include "LocalTree.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
 #include <map>
-#include <unordered_map>
+#include <thread>
 
 namespace bitpit {
 
@@ -38,6 +41,39 @@ namespace bitpit {
     // =================================================================================== //
     using namespace std;
 
+    namespace {
+
+    /*!Process the specified number of chunks concurrently.
+     * The first chunk is processed by the calling thread, each one of the
+     * other chunks is processed by a dedicated thread.
+     * \param[in] nChunks Number of chunks.
+     * \param[in] function Function that processes the chunk whose index
+     * is passed as argument, it should not throw.
+     */
+    template<typename Function>
+    void processChunks(int nChunks, const Function &function){
+        std::vector<std::thread> threads;
+        threads.reserve(nChunks - 1);
+        try {
+            for (int chunk=1; chunk<nChunks; ++chunk){
+                threads.emplace_back(function, chunk);
+            }
+        } catch (...) {
+            for (std::thread &thread : threads){
+                thread.join();
+            }
+            throw;
+        }
+
+        function(0);
+
+        for (std::thread &thread : threads){
+            thread.join();
+        }
+    }
+
+    }
+
     // =================================================================================== //
     // CLASS IMPLEMENTATION                                                                    //
     // =================================================================================== //
@@ -49,6 +85,8 @@ namespace bitpit {
     /*!Defaut constructor.
      */
     LocalTree::LocalTree() {
+        m_refinementThreadCount = 1;
+
         initialize();
         reset(false);
     };
@@ -57,6 +95,8 @@ namespace bitpit {
      * \param[in] dim Space dimension of octree.
      */
     LocalTree::LocalTree(uint8_t dim){
+        m_refinementThreadCount = 1;
+
         initialize(dim);
         reset(true);
     };
@@ -194,6 +234,14 @@ namespace bitpit {
         return m_balanceCodim;
     };
 
+    /*! Get the maximum number of threads used for refining the octants
+     * \return Maximum number of threads used for refining the octants.
+     */
+    int
+    LocalTree::getRefinementThreadCount() const{
+        return m_refinementThreadCount;
+    };
+
     /** Set refinement/coarsening marker for idx-th octant
      * \param[in] idx Local index of the target octant.
      * \param[in] marker Refinement marker for the target octant.
@@ -220,6 +268,15 @@ namespace bitpit {
         m_balanceCodim = b21codim;
     };
 
+    /*! Set the maximum number of threads used for refining the octants
+     * \param[in] nThreads Maximum number of threads used for refining the
+     * octants, values lower than one are treated as one (serial refinement).
+     */
+    void
+    LocalTree::setRefinementThreadCount(int nThreads){
+        m_refinementThreadCount = std::max(nThreads, 1);
+    };
+
     /*!Set the Morton number of first descentant octant of the octree.
      */
     void
@@ -440,6 +497,16 @@ namespace bitpit {
             return false;
         }
 
+        // Use multiple threads only if each thread has enough octants to
+        // process, otherwise the cost of spawning the threads will not be
+        // recovered.
+        const uint32_t MIN_THREAD_OCTANTS = 4096;
+
+        int nThreads = static_cast<int>(std::min<uint32_t>(m_refinementThreadCount, nOctants / MIN_THREAD_OCTANTS));
+        if (nThreads > 1) {
+            return refineThreaded(nThreads, mapidx);
+        }
+
         // Validate markers
         //
         // Not all octants marked for refinement can be really refined, for
@@ -472,86 +539,237 @@ namespace bitpit {
             return false;
         }
 
-        // Resize octant container
+        // Refine the octants
         //
-        // We want to be sure the container capacity is equal to its size.
+        // The refined octants are built in a new container, whose capacity
+        // is equal to its size. The octants are processed in order and the
+        // position of an octant in the new container is given by the number
+        // of octants generated by the preceding ones:
+        //  - if an octant doesn't need refinement, it will only be moved to
+        //    its new position;
+        //  - if an octant needs to be refined, it will be replaced with its
+        //    children.
+        //
+        // Octants that precede the first refined octant keep their position.
         uint32_t nFutureOctants = nOctants + (m_treeConstants->nChildren - 1) * nValidRefinements;
 
-        m_octants.reserve(nFutureOctants);
-        m_octants.resize(nFutureOctants, Octant(m_dim));
-        m_octants.shrink_to_fit();
+        octvector futureOctants;
+        futureOctants.reserve(nFutureOctants);
+        futureOctants.insert(futureOctants.end(), std::make_move_iterator(m_octants.begin()), std::make_move_iterator(m_octants.begin() + firstRefinedIdx));
 
-        // Initialize mapping
+        u32vector futureMapidx;
         if(!mapidx.empty()){
-            mapidx.resize(nFutureOctants);
+            futureMapidx.resize(nFutureOctants);
+            for (uint32_t idx=0; idx<firstRefinedIdx; ++idx) {
+                futureMapidx[idx] = idx;
+            }
         }
 
-        // Refine the octants
-        //
-        // We process the octants backwards (starting from the back of their
-        // container):
-        //  - if an octant doesn't need refinement, it will only be moved to
-        //    its new position;
-        //  - if an octant needs to be refined, it will be replaced with its
-        //    children.
         bool refinementCompleted = true;
 
-        uint32_t futureIdx = nFutureOctants - 1;
-        for (uint32_t n=0; n<(nOctants - firstRefinedIdx); ++n) {
-            uint32_t idx = nOctants - n - 1;
+        Octant children[8];
+        for (uint32_t idx=firstRefinedIdx; idx<nOctants; ++idx) {
+            uint32_t futureIdx = futureOctants.size();
+
             Octant &octant = m_octants[idx];
             if(octant.getMarker()<=0){
                 // The octant is not refiend, we need to move it to its new
                 // position in the container.
-                if (futureIdx != idx) {
-                    m_octants[futureIdx] = std::move(octant);
-                }
+                futureOctants.push_back(std::move(octant));
 
                 // Update the mapping
                 if(!mapidx.empty()){
-                    mapidx[futureIdx] = idx;
+                    futureMapidx[futureIdx] = idx;
                 }
-
-                // Update future octant index
-                --futureIdx;
             } else {
-                // Move original octant out of the container
-                Octant fatherOctant = std::move(octant);
-                fatherOctant.m_info[Octant::INFO_AUX] = false;
-
                 // Create children
-                uint8_t nChildren = fatherOctant.countChildren();
-                uint32_t firstChildIdx = futureIdx - (nChildren - 1);
-                fatherOctant.buildChildren(m_octants.data() + firstChildIdx);
+                octant.m_info[Octant::INFO_AUX] = false;
+
+                uint8_t nChildren = octant.countChildren();
+                octant.buildChildren(children);
+                futureOctants.insert(futureOctants.end(), children, children + nChildren);
 
                 // Update the mapping
                 if(!mapidx.empty()){
                     for (uint8_t i=0; i<nChildren; i++){
-                        mapidx[firstChildIdx + i] = idx;
+                        futureMapidx[futureIdx + i] = idx;
                     }
                 }
 
                 // Check if more refinement is needed to satisfy the markers
                 if (refinementCompleted) {
-                    refinementCompleted = (m_octants[firstChildIdx].getMarker() <= 0);
+                    refinementCompleted = (children[0].getMarker() <= 0);
                 }
 
                 // Update local max depth
-                uint8_t childrenLevel = m_octants[firstChildIdx].getLevel();
+                uint8_t childrenLevel = children[0].getLevel();
                 if (childrenLevel > m_localMaxDepth){
                     m_localMaxDepth = childrenLevel;
                 }
+            }
+        }
+
+        assert(futureOctants.size() == nFutureOctants);
+
+        m_octants.swap(futureOctants);
+        if(!mapidx.empty()){
+            mapidx.swap(futureMapidx);
+        }
+
+        // Update the number of octants
+        m_sizeOctants = nFutureOctants;
+
+        return (!refinementCompleted);
+
+    };
+
+    // =================================================================================== //
+
+    /*! Refine local tree using multiple threads: refine one time octants with marker >0
+     *
+     * The octants are split in contiguous chunks, one for each thread. A first
+     * pass validates the markers and counts the refinements of each chunk, the
+     * position of the first octant generated by a chunk is then given by the
+     * number of octants generated by the preceding chunks. A second pass moves
+     * the octants of each chunk to their new position, replacing the octants
+     * that need refinement with their children. The result is identical to
+     * the one of the serial refinement.
+     * \param[in] nThreads Number of threads
+     * \param[out] mapidx mapidx[i] = index in old octants vector of the new i-th octant (index of father if octant is new after refinement)
+     * \return	true if additional refinement is needed in order to satisfy
+     * the specified markers
+     */
+    bool
+    LocalTree::refineThreaded(int nThreads, u32vector & mapidx){
+        // Current number of octants
+        uint32_t nOctants = m_octants.size();
+
+        // Split the octants in chunks
+        std::vector<uint32_t> chunkBegins(nThreads + 1);
+        for (int chunk=0; chunk<=nThreads; ++chunk){
+            chunkBegins[chunk] = static_cast<uint32_t>((uint64_t(nOctants) * chunk) / nThreads);
+        }
 
-                // Update future octant index
-                futureIdx -= nChildren;
+        // Validate markers
+        //
+        // Not all octants marked for refinement can be really refined, for
+        // example octants cannot be refined further than the maximum level.
+        std::vector<uint32_t> chunkRefinements(nThreads, 0);
+        processChunks(nThreads, [&](int chunk){
+            uint32_t nChunkRefinements = 0;
+            for (uint32_t idx=chunkBegins[chunk]; idx<chunkBegins[chunk + 1]; idx++) {
+                // Skip octants not marked for refinement
+                Octant &octant = m_octants[idx];
+                if(octant.getMarker()<= 0){
+                    continue;
+                }
+
+                // Octants cannot be refined further than the maximum level
+                if(octant.getLevel()>=m_treeConstants->maxLevel){
+                    octant.setMarker(0);
+                    octant.m_info[Octant::INFO_AUX] = false;
+                    continue;
+                }
+
+                // The octant will be refined
+                ++nChunkRefinements;
             }
+
+            chunkRefinements[chunk] = nChunkRefinements;
+        });
+
+        // Evaluate the position of the first octant generated by each chunk
+        std::vector<uint32_t> chunkFutureBegins(nThreads);
+        uint32_t nValidRefinements = 0;
+        for (int chunk=0; chunk<nThreads; ++chunk){
+            chunkFutureBegins[chunk] = chunkBegins[chunk] + (m_treeConstants->nChildren - 1) * nValidRefinements;
+            nValidRefinements += chunkRefinements[chunk];
         }
 
-        // Update the mapping for cells that have not been modified
+        // Early return if no octants need to be refined
+        if (nValidRefinements == 0) {
+            return false;
+        }
+
+        // Refine the octants
+        //
+        // Chunks write to disjoint ranges of the new containers, hence the
+        // containers need to be sized before processing the chunks.
+        uint32_t nFutureOctants = nOctants + (m_treeConstants->nChildren - 1) * nValidRefinements;
+
+        octvector futureOctants(nFutureOctants);
+
+        u32vector futureMapidx;
         if(!mapidx.empty()){
-            for (uint32_t idx=0; idx<firstRefinedIdx; ++idx) {
-                mapidx[idx] = idx;
+            futureMapidx.resize(nFutureOctants);
+        }
+
+        std::vector<char> chunkRefinementCompleted(nThreads, true);
+        std::vector<int8_t> chunkMaxDepths(nThreads, m_localMaxDepth);
+        processChunks(nThreads, [&](int chunk){
+            uint32_t futureIdx = chunkFutureBegins[chunk];
+            bool refinementCompleted = true;
+            int8_t maxDepth = chunkMaxDepths[chunk];
+
+            Octant children[8];
+            for (uint32_t idx=chunkBegins[chunk]; idx<chunkBegins[chunk + 1]; ++idx) {
+                Octant &octant = m_octants[idx];
+                if(octant.getMarker()<=0){
+                    // The octant is not refiend, we need to move it to its new
+                    // position in the container.
+                    futureOctants[futureIdx] = std::move(octant);
+
+                    // Update the mapping
+                    if(!futureMapidx.empty()){
+                        futureMapidx[futureIdx] = idx;
+                    }
+
+                    ++futureIdx;
+                } else {
+                    // Create children
+                    octant.m_info[Octant::INFO_AUX] = false;
+
+                    uint8_t nChildren = octant.countChildren();
+                    octant.buildChildren(children);
+                    std::move(children, children + nChildren, futureOctants.begin() + futureIdx);
+
+                    // Update the mapping
+                    if(!futureMapidx.empty()){
+                        for (uint8_t i=0; i<nChildren; i++){
+                            futureMapidx[futureIdx + i] = idx;
+                        }
+                    }
+
+                    futureIdx += nChildren;
+
+                    // Check if more refinement is needed to satisfy the markers
+                    if (refinementCompleted) {
+                        refinementCompleted = (children[0].getMarker() <= 0);
+                    }
+
+                    // Update local max depth
+                    int8_t childrenLevel = children[0].getLevel();
+                    if (childrenLevel > maxDepth){
+                        maxDepth = childrenLevel;
+                    }
+                }
             }
+
+            assert(futureIdx == (chunk + 1 < nThreads ? chunkFutureBegins[chunk + 1] : nFutureOctants));
+
+            chunkRefinementCompleted[chunk] = refinementCompleted;
+            chunkMaxDepths[chunk] = maxDepth;
+        });
+
+        bool refinementCompleted = true;
+        for (int chunk=0; chunk<nThreads; ++chunk){
+            refinementCompleted = refinementCompleted && chunkRefinementCompleted[chunk];
+            m_localMaxDepth = std::max(m_localMaxDepth, chunkMaxDepths[chunk]);
+        }
+
+        m_octants.swap(futureOctants);
+        if(!mapidx.empty()){
+            mapidx.swap(futureMapidx);
         }
 
         // Update the number of octants
@@ -625,11 +843,13 @@ namespace bitpit {
         for (idx=0; idx<m_sizeOctants; idx++){
             if(m_octants[idx].getMarker() < 0 && m_octants[idx].getLevel() > 0){
                 nbro = 0;
-                father = m_octants[idx].buildFather();
+                uint8_t level = m_octants[idx].getLevel();
+                uint64_t fatherMorton = m_octants[idx].computeFatherMorton();
                 // Check if family is to be refined
                 for (idx2=idx; idx2<idx+m_treeConstants->nChildren; idx2++){
                     if (idx2<m_sizeOctants){
-                        if(m_octants[idx2].getMarker() < 0 && m_octants[idx2].buildFather() == father){
+                        const Octant &sibling = m_octants[idx2];
+                        if(sibling.getMarker() < 0 && sibling.getLevel() == level && sibling.computeFatherMorton() == fatherMorton){
                             nbro++;
                         }
                     }
@@ -1732,8 +1952,10 @@ namespace bitpit {
 
     /*! Pre-processing for 2:1 balancing of local tree. Check if there are broken families over processes.
      * \param[in] internal Set to true if the interior octants have to be checked.
+     * \return Returns true if the marker of at least one local octant has
+     * been modified.
      */
-    void
+    bool
     LocalTree::preBalance21(bool internal){
 
         Octant 			father(m_dim), lastdesc(m_dim);
@@ -1747,6 +1969,8 @@ namespace bitpit {
         //------------------------------------------ //
         // Initialization
 
+        bool modified = false;
+
         nbro = 0;
         idx=0;
         idx2_gh = idx0 = 0;
@@ -1810,6 +2034,7 @@ namespace bitpit {
                             if (m_octants[ii].getMarker()<0){
                                 m_octants[ii].setMarker(0);
                                 m_octants[ii].m_info[Octant::INFO_AUX]=true;
+                                modified = true;
                             }
                         }
                         //Clean ghost index to structure for mapper in case of coarsening a broken family
@@ -1856,6 +2081,7 @@ namespace bitpit {
                             if (m_octants[ii].getMarker()<0){
                                 m_octants[ii].setMarker(0);
                                 m_octants[ii].m_info[Octant::INFO_AUX]=true;
+                                modified = true;
                             }
                         }
                         //Clean ghost index to structure for mapper in case of coarsening a broken family
@@ -1903,12 +2129,15 @@ namespace bitpit {
                             if (idx<=last_idx){
                                 m_octants[idx].setMarker(0);
                                 m_octants[idx].m_info[Octant::INFO_AUX]=true;
+                                modified = true;
                             }
                         }
                     }
                 }
             }
         }
+
+        return modified;
     };
 
     // =================================================================================== //
@@ -2326,6 +2555,14 @@ namespace bitpit {
             while(!modified.empty()){
                 newmodified.clear();
 
+                // The same octant may have been modified several times during
+                // the previous sweep, since markers can only be increased the
+                // result of the balance doesn't depend on the order in which
+                // the octants are processed, hence every octant is processed
+                // once and in Morton order.
+                std::sort(modified.begin(), modified.end());
+                modified.erase(std::unique(modified.begin(), modified.end()), modified.end());
+
                 ibegin = modified.begin();
                 iend = modified.end();
                 for (iit=ibegin; iit!=iend; ++iit){
@@ -2502,6 +2739,14 @@ namespace bitpit {
             while(!modified.empty()){
                 newmodified.clear();
 
+                // The same octant may have been modified several times during
+                // the previous sweep, since markers can only be increased the
+                // result of the balance doesn't depend on the order in which
+                // the octants are processed, hence every octant is processed
+                // once and in Morton order.
+                std::sort(modified.begin(), modified.end());
+                modified.erase(std::unique(modified.begin(), modified.end()), modified.end());
+
                 ibegin = modified.begin();
                 iend = modified.end();
                 for (iit=ibegin; iit!=iend; ++iit){
@@ -2984,21 +3229,32 @@ namespace bitpit {
     // =================================================================================== //
 
     /** Compute the connectivity of octants and store the coordinates of nodes.
+     *
+     * Nodes are identified by their persistent XYZ key. The keys of all the
+     * nodes of the octants are gathered in a single list, which is then
+     * sorted: nodes shared by multiple octants become adjacent in the list
+     * and the unique nodes are numbered following the order of their keys.
+     * Since the XYZ key orders the nodes of an octant following their local
+     * numbering, the connectivity of every octant lists the nodes in the
+     * same order as the local nodes of the octant.
+     *
+     * If the connectivity was already computed, the storage allocated for
+     * the connectivity is reused.
      */
     void
     LocalTree::computeConnectivity(){
-        vector<uint64_t>                             mortonList;
-        unordered_map<uint64_t, array<uint32_t, 3> > nodeCoords;
-        unordered_map<uint64_t, vector<uint64_t> >   nodeOctants;
         uint32_t                                     noctants = getNumOctants();
         uint32_t                                     nghosts  = m_sizeGhosts;
-
-
+        uint8_t                                      nnodes   = m_treeConstants->nNodes;
 
         // Gather node information
-        mortonList.reserve(noctants);
-        nodeCoords.reserve(noctants);
-        nodeOctants.reserve(noctants);
+        //
+        // Every entry contains the key of the node and the position of the
+        // node in the connectivity, i.e., the index of the octant (ghosts are
+        // numbered after the internal octants) multiplied by the number of
+        // nodes of an octant plus the local index of the node.
+        std::vector<std::pair<uint64_t, uint64_t>> nodeEntries;
+        nodeEntries.reserve(static_cast<std::size_t>(noctants + nghosts) * nnodes);
 
         for (uint64_t n = 0; n < (noctants + nghosts); n++){
             const Octant *octant;
@@ -3010,45 +3266,69 @@ namespace bitpit {
                 octant = &(m_ghosts[octantId]);
             }
 
-            for (uint8_t i = 0; i < m_treeConstants->nNodes; ++i){
+            for (uint8_t i = 0; i < nnodes; ++i){
                 u32array3 node;
                 octant->getLogicalNode(node, i);
 
                 uint64_t morton = octant->computeNodePersistentKey(node);
-                if (nodeCoords.count(morton) == 0) {
-                    mortonList.push_back(morton);
-                    nodeCoords.insert({{morton, std::move(node)}});
-                    nodeOctants[morton].reserve(m_treeConstants->nNodes);
-                }
+                nodeEntries.emplace_back(morton, n * nnodes + i);
+            }
+        }
+        std::sort(nodeEntries.begin(), nodeEntries.end());
+
+        // Count unique nodes
+        std::size_t nEntries = nodeEntries.size();
 
-                nodeOctants[morton].push_back(n);
+        std::size_t nUniqueNodes = 0;
+        for (std::size_t k = 0; k < nEntries; ++k) {
+            if (k == 0 || nodeEntries[k].first != nodeEntries[k - 1].first) {
+                ++nUniqueNodes;
             }
         }
-        std::sort(mortonList.begin(), mortonList.end());
 
         // Build node list and connectivity
-        m_nodes.reserve(mortonList.size());
+        m_nodes.clear();
+        m_nodes.reserve(nUniqueNodes);
+
         m_connectivity.resize(noctants);
+        for (u32vector &octantConnect : m_connectivity) {
+            octantConnect.resize(nnodes);
+        }
+
         m_ghostsConnectivity.resize(nghosts);
+        for (u32vector &octantConnect : m_ghostsConnectivity) {
+            octantConnect.resize(nnodes);
+        }
 
         uint32_t nodeId = 0;
-        for (uint64_t morton : mortonList) {
-            m_nodes.emplace_back(std::move(nodeCoords.at(morton)));
-            for (uint64_t n : nodeOctants.at(morton)) {
+        std::size_t k = 0;
+        while (k < nEntries) {
+            uint64_t morton = nodeEntries[k].first;
+            do {
+                uint64_t n = nodeEntries[k].second / nnodes;
+                uint8_t  i = nodeEntries[k].second % nnodes;
+
+                const Octant *octant;
                 std::vector<uint32_t> *octantConnect;
                 if (n < noctants) {
                     uint32_t octantId = n;
+                    octant        = &(m_octants[octantId]);
                     octantConnect = &(m_connectivity[octantId]);
                 } else {
                     uint32_t octantId = n - noctants;
+                    octant        = &(m_ghosts[octantId]);
                     octantConnect = &(m_ghostsConnectivity[octantId]);
                 }
 
-                if (octantConnect->size() == 0) {
-                    octantConnect->reserve(m_treeConstants->nNodes);
+                if (nodeId == m_nodes.size()) {
+                    m_nodes.emplace_back();
+                    octant->getLogicalNode(m_nodes.back(), i);
                 }
-                octantConnect->push_back(nodeId);
-            }
+                (*octantConnect)[i] = nodeId;
+
+                ++k;
+            } while (k < nEntries && nodeEntries[k].first == morton);
+
             nodeId++;
         }
     };
@@ -3063,10 +3343,11 @@ namespace bitpit {
     };
 
     /*! Updates nodes vector and connectivity of octants of local tree
+     *
+     * The storage allocated for the current connectivity is reused.
      */
     void
     LocalTree::updateConnectivity(){
-        clearConnectivity();
         computeConnectivity();
     };
 
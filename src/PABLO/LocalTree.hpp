@@ -126,6 +126,7 @@ private:
 	uint8_t 				m_balanceCodim;			/**<Maximum codimension of the entity for 2:1 balancing (1 = 2:1 balance through faces (default);
 	 	 	 	 	 	 	 	 	 	 	 	 	 	 2 = 2:1 balance through edges and faces;
 	 	 	 	 	 	 	 	 	 	 	 	 	 	 3 = 2:1 balance through nodes, edges and faces)*/
+	int						m_refinementThreadCount;	/**<Maximum number of threads used for refining the octants (1 = serial refinement (default))*/
 	u32vector 				m_lastGhostBros;		/**<Index of ghost brothers in case of broken family coarsened (tail of local octants)*/
 	u32vector 				m_firstGhostBros;		/**<Index of ghost brothers in case of broken family coarsened (head of local octants)*/
 	u32vector2D				m_connectivity;			/**<Local vector of connectivity (node1, node2, ...) ordered with Morton-order.
@@ -167,9 +168,11 @@ private:
 	uint64_t 		computeGhostNodePersistentKey(int32_t idx, uint8_t inode) const;
 	bool 			getBalance(int32_t idx) const;
 	uint8_t 		getBalanceCodim() const;
+	int 			getRefinementThreadCount() const;
 	void 			setMarker(int32_t idx, int8_t marker);
 	void 			setBalance(int32_t idx, bool balance);
 	void 			setBalanceCodim(uint8_t b21codim);
+	void 			setRefinementThreadCount(int nThreads);
 	void 			setFirstDescMorton();
 	void 			setLastDescMorton();
 	void 			setPeriodic(bvector & periodic);
@@ -196,6 +199,7 @@ private:
 
 
 	bool 		refine(u32vector & mapidx);
+	bool 		refineThreaded(int nThreads, u32vector & mapidx);
 	bool 		coarse(u32vector & mapidx);
 	bool 		globalRefine(u32vector & mapidx);
 	bool 		globalCoarse(u32vector & mapidx);
@@ -208,7 +212,7 @@ private:
 
 	void 		computeNeighSearchBegin(uint64_t sameSizeVirtualNeighMorton, const octvector &octants, uint32_t *searchBeginIdx, uint64_t *searchBeginMorton) const;
 
-	void 		preBalance21(bool internal);
+	bool 		preBalance21(bool internal);
 	void 		preBalance21(u32vector& newmodified);
 	bool 		localBalance(bool doNew, bool doInterior);
 
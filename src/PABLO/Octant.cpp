@@ -631,11 +631,17 @@ u32array3	Octant::computeLastDescCoordinates() const {
 };
 
 /** Compute the Morton index of the father of this octant.
+ *
+ * The coordinates of the father are obtained zeroing the lowest bits of the
+ * coordinates of the octant, since the bits of the coordinates are interleaved
+ * in the Morton index the same result can be obtained masking directly the
+ * lowest bits of the Morton index.
+ *
  * \return Morton index of the father of this octant.
  */
 uint64_t	Octant::computeFatherMorton() const {
-	u32array3 fatherCoordinates = computeFatherCoordinates();
-	return PABLO::computeMorton(m_dim, fatherCoordinates[0], fatherCoordinates[1], fatherCoordinates[2]);
+	int fatherShift = m_dim * (sm_treeConstants[m_dim].maxLevel - max(0,(m_level-1)));
+	return (m_morton & ~((uint64_t(1) << fatherShift) - 1));
 };
 
 /** Compute the coordinates (i.e. the coordinates of the node 0) of the father
@@ -755,121 +761,36 @@ vector< Octant >	Octant::buildChildren() const {
  */
 void	Octant::buildChildren(Octant *children) const {
 
-	u32array3 coords = getLogicalCoordinates();
-
 	int nChildren = countChildren();
-	for (int i=0; i<nChildren; ++i){
-		// Octant information
-		uint8_t xf;
-		uint8_t yf;
-		uint8_t zf;
-		uint8_t dx;
-		uint8_t dy;
-		uint8_t dz;
-		switch (i) {
-
-		case 0 :
-			dx = 0;
-			dy = 0;
-			dz = 0;
-
-			xf = 1;
-			yf = 3;
-			zf = 5;
-
-			break;
-
-		case 1 :
-			dx = 1;
-			dy = 0;
-			dz = 0;
-
-			xf = 0;
-			yf = 3;
-			zf = 5;
-
-			break;
-
-		case 2 :
-			dx = 0;
-			dy = 1;
-			dz = 0;
-
-			xf = 1;
-			yf = 2;
-			zf = 5;
-
-			break;
-
-		case 3 :
-			dx = 1;
-			dy = 1;
-			dz = 0;
-
-			xf = 0;
-			yf = 2;
-			zf = 5;
-
-			break;
-
-		case 4 :
-			dx = 0;
-			dy = 0;
-			dz = 1;
-
-			xf = 1;
-			yf = 3;
-			zf = 4;
-
-			break;
-
-		case 5 :
-			dx = 1;
-			dy = 0;
-			dz = 1;
-
-			xf = 0;
-			yf = 3;
-			zf = 4;
-
-			break;
-
-		case 6 :
-			dx = 0;
-			dy = 1;
-			dz = 1;
-
-			xf = 1;
-			yf = 2;
-			zf = 4;
-
-			break;
-
-		case 7 :
-			dx = 1;
-			dy = 1;
-			dz = 1;
-
-			xf = 0;
-			yf = 2;
-			zf = 4;
-
-			break;
+	if (nChildren == 0){
+		return;
+	}
 
-		default:
-			BITPIT_UNREACHABLE("The maximum number of children is 8.");
+	// The bits of the local index of the child are the displacements of the
+	// child along the coordinate directions, hence the Morton index of the
+	// child can be obtained adding the local index, properly shifted, to the
+	// Morton index of the father.
+	uint8_t childLevel = m_level + 1;
+	int childShift = m_dim * (sm_treeConstants[m_dim].maxLevel - childLevel);
+	for (int i=0; i<nChildren; ++i){
+		// Displacements of the child
+		uint8_t dx = (i & 1);
+		uint8_t dy = ((i >> 1) & 1);
+		uint8_t dz = ((i >> 2) & 1);
 
-		}
+		// Faces of the child that are internal to the father
+		uint8_t xf = 1 - dx;
+		uint8_t yf = 3 - dy;
+		uint8_t zf = 5 - dz;
 
 		// Create octant
 		children[i] = Octant(*this);
 		Octant &oct = children[i];
 
 		oct.setMarker(std::max(0, oct.m_marker - 1));
-		oct.setLevel(oct.m_level + 1);
+		oct.setLevel(childLevel);
 
-		uint32_t dh = oct.getLogicalSize();
-		oct.m_morton = PABLO::computeMorton(m_dim, coords[0] + dh * dx, coords[1] + dh * dy, coords[2] + dh * dz);
+		oct.m_morton = m_morton + (uint64_t(i) << childShift);
 
 		oct.m_info[OctantInfo::INFO_NEW4REFINEMENT] = true;
 
@@ -25,6 +25,8 @@
 // =================================================================================== //
 // INCLUDES                                                                            //
 // =================================================================================== //
+#include <cassert>
+
 #include "bitpit_operators.hpp"
 
 #include "PabloUniform.hpp"
@@ -100,6 +102,41 @@ namespace bitpit {
     // METHODS
     // =================================================================================== //
 
+    /*! Internal function to update the size, the area and the volume of the
+     * octants of each level in the physical domain.
+     *
+     * Geometry accessors look up the tables using the level of the octant,
+     * instead of converting the logical geometry of each octant.
+     */
+    void
+    PabloUniform::__updateLevelGeometry(){
+        m_levelSizes.clear();
+        m_levelAreas.clear();
+        m_levelVolumes.clear();
+        if (getDim() == 0){
+            return;
+        }
+
+        // Logical to physical conversion is evaluated as in the map of the
+        // tree, this way tables and accessors of the tree give the same
+        // results.
+        const TreeConstants &treeConstants = TreeConstants::instance(getDim());
+
+        double maxLength_1 = 1. / double(treeConstants.lengths[0]);
+        double maxArea_1   = 1. / double(treeConstants.areas[0]);
+        double maxVolume_1 = 1. / double(treeConstants.volumes[0]);
+
+        int nLevels = treeConstants.maxLevel + 1;
+        m_levelSizes.resize(nLevels);
+        m_levelAreas.resize(nLevels);
+        m_levelVolumes.resize(nLevels);
+        for (int level = 0; level < nLevels; ++level){
+            m_levelSizes[level]   = m_L * (maxLength_1 * double(treeConstants.lengths[level]));
+            m_levelAreas[level]   = m_area * (maxArea_1 * double(treeConstants.areas[level]));
+            m_levelVolumes[level] = m_volume * (maxVolume_1 * double(treeConstants.volumes[level]));
+        }
+    }
+
     /*! Reset the octree
      */
     void
@@ -164,6 +201,56 @@ namespace bitpit {
         setL(L);
     }
 
+#if BITPIT_ENABLE_MPI==1
+    /*! Get the version associated to the collective binary dumps.
+     *
+     *  \result The version associated to the collective binary dumps.
+     */
+    int
+    PabloUniform::getCollectiveDumpVersion() const
+    {
+        const int COLLECTIVE_DUMP_VERSION = 1;
+
+        return (COLLECTIVE_DUMP_VERSION + ParaTree::getCollectiveDumpVersion());
+    }
+
+    /*! Write the properties of the tree to the header of a collective dump.
+     *
+     *  \param stream is the stream to write to
+     */
+    void
+    PabloUniform::dumpCollectiveHeader(OBinaryStream &stream)
+    {
+        ParaTree::dumpCollectiveHeader(stream);
+
+        stream << m_origin[0];
+        stream << m_origin[1];
+        stream << m_origin[2];
+        stream << m_L;
+    }
+
+    /*! Restore the properties of the tree from the header of a collective
+     *  dump.
+     *
+     *  \param stream is the stream to read from
+     */
+    void
+    PabloUniform::restoreCollectiveHeader(IBinaryStream &stream)
+    {
+        ParaTree::restoreCollectiveHeader(stream);
+
+        std::array<double, 3> origin;
+        stream >> origin[0];
+        stream >> origin[1];
+        stream >> origin[2];
+        setOrigin(origin);
+
+        double L;
+        stream >> L;
+        setL(L);
+    }
+#endif
+
     // =================================================================================== //
     // BASIC GET/SET METHODS															   //
     // =================================================================================== //
@@ -215,6 +302,8 @@ namespace bitpit {
         m_L      = L;
         m_area   = uipow(L, getDim() - 1);
         m_volume = uipow(L, getDim());
+
+        __updateLevelGeometry();
     };
 
     /*! Set the origin of the domain.
@@ -231,8 +320,8 @@ namespace bitpit {
      */
     double
     PabloUniform::levelToSize(uint8_t level) {
-        double size = ParaTree::levelToSize(level);
-        return m_L *size;
+        assert(level < m_levelSizes.size());
+        return m_levelSizes[level];
     }
 
     // =================================================================================== //
@@ -294,7 +383,9 @@ namespace bitpit {
      */
     double
     PabloUniform::getSize(uint32_t idx) const {
-        return m_L * ParaTree::getSize(idx);
+        uint8_t level = getLevel(idx);
+        assert(level < m_levelSizes.size());
+        return m_levelSizes[level];
     };
 
     /*! Get the area of an octant (for 2D case the same value of getSize).
@@ -303,7 +394,9 @@ namespace bitpit {
      */
     double
     PabloUniform::getArea(uint32_t idx) const {
-        return m_area * ParaTree::getArea(idx);
+        uint8_t level = getLevel(idx);
+        assert(level < m_levelAreas.size());
+        return m_levelAreas[level];
     };
 
     /*! Get the volume of an octant.
@@ -312,7 +405,9 @@ namespace bitpit {
      */
     double
     PabloUniform::getVolume(uint32_t idx) const {
-        return m_volume * ParaTree::getVolume(idx);
+        uint8_t level = getLevel(idx);
+        assert(level < m_levelVolumes.size());
+        return m_levelVolumes[level];
     };
 
     /*! Get the coordinates of the center of an octant.
@@ -504,7 +599,9 @@ namespace bitpit {
      */
     double
     PabloUniform::getSize(const Octant* oct) const {
-        return m_L * ParaTree::getSize(oct);
+        uint8_t level = oct->getLevel();
+        assert(level < m_levelSizes.size());
+        return m_levelSizes[level];
     };
 
     /*! Get the area of an octant (for 2D case the same value of getSize).
@@ -513,7 +610,9 @@ namespace bitpit {
      */
     double
     PabloUniform::getArea(const Octant* oct) const {
-        return m_area * ParaTree::getArea(oct);
+        uint8_t level = oct->getLevel();
+        assert(level < m_levelAreas.size());
+        return m_levelAreas[level];
     };
 
     /*! Get the volume of an octant.
@@ -522,7 +621,9 @@ namespace bitpit {
      */
     double
     PabloUniform::getVolume(const Octant* oct) const {
-        return m_volume * ParaTree::getVolume(oct);
+        uint8_t level = oct->getLevel();
+        assert(level < m_levelVolumes.size());
+        return m_levelVolumes[level];
     };
 
     /*! Get the coordinates of the center of an octant.
@@ -655,6 +756,86 @@ namespace bitpit {
         return ParaTree::getNormal(oct, iface);
     }
 
+    // =================================================================================== //
+    // LOCAL OCTANTS BASED METHODS														   //
+    // =================================================================================== //
+    /*! Get the sizes of all the local octants.
+     * \param[out] sizes Sizes of the octants, it's up to the caller to
+     * allocate enough space for all the local octants.
+     */
+    void
+    PabloUniform::getSizes(double *sizes) const {
+        const double *levelValues = m_levelSizes.data();
+
+        uint32_t nOctants = getNumOctants();
+        for (uint32_t idx=0; idx<nOctants; idx++){
+            uint8_t level = getOctant(idx)->getLevel();
+            assert(level < m_levelSizes.size());
+            sizes[idx] = levelValues[level];
+        }
+    };
+
+    /*! Get the areas of all the local octants.
+     * \param[out] areas Areas of the octants, it's up to the caller to
+     * allocate enough space for all the local octants.
+     */
+    void
+    PabloUniform::getAreas(double *areas) const {
+        const double *levelValues = m_levelAreas.data();
+
+        uint32_t nOctants = getNumOctants();
+        for (uint32_t idx=0; idx<nOctants; idx++){
+            uint8_t level = getOctant(idx)->getLevel();
+            assert(level < m_levelAreas.size());
+            areas[idx] = levelValues[level];
+        }
+    };
+
+    /*! Get the volumes of all the local octants.
+     * \param[out] volumes Volumes of the octants, it's up to the caller to
+     * allocate enough space for all the local octants.
+     */
+    void
+    PabloUniform::getVolumes(double *volumes) const {
+        const double *levelValues = m_levelVolumes.data();
+
+        uint32_t nOctants = getNumOctants();
+        for (uint32_t idx=0; idx<nOctants; idx++){
+            uint8_t level = getOctant(idx)->getLevel();
+            assert(level < m_levelVolumes.size());
+            volumes[idx] = levelValues[level];
+        }
+    };
+
+    /*! Get the coordinates of the centers of all the local octants.
+     *
+     * Coordinates are returned in separate arrays, one for each direction.
+     * In two dimensions the z coordinates of the centers are set anyway.
+     *
+     * \param[out] xCenters X coordinates of the centers of the octants
+     * \param[out] yCenters Y coordinates of the centers of the octants
+     * \param[out] zCenters Z coordinates of the centers of the octants
+     * It's up to the caller to allocate enough space for all the local
+     * octants.
+     */
+    void
+    PabloUniform::getCenters(double *xCenters, double *yCenters, double *zCenters) const {
+        // Domain data are copied into local variables, otherwise they
+        // have to be reloaded after every store into the output arrays.
+        const double L = m_L;
+        const darray3 origin = m_origin;
+        const double maxLength_1 = 1. / double(getMaxLength());
+
+        uint32_t nOctants = getNumOctants();
+        for (uint32_t idx=0; idx<nOctants; idx++){
+            darray3 center = getOctant(idx)->getLogicalCenter();
+
+            xCenters[idx] = origin[0] + L * (maxLength_1 * center[0]);
+            yCenters[idx] = origin[1] + L * (maxLength_1 * center[1]);
+            zCenters[idx] = origin[2] + L * (maxLength_1 * center[2]);
+        }
+    };
+
     // =================================================================================== //
     // LOCAL TREE GET/SET METHODS														   //
     // =================================================================================== //
@@ -834,6 +1015,44 @@ namespace bitpit {
         }
         return ParaTree::getPointOwnerIdx(point,isghost);
     };
+
+    /** Get the octants owner of a list of input points.
+     * Only the internal octants are considered, points owned by other
+     * processes are not located.
+     * \param[in] nPoints Number of points.
+     * \param[in] points Coordinates of target points.
+     * \param[out] idx On output will contain the index of the octant owner
+     * of every target point (max uint32_t representable if the point is
+     * outside of the local domain).
+     */
+    void
+    PabloUniform::getPointOwnerIdx(std::size_t nPoints, const darray3 *points, uint32_t *idx) const {
+        getPointOwnerIdx(nPoints, points, idx, nullptr);
+    };
+
+    /** Get the octants owner of a list of input points.
+     * See ParaTree::getPointOwnerIdx(std::size_t, const darray3 *, uint32_t *, bool *)
+     * for a description of the algorithm.
+     * \param[in] nPoints Number of points.
+     * \param[in] points Coordinates of target points.
+     * \param[out] idx On output will contain the index of the octant owner
+     * of every target point (max uint32_t representable if the point is
+     * outside of the ghosted domain).
+     * \param[out] isghost On output will contain a flag for every target
+     * point that will be true if the octant found is ghost. If a null pointer
+     * is passed, the ghost octants are not considered.
+     */
+    void
+    PabloUniform::getPointOwnerIdx(std::size_t nPoints, const darray3 *points, uint32_t *idx, bool *isghost) const {
+        std::vector<darray3> logicalPoints(nPoints);
+        for (std::size_t n = 0; n < nPoints; ++n) {
+            for (int i=0; i<3; i++){
+                logicalPoints[n][i] = (points[n][i] - m_origin[i])/m_L;
+            }
+        }
+
+        ParaTree::getPointOwnerIdx(nPoints, logicalPoints.data(), idx, isghost);
+    };
     
     /** Get the octant owner rank of an input point.
      * \param[in] point Coordinates of target point.
@@ -68,6 +68,9 @@ namespace bitpit {
         double 		m_L;					/**<Side length of octree in the physical domain*/
         double 		m_area;					/**<Area of octree in the physical domain*/
         double 		m_volume;				/**<Volume of octree in the physical domain*/
+        dvector		m_levelSizes;			/**<Size of the octants of each level in the physical domain*/
+        dvector		m_levelAreas;			/**<Area of the octants of each level in the physical domain*/
+        dvector		m_levelVolumes;			/**<Volume of the octants of each level in the physical domain*/
 
         // =================================================================================== //
         // CONSTRUCTORS AND OPERATORS
@@ -77,6 +80,7 @@ namespace bitpit {
         // METHODS
         // =================================================================================== //
         void	__reset();
+        void	__updateLevelGeometry();
     public:
 #if BITPIT_ENABLE_MPI==1
         PabloUniform(const std::string &logfile = DEFAULT_LOG_FILE, MPI_Comm comm = MPI_COMM_WORLD);
@@ -97,6 +101,15 @@ namespace bitpit {
         void	dump(std::ostream &stream, bool full = true) override;
         void	restore(std::istream &stream) override;
 
+    protected:
+#if BITPIT_ENABLE_MPI==1
+        int		getCollectiveDumpVersion() const override;
+        void	dumpCollectiveHeader(OBinaryStream &stream) override;
+        void	restoreCollectiveHeader(IBinaryStream &stream) override;
+#endif
+
+    public:
+
         // =================================================================================== //
         // BASIC GET/SET METHODS															   //
         // =================================================================================== //
@@ -151,6 +164,14 @@ namespace bitpit {
         void 		getNormal(const Octant* oct, uint8_t iface, darray3 & normal) const;
         darray3 	getNormal(const Octant* oct, uint8_t iface) const;
 
+        // =================================================================================== //
+        // LOCAL OCTANTS BASED METHODS														   //
+        // =================================================================================== //
+        void 		getSizes(double *sizes) const;
+        void 		getAreas(double *areas) const;
+        void 		getVolumes(double *volumes) const;
+        void 		getCenters(double *xCenters, double *yCenters, double *zCenters) const;
+
         // =================================================================================== //
         // LOCAL TREE GET/SET METHODS														   //
         // =================================================================================== //
@@ -174,6 +195,8 @@ namespace bitpit {
         uint32_t getPointOwnerIdx(darray3 point) const;
         Octant* getPointOwner(darray3 point, bool & isghost);
         uint32_t getPointOwnerIdx(darray3 point, bool & isghost) const;
+        void getPointOwnerIdx(std::size_t nPoints, const darray3 *points, uint32_t *idx) const;
+        void getPointOwnerIdx(std::size_t nPoints, const darray3 *points, uint32_t *idx, bool *isghost) const;
         int getPointOwnerRank(darray3 point);
 
         // =================================================================================== //
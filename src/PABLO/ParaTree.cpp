@@ -29,6 +29,7 @@
 
 #include "ParaTree.hpp"
 #include <climits>
+#include <memory>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
@@ -119,6 +120,7 @@ namespace bitpit {
     // =================================================================================== //
 
     const std::string	ParaTree::DEFAULT_LOG_FILE   = "PABLO";
+    const uint32_t		ParaTree::LOADBALANCE_CHUNK_SIZE = 1024;
 
     // =================================================================================== //
     // CONSTRUCTORS AND OPERATORS														   //
@@ -454,6 +456,9 @@ namespace bitpit {
 
         m_lastOp = OP_INIT;
 
+        m_balanceIterationCount     = 0;
+        m_balanceCommunicationCount = 0;
+
         m_bordersPerProc.clear();
         m_internals.clear();
         m_pborders.clear();
@@ -734,6 +739,297 @@ namespace bitpit {
         }
     }
 
+#if BITPIT_ENABLE_MPI==1
+    // =============================================================================== //
+
+    /*! Get the version associated to the collective binary dumps.
+     *
+     *  \result The version associated to the collective binary dumps.
+     */
+    int ParaTree::getCollectiveDumpVersion() const
+    {
+        const int COLLECTIVE_DUMP_VERSION = 1;
+
+        return COLLECTIVE_DUMP_VERSION;
+    }
+
+    // =============================================================================== //
+
+    /*! Write the properties of the tree to the header of a collective dump.
+     *
+     *  \param stream is the stream to write to
+     */
+    void ParaTree::dumpCollectiveHeader(OBinaryStream &stream)
+    {
+        stream << getDim();
+        stream << getNofGhostLayers();
+        stream << getBalanceCodimension();
+        stream << getStatus();
+
+        for (int i = 0; i < m_treeConstants->nFaces; i++) {
+            stream << getPeriodic(i);
+        }
+
+        stream << getGlobalNumOctants();
+    }
+
+    // =============================================================================== //
+
+    /*! Restore the properties of the tree from the header of a collective dump.
+     *
+     *  The tree is re-initialized using the dimension read from the header.
+     *
+     *  \param stream is the stream to read from
+     */
+    void ParaTree::restoreCollectiveHeader(IBinaryStream &stream)
+    {
+        // Initialize the tree
+        uint8_t dimension;
+        stream >> dimension;
+
+        m_octree.initialize(dimension);
+        m_trans.initialize(dimension);
+        reinitialize(dimension, m_log->getName());
+        reset(false);
+
+        // Set tree properties
+        stream >> m_nofGhostLayers;
+
+        uint8_t balanceCodimension;
+        stream >> balanceCodimension;
+        setBalanceCodimension(balanceCodimension);
+
+        stream >> m_status;
+
+        for (int i = 0; i < m_treeConstants->nFaces; i++) {
+            bool periodicBorder;
+            stream >> periodicBorder;
+            if (periodicBorder){
+                setPeriodic(i);
+            }
+        }
+
+        stream >> m_globalNumOctants;
+    }
+
+    // =============================================================================== //
+
+    /*! Write the octree to the specified file using collective MPI-IO operations.
+     *
+     *  All the processes write to the same file. The file contains a header,
+     *  written by the first process, followed by the octants of all the
+     *  processes sorted by their Morton index. The header contains the
+     *  properties of the tree and the global distribution of the octants
+     *  among the processes, hence the file can be restored by a different
+     *  number of processes.
+     *
+     *  Only the octants are dumped, information about the mapping of the
+     *  last operation is not stored.
+     *
+     *  \param filename is the name of the file
+     */
+    void ParaTree::dumpCollective(const std::string &filename)
+    {
+        // Octants that will be dumped by this process
+        //
+        // If the tree is serial, all processes own all the octants, hence
+        // only the first process will dump them.
+        uint64_t nDumpedOctants = 0;
+        if (!m_serial || m_rank == 0) {
+            nDumpedOctants = getNumOctants();
+        }
+
+        uint64_t octantOffset = 0;
+        MPI_Exscan(&nDumpedOctants, &octantOffset, 1, MPI_UINT64_T, MPI_SUM, m_comm);
+        if (m_rank == 0) {
+            octantOffset = 0;
+        }
+
+        // Header
+        OBinaryStream headerStream;
+        headerStream << getCollectiveDumpVersion();
+
+        headerStream << m_nproc;
+        headerStream << m_serial;
+        for (int p = 0; p < m_nproc; ++p) {
+            uint64_t nPartitionOctants;
+            if (m_serial) {
+                nPartitionOctants = (p == 0) ? m_globalNumOctants : 0;
+            } else if (p == 0) {
+                nPartitionOctants = m_partitionRangeGlobalIdx[p] + 1;
+            } else {
+                nPartitionOctants = m_partitionRangeGlobalIdx[p] - m_partitionRangeGlobalIdx[p - 1];
+            }
+
+            headerStream << nPartitionOctants;
+        }
+
+        dumpCollectiveHeader(headerStream);
+        headerStream.squeeze();
+
+        uint64_t headerSize = headerStream.getSize();
+
+        // Octants
+        const std::size_t octantBinarySize = Octant::getBinarySize();
+
+        OBinaryStream octantStream(nDumpedOctants * octantBinarySize);
+        for (uint64_t i = 0; i < nDumpedOctants; ++i) {
+            octantStream << m_octree.m_octants[i];
+        }
+
+        // Write the file
+        MPI_File file;
+        int openStatus = MPI_File_open(m_comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file);
+        if (openStatus != MPI_SUCCESS) {
+            throw std::runtime_error("Unable to open file \"" + filename + "\" for writing.");
+        }
+
+        MPI_File_set_size(file, 0);
+
+        if (m_rank == 0) {
+            MPI_File_write_at(file, 0, &headerSize, 1, MPI_UINT64_T, MPI_STATUS_IGNORE);
+            MPI_File_write_at(file, sizeof(uint64_t), headerStream.data(), static_cast<int>(headerSize), MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+
+        // The number of items that can be written by a single MPI call is
+        // limited to INT_MAX, octants are therefore written in chunks.
+        // Collective calls have to be invoked by all the processes, also
+        // by the ones that have no more data to write.
+        uint64_t octantBytes = nDumpedOctants * octantBinarySize;
+        uint64_t nChunks = (octantBytes + INT_MAX - 1) / INT_MAX;
+        MPI_Allreduce(MPI_IN_PLACE, &nChunks, 1, MPI_UINT64_T, MPI_MAX, m_comm);
+
+        MPI_Offset octantFileOffset = sizeof(uint64_t) + headerSize + octantOffset * octantBinarySize;
+        for (uint64_t k = 0; k < nChunks; ++k) {
+            uint64_t chunkBegin = std::min(k * INT_MAX, octantBytes);
+            uint64_t chunkEnd   = std::min((k + 1) * INT_MAX, octantBytes);
+            int chunkSize = static_cast<int>(chunkEnd - chunkBegin);
+
+            MPI_File_write_at_all(file, octantFileOffset + chunkBegin, octantStream.data() + chunkBegin, chunkSize, MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+
+        MPI_File_close(&file);
+    }
+
+    // =============================================================================== //
+
+    /*! Restore the octree from the specified file using collective MPI-IO
+     *  operations.
+     *
+     *  The file can be restored by a number of processes different from the
+     *  one that wrote it. If the number of processes matches the one used
+     *  when writing the file, the dumped distribution of the octants is
+     *  retained, otherwise octants are evenly distributed among processes.
+     *  Every process reads only the portion of the Morton curve assigned to
+     *  it by the partition.
+     *
+     *  \param filename is the name of the file
+     */
+    void ParaTree::restoreCollective(const std::string &filename)
+    {
+        MPI_File file;
+        int openStatus = MPI_File_open(m_comm, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file);
+        if (openStatus != MPI_SUCCESS) {
+            throw std::runtime_error("Unable to open file \"" + filename + "\" for reading.");
+        }
+
+        // Header
+        uint64_t headerSize;
+        MPI_File_read_at_all(file, 0, &headerSize, 1, MPI_UINT64_T, MPI_STATUS_IGNORE);
+
+        IBinaryStream headerStream(headerSize);
+        MPI_File_read_at_all(file, sizeof(uint64_t), headerStream.data(), static_cast<int>(headerSize), MPI_BYTE, MPI_STATUS_IGNORE);
+
+        int version;
+        headerStream >> version;
+        if (version != getCollectiveDumpVersion()) {
+            MPI_File_close(&file);
+            throw std::runtime_error ("The version of the file does not match the required version");
+        }
+
+        int nDumpProcs;
+        headerStream >> nDumpProcs;
+
+        bool dumpSerial;
+        headerStream >> dumpSerial;
+
+        std::vector<uint64_t> dumpPartition(nDumpProcs);
+        for (int p = 0; p < nDumpProcs; ++p) {
+            headerStream >> dumpPartition[p];
+        }
+
+        restoreCollectiveHeader(headerStream);
+
+        // Evaluate the partition
+        std::vector<uint32_t> partition(m_nproc);
+        if (nDumpProcs == m_nproc && !dumpSerial) {
+            for (int p = 0; p < m_nproc; ++p) {
+                partition[p] = static_cast<uint32_t>(dumpPartition[p]);
+            }
+        } else {
+            computePartition(partition.data());
+        }
+
+        uint64_t nOctants = partition[m_rank];
+
+        uint64_t octantOffset = 0;
+        for (int p = 0; p < m_rank; ++p) {
+            octantOffset += partition[p];
+        }
+
+        // Read the octants
+        const std::size_t octantBinarySize = Octant::getBinarySize();
+
+        uint64_t octantBytes = nOctants * octantBinarySize;
+        uint64_t nChunks = (octantBytes + INT_MAX - 1) / INT_MAX;
+        MPI_Allreduce(MPI_IN_PLACE, &nChunks, 1, MPI_UINT64_T, MPI_MAX, m_comm);
+
+        IBinaryStream octantStream(octantBytes);
+        MPI_Offset octantFileOffset = sizeof(uint64_t) + headerSize + octantOffset * octantBinarySize;
+        for (uint64_t k = 0; k < nChunks; ++k) {
+            uint64_t chunkBegin = std::min(k * INT_MAX, octantBytes);
+            uint64_t chunkEnd   = std::min((k + 1) * INT_MAX, octantBytes);
+            int chunkSize = static_cast<int>(chunkEnd - chunkBegin);
+
+            MPI_File_read_at_all(file, octantFileOffset + chunkBegin, octantStream.data() + chunkBegin, chunkSize, MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+
+        MPI_File_close(&file);
+
+        m_octree.m_octants.clear();
+        m_octree.m_octants.reserve(nOctants);
+        for (uint64_t i = 0; i < nOctants; ++i) {
+            Octant octant;
+            octantStream >> octant;
+            m_octree.m_octants.push_back(std::move(octant));
+        }
+        m_octree.m_sizeOctants = m_octree.m_octants.size();
+
+        // Update partitioning information
+        if (m_nproc > 1) {
+            updateLoadBalance();
+            m_errorFlag = MPI_Allreduce(&m_octree.m_localMaxDepth, &m_maxDepth, 1, MPI_INT8_T, MPI_MAX, m_comm);
+            computeGhostHalo();
+        } else {
+            m_octree.updateLocalMaxDepth();
+            m_maxDepth = m_octree.m_localMaxDepth;
+
+            m_octree.setFirstDescMorton();
+            m_octree.setLastDescMorton();
+            m_partitionFirstDesc[0] = m_octree.getFirstDescMorton();
+            m_partitionLastDesc[0]  = m_octree.getLastDescMorton();
+            m_partitionRangeGlobalIdx[0] = m_globalNumOctants - 1;
+        }
+
+        for (int i = 0; i < m_nproc; ++i) {
+            m_partitionRangeGlobalIdx0[i] = 0;
+        }
+
+        m_mapIdx.clear();
+        m_lastOp = OP_INIT;
+    }
+#endif
+
     // =============================================================================== //
 
     /*! Print the initial PABLO header.
@@ -2161,6 +2457,36 @@ namespace bitpit {
         return m_octree.getBalanceCodim();
     };
 
+    /*! Get the number of iterations performed by the last 2:1 balancing.
+     * Each iteration exchanges the markers of the border octants and
+     * propagates the modified markers through the local octants.
+     * \return Number of iterations performed by the last 2:1 balancing.
+     */
+    int
+    ParaTree::getBalanceIterationCount() const{
+        return m_balanceIterationCount;
+    };
+
+    /*! Get the number of communication rounds performed by the last 2:1
+     * balancing. An exchange of the markers of the border octants counts as
+     * one round, also when the global reduction needed to check the
+     * convergence is overlapped with it.
+     * \return Number of communication rounds performed by the last 2:1
+     * balancing, it is zero if the octree is not partitioned.
+     */
+    int
+    ParaTree::getBalanceCommunicationCount() const{
+        return m_balanceCommunicationCount;
+    };
+
+    /*! Get the maximum number of threads used for refining the local octants.
+     * \return Maximum number of threads used for refining the local octants.
+     */
+    int
+    ParaTree::getRefinementThreadCount() const{
+        return m_octree.getRefinementThreadCount();
+    };
+
     /*!Get the first possible descendant with maximum refinement level of the local tree.
      * \return Constant reference to the first finest descendant of the local tree.
      */
@@ -2228,6 +2554,20 @@ namespace bitpit {
         m_octree.setBalanceCodim(b21codim);
     };
 
+    /*! Set the maximum number of threads used for refining the local octants.
+     * Refinement is serial by default. When more threads are allowed, the
+     * local octants are split in contiguous chunks refined concurrently, the
+     * resulting octants and mapping are the same of the serial refinement.
+     * Threads are used only when the local tree is large enough to give each
+     * thread a few thousand octants. Coarsening is always serial.
+     * \param[in] nThreads Maximum number of threads used for refining the
+     * local octants, values lower than one are treated as one.
+     */
+    void
+    ParaTree::setRefinementThreadCount(int nThreads){
+        m_octree.setRefinementThreadCount(nThreads);
+    };
+
     // =================================================================================== //
     // INTERSECTION GET/SET METHODS
     // =================================================================================== //
@@ -3131,7 +3471,7 @@ namespace bitpit {
         powner = 0;
         if(!m_serial) powner = findOwner(morton);
 
-        if (powner==m_rank){
+        if (m_serial || powner==m_rank){
 
             int32_t jump = idxtry;
             while(abs(jump) > 0){
@@ -3174,9 +3514,6 @@ namespace bitpit {
                 return idxtry;
             }
         }
-        else if((powner != m_rank) && m_serial){
-            return numeric_limits<uint32_t>::max();
-        }
         else{
             //GHOST SEARCH
             uint32_t nghosts = m_octree.m_ghosts.size();
@@ -3241,6 +3578,178 @@ namespace bitpit {
         }///end ghosts search
     };
 
+    /** Get the octants owner of a list of input points.
+     * Only the internal octants are considered, points owned by other
+     * processes are not located.
+     * \param[in] nPoints Number of points.
+     * \param[in] points Coordinates of target points.
+     * \param[out] idx On output will contain the index of the octant owner
+     * of every target point (max uint32_t representable if the point is
+     * outside of the local domain).
+     */
+    void
+    ParaTree::getPointOwnerIdx(std::size_t nPoints, const darray3 *points, uint32_t *idx) const {
+        getPointOwnerIdx(nPoints, points, idx, nullptr);
+    };
+
+    /** Get the octants owner of a list of input points.
+     * The results are the same that would be obtained locating the points
+     * one by one, however the points are located together: the Morton numbers
+     * of the points are sorted and the octants are visited in a single pass,
+     * hence this function is much faster than the location of the single
+     * points when the number of points is large.
+     * \param[in] nPoints Number of points.
+     * \param[in] points Coordinates of target points.
+     * \param[out] idx On output will contain the index of the octant owner
+     * of every target point (max uint32_t representable if the point is
+     * outside of the ghosted domain).
+     * \param[out] isghost On output will contain a flag for every target
+     * point that will be true if the octant found is ghost. If a null pointer
+     * is passed, the ghost octants are not considered.
+     */
+    void
+    ParaTree::getPointOwnerIdx(std::size_t nPoints, const darray3 *points, uint32_t *idx, bool *isghost) const {
+        const uint32_t NULL_IDX = numeric_limits<uint32_t>::max();
+
+        uint32_t noctants = m_octree.m_octants.size();
+        uint32_t nghosts  = m_octree.m_ghosts.size();
+
+        bool searchGhosts = (isghost != nullptr) && (nghosts > 0);
+
+        // Morton numbers of the octants are aligned to the level of the
+        // octants, hence, when looking for the owner of a point, the bits
+        // of the Morton number of the point below the finest level of the
+        // octants can be discarded. This reduces the number of bits that
+        // need to be sorted.
+        //
+        // Ghost octants don't cover the whole domain, only the points whose
+        // Morton number is between the Morton number of the first ghost and
+        // the Morton number of the upper corner of the last ghost can be
+        // owned by a ghost (the check on the ghost octants includes their
+        // upper faces).
+        int8_t maxLevel = m_treeConstants->maxLevel;
+        uint32_t maxLength = getMaxLength();
+
+        int8_t octantsMaxDepth = 0;
+        for (const Octant &octant : m_octree.m_octants) {
+            octantsMaxDepth = std::max(octantsMaxDepth, int8_t(octant.getLevel()));
+        }
+        int octantsShift = m_dim * (maxLevel - octantsMaxDepth);
+
+        int8_t ghostsMaxDepth = 0;
+        uint64_t ghostsFirstMorton = PABLO::INVALID_MORTON;
+        uint64_t ghostsLastMorton  = PABLO::INVALID_MORTON;
+        if (searchGhosts) {
+            for (const Octant &ghost : m_octree.m_ghosts) {
+                ghostsMaxDepth = std::max(ghostsMaxDepth, int8_t(ghost.getLevel()));
+            }
+
+            ghostsFirstMorton = m_octree.m_ghosts.front().getMorton();
+
+            u32array3 lastGhostCorner = m_octree.m_ghosts.back().getLogicalNode(m_treeConstants->nNodes - 1);
+            for (int i = 0; i < 3; ++i) {
+                lastGhostCorner[i] = std::min(lastGhostCorner[i], maxLength - 1);
+            }
+            ghostsLastMorton = PABLO::computeMorton(m_dim, lastGhostCorner[0], lastGhostCorner[1], lastGhostCorner[2]);
+        }
+        int ghostsShift = m_dim * (maxLevel - ghostsMaxDepth);
+
+        // Compute the Morton number of the points
+        //
+        // Points outside the domain are not located, points inside the
+        // domain are split among the points owned by the local octants and
+        // the points that may be owned by the ghost octants. Shifted Morton
+        // numbers are stored together with the index of the points.
+
+        std::vector<std::pair<uint64_t, std::size_t>> octantPointKeys;
+        std::vector<std::pair<uint64_t, std::size_t>> ghostPointKeys;
+        for (std::size_t n = 0; n < nPoints; ++n) {
+            idx[n] = NULL_IDX;
+            if (isghost) {
+                isghost[n] = false;
+            }
+
+            //ParaTree works in [0,1] domain
+            const darray3 &point = points[n];
+            if (point[0] > 1+m_tol || point[1] > 1+m_tol || point[2] > 1+m_tol
+                || point[0] < -m_tol || point[1] < -m_tol || point[2] < -m_tol){
+                continue;
+            }
+
+            uint32_t x = m_trans.mapX(std::min(std::max(point[0], 0.0), 1.0));
+            uint32_t y = m_trans.mapY(std::min(std::max(point[1], 0.0), 1.0));
+            uint32_t z = m_trans.mapZ(std::min(std::max(point[2], 0.0), 1.0));
+
+            if (x == maxLength) x = x - 1;
+            if (y == maxLength) y = y - 1;
+            if (z == maxLength) z = z - 1;
+
+            uint64_t morton = PABLO::computeMorton(m_dim, x, y, z);
+
+            int powner = 0;
+            if(!m_serial) powner = findOwner(morton);
+
+            if (m_serial || powner == m_rank) {
+                if (noctants > 0) {
+                    octantPointKeys.emplace_back(morton >> octantsShift, n);
+                }
+            } else if (searchGhosts) {
+                if (morton >= ghostsFirstMorton && morton <= ghostsLastMorton) {
+                    ghostPointKeys.emplace_back(morton >> ghostsShift, n);
+                }
+            }
+        }
+
+        // Locate the points owned by the local octants
+        //
+        // Octants are sorted by Morton number, hence the owner of a point is
+        // the last octant whose Morton number is not greater than the Morton
+        // number of the point. Since also the points are sorted, octants are
+        // visited only once.
+        PABLO::sortMortonKeys(m_dim * octantsMaxDepth, &octantPointKeys);
+
+        uint32_t octantIdx = 0;
+        for (const std::pair<uint64_t, std::size_t> &pointKey : octantPointKeys) {
+            uint64_t key = pointKey.first;
+            while (octantIdx + 1 < noctants && (m_octree.m_octants[octantIdx + 1].getMorton() >> octantsShift) <= key) {
+                ++octantIdx;
+            }
+
+            idx[pointKey.second] = octantIdx;
+        }
+
+        // Locate the points owned by the ghost octants
+        //
+        // The candidate ghost octant is found as for the local octants,
+        // however the ghost octants don't cover the whole domain, hence it's
+        // necessary to check if the candidate octant contains the point.
+        PABLO::sortMortonKeys(m_dim * ghostsMaxDepth, &ghostPointKeys);
+
+        uint32_t ghostIdx = 0;
+        for (const std::pair<uint64_t, std::size_t> &pointKey : ghostPointKeys) {
+            uint64_t key = pointKey.first;
+            while (ghostIdx + 1 < nghosts && (m_octree.m_ghosts[ghostIdx + 1].getMorton() >> ghostsShift) <= key) {
+                ++ghostIdx;
+            }
+
+            std::size_t n = pointKey.second;
+            const darray3 &point = points[n];
+            const Octant* octtry = getGhostOctant(ghostIdx);
+            darray3 anchor_idxtry = {{getX(octtry),getY(octtry),getZ(octtry)}};
+            double size_try = getSize(octtry);
+            bool isInIdxtry = true;
+
+            for(int i = 0; i < m_dim; ++i){
+                isInIdxtry = isInIdxtry && (point[i] >= anchor_idxtry[i] && point[i] <= (anchor_idxtry[i] + size_try));
+            }
+
+            if (isInIdxtry) {
+                idx[n]     = ghostIdx;
+                isghost[n] = true;
+            }
+        }
+    };
+
     /** Get the octant owner rank of an input point.
      * \param[in] point Coordinates of target point.
      * \return Owner rank of target point (negative if out of global domain).
@@ -3283,12 +3792,7 @@ namespace bitpit {
 
         morton = PABLO::computeMorton(m_dim, x, y, z);
 
-        for (int p = 0; p < m_nproc; ++p){
-            if (morton <= m_partitionLastDesc[p] && morton >= m_partitionFirstDesc[p])
-                return p;
-        }
-
-        return -1;
+        return findOwner(morton);
     };
 
     /** Get the local index of the node of a target octant, corresponding to the splitting node of its family; i.e. the index of the local node
@@ -4687,6 +5191,12 @@ namespace bitpit {
 
     /*! Compute the partition of the octree over the processes (only compute the information about
      * how distribute the mesh). This is an weighted distribution method: each process will have the same weight.
+     *
+     * The partition is evaluated cutting the Morton curve at the positions where the prefix sum of
+     * the weights crosses the multiples of the average partition weight. When the tree is distributed,
+     * the offset of the local weights is evaluated with a parallel prefix sum, hence global weights
+     * never need to be gathered: every process locates the cuts that fall inside its portion of the
+     * curve and only the cuts (one per process) are shared.
      * \param[out] partition Pointer to partition information array. partition[i] = number of octants
      * to be stored on the i-th process (i-th rank).
      * \param[in] weights Pointer to weight array. weight[i] = weight of i-th local octant.
@@ -4696,70 +5206,124 @@ namespace bitpit {
 
         assert(weight->size() >= m_octree.m_sizeOctants);
 
-        // Evaluate global weights
+        // Evaluate local weight and its offset along the curve
         //
         // If the tree is serial, all process have all the octants, hence
-        // global weights and local weights are the same.
-        std::vector<double> globalWeightsStorage;
-
-        const double *globalWeights;
-        if (m_serial) {
-            globalWeights = weight->data();
-        } else {
-            // Information about current partitioning and displacements should
-            // be stored using uint32_t, however the maximum number of items
-            // that can be exchanged using MPI funcitons is limited to INT_MAX.
-            assert(m_globalNumOctants <= INT_MAX);
-            std::vector<int> currentPartition(m_nproc);
-            MPI_Allgather(&(m_octree.m_sizeOctants), 1, MPI_INT, currentPartition.data(), 1, MPI_INT, m_comm);
-
-            std::vector<int> displacements(m_nproc);
-            displacements[0] = 0;
-            for(int i = 1; i < m_nproc; ++i){
-                displacements[i] = displacements[i - 1] + currentPartition[i - 1];
-            }
+        // the offset of the local weights is zero.
+        uint32_t nLocalOctants = m_octree.m_sizeOctants;
 
-            globalWeightsStorage.resize(m_globalNumOctants);
-            globalWeights = globalWeightsStorage.data();
-            MPI_Allgatherv(weight->data(), m_octree.m_sizeOctants, MPI_DOUBLE, globalWeightsStorage.data(),
-                           currentPartition.data(), displacements.data(), MPI_DOUBLE, m_comm);
+        double localWeight = 0.;
+        for (uint32_t n = 0; n < nLocalOctants; ++n) {
+            localWeight += (*weight)[n];
         }
 
-        // Initialize partitioning
-        for (int i = 0; i < m_nproc; ++i) {
-            partition[i] = 0;
+        double weightOffset = 0.;
+        double globalWeight = localWeight;
+        uint64_t octantOffset = 0;
+        if (!m_serial) {
+            uint64_t nLocalOctants64 = nLocalOctants;
+            MPI_Exscan(&localWeight, &weightOffset, 1, MPI_DOUBLE, MPI_SUM, m_comm);
+            MPI_Exscan(&nLocalOctants64, &octantOffset, 1, MPI_UINT64_T, MPI_SUM, m_comm);
+            if (m_rank == 0) {
+                weightOffset = 0.;
+                octantOffset = 0;
+            }
+
+            MPI_Allreduce(&localWeight, &globalWeight, 1, MPI_DOUBLE, MPI_SUM, m_comm);
         }
 
-        // Assign octants to partitions
+        // Evaluate the portion of the curve owned by the local process
         //
-        // After evaluationg the target weight of a partition, octants will
-        // be added to that partition until the weigth of the partition is
-        // greater or equal the target weigth or until all the octant are
-        // assigned
-        uint32_t nAssigendOctants = 0;
-        for (int i = 0; i < m_nproc - 1; ++i) {
-            double unassignedWeight = 0.;
-            for (uint32_t n=nAssigendOctants; n<m_globalNumOctants; n++){
-                unassignedWeight += globalWeights[n];
+        // The local sum of the weights and the offset evaluated by the next
+        // process may differ because of round-off errors, hence the end of
+        // the local portion is taken from the offset of the next process
+        // that has octants. This way the portions are half-open intervals
+        // (begin, end] that never overlap and leave no gaps: the first
+        // non-empty process owns everything before its end and the last
+        // non-empty process owns everything after its begin.
+        bool ownsBegin = true;
+        bool ownsEnd   = true;
+        double portionBegin = weightOffset;
+        double portionEnd   = weightOffset + localWeight;
+        if (!m_serial) {
+            std::vector<double> weightOffsets(m_nproc);
+            std::vector<uint32_t> octantCounts(m_nproc);
+            MPI_Allgather(&weightOffset, 1, MPI_DOUBLE, weightOffsets.data(), 1, MPI_DOUBLE, m_comm);
+            MPI_Allgather(&nLocalOctants, 1, MPI_UINT32_T, octantCounts.data(), 1, MPI_UINT32_T, m_comm);
+
+            for (int r = 0; r < m_rank; ++r) {
+                if (octantCounts[r] > 0) {
+                    ownsBegin = false;
+                    break;
+                }
             }
-            double targetWeight = unassignedWeight / (m_nproc - i);
 
-            double partitionWeight = 0.;
-            while(partitionWeight < targetWeight){
-                partitionWeight += globalWeights[nAssigendOctants];
-                partition[i]++;
-
-                nAssigendOctants++;
-                if (nAssigendOctants == m_globalNumOctants) {
+            for (int r = m_rank + 1; r < m_nproc; ++r) {
+                if (octantCounts[r] > 0) {
+                    ownsEnd = false;
+                    portionEnd = weightOffsets[r];
                     break;
                 }
             }
+        }
 
-            if (nAssigendOctants == m_globalNumOctants) {
+        // Locate the cuts that fall inside the local portion of the curve
+        //
+        // The i-th cut is the number of octants assigned to the processes
+        // up to the i-th one. Octants are added to a partition until the
+        // cumulative weight is greater or equal than the target weight.
+        // Each process evaluates only the cuts whose target falls inside
+        // its portion of the curve, cuts that are not found are marked
+        // with a negative value.
+        int nCuts = m_nproc - 1;
+        double averageWeight = globalWeight / m_nproc;
+
+        std::vector<int64_t> cuts(nCuts, -1);
+        if (nLocalOctants > 0) {
+            double cumulativeWeight = weightOffset;
+            uint32_t n = 0;
+            for (int i = 0; i < nCuts; ++i) {
+                double targetWeight = (i + 1) * averageWeight;
+                if (!ownsBegin && targetWeight <= portionBegin) {
+                    continue;
+                } else if (!ownsEnd && targetWeight > portionEnd) {
                     break;
+                }
+
+                while (cumulativeWeight < targetWeight && n < nLocalOctants) {
+                    cumulativeWeight += (*weight)[n];
+                    ++n;
+                }
+
+                cuts[i] = octantOffset + n;
             }
         }
-        partition[m_nproc-1] = m_globalNumOctants - nAssigendOctants;
+
+        if (!m_serial) {
+            MPI_Allreduce(MPI_IN_PLACE, cuts.data(), nCuts, MPI_INT64_T, MPI_MAX, m_comm);
+        }
+
+        // Evaluate the partitioning
+        //
+        // Since the portions of the curve cover the whole real line, every
+        // cut is found as long as the tree has octants. Cuts are clamped
+        // to be non-decreasing to guard against non-monotonic weights.
+        uint64_t previousCut = 0;
+        for (int i = 0; i < nCuts; ++i) {
+            uint64_t cut;
+            if (cuts[i] >= 0) {
+                cut = static_cast<uint64_t>(cuts[i]);
+            } else if ((i + 1) * averageWeight <= 0.) {
+                cut = 0;
+            } else {
+                cut = m_globalNumOctants;
+            }
+            cut = std::min(std::max(cut, previousCut), m_globalNumOctants);
+
+            partition[i] = static_cast<uint32_t>(cut - previousCut);
+            previousCut = cut;
+        }
+        partition[m_nproc - 1] = static_cast<uint32_t>(m_globalNumOctants - previousCut);
     };
 
     /*! Compute the partition of the octree over the processes (only compute the information about
@@ -5651,72 +6215,95 @@ namespace bitpit {
         ghostDataCommunicator.waitAllSends();
     }
 
-    /*! Communicate the marker of the octants and the auxiliary info[15].
+    /*! Initialize the communicator used to exchange the markers of the octants.
+     *
+     * Border octants don't change while the markers are modified, hence the
+     * communicator can be used for any number of marker exchanges, as long
+     * as the octree is not adapted or partitioned.
+     *
+     * \param[in,out] markerCommunicator is the communicator that will be
+     * initialized
      */
     void
-    ParaTree::commMarker() {
-        // If the tree is not partitioned, there is nothing to communicate.
-        if (m_serial) {
-            return;
+    ParaTree::initializeMarkerCommunicator(DataCommunicator *markerCommunicator) {
+        // Binary size of a marker entry in the communication buffer
+        const std::size_t MARKER_ENTRY_BINARY_SIZE = sizeof(int8_t) + sizeof(bool);
+
+        // Set the sends
+        for(const auto &bordersPerProcEntry : m_bordersPerProc){
+            int rank = bordersPerProcEntry.first;
+            std::size_t nRankBorders = bordersPerProcEntry.second.size();
+
+            markerCommunicator->setSend(rank, nRankBorders * MARKER_ENTRY_BINARY_SIZE);
         }
 
+        // Discover the receives
+        markerCommunicator->discoverRecvs();
+    }
+
+    /*! Communicate the marker of the octants and the auxiliary info[15] using
+     * the specified communicator.
+     * \param[in,out] markerCommunicator is the communicator, it should have
+     * been initialized with initializeMarkerCommunicator
+     */
+    void
+    ParaTree::commMarker(DataCommunicator *markerCommunicator) {
         // Binary size of a marker entry in the communication buffer
         const std::size_t MARKER_ENTRY_BINARY_SIZE = sizeof(int8_t) + sizeof(bool);
 
+        // Start the receives
+        markerCommunicator->startAllRecvs();
+
         // Fill communication buffer with level and marker
         //
         // It visits every element in m_bordersPerProc (one for every neighbor proc)
         // for every element it visits the border octants it contains and write them in the bitpit communication structure, DataCommunicator
         // this structure has a buffer for every proc containing the octants to be sent to that proc written in a char* buffer
-        DataCommunicator markerCommunicator(m_comm);
-
         for(const auto &bordersPerProcEntry : m_bordersPerProc){
             int rank = bordersPerProcEntry.first;
-            const std::vector<uint32_t> &rankBordersPerProc = m_bordersPerProc.at(rank);
+            const std::vector<uint32_t> &rankBordersPerProc = bordersPerProcEntry.second;
             const std::size_t nRankBorders = rankBordersPerProc.size();
 
-            std::size_t buffSize = nRankBorders * MARKER_ENTRY_BINARY_SIZE;
-            markerCommunicator.setSend(rank, buffSize);
+            // Markers and auxiliary bits are written in two separate blocks
+            SendBuffer &sendBuffer = markerCommunicator->getSendBuffer(rank);
+            int8_t *markers = sendBuffer.reserve<int8_t>(nRankBorders);
+            for(std::size_t i = 0; i < nRankBorders; ++i){
+                markers[i] = m_octree.m_octants[rankBordersPerProc[i]].getMarker();
+            }
 
-            SendBuffer &sendBuffer = markerCommunicator.getSendBuffer(rank);
+            bool *auxs = sendBuffer.reserve<bool>(nRankBorders);
             for(std::size_t i = 0; i < nRankBorders; ++i){
-                const Octant &octant = m_octree.m_octants[rankBordersPerProc[i]];
-                sendBuffer << octant.getMarker();
-                sendBuffer << octant.m_info[Octant::INFO_AUX];
+                auxs[i] = m_octree.m_octants[rankBordersPerProc[i]].m_info[Octant::INFO_AUX];
             }
-        }
 
-        markerCommunicator.discoverRecvs();
-        markerCommunicator.startAllRecvs();
-        markerCommunicator.startAllSends();
+            markerCommunicator->startSend(rank);
+        }
 
         // Read level and marker from communication buffer
         //
         // every receive buffer is visited, and read octant by octant.
         // every ghost octant level and marker are updated
-        std::vector<int> recvRanks = markerCommunicator.getRecvRanks();
+        std::vector<int> recvRanks = markerCommunicator->getRecvRanks();
         std::sort(recvRanks.begin(), recvRanks.end());
 
         uint32_t ghostIdx = 0;
         for(int rank : recvRanks){
-            markerCommunicator.waitRecv(rank);
-            RecvBuffer &recvBuffer = markerCommunicator.getRecvBuffer(rank);
+            markerCommunicator->waitRecv(rank);
+            RecvBuffer &recvBuffer = markerCommunicator->getRecvBuffer(rank);
 
             const std::size_t nRankGhosts = recvBuffer.getSize() / MARKER_ENTRY_BINARY_SIZE;
+            const int8_t *markers = recvBuffer.read<int8_t>(nRankGhosts);
+            const bool *auxs = recvBuffer.read<bool>(nRankGhosts);
             for(std::size_t i = 0; i < nRankGhosts; ++i){
-                int8_t marker;
-                recvBuffer >> marker;
-                m_octree.m_ghosts[ghostIdx].setMarker(marker);
-
-                bool aux;
-                recvBuffer >> aux;
-                m_octree.m_ghosts[ghostIdx].m_info[Octant::INFO_AUX] = aux;
+                Octant &ghost = m_octree.m_ghosts[ghostIdx];
+                ghost.setMarker(markers[i]);
+                ghost.m_info[Octant::INFO_AUX] = auxs[i];
 
                 ++ghostIdx;
             }
         }
 
-        markerCommunicator.waitAllSends();
+        markerCommunicator->waitAllSends();
     }
 #endif
 
@@ -5754,40 +6341,73 @@ namespace bitpit {
             (*m_log) << " " << endl;
         }
 
+        // Initialize the communications
+        //
+        // The same communicator is used for all the marker exchanges, this
+        // avoids setting up the communications at every exchange.
+#if BITPIT_ENABLE_MPI==1
+        std::unique_ptr<DataCommunicator> markerCommunicator;
+        if (!m_serial) {
+            markerCommunicator = std::unique_ptr<DataCommunicator>(new DataCommunicator(m_comm));
+            initializeMarkerCommunicator(markerCommunicator.get());
+        }
+#endif
+
+        m_balanceIterationCount     = 0;
+        m_balanceCommunicationCount = 0;
+
         // 2:1 balancing
-        int iteration = 0;
+        //
+        // Within each process, the modified markers are propagated through
+        // the local octants using a worklist (see LocalTree::localBalance),
+        // hence the iterations are needed only to propagate the markers
+        // across the borders of the processes.
+        //
+        // Every iteration needs a single communication round: the markers
+        // modified by the pre-processing and by the local balance are sent
+        // to the neighbours together, while the reduction that checks the
+        // convergence is overlapped with the exchange. The exchange done
+        // in the last iteration is not wasted, it provides the up-to-date
+        // ghost markers needed by the post-processing.
+#if BITPIT_ENABLE_MPI==1
+        if (!m_serial) {
+            commMarker(markerCommunicator.get());
+            ++m_balanceCommunicationCount;
+        }
+#endif
+
         bool markersModified = true;
         while (markersModified) {
             if (verbose){
-                (*m_log) << " Iteration	:	" + to_string(iteration) << endl;
+                (*m_log) << " Iteration	:	" + to_string(m_balanceIterationCount) << endl;
             }
 
             // Only first iteration will process internl octants
-            bool processInternals = (iteration == 0);
-
-#if BITPIT_ENABLE_MPI==1
-            // Communicate markers
-            commMarker();
-#endif
+            bool processInternals = (m_balanceIterationCount == 0);
 
             // Pre-processing for 2:1 balancing
-            m_octree.preBalance21(processInternals);
-
-#if BITPIT_ENABLE_MPI==1
-            // Communicate markers
-            commMarker();
-#endif
+            bool preBalanceModified = m_octree.preBalance21(processInternals);
 
             // Execute local loadbalance
             markersModified = m_octree.localBalance(balanceNewOctants, processInternals);
 #if BITPIT_ENABLE_MPI==1
             if (!m_serial) {
-                MPI_Allreduce(MPI_IN_PLACE, &markersModified, 1, MPI_C_BOOL, MPI_LOR, m_comm);
+                // Markers modified by the pre-processing have not been
+                // balanced by the neighbours yet.
+                markersModified = markersModified || preBalanceModified;
+
+                MPI_Request convergenceRequest;
+                MPI_Iallreduce(MPI_IN_PLACE, &markersModified, 1, MPI_C_BOOL, MPI_LOR, m_comm, &convergenceRequest);
+                commMarker(markerCommunicator.get());
+                MPI_Wait(&convergenceRequest, MPI_STATUS_IGNORE);
+                ++m_balanceCommunicationCount;
             }
+#else
+            BITPIT_UNUSED(preBalanceModified);
 #endif
 
             // Increase iteration counter
-            iteration++;
+            ++m_balanceIterationCount;
         }
 
         // Post-processing for 2:1 balancing
@@ -5798,9 +6418,16 @@ namespace bitpit {
 
 #if BITPIT_ENABLE_MPI==1
         // Communicate markers
-        commMarker();
+        if (!m_serial) {
+            commMarker(markerCommunicator.get());
+            ++m_balanceCommunicationCount;
+        }
 #endif
 
+        if (verbose){
+            (*m_log) << " Communication rounds	:	" + to_string(m_balanceCommunicationCount) << endl;
+        }
+
         // Print footer
         if (verbose){
             (*m_log) << " 2:1 Balancing reached " << endl;
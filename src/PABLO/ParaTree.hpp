@@ -186,6 +186,7 @@ namespace bitpit {
                                                                 */
         //elements sent during last loadbalance operation
         LoadBalanceRanges         m_loadBalanceRanges;											  /**<Local mapper for sent elements. Each element refers to the receiver rank and collect the */
+        static const uint32_t     LOADBALANCE_CHUNK_SIZE;										  /**<Maximum number of octants whose data are packed together during load balance*/
 
         //auxiliary members
         int 					m_errorFlag;					/**<MPI error flag*/
@@ -203,6 +204,8 @@ namespace bitpit {
         uint64_t				m_status;						/**<Label of actual m_status of octree (incremental after an adpat
                                                                    with at least one modifyed element).*/
         Operation				m_lastOp;						/**<Last operation perforfmed by the octree (initialization, adapt (mapped or unmapped), loadbalance (first or not).*/
+        int					m_balanceIterationCount;		/**<Number of iterations performed by the last 2:1 balancing*/
+        int					m_balanceCommunicationCount;	/**<Number of communication rounds (marker exchanges and global reductions) performed by the last 2:1 balancing*/
 
         //log member
         Logger* 				m_log;							/**<Log object pointer*/
@@ -242,9 +245,22 @@ namespace bitpit {
         virtual int		getDumpVersion() const;
         virtual void	dump(std::ostream &stream, bool full = true);
         virtual void	restore(std::istream &stream);
+#if BITPIT_ENABLE_MPI==1
+        void	dumpCollective(const std::string &filename);
+        void	restoreCollective(const std::string &filename);
+#endif
 
         void	printHeader();
 
+    protected:
+#if BITPIT_ENABLE_MPI==1
+        virtual int		getCollectiveDumpVersion() const;
+        virtual void	dumpCollectiveHeader(OBinaryStream &stream);
+        virtual void	restoreCollectiveHeader(IBinaryStream &stream);
+#endif
+
+    public:
+
         // =================================================================================== //
         // BASIC GET/SET METHODS															   //
         // =================================================================================== //
@@ -390,6 +406,9 @@ namespace bitpit {
         double	 	getLocalMaxSize() const;
         double	 	getLocalMinSize() const;
         uint8_t 	getBalanceCodimension() const;
+        int 		getBalanceIterationCount() const;
+        int 		getBalanceCommunicationCount() const;
+        int 		getRefinementThreadCount() const;
         uint64_t 	getFirstDescMorton() const;
         uint64_t 	getLastDescMorton() const;
         uint64_t 	getLastDescMorton(uint32_t idx) const;
@@ -398,6 +417,7 @@ namespace bitpit {
         octantIterator	getPboundOctantsBegin();
         octantIterator	getPboundOctantsEnd();
         void 		setBalanceCodimension(uint8_t b21codim);
+        void 		setRefinementThreadCount(int nThreads);
 
         // =================================================================================== //
         // INTERSECTION GET/SET METHODS														   //
@@ -494,6 +514,8 @@ namespace bitpit {
         uint32_t 	getPointOwnerIdx(const dvector &point, bool & isghost) const;
         uint32_t 	getPointOwnerIdx(const darray3 &point) const;
         uint32_t 	getPointOwnerIdx(const darray3 &point, bool & isghost) const;
+        void 		getPointOwnerIdx(std::size_t nPoints, const darray3 *points, uint32_t *idx) const;
+        void 		getPointOwnerIdx(std::size_t nPoints, const darray3 *points, uint32_t *idx, bool *isghost) const;
         void 		getMapping(uint32_t & idx, u32vector & mapper, bvector & isghost) const;
         void 		getMapping(uint32_t & idx, u32vector & mapper, bvector & isghost, ivector & rank) const;
         void 		getPreMapping(u32vector & idx, std::vector<int8_t> & markers, std::vector<bool> & isghost);
@@ -570,7 +592,8 @@ namespace bitpit {
         void 		exchangeGhostHaloAccretions(DataCommunicator *dataCommunicator, std::vector<AccretionData> *accretions);
 
         void 		computeGhostHalo();
-        void 		commMarker();
+        void 		commMarker(DataCommunicator *markerCommunicator);
+        void 		initializeMarkerCommunicator(DataCommunicator *markerCommunicator);
 #endif
         void 		updateAfterCoarse();
         void 		balance21(bool verbose, bool balanceNewOctants);
@@ -860,10 +883,20 @@ namespace bitpit {
                     }
                     lbCommunicator.setSend(rank, buffSize);
 
+                    // Octants are packed in chunks, each chunk contains the
+                    // octants followed by the user data of those octants.
                     SendBuffer &sendBuffer = lbCommunicator.getSendBuffer(rank);
-                    for (uint32_t i = beginSendIdx; i < endSendIdx; ++i) {
-                        sendBuffer << m_octree.m_octants[i];
-                        userData->gather(sendBuffer, i);
+                    uint32_t beginChunkIdx = beginSendIdx;
+                    while (beginChunkIdx < endSendIdx) {
+                        uint32_t endChunkIdx = beginChunkIdx + std::min(endSendIdx - beginChunkIdx, LOADBALANCE_CHUNK_SIZE);
+                        for (uint32_t i = beginChunkIdx; i < endChunkIdx; ++i) {
+                            sendBuffer << m_octree.m_octants[i];
+                        }
+                        if (userData) {
+                            userData->gather(sendBuffer, beginChunkIdx, endChunkIdx);
+                        }
+
+                        beginChunkIdx = endChunkIdx;
                     }
 
                     lbCommunicator.startSend(rank);
@@ -950,11 +983,17 @@ namespace bitpit {
                     assert(userData || ((endRecvIdx - beginRecvIdx) == (recvBuffer.getSize() / (Octant::getBinarySize()))));
                     assert(!userData || !userData->fixedSize() || ((endRecvIdx - beginRecvIdx) == (recvBuffer.getSize() / (Octant::getBinarySize() + userData->fixedSize()))));
 
-                    for (uint32_t i = beginRecvIdx; i < endRecvIdx; ++i) {
-                        recvBuffer >> m_octree.m_octants[i];
+                    uint32_t beginChunkIdx = beginRecvIdx;
+                    while (beginChunkIdx < endRecvIdx) {
+                        uint32_t endChunkIdx = beginChunkIdx + std::min(endRecvIdx - beginChunkIdx, LOADBALANCE_CHUNK_SIZE);
+                        for (uint32_t i = beginChunkIdx; i < endChunkIdx; ++i) {
+                            recvBuffer >> m_octree.m_octants[i];
+                        }
                         if (userData) {
-                            userData->scatter(recvBuffer, i);
+                            userData->scatter(recvBuffer, beginChunkIdx, endChunkIdx);
                         }
+
+                        beginChunkIdx = endChunkIdx;
                     }
 
                     ++nCompletedRecvs;
@@ -26,9 +26,12 @@
 #define __BITPIT_PABLO_MORTON_HPP__
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <limits>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace bitpit {
 
@@ -336,6 +339,58 @@ inline uint64_t computeXYZKey(uint8_t dimension, uint32_t x, uint32_t y, uint32_
     }
 }
 
+/**
+* Sort the specified list of keys by Morton number.
+*
+* Keys are sorted using a least significant digit radix sort, which
+* processes the Morton numbers eight bits at a time. Only the specified
+* number of least significant bits is considered, hence the sort is
+* faster when the Morton numbers are shifted to discard the bits that
+* are not needed (e.g., the bits below the finest level of interest).
+* The sort is stable.
+*
+* \param nBits is the number of significant bits of the Morton numbers
+* \param[in,out] keys are the keys that will be sorted, the first item of
+* every key is its Morton number
+*/
+template<typename T>
+void sortMortonKeys(int nBits, std::vector<std::pair<uint64_t, T>> *keys)
+{
+    static const int DIGIT_BITS = 8;
+    static const std::size_t N_BUCKETS = (1 << DIGIT_BITS);
+    static const uint64_t DIGIT_MASK = N_BUCKETS - 1;
+
+    std::size_t nKeys = keys->size();
+    if (nKeys <= 1) {
+        return;
+    }
+
+    std::vector<std::pair<uint64_t, T>> sortedKeys(nKeys);
+    std::array<std::size_t, N_BUCKETS> bucketOffsets;
+    for (int shift = 0; shift < nBits; shift += DIGIT_BITS) {
+        // Count the keys in each bucket
+        bucketOffsets.fill(0);
+        for (const std::pair<uint64_t, T> &key : *keys) {
+            ++bucketOffsets[(key.first >> shift) & DIGIT_MASK];
+        }
+
+        // Evaluate the position of the first key of each bucket
+        std::size_t offset = 0;
+        for (std::size_t &bucketOffset : bucketOffsets) {
+            std::size_t bucketSize = bucketOffset;
+            bucketOffset = offset;
+            offset += bucketSize;
+        }
+
+        // Scatter the keys
+        for (const std::pair<uint64_t, T> &key : *keys) {
+            sortedKeys[bucketOffsets[(key.first >> shift) & DIGIT_MASK]++] = key;
+        }
+
+        keys->swap(sortedKeys);
+    }
+}
+
 }
 
 }
@@ -25,6 +25,8 @@
 #ifndef __BITPIT_COMMUNICATIONS_BUFFERS_HPP__
 #define __BITPIT_COMMUNICATIONS_BUFFERS_HPP__
 
+#include <cstddef>
+#include <type_traits>
 #include <vector>
 
 #include "bitpit_containers.hpp"
@@ -75,6 +77,9 @@ protected:
     RawBufferType & getFront();
     RawBufferType & getBack();
 
+    template<typename T>
+    static std::size_t evalAlignmentPadding(std::size_t pos);
+
     void swap();
 
     std::vector<RawBufferType> & getBuffers();
@@ -101,6 +106,9 @@ public:
 
     void write(const char *data, std::size_t size);
 
+    template<typename T>
+    T * reserve(std::size_t n);
+
 };
 
 class RecvBuffer : public CommunicationBuffer<RawRecvBuffer>
@@ -115,6 +123,9 @@ public:
 
     void read(char *data, std::size_t size);
 
+    template<typename T>
+    const T * read(std::size_t n);
+
 };
 
 }
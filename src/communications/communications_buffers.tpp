@@ -124,6 +124,27 @@ RawBufferType & CommunicationBuffer<RawBufferType>::getBack()
     return *m_back;
 }
 
+/*!
+    Evaluate the padding needed to align the specified position of the buffer
+    to the alignment requirement of the given type.
+
+    Memory of the raw buffers is aligned to the fundamental alignment, hence
+    aligning the position inside the buffer is enough to align the address.
+    Padding only depends on the position, hence sender and receiver evaluate
+    the same padding as long as they access data in the same order.
+
+    \param pos is the position inside the buffer
+    \result The padding (in bytes) needed to align the position.
+ */
+template<typename RawBufferType>
+template<typename T>
+std::size_t CommunicationBuffer<RawBufferType>::evalAlignmentPadding(std::size_t pos)
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+
+    return ((alignof(T) - pos % alignof(T)) % alignof(T));
+}
+
 /*!
     Swap front and back buffers.
  */
@@ -151,6 +172,56 @@ const std::vector<RawBufferType> & CommunicationBuffer<RawBufferType>::getBuffer
     return m_buffers;
 }
 
+/*!
+    Reserve space for writing the specified number of items into the buffer.
+
+    The function returns a pointer to the reserved space, items can be
+    written directly through the pointer. Reserved space is aligned to the
+    alignment requirement of the items: if needed, padding is added before
+    the reserved space, hence the buffer may grow by up to alignof(T) - 1
+    bytes more than the size of the items. The pointer is invalidated by any
+    subsequent operation that changes the size of the buffer.
+
+    Items should be read from the receive buffer using the corresponding
+    function RecvBuffer::read(std::size_t n).
+
+    \param n is the number of items
+    \result A pointer to the reserved space.
+*/
+template<typename T>
+T * SendBuffer::reserve(std::size_t n)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written in bulk");
+
+    RawSendBuffer &buffer = getFront();
+    std::size_t padding = evalAlignmentPadding<T>(buffer.tellg());
+    char *data = buffer.reserve(padding + n * sizeof(T));
+
+    return reinterpret_cast<T *>(data + padding);
+}
+
+/*!
+    Read the specified number of items from the buffer without copying them.
+
+    The function returns a pointer to the items stored in the buffer, items
+    should have been written using the function SendBuffer::reserve(std::size_t n).
+    The pointer remains valid until the buffer is resized.
+
+    \param n is the number of items
+    \result A pointer to the items.
+*/
+template<typename T>
+const T * RecvBuffer::read(std::size_t n)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read in bulk");
+
+    RawRecvBuffer &buffer = getFront();
+    std::size_t padding = evalAlignmentPadding<T>(buffer.tellg());
+    const char *data = buffer.consume(padding + n * sizeof(T));
+
+    return reinterpret_cast<const T *>(data + padding);
+}
+
 }
 
 /*!
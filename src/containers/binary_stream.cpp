@@ -426,6 +426,28 @@ void IBinaryStream::read(char *data, std::size_t size)
     m_pos += size;
 }
 
+/*!
+* Consume data from the stream without copying it.
+*
+* The function returns a pointer to the data stored at the current position
+* of the stream and advances the position past the consumed data. The pointer
+* remains valid until the stream is re-opened or resized.
+*
+* \param[in] size is the size (in bytes) of the data to be consumed
+* \result A pointer to the consumed data.
+*/
+const char * IBinaryStream::consume(std::size_t size)
+{
+    if ((m_pos + size) > getSize()) {
+        throw std::runtime_error("Bad memory access!");
+    }
+
+    const char *data = m_buffer.data() + m_pos;
+    m_pos += size;
+
+    return data;
+}
+
 /*!
 * \class OBinaryStream
 * \ingroup BinaryStream
@@ -532,4 +554,31 @@ void OBinaryStream::write(const char *data, std::size_t size)
     m_pos += size;
 }
 
+/*!
+* Reserve space for writing data into the stream.
+*
+* The function returns a pointer to the current position of the stream, the
+* position is advanced past the reserved space. The caller should fill the
+* reserved space writing data directly through the pointer. The pointer is
+* invalidated by any subsequent operation that changes the size of the
+* stream (e.g., writing data past the end of a resizable stream).
+*
+* \param[in] size is the size (in bytes) of the space to reserve
+* \result A pointer to the reserved space.
+*/
+char * OBinaryStream::reserve(std::size_t size)
+{
+    if (getSize() - m_pos < size) {
+        // If the stream is not expandable, the request for a new size
+        // will throw an exception.
+        std::size_t bufferSize = getSize() + size;
+        setSize(bufferSize);
+    }
+
+    char *data = m_buffer.data() + m_pos;
+    m_pos += size;
+
+    return data;
+}
+
 }
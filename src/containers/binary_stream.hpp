@@ -119,6 +119,7 @@ public:
     void open(std::size_t size);
 
     void read(char *data, std::size_t size);
+    const char * consume(std::size_t size);
 
 };
 
@@ -137,6 +138,7 @@ public:
     void squeeze();
 
     void write(const char *data, std::size_t size);
+    char * reserve(std::size_t size);
 
 private:
     bool m_expandable;
@@ -352,6 +352,18 @@ public:
     ClearAction clear(bool release = true);
     ReserveAction reserve(std::size_t n);
     ResizeAction resize(std::size_t n);
+    template<typename Compare>
+    SortAction sort(Compare comparator);
+    template<typename Compare>
+    SortAction sortAfter(id_t referenceId, bool inclusive, Compare comparator);
+    template<typename Compare>
+    SortAction sortBefore(id_t referenceId, bool inclusive, Compare comparator);
+    template<typename RawCompare>
+    SortAction rawSort(RawCompare comparator);
+    template<typename RawCompare>
+    SortAction rawSortAfter(id_t referenceId, bool inclusive, RawCompare comparator);
+    template<typename RawCompare>
+    SortAction rawSortBefore(id_t referenceId, bool inclusive, RawCompare comparator);
     SortAction sort();
     SortAction sortAfter(id_t referenceId, bool inclusive);
     SortAction sortBefore(id_t referenceId, bool inclusive);
@@ -455,6 +467,8 @@ protected:
     ClearAction _clear(bool release = true);
     ReserveAction _reserve(std::size_t n);
     ResizeAction _resize(std::size_t n);
+    template<typename PositionCompare>
+    SortAction _sort(std::size_t begin, std::size_t end, PositionCompare comparator);
     SortAction _sort(std::size_t begin, std::size_t end);
     SqueezeAction _squeeze();
     ShrinkToFitAction _shrinkToFit();
@@ -530,6 +544,27 @@ private:
         }
     };
 
+    /**
+    * Functional for comparing the position of two elements using a
+    * user-specified comparator of their ids.
+    */
+    template<typename Compare>
+    struct idCompare
+    {
+        const std::vector<id_t> &m_ids;
+        Compare m_comparator;
+
+        idCompare(const std::vector<id_t> &ids, Compare comparator)
+            : m_ids(ids), m_comparator(comparator)
+        {
+        }
+
+        inline bool operator() (std::size_t pos_x, std::size_t pos_y)
+        {
+            return m_comparator(m_ids[pos_x], m_ids[pos_y]);
+        }
+    };
+
     /**
     * Maximum number of pending deletes before the changes are flushed.
     */
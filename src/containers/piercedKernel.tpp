@@ -288,6 +288,197 @@ typename PiercedKernel<id_t>::ResizeAction PiercedKernel<id_t>::_resize(std::siz
     return syncAction;
 }
 
+/**
+* Sorts the elements of the kernel using the specified comparator.
+*
+* \param comparator is a binary function that accepts two ids and returns
+* true if the element with the first id should be placed before the element
+* with the second id. The comparator should define a strict weak ordering
+* on the ids.
+*/
+template<typename id_t>
+template<typename Compare>
+typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::sort(Compare comparator)
+{
+    SortAction syncAction = _sort(m_begin_pos, m_end_pos, idCompare<Compare>(m_ids, comparator));
+
+    // Update the storage
+    processSyncAction(syncAction);
+
+    return syncAction;
+}
+
+/**
+* Sorts the kernel after the element with the reference id using the
+* specified comparator.
+*
+* \param referenceId is the id of the element after which the kernel will
+* be sorted
+* \param inclusive if true the reference element will be sorted, otherwise
+* the sorting will stop at the element following the reference
+* \param comparator is a binary function that accepts two ids and returns
+* true if the element with the first id should be placed before the element
+* with the second id. The comparator should define a strict weak ordering
+* on the ids.
+*/
+template<typename id_t>
+template<typename Compare>
+typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::sortAfter(id_t referenceId, bool inclusive, Compare comparator)
+{
+    // Get the reference position
+    std::size_t referencePos = getPos(referenceId);
+    if (!inclusive) {
+        referencePos++;
+    }
+
+    // Sort the kernel
+    SortAction syncAction = _sort(referencePos, m_end_pos, idCompare<Compare>(m_ids, comparator));
+
+    // Update the storage
+    processSyncAction(syncAction);
+
+    return syncAction;
+}
+
+/**
+* Sorts the kernel before the element with the reference id using the
+* specified comparator.
+*
+* \param referenceId is the id of the element before which the kernel will
+* be sorted
+* \param inclusive if true the reference element will be sorted, otherwise
+* the sorting will stop at the element preceding the reference
+* \param comparator is a binary function that accepts two ids and returns
+* true if the element with the first id should be placed before the element
+* with the second id. The comparator should define a strict weak ordering
+* on the ids.
+*/
+template<typename id_t>
+template<typename Compare>
+typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::sortBefore(id_t referenceId, bool inclusive, Compare comparator)
+{
+    // Get the reference position
+    std::size_t referencePos = getPos(referenceId);
+    if (inclusive) {
+        referencePos++;
+    }
+
+    // Sort the kernel
+    SortAction syncAction = _sort(m_begin_pos, referencePos, idCompare<Compare>(m_ids, comparator));
+
+    // Update the storage
+    processSyncAction(syncAction);
+
+    return syncAction;
+}
+
+/**
+* Sorts the elements of the kernel using the specified comparator on raw
+* indexes.
+*
+* Before sorting, the kernel is squeezed and the synchronized storages are
+* updated accordingly. The comparator receives the raw indexes the elements
+* have after the squeeze, which are the current raw indexes if the kernel
+* has no holes. Comparing raw indexes allows to use data stored in dense
+* arrays indexed by raw index without looking up the ids.
+*
+* \param comparator is a binary function that accepts two raw indexes and
+* returns true if the element with the first raw index should be placed
+* before the element with the second raw index. The comparator should
+* define a strict weak ordering on the raw indexes.
+*/
+template<typename id_t>
+template<typename RawCompare>
+typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::rawSort(RawCompare comparator)
+{
+    // Squeeze the kernel
+    squeeze();
+
+    // Sort the kernel
+    SortAction syncAction = _sort(m_begin_pos, m_end_pos, comparator);
+
+    // Update the storage
+    processSyncAction(syncAction);
+
+    return syncAction;
+}
+
+/**
+* Sorts the kernel after the element with the reference id using the
+* specified comparator on raw indexes.
+*
+* Before sorting, the kernel is squeezed and the synchronized storages are
+* updated accordingly (see rawSort()).
+*
+* \param referenceId is the id of the element after which the kernel will
+* be sorted
+* \param inclusive if true the reference element will be sorted, otherwise
+* the sorting will stop at the element following the reference
+* \param comparator is a binary function that accepts two raw indexes and
+* returns true if the element with the first raw index should be placed
+* before the element with the second raw index. The comparator should
+* define a strict weak ordering on the raw indexes.
+*/
+template<typename id_t>
+template<typename RawCompare>
+typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::rawSortAfter(id_t referenceId, bool inclusive, RawCompare comparator)
+{
+    // Squeeze the kernel
+    squeeze();
+
+    // Get the reference position
+    std::size_t referencePos = getPos(referenceId);
+    if (!inclusive) {
+        referencePos++;
+    }
+
+    // Sort the kernel
+    SortAction syncAction = _sort(referencePos, m_end_pos, comparator);
+
+    // Update the storage
+    processSyncAction(syncAction);
+
+    return syncAction;
+}
+
+/**
+* Sorts the kernel before the element with the reference id using the
+* specified comparator on raw indexes.
+*
+* Before sorting, the kernel is squeezed and the synchronized storages are
+* updated accordingly (see rawSort()).
+*
+* \param referenceId is the id of the element before which the kernel will
+* be sorted
+* \param inclusive if true the reference element will be sorted, otherwise
+* the sorting will stop at the element preceding the reference
+* \param comparator is a binary function that accepts two raw indexes and
+* returns true if the element with the first raw index should be placed
+* before the element with the second raw index. The comparator should
+* define a strict weak ordering on the raw indexes.
+*/
+template<typename id_t>
+template<typename RawCompare>
+typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::rawSortBefore(id_t referenceId, bool inclusive, RawCompare comparator)
+{
+    // Squeeze the kernel
+    squeeze();
+
+    // Get the reference position
+    std::size_t referencePos = getPos(referenceId);
+    if (inclusive) {
+        referencePos++;
+    }
+
+    // Sort the kernel
+    SortAction syncAction = _sort(m_begin_pos, referencePos, comparator);
+
+    // Update the storage
+    processSyncAction(syncAction);
+
+    return syncAction;
+}
+
 /**
 * Sorts the elements of the kernel in ascending id order.
 */
@@ -366,6 +557,24 @@ typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::sortBefore(id_t re
 */
 template<typename id_t>
 typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::_sort(std::size_t beginPos, std::size_t endPos)
+{
+    return _sort(beginPos, endPos, idLess(m_ids));
+}
+
+/**
+* Sorts the elements of the kernel using the specified comparator.
+*
+* The function will NOT process the sync action.
+*
+* \param beginPos is the first position that will be sorted
+* \param endPos is the position past the last element that will be sorted
+* \param comparator is a binary function that accepts two positions and
+* returns true if the element in the first position should be placed before
+* the element in the second position
+*/
+template<typename id_t>
+template<typename PositionCompare>
+typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::_sort(std::size_t beginPos, std::size_t endPos, PositionCompare comparator)
 {
     // Squeeze the kernel
     //
@@ -399,7 +608,7 @@ typename PiercedKernel<id_t>::SortAction PiercedKernel<id_t>::_sort(std::size_t
         sortPermutations[i] = i;
     }
 
-    std::sort(sortPermutations.begin() + beginPos, sortPermutations.begin() + endPos, idLess(m_ids));
+    std::sort(sortPermutations.begin() + beginPos, sortPermutations.begin() + endPos, comparator);
 
     // Create the sync action
     SortAction syncAction;
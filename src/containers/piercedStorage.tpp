@@ -884,8 +884,10 @@ void PiercedStorage<value_t, id_t>::rawErase(std::size_t pos, std::size_t n)
 template<typename value_t, typename id_t>
 void PiercedStorage<value_t, id_t>::rawSwap(std::size_t pos_first, std::size_t pos_second)
 {
+    using std::swap;
+
     for (std::size_t k = 0; k < m_nFields; ++k) {
-        std::swap(m_fields[pos_first * m_nFields + k], m_fields[pos_second * m_nFields + k]);
+        swap(m_fields[pos_first * m_nFields + k], m_fields[pos_second * m_nFields + k]);
     }
 }
 
@@ -190,6 +190,18 @@ public:
     void clear(bool release = true);
     void reserve(std::size_t n);
     void resize(std::size_t n);
+    template<typename Compare>
+    void sort(Compare comparator);
+    template<typename Compare>
+    void sortAfter(id_t referenceId, bool inclusive, Compare comparator);
+    template<typename Compare>
+    void sortBefore(id_t referenceId, bool inclusive, Compare comparator);
+    template<typename RawCompare>
+    void rawSort(RawCompare comparator);
+    template<typename RawCompare>
+    void rawSortAfter(id_t referenceId, bool inclusive, RawCompare comparator);
+    template<typename RawCompare>
+    void rawSortBefore(id_t referenceId, bool inclusive, RawCompare comparator);
     void sort();
     void sortAfter(id_t referenceId, bool inclusive);
     void sortBefore(id_t referenceId, bool inclusive);
@@ -693,6 +693,161 @@ void PiercedVector<value_t, id_t>::resize(std::size_t n)
     PiercedVectorStorage<value_t, id_t>::commitSyncAction(resizeAction);
 }
 
+/**
+* Sorts the elements of the container using the specified comparator.
+*
+* \param comparator is a binary function that accepts two ids and returns
+* true if the element with the first id should be placed before the element
+* with the second id. The comparator should define a strict weak ordering
+* on the ids.
+*/
+template<typename value_t, typename id_t>
+template<typename Compare>
+void PiercedVector<value_t, id_t>::sort(Compare comparator)
+{
+    // Update the kernel
+    SortAction sortAction = PiercedVectorKernel<id_t>::sort(comparator);
+
+    // Update the storage
+    PiercedVectorStorage<value_t, id_t>::commitSyncAction(sortAction);
+}
+
+/**
+* Sorts the container after the element with the reference id using the
+* specified comparator.
+*
+* \param referenceId is the id of the element after which the container will
+* be sorted
+* \param inclusive if true the reference element will be sorted, otherwise
+* the sorting will stop at the element following the reference
+* \param comparator is a binary function that accepts two ids and returns
+* true if the element with the first id should be placed before the element
+* with the second id. The comparator should define a strict weak ordering
+* on the ids.
+*/
+template<typename value_t, typename id_t>
+template<typename Compare>
+void PiercedVector<value_t, id_t>::sortAfter(id_t referenceId, bool inclusive, Compare comparator)
+{
+    // Update the kernel
+    SortAction sortAction = PiercedVectorKernel<id_t>::sortAfter(referenceId, inclusive, comparator);
+
+    // Update the storage
+    PiercedVectorStorage<value_t, id_t>::commitSyncAction(sortAction);
+}
+
+/**
+* Sorts the container before the element with the reference id using the
+* specified comparator.
+*
+* \param referenceId is the id of the element before which the container will
+* be sorted
+* \param inclusive if true the reference element will be sorted, otherwise
+* the sorting will stop at the element preceding the reference
+* \param comparator is a binary function that accepts two ids and returns
+* true if the element with the first id should be placed before the element
+* with the second id. The comparator should define a strict weak ordering
+* on the ids.
+*/
+template<typename value_t, typename id_t>
+template<typename Compare>
+void PiercedVector<value_t, id_t>::sortBefore(id_t referenceId, bool inclusive, Compare comparator)
+{
+    // Update the kernel
+    SortAction sortAction = PiercedVectorKernel<id_t>::sortBefore(referenceId, inclusive, comparator);
+
+    // Update the storage
+    PiercedVectorStorage<value_t, id_t>::commitSyncAction(sortAction);
+}
+
+/**
+* Sorts the elements of the container using the specified comparator on
+* raw indexes.
+*
+* Before sorting, the container is squeezed and the synchronized storages
+* are updated accordingly. The comparator receives the raw indexes the
+* elements have after the squeeze, which are the current raw indexes if the
+* container has no holes.
+*
+* \param comparator is a binary function that accepts two raw indexes and
+* returns true if the element with the first raw index should be placed
+* before the element with the second raw index. The comparator should
+* define a strict weak ordering on the raw indexes.
+*/
+template<typename value_t, typename id_t>
+template<typename RawCompare>
+void PiercedVector<value_t, id_t>::rawSort(RawCompare comparator)
+{
+    // Squeeze the container
+    squeeze();
+
+    // Update the kernel
+    SortAction sortAction = PiercedVectorKernel<id_t>::rawSort(comparator);
+
+    // Update the storage
+    PiercedVectorStorage<value_t, id_t>::commitSyncAction(sortAction);
+}
+
+/**
+* Sorts the container after the element with the reference id using the
+* specified comparator on raw indexes.
+*
+* Before sorting, the container is squeezed and the synchronized storages
+* are updated accordingly (see rawSort()).
+*
+* \param referenceId is the id of the element after which the container will
+* be sorted
+* \param inclusive if true the reference element will be sorted, otherwise
+* the sorting will stop at the element following the reference
+* \param comparator is a binary function that accepts two raw indexes and
+* returns true if the element with the first raw index should be placed
+* before the element with the second raw index. The comparator should
+* define a strict weak ordering on the raw indexes.
+*/
+template<typename value_t, typename id_t>
+template<typename RawCompare>
+void PiercedVector<value_t, id_t>::rawSortAfter(id_t referenceId, bool inclusive, RawCompare comparator)
+{
+    // Squeeze the container
+    squeeze();
+
+    // Update the kernel
+    SortAction sortAction = PiercedVectorKernel<id_t>::rawSortAfter(referenceId, inclusive, comparator);
+
+    // Update the storage
+    PiercedVectorStorage<value_t, id_t>::commitSyncAction(sortAction);
+}
+
+/**
+* Sorts the container before the element with the reference id using the
+* specified comparator on raw indexes.
+*
+* Before sorting, the container is squeezed and the synchronized storages
+* are updated accordingly (see rawSort()).
+*
+* \param referenceId is the id of the element before which the container
+* will be sorted
+* \param inclusive if true the reference element will be sorted, otherwise
+* the sorting will stop at the element preceding the reference
+* \param comparator is a binary function that accepts two raw indexes and
+* returns true if the element with the first raw index should be placed
+* before the element with the second raw index. The comparator should
+* define a strict weak ordering on the raw indexes.
+*/
+template<typename value_t, typename id_t>
+template<typename RawCompare>
+void PiercedVector<value_t, id_t>::rawSortBefore(id_t referenceId, bool inclusive, RawCompare comparator)
+{
+    // Squeeze the container
+    squeeze();
+
+    // Update the kernel
+    SortAction sortAction = PiercedVectorKernel<id_t>::rawSortBefore(referenceId, inclusive, comparator);
+
+    // Update the storage
+    PiercedVectorStorage<value_t, id_t>::commitSyncAction(sortAction);
+}
+
 /**
 * Sorts the elements of the container in ascending id order.
 */
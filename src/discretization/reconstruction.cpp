@@ -22,8 +22,13 @@
  *
 \*---------------------------------------------------------------------------*/
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <exception>
 #include <limits>
+#include <stdexcept>
+#include <thread>
 #include <cblas.h>
 
 #include "bitpit_LA.hpp"
@@ -206,6 +211,127 @@ uint16_t ReconstructionPolynomial::countDegreeCoefficients(uint8_t degree, uint8
     return (utils::factorial(dimensions - 1 + degree) / utils::factorial(dimensions - 1) / utils::factorial(degree));
 }
 
+/*!
+ * Evaluates the values of the basis for point reconstruction.
+ *
+ * The degree of the polynomial and the number of space dimensions are
+ * known at compile time, hence the evaluation is fully unrolled.
+ *
+ * \param origin is the point chosen as origin of the reconstruction
+ * \param point is the point were the basis will be evaluated
+ * \param[out] csi on output will contain values of the basis for point
+ * reconstruction.
+ */
+template<int degree, int dimensions>
+void ReconstructionPolynomial::evalPointBasisValues(const std::array<double, 3> &origin,
+                                                    const std::array<double, 3> &point, double *csi)
+{
+    static_assert(degree >= 0 && degree <= 2, "Unsupported polynomial degree");
+    static_assert(dimensions >= 1 && dimensions <= 3, "Unsupported number of dimensions");
+
+    // Set 0-th degree coefficients
+    csi[0] = 1.;
+    if (degree < 1) {
+        return;
+    }
+
+    // Set 1-st degree coefficients
+    const double dx = point[0] - origin[0];
+    const double dy = (dimensions >= 2) ? point[1] - origin[1] : 0.;
+    const double dz = (dimensions >= 3) ? point[2] - origin[2] : 0.;
+
+    csi[1] = dx;
+    if (dimensions >= 2) {
+        csi[2] = dy;
+    }
+    if (dimensions >= 3) {
+        csi[3] = dz;
+    }
+
+    if (degree < 2) {
+        return;
+    }
+
+    // Set 2-nd degree coefficients
+    double *csi_2 = csi + 1 + dimensions;
+    if (dimensions == 1) {
+        csi_2[0] = 0.5 * dx * dx;
+    } else if (dimensions == 2) {
+        csi_2[0] = 0.5 * dx * dx;
+        csi_2[1] = 0.5 * dy * dy;
+        csi_2[2] = dx * dy;
+    } else {
+        csi_2[0] = 0.5 * dx * dx;
+        csi_2[1] = 0.5 * dy * dy;
+        csi_2[2] = 0.5 * dz * dz;
+        csi_2[3] = dx * dy;
+        csi_2[4] = dx * dz;
+        csi_2[5] = dy * dz;
+    }
+}
+
+/*!
+ * Evaluates the derivatives of the basis for point reconstruction.
+ *
+ * The degree of the polynomial and the number of space dimensions are
+ * known at compile time, hence the evaluation is fully unrolled.
+ *
+ * \param origin is the point chosen as origin of the reconstruction
+ * \param point is the point were the basis will be evaluated
+ * \param direction is the direction of the derivative
+ * \param[out] dcsi on output will contain values of the basis for point
+ * derivative reconstruction.
+ */
+template<int degree, int dimensions>
+void ReconstructionPolynomial::evalPointBasisDerivatives(const std::array<double, 3> &origin,
+                                                         const std::array<double, 3> &point,
+                                                         const std::array<double, 3> &direction,
+                                                         double *dcsi)
+{
+    static_assert(degree >= 0 && degree <= 2, "Unsupported polynomial degree");
+    static_assert(dimensions >= 1 && dimensions <= 3, "Unsupported number of dimensions");
+
+    // Set 0-th degree coefficients
+    dcsi[0] = 0.;
+    if (degree < 1) {
+        return;
+    }
+
+    // Set 1-st degree coefficients
+    dcsi[1] = direction[0];
+    if (dimensions >= 2) {
+        dcsi[2] = direction[1];
+    }
+    if (dimensions >= 3) {
+        dcsi[3] = direction[2];
+    }
+
+    if (degree < 2) {
+        return;
+    }
+
+    // Set 2-nd degree coefficients
+    const double dx = point[0] - origin[0];
+    const double dy = (dimensions >= 2) ? point[1] - origin[1] : 0.;
+    const double dz = (dimensions >= 3) ? point[2] - origin[2] : 0.;
+
+    double *dcsi_2 = dcsi + 1 + dimensions;
+    if (dimensions == 1) {
+        dcsi_2[0] = dx * direction[0];
+    } else if (dimensions == 2) {
+        dcsi_2[0] = dx * direction[0];
+        dcsi_2[1] = dy * direction[1];
+        dcsi_2[2] = dx * direction[1] + dy * direction[0];
+    } else {
+        dcsi_2[0] = dx * direction[0];
+        dcsi_2[1] = dy * direction[1];
+        dcsi_2[2] = dz * direction[2];
+        dcsi_2[3] = dx * direction[1] + dy * direction[0];
+        dcsi_2[4] = dx * direction[2] + dz * direction[0];
+        dcsi_2[5] = dy * direction[2] + dz * direction[1];
+    }
+}
+
 /*!
  * Evaluates the values of the basis for point reconstruction.
  *
@@ -219,6 +345,23 @@ uint16_t ReconstructionPolynomial::countDegreeCoefficients(uint8_t degree, uint8
 void ReconstructionPolynomial::evalPointBasisValues(uint8_t degree, uint8_t dimensions, const std::array<double, 3> &origin,
                                                     const std::array<double, 3> &point, double *csi)
 {
+    // Specialized evaluation
+    if (ENABLE_FAST_PATH_OPTIMIZATIONS) {
+        if (degree == 1) {
+            switch (dimensions) {
+            case 1: evalPointBasisValues<1, 1>(origin, point, csi); return;
+            case 2: evalPointBasisValues<1, 2>(origin, point, csi); return;
+            case 3: evalPointBasisValues<1, 3>(origin, point, csi); return;
+            }
+        } else if (degree == 2) {
+            switch (dimensions) {
+            case 1: evalPointBasisValues<2, 1>(origin, point, csi); return;
+            case 2: evalPointBasisValues<2, 2>(origin, point, csi); return;
+            case 3: evalPointBasisValues<2, 3>(origin, point, csi); return;
+            }
+        }
+    }
+
     // Set 0-th degree coefficients
     csi[0] = 1.;
 
@@ -269,6 +412,23 @@ void ReconstructionPolynomial::evalPointBasisDerivatives(uint8_t degree, uint8_t
                                                          const std::array<double, 3> &point, const std::array<double, 3> &direction,
                                                          double *dcsi)
 {
+    // Specialized evaluation
+    if (ENABLE_FAST_PATH_OPTIMIZATIONS) {
+        if (degree == 1) {
+            switch (dimensions) {
+            case 1: evalPointBasisDerivatives<1, 1>(origin, point, direction, dcsi); return;
+            case 2: evalPointBasisDerivatives<1, 2>(origin, point, direction, dcsi); return;
+            case 3: evalPointBasisDerivatives<1, 3>(origin, point, direction, dcsi); return;
+            }
+        } else if (degree == 2) {
+            switch (dimensions) {
+            case 1: evalPointBasisDerivatives<2, 1>(origin, point, direction, dcsi); return;
+            case 2: evalPointBasisDerivatives<2, 2>(origin, point, direction, dcsi); return;
+            case 3: evalPointBasisDerivatives<2, 3>(origin, point, direction, dcsi); return;
+            }
+        }
+    }
+
     // Set 0-th degree coefficients
     dcsi[0] = 0.;
 
@@ -692,6 +852,75 @@ std::size_t ReconstructionPolynomial::getFieldCoefficientsStride() const
     return m_nCoeffs;
 }
 
+/*!
+ * Computes the values of the polynomial at the specified point.
+ *
+ * The degree of the polynomial and the number of space dimensions are
+ * known at compile time: the basis is evaluated once and it is then
+ * applied to the coefficients of all the fields with fully unrolled loops.
+ *
+ * \param point is the point were the polynomial will be evaluated
+ * \param nFields is the number of fields that will be evaluated
+ * \param fieldCoeffs are the coefficients of the first field that will
+ * be evaluated
+ * \param[out] values on output will contain the values of the polynomial
+ */
+template<int degree, int dimensions>
+void ReconstructionPolynomial::_computeValues(const std::array<double, 3> &point, int nFields,
+                                              const double *fieldCoeffs, double *values) const
+{
+    constexpr int nCoeffs = 1 + (degree >= 1 ? dimensions : 0) + (degree >= 2 ? (dimensions * (dimensions + 1)) / 2 : 0);
+
+    double csi[nCoeffs];
+    ReconstructionPolynomial::evalPointBasisValues<degree, dimensions>(m_origin, point, csi);
+
+    const std::size_t fieldCoeffsStride = getFieldCoefficientsStride();
+    for (int k = 0; k < nFields; ++k) {
+        double value = fieldCoeffs[0];
+        for (int i = 1; i < nCoeffs; ++i) {
+            value += fieldCoeffs[i] * csi[i];
+        }
+        values[k] = value;
+
+        fieldCoeffs += fieldCoeffsStride;
+    }
+}
+
+/*!
+ * Computes the derivatives of the polynomial at the specified point.
+ *
+ * The degree of the polynomial and the number of space dimensions are
+ * known at compile time: the basis is evaluated once and it is then
+ * applied to the coefficients of all the fields with fully unrolled loops.
+ *
+ * \param point is the point were the derivatives will be evaluated
+ * \param direction is the direction of the derivatives
+ * \param nFields is the number of fields that will be evaluated
+ * \param fieldCoeffs are the coefficients of the first field that will
+ * be evaluated
+ * \param[out] derivatives on output will contain the derivatives
+ */
+template<int degree, int dimensions>
+void ReconstructionPolynomial::_computeDerivatives(const std::array<double, 3> &point, const std::array<double, 3> &direction,
+                                                   int nFields, const double *fieldCoeffs, double *derivatives) const
+{
+    constexpr int nCoeffs = 1 + (degree >= 1 ? dimensions : 0) + (degree >= 2 ? (dimensions * (dimensions + 1)) / 2 : 0);
+
+    double dcsi[nCoeffs];
+    ReconstructionPolynomial::evalPointBasisDerivatives<degree, dimensions>(m_origin, point, direction, dcsi);
+
+    const std::size_t fieldCoeffsStride = getFieldCoefficientsStride();
+    for (int k = 0; k < nFields; ++k) {
+        double derivative = 0.;
+        for (int i = 1; i < nCoeffs; ++i) {
+            derivative += fieldCoeffs[i] * dcsi[i];
+        }
+        derivatives[k] = derivative;
+
+        fieldCoeffs += fieldCoeffsStride;
+    }
+}
+
 /*!
  * Computes the value of the polynomial at the specified point.
  *
@@ -825,6 +1054,23 @@ void ReconstructionPolynomial::computeValues(int degree, const std::array<double
         return;
     }
 
+    // Polynomials with a specialized kernel
+    if (ENABLE_FAST_PATH_OPTIMIZATIONS) {
+        if (degree == 1) {
+            switch (m_dimensions) {
+            case 1: _computeValues<1, 1>(point, nFields, fieldCoeffs, values); return;
+            case 2: _computeValues<1, 2>(point, nFields, fieldCoeffs, values); return;
+            case 3: _computeValues<1, 3>(point, nFields, fieldCoeffs, values); return;
+            }
+        } else if (degree == 2) {
+            switch (m_dimensions) {
+            case 1: _computeValues<2, 1>(point, nFields, fieldCoeffs, values); return;
+            case 2: _computeValues<2, 2>(point, nFields, fieldCoeffs, values); return;
+            case 3: _computeValues<2, 3>(point, nFields, fieldCoeffs, values); return;
+            }
+        }
+    }
+
     // Generic polynomial
     int nCoeffs = ReconstructionPolynomial::getCoefficientCount(degree, m_dimensions);
 
@@ -1229,6 +1475,15 @@ void ReconstructionPolynomial::computeDerivatives(int degree, const std::array<d
         return;
     }
 
+    // Polynomials with a specialized kernel
+    if (ENABLE_FAST_PATH_OPTIMIZATIONS && degree == 2) {
+        switch (m_dimensions) {
+        case 1: _computeDerivatives<2, 1>(point, direction, nFields, fieldCoeffs, derivatives); return;
+        case 2: _computeDerivatives<2, 2>(point, direction, nFields, fieldCoeffs, derivatives); return;
+        case 3: _computeDerivatives<2, 3>(point, direction, nFields, fieldCoeffs, derivatives); return;
+        }
+    }
+
     // Generic polynomial
     int nCoeffs = ReconstructionPolynomial::getCoefficientCount(degree, m_dimensions);
     BITPIT_CREATE_WORKSPACE(csi, double, nCoeffs, MAX_STACK_WORKSPACE_SIZE);
@@ -1992,7 +2247,7 @@ const int ReconstructionKernel::MAX_STACK_WORKSPACE_SIZE = 10;
  * Constructor.
  */
 ReconstructionKernel::ReconstructionKernel()
-    : m_nEquations(0), m_nCoeffs(0), m_degree(0), m_dimensions(0)
+    : m_weights(nullptr), m_nEquations(0), m_nCoeffs(0), m_degree(0), m_dimensions(0)
 {
     initialize(0, 0, 0);
 }
@@ -2005,7 +2260,7 @@ ReconstructionKernel::ReconstructionKernel()
  * \param nEquations is the number of equations that defines the reconstruction
  */
 ReconstructionKernel::ReconstructionKernel(uint8_t degree, uint8_t dimensions, int nEquations)
-    : m_nEquations(0), m_nCoeffs(0), m_degree(0), m_dimensions(0)
+    : m_weights(nullptr), m_nEquations(0), m_nCoeffs(0), m_degree(0), m_dimensions(0)
 {
     initialize(degree, dimensions, nEquations);
 }
@@ -2013,6 +2268,9 @@ ReconstructionKernel::ReconstructionKernel(uint8_t degree, uint8_t dimensions, i
 /*!
     Copy constructor
 
+    The weights are always copied in a storage owned by the new kernel, also
+    when the weights of the other kernel are stored in a pool.
+
     \param other is another reconstruction whose content is copied in this
     reconstruction
 */
@@ -2021,7 +2279,7 @@ ReconstructionKernel::ReconstructionKernel(const ReconstructionKernel &other)
 {
     if (m_nEquations > 0) {
         int nWeights = m_nCoeffs * m_nEquations;
-        std::copy(other.m_weights.get(), other.m_weights.get() + nWeights, m_weights.get());
+        std::copy(other.m_weights, other.m_weights + nWeights, m_weights);
     }
 }
 
@@ -2052,12 +2310,16 @@ void ReconstructionKernel::swap(ReconstructionKernel &other) noexcept
     std::swap(other.m_dimensions, m_dimensions);
     std::swap(other.m_nCoeffs, m_nCoeffs);
     std::swap(other.m_nEquations, m_nEquations);
+    std::swap(other.m_weightsStorage, m_weightsStorage);
     std::swap(other.m_weights, m_weights);
 }
 
 /*!
  * Initialize the kernel.
  *
+ * If the weights of the kernel were stored in a pool, after the
+ * initialization the kernel will store its weights in its own storage.
+ *
  * \param degree is the degree of the polynomial
  * \param dimensions is the number of space dimensions
  * \param nEquations is the number of equations that defines the reconstruction
@@ -2081,17 +2343,47 @@ void ReconstructionKernel::initialize(uint8_t degree, uint8_t dimensions, int nE
     int storageSize = m_nCoeffs * m_nEquations;
 
     bool reallocate;
-    if (release) {
+    if (m_weights != m_weightsStorage.get()) {
+        reallocate = true;
+    } else if (release) {
         reallocate = (currentStorageSize != storageSize);
     } else {
         reallocate = (currentStorageSize < storageSize);
     }
 
     if (reallocate) {
-        m_weights = std::unique_ptr<double[]>(new double[storageSize]);
+        m_weightsStorage = std::unique_ptr<double[]>(new double[storageSize]);
+        m_weights = m_weightsStorage.get();
     }
 }
 
+/*!
+ * Initialize the kernel storing its weights in the specified pooled storage.
+ *
+ * The storage owned by the kernel is released. The pooled storage should be
+ * able to contain the weights of the kernel and it should not be released
+ * as long as the kernel is using it.
+ *
+ * \param degree is the degree of the polynomial
+ * \param dimensions is the number of space dimensions
+ * \param nEquations is the number of equations that defines the reconstruction
+ * \param weights is the pooled storage for the weights of the kernel
+ */
+void ReconstructionKernel::initializePooled(uint8_t degree, uint8_t dimensions, int nEquations, double *weights)
+{
+    assert(degree <= ReconstructionPolynomial::MAX_DEGREE);
+    m_degree = degree;
+
+    assert(dimensions <= ReconstructionPolynomial::MAX_DIMENSIONS);
+    m_dimensions = dimensions;
+
+    m_nCoeffs    = ReconstructionPolynomial::getCoefficientCount(m_degree, m_dimensions);
+    m_nEquations = nEquations;
+
+    m_weightsStorage.reset();
+    m_weights = weights;
+}
+
 /*!
  * Get the degree of the polynomial.
  *
@@ -2141,7 +2433,7 @@ int ReconstructionKernel::getEquationCount() const
  */
 const double * ReconstructionKernel::getPolynomialWeights() const
 {
-    return m_weights.get();
+    return m_weights;
 }
 
 /*!
@@ -2153,7 +2445,7 @@ const double * ReconstructionKernel::getPolynomialWeights() const
  */
 double * ReconstructionKernel::getPolynomialWeights()
 {
-    return m_weights.get();
+    return m_weights;
 }
 
 /*!
@@ -2374,7 +2666,7 @@ void ReconstructionKernel::updatePolynomial(uint8_t degree, int nFields, const d
     int nEquations = getEquationCount();
     int nCoeffs    = ReconstructionPolynomial::getCoefficientCount(degree, dimensions);
 
-    const double *weights = m_weights.get();
+    const double *weights = m_weights;
     double *coeffs = polynomial->getCoefficients();
     for (int k = 0; k < nFields; ++k) {
         double *fieldCoeffs = coeffs + polynomial->computeFieldCoefficientsOffset(0, k);
@@ -2896,6 +3188,8 @@ void ReconstructionAssembler::swap(ReconstructionAssembler &other) noexcept
     std::swap(other.m_S, m_S);
     std::swap(other.m_Vt, m_Vt);
     std::swap(other.m_SVDWorkspace, m_SVDWorkspace);
+    std::swap(other.m_QR, m_QR);
+    std::swap(other.m_QRTau, m_QRTau);
     std::swap(other.m_w, m_w);
 }
 
@@ -2941,6 +3235,8 @@ void ReconstructionAssembler::clear(bool release)
     m_S.clear();
     m_Vt.clear();
     m_SVDWorkspace.resize(1);
+    m_QR.clear();
+    m_QRTau.clear();
     m_w.clear();
 
     if (release) {
@@ -2956,6 +3252,8 @@ void ReconstructionAssembler::clear(bool release)
         m_S.shrink_to_fit();
         m_Vt.shrink_to_fit();
         m_SVDWorkspace.shrink_to_fit();
+        m_QR.shrink_to_fit();
+        m_QRTau.shrink_to_fit();
         m_w.shrink_to_fit();
     }
 }
@@ -3194,41 +3492,51 @@ void ReconstructionAssembler::updateKernel(ReconstructionKernel *kernel) const
     //
     // The matrices S and S^-1 are symmetric and only the upper portions are
     // computed
+    //
+    // Matrices are small and they are accessed directly: A and C are stored
+    // in row-major ordering, S in column-major ordering.
     int nUnknowns = nCoeffs + nConstraints;
 
-    m_S.resize(nUnknowns * nUnknowns);
-    for (int i = 0; i < nCoeffs; ++i) {
-        for (int j = i; j < nCoeffs; ++j) {
-            // Compute A^t A on the fly
-            double ATA_ij = 0.;
-            for (int k = 0; k < nLeastSquares; ++k) {
-                int A_ki_idx = linearalgebra::linearIndexRowMajor(k, i, nLeastSquares, nCoeffs);
-                int A_kj_idx = linearalgebra::linearIndexRowMajor(k, j, nLeastSquares, nCoeffs);
-                ATA_ij += m_A[A_ki_idx] * m_A[A_kj_idx] * m_w[k];
+    m_S.assign(nUnknowns * nUnknowns, 0.);
+
+    // Compute A^t A, one equation at a time, only the upper portion is
+    // accumulated and then it is copied to the lower portion
+    for (int k = 0; k < nLeastSquares; ++k) {
+        const double *A_k = m_A.data() + k * nCoeffs;
+        for (int j = 0; j < nCoeffs; ++j) {
+            double wA_kj = m_w[k] * A_k[j];
+            double *S_j = m_S.data() + j * nUnknowns;
+            for (int i = 0; i <= j; ++i) {
+                S_j[i] += A_k[i] * wA_kj;
             }
-
-            int l = linearalgebra::linearIndexColMajor(i, j, nUnknowns, nUnknowns);
-            m_S[l] = ATA_ij;
-
-            int m = linearalgebra::linearIndexColMajor(j, i, nUnknowns, nUnknowns);
-            m_S[m] = ATA_ij;
         }
+    }
 
-        for (int j = nCoeffs; j < nUnknowns; ++j) {
-            int l     = linearalgebra::linearIndexColMajor(i, j, nUnknowns, nUnknowns);
-            int C_idx = linearalgebra::linearIndexRowMajor(j - nCoeffs, i, nConstraints, nCoeffs);
-            m_S[l] = m_C[C_idx];
+    for (int j = 0; j < nCoeffs; ++j) {
+        for (int i = j + 1; i < nCoeffs; ++i) {
+            m_S[i + j * nUnknowns] = m_S[j + i * nUnknowns];
+        }
+    }
 
-            int m = linearalgebra::linearIndexColMajor(j, i, nUnknowns, nUnknowns);
-            m_S[m] = m_S[l];
+    // Add the constraints
+    for (int n = 0; n < nConstraints; ++n) {
+        const double *C_n = m_C.data() + n * nCoeffs;
+        int j = nCoeffs + n;
+        for (int i = 0; i < nCoeffs; ++i) {
+            m_S[i + j * nUnknowns] = C_n[i];
+            m_S[j + i * nUnknowns] = C_n[i];
         }
     }
 
     // Compute inverse S matrix
     // Since S may me be rank-deficit (eg if not enough neighbours are available)
     // the pseudo-inverse is used. This corresponds of computing the least-norm
-    // solution of the problem.
-    computePseudoInverse(nUnknowns, nUnknowns, SVD_ZERO_THRESHOLD, m_S.data());
+    // solution of the problem. When all the singular values of S are above the
+    // threshold, the pseudo-inverse coincides with the inverse, which can be
+    // evaluated with a QR factorization at a fraction of the cost of the SVD.
+    if (!computeInverseQR(nUnknowns, SVD_ZERO_THRESHOLD, m_S.data())) {
+        computePseudoInverse(nUnknowns, nUnknowns, SVD_ZERO_THRESHOLD, m_S.data());
+    }
 
     // Weights needed to evaluate the polynomial coefficients come from the
     // following equation:
@@ -3245,30 +3553,31 @@ void ReconstructionAssembler::updateKernel(ReconstructionKernel *kernel) const
     // added.
     double *weights = kernel->getPolynomialWeights();
     for (int i = 0; i < nCoeffs; ++i) {
-        for (int j = 0; j < nEquations; ++j) {
+        // Least-squares equations
+        for (int j = 0; j < nLeastSquares; ++j) {
+            const double *A_j = m_A.data() + j * nCoeffs;
+
             double value = 0;
-            for (int k = 0; k < nUnknowns; ++k) {
-                int l = linearalgebra::linearIndexColMajorSymmetric(i, k, nUnknowns, nUnknowns, 'U');
-                if (k < nCoeffs && j < nLeastSquares) {
-                    int A_jk_idx = linearalgebra::linearIndexRowMajor(j, k, nLeastSquares, nCoeffs);
-                    value += m_S[l] * m_A[A_jk_idx] * m_w[j];
-                } else if ((k - nCoeffs) == (j - nLeastSquares)) {
-                    value += m_S[l];
-                }
+            for (int k = 0; k < nCoeffs; ++k) {
+                double S_ik = (i <= k) ? m_S[i + k * nUnknowns] : m_S[k + i * nUnknowns];
+                value += S_ik * A_j[k];
             }
+            value *= m_w[j];
 
-            int equation;
-            if (j < nLeastSquares) {
-                equation = m_leastSquaresOrder[j];
-            } else {
-                equation = m_constraintsOrder[j - nLeastSquares];
-            }
+            int equation = m_leastSquaresOrder[j];
+            weights[equation + i * nEquations] = value;
+        }
+
+        // Constraint equations
+        for (int j = 0; j < nConstraints; ++j) {
+            int k = nCoeffs + j;
 
-            int weightLineraIndex = linearalgebra::linearIndexColMajor(equation, i, nEquations, nCoeffs);
-            weights[weightLineraIndex] = value;
+            int equation = m_constraintsOrder[j];
+            weights[equation + i * nEquations] = m_S[i + k * nUnknowns];
         }
     }
 }
+
 /*!
  * Computes the pseudo inverse of a matrix using a singular value decomposition
  *
@@ -3334,6 +3643,447 @@ void ReconstructionAssembler::computePseudoInverse(int m, int n, double zeroThre
                 n, m, k, 1., m_Vt.data(), k, m_U.data(), m, 0., A, n);
 }
 
+/*!
+ * Computes the inverse of a square matrix using a Householder QR
+ * factorization.
+ *
+ * The inverse is evaluated only if all the singular values of the matrix
+ * are greater than the specified threshold, i.e., only if the inverse
+ * coincides with the pseudo-inverse evaluated by computePseudoInverse().
+ * The smallest singular value of the matrix is the reciprocal of the 2-norm
+ * of its inverse, the check is performed using the Frobenius norm of the
+ * inverse, which is an upper bound of its 2-norm.
+ *
+ * The factorization is performed in a workspace owned by the assembler,
+ * hence no memory is allocated once the workspace has grown to the size
+ * of the largest system.
+ *
+ * \param n number of rows and columns
+ * \param zeroThreshold is the threshold below which a singular value is
+ * considered zero
+ * \param[in,out] A on input matrix in column-major ordering, on output its
+ * inverse. If the inverse cannot be evaluated, the matrix is not modified
+ * \result Returns true if the inverse has been evaluated, false otherwise.
+ */
+bool ReconstructionAssembler::computeInverseQR(int n, double zeroThreshold, double *A) const
+{
+    // Factorize the matrix
+    //
+    // A = Q * R, with Q = H_0 * H_1 * ... * H_(n-1) and H_j = I - tau_j v_j v_j^T.
+    //
+    // R is stored in the upper triangular portion of the workspace, while the
+    // Householder vectors are stored below the diagonal (the first element of
+    // each vector is one and it is not stored). Matrices are small and stored
+    // in column-major ordering, they are accessed directly.
+    m_QR.assign(A, A + n * n);
+    m_QRTau.resize(n);
+
+    double *QR = m_QR.data();
+    for (int j = 0; j < n; ++j) {
+        double *QR_j = QR + j * n;
+
+        double norm = 0.;
+        for (int i = j; i < n; ++i) {
+            norm += QR_j[i] * QR_j[i];
+        }
+        norm = std::sqrt(norm);
+        if (norm == 0.) {
+            return false;
+        }
+
+        double beta = (QR_j[j] > 0.) ? - norm : norm;
+        double v_0  = QR_j[j] - beta;
+        double tau  = - v_0 / beta;
+
+        for (int i = j + 1; i < n; ++i) {
+            QR_j[i] /= v_0;
+        }
+        QR_j[j]    = beta;
+        m_QRTau[j] = tau;
+
+        for (int k = j + 1; k < n; ++k) {
+            double *QR_k = QR + k * n;
+
+            double s = QR_k[j];
+            for (int i = j + 1; i < n; ++i) {
+                s += QR_j[i] * QR_k[i];
+            }
+            s *= tau;
+
+            QR_k[j] -= s;
+            for (int i = j + 1; i < n; ++i) {
+                QR_k[i] -= s * QR_j[i];
+            }
+        }
+    }
+
+    // Invert R
+    //
+    // The inverse is evaluated in place, one column at a time. Since Q is
+    // orthogonal, the Frobenius norm of R^-1 is the Frobenius norm of A^-1.
+    double inverseNorm = 0.;
+    for (int j = 0; j < n; ++j) {
+        double *QR_j = QR + j * n;
+
+        double R_jj = QR_j[j];
+        for (int i = 0; i < j; ++i) {
+            double value = 0.;
+            for (int k = i; k < j; ++k) {
+                value += QR[i + k * n] * QR_j[k];
+            }
+            QR_j[i] = - value / R_jj;
+            inverseNorm += QR_j[i] * QR_j[i];
+        }
+        QR_j[j] = 1. / R_jj;
+        inverseNorm += QR_j[j] * QR_j[j];
+    }
+
+    if (!(zeroThreshold * std::sqrt(inverseNorm) < 1.)) {
+        return false;
+    }
+
+    // Evaluate the inverse
+    //
+    // Inv(A) = Inv(R) * Q^T = Inv(R) * H_(n-1) * ... * H_0
+    for (int j = 0; j < n; ++j) {
+        double *A_j = A + j * n;
+        double *QR_j = QR + j * n;
+        for (int i = 0; i <= j; ++i) {
+            A_j[i] = QR_j[i];
+        }
+        for (int i = j + 1; i < n; ++i) {
+            A_j[i] = 0.;
+        }
+    }
+
+    for (int j = n - 1; j >= 0; --j) {
+        const double *v = QR + j * n;
+        double tau = m_QRTau[j];
+
+        // Columns of A from j onwards are combined using the Householder
+        // vector, the first element of the vector is one.
+        for (int r = 0; r < n; ++r) {
+            double s = A[r + j * n];
+            for (int i = j + 1; i < n; ++i) {
+                s += A[r + i * n] * v[i];
+            }
+            s *= tau;
+
+            A[r + j * n] -= s;
+            for (int i = j + 1; i < n; ++i) {
+                A[r + i * n] -= s * v[i];
+            }
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * \class ReconstructionKernelPool
+ * \ingroup discretization
+ *
+ * \brief The ReconstructionKernelPool class stores a collection of
+ * reconstruction kernels whose weights are kept in a single contiguous
+ * storage.
+ *
+ * Storing the weights of all the kernels in a single allocation avoids a
+ * heap allocation for every kernel. The kernels of the pool can be used as
+ * any other kernel; copying a kernel out of the pool creates a kernel that
+ * owns its weights.
+ *
+ * The pool can assemble all its kernels (see assemble), kernels with the
+ * same degree and the same number of equations are assembled one after the
+ * other and the assembly can be split among several threads.
+ */
+
+/*!
+ * Constructor.
+ */
+ReconstructionKernelPool::ReconstructionKernelPool()
+    : m_dimensions(0), m_weightsSize(0)
+{
+}
+
+/*!
+ * Constructor.
+ *
+ * \param dimensions is the number of space dimensions
+ * \param nKernels is the number of kernels
+ * \param degrees are the degrees of the polynomials of the kernels
+ * \param nEquations are the number of equations that defines the kernels
+ */
+ReconstructionKernelPool::ReconstructionKernelPool(uint8_t dimensions, std::size_t nKernels,
+                                                   const uint8_t *degrees, const int *nEquations)
+    : m_dimensions(0), m_weightsSize(0)
+{
+    initialize(dimensions, nKernels, degrees, nEquations);
+}
+
+/**
+* Exchanges the content of the pool by the content the specified other pool.
+*
+* \param other is another pool whose content is swapped with that of this
+* pool
+*/
+void ReconstructionKernelPool::swap(ReconstructionKernelPool &other) noexcept
+{
+    std::swap(other.m_dimensions, m_dimensions);
+    std::swap(other.m_weightsSize, m_weightsSize);
+    std::swap(other.m_weights, m_weights);
+    std::swap(other.m_kernels, m_kernels);
+}
+
+/*!
+ * Initialize the pool.
+ *
+ * The weights of the kernels are stored one after the other, in the same
+ * order of the kernels.
+ *
+ * \param dimensions is the number of space dimensions
+ * \param nKernels is the number of kernels
+ * \param degrees are the degrees of the polynomials of the kernels
+ * \param nEquations are the number of equations that defines the kernels
+ * \param release if true, possible unneeded memory hold by the pool will be
+ * released, otherwise the pool will be initialized but possible unneeded
+ * memory will not be released
+ */
+void ReconstructionKernelPool::initialize(uint8_t dimensions, std::size_t nKernels,
+                                          const uint8_t *degrees, const int *nEquations,
+                                          bool release)
+{
+    assert(dimensions <= ReconstructionPolynomial::MAX_DIMENSIONS);
+    m_dimensions = dimensions;
+
+    // Evaluate the size of the storage
+    std::size_t weightsSize = 0;
+    for (std::size_t n = 0; n < nKernels; ++n) {
+        assert(degrees[n] <= ReconstructionPolynomial::MAX_DEGREE);
+        int nCoeffs = ReconstructionPolynomial::getCoefficientCount(degrees[n], dimensions);
+        weightsSize += static_cast<std::size_t>(nCoeffs) * nEquations[n];
+    }
+
+    bool reallocate;
+    if (release) {
+        reallocate = (m_weightsSize != weightsSize);
+    } else {
+        reallocate = (m_weightsSize < weightsSize);
+    }
+
+    if (reallocate) {
+        m_weights = std::unique_ptr<double[]>(new double[weightsSize]);
+        m_weightsSize = weightsSize;
+    }
+
+    // Initialize the kernels
+    m_kernels.resize(nKernels);
+    if (release) {
+        m_kernels.shrink_to_fit();
+    }
+
+    double *kernelWeights = m_weights.get();
+    for (std::size_t n = 0; n < nKernels; ++n) {
+        m_kernels[n].initializePooled(degrees[n], dimensions, nEquations[n], kernelWeights);
+
+        int nCoeffs = m_kernels[n].getCoefficientCount();
+        kernelWeights += static_cast<std::size_t>(nCoeffs) * nEquations[n];
+    }
+}
+
+/*!
+ * Clear the pool.
+ *
+ * \param release if true, the memory hold by the pool will be released,
+ * otherwise the pool will be cleared but its memory will not be released
+ */
+void ReconstructionKernelPool::clear(bool release)
+{
+    m_kernels.clear();
+
+    if (release) {
+        m_kernels.shrink_to_fit();
+
+        m_weights.reset();
+        m_weightsSize = 0;
+    }
+}
+
+/*!
+ * Get the number of space dimensions.
+ *
+ * \return The number of space dimensions.
+ */
+uint8_t ReconstructionKernelPool::getDimensions() const
+{
+    return m_dimensions;
+}
+
+/*!
+ * Get the number of kernels in the pool.
+ *
+ * \return The number of kernels in the pool.
+ */
+std::size_t ReconstructionKernelPool::getKernelCount() const
+{
+    return m_kernels.size();
+}
+
+/*!
+ * Get a constant reference to the specified kernel.
+ *
+ * \param n is the index of the kernel
+ * \return A constant reference to the specified kernel.
+ */
+const ReconstructionKernel & ReconstructionKernelPool::getKernel(std::size_t n) const
+{
+    return m_kernels[n];
+}
+
+/*!
+ * Get a reference to the specified kernel.
+ *
+ * \param n is the index of the kernel
+ * \return A reference to the specified kernel.
+ */
+ReconstructionKernel & ReconstructionKernelPool::getKernel(std::size_t n)
+{
+    return m_kernels[n];
+}
+
+/*!
+ * Assembles all the kernels of the pool.
+ *
+ * For every kernel, the specified function is called to add the equations
+ * of the kernel to an assembler that has already been initialized with the
+ * degree and the dimensions of the kernel. The equations should be added
+ * in the same order that will be used when evaluating the reconstruction,
+ * and their number should match the number of equations of the kernel.
+ *
+ * Kernels with the same degree and the same number of equations are
+ * assembled one after the other, in this way the systems solved in a row
+ * have the same size and the workspace of the assembler is sized only once
+ * for every group. The groups are then split among the threads in chunks
+ * of similar cost, every thread uses its own assembler. When more than one
+ * thread is used, the function that adds the equations will be called
+ * concurrently and it should be thread-safe.
+ *
+ * \param initializeAssembler is the function that adds the equations of the
+ * kernel with the specified index to the assembler
+ * \param nThreads is the number of threads that will be used
+ */
+void ReconstructionKernelPool::assemble(const AssemblerInitializer &initializeAssembler, int nThreads)
+{
+    std::size_t nKernels = getKernelCount();
+    if (nKernels == 0) {
+        return;
+    }
+
+    // Sort the kernels by group
+    std::vector<std::size_t> assemblyOrder = evalAssemblyOrder();
+
+    // Split the kernels in chunks
+    //
+    // The cost of the assembly is estimated as the cost of evaluating the
+    // matrix of the normal equations.
+    nThreads = std::max(nThreads, 1);
+    if (static_cast<std::size_t>(nThreads) > nKernels) {
+        nThreads = static_cast<int>(nKernels);
+    }
+
+    std::vector<double> assemblyCosts(nKernels + 1);
+    assemblyCosts[0] = 0.;
+    for (std::size_t k = 0; k < nKernels; ++k) {
+        const ReconstructionKernel &kernel = m_kernels[assemblyOrder[k]];
+        double nCoeffs = kernel.getCoefficientCount();
+        assemblyCosts[k + 1] = assemblyCosts[k] + kernel.getEquationCount() * nCoeffs * nCoeffs + 1.;
+    }
+
+    std::vector<std::size_t> chunkBegins(nThreads + 1);
+    for (int i = 0; i < nThreads; ++i) {
+        double chunkBeginCost = assemblyCosts.back() * i / nThreads;
+        chunkBegins[i] = std::lower_bound(assemblyCosts.begin(), assemblyCosts.end() - 1, chunkBeginCost) - assemblyCosts.begin();
+    }
+    chunkBegins[nThreads] = nKernels;
+
+    // Assemble the kernels
+    auto assembleChunk = [this, &initializeAssembler, &assemblyOrder](std::size_t begin, std::size_t end) {
+        ReconstructionAssembler assembler;
+        for (std::size_t k = begin; k < end; ++k) {
+            std::size_t n = assemblyOrder[k];
+            ReconstructionKernel &kernel = m_kernels[n];
+
+            assembler.initialize(kernel.getDegree(), m_dimensions, false);
+            initializeAssembler(n, &assembler);
+            if (assembler.countEquations() != kernel.getEquationCount()) {
+                throw std::runtime_error("The number of equations added to the assembler doesn't match the number of equations of the kernel.");
+            }
+
+            assembler.updateKernel(&kernel);
+        }
+    };
+
+    std::vector<std::exception_ptr> chunkExceptions(nThreads);
+    auto assembleChunkCatching = [&assembleChunk, &chunkBegins, &chunkExceptions](int chunk) {
+        try {
+            assembleChunk(chunkBegins[chunk], chunkBegins[chunk + 1]);
+        } catch (...) {
+            chunkExceptions[chunk] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (int i = 1; i < nThreads; ++i) {
+        threads.emplace_back(assembleChunkCatching, i);
+    }
+
+    assembleChunkCatching(0);
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    for (const std::exception_ptr &exception : chunkExceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+/*!
+ * Evaluates the order in which the kernels will be assembled.
+ *
+ * Kernels are sorted by degree and then by number of equations, kernels
+ * with the same degree and the same number of equations keep the order
+ * they have in the pool.
+ *
+ * \result The indexes of the kernels in the order in which they will be
+ * assembled.
+ */
+std::vector<std::size_t> ReconstructionKernelPool::evalAssemblyOrder() const
+{
+    std::size_t nKernels = getKernelCount();
+
+    std::vector<std::size_t> assemblyOrder(nKernels);
+    for (std::size_t n = 0; n < nKernels; ++n) {
+        assemblyOrder[n] = n;
+    }
+
+    std::stable_sort(assemblyOrder.begin(), assemblyOrder.end(),
+        [this](std::size_t i, std::size_t j)
+        {
+            const ReconstructionKernel &kernel_i = m_kernels[i];
+            const ReconstructionKernel &kernel_j = m_kernels[j];
+            if (kernel_i.getDegree() != kernel_j.getDegree()) {
+                return (kernel_i.getDegree() < kernel_j.getDegree());
+            }
+
+            return (kernel_i.getEquationCount() < kernel_j.getEquationCount());
+        });
+
+    return assemblyOrder;
+}
+
 /*!
  * \class Reconstruction
  * \ingroup discretization
@@ -26,6 +26,7 @@
 #define __BTPIT_RECONSTRUCTION_HPP__
 
 #include <array>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -37,6 +38,7 @@ namespace bitpit {
 class ReconstructionPolynomial {
 
 friend class ReconstructionKernel;
+friend class ReconstructionKernelPool;
 friend class ReconstructionAssembler;
 
 public:
@@ -151,6 +153,11 @@ private:
     static std::vector<std::vector<uint16_t>> generateCountCoefficientCache();
     static std::vector<std::vector<uint16_t>> generateCountDegreeCoefficientCache();
 
+    template<int degree, int dimensions>
+    static void evalPointBasisValues(const std::array<double, 3> &origin, const std::array<double, 3> &point, double *csi);
+    template<int degree, int dimensions>
+    static void evalPointBasisDerivatives(const std::array<double, 3> &origin, const std::array<double, 3> &point, const std::array<double, 3> &direction, double *dcsi);
+
     uint8_t m_degree;
     uint8_t m_dimensions;
 
@@ -164,10 +171,17 @@ private:
     std::size_t computeFieldCoefficientsOffset(uint8_t degree, int field) const;
     std::size_t getFieldCoefficientsStride() const;
 
+    template<int degree, int dimensions>
+    void _computeValues(const std::array<double, 3> &point, int nFields, const double *fieldCoeffs, double *values) const;
+    template<int degree, int dimensions>
+    void _computeDerivatives(const std::array<double, 3> &point, const std::array<double, 3> &direction, int nFields, const double *fieldCoeffs, double *derivatives) const;
+
 };
 
 class ReconstructionKernel {
 
+friend class ReconstructionKernelPool;
+
 public:
     ReconstructionKernel();
     ReconstructionKernel(uint8_t degree, uint8_t dimensions, int nEquations);
@@ -221,10 +235,13 @@ public:
 protected:
     void applyLimiter(uint8_t degree, const double *limiters, double *coeffs) const;
 
+    void initializePooled(uint8_t degree, uint8_t dimensions, int nEquations, double *weights);
+
 private:
     static const int MAX_STACK_WORKSPACE_SIZE;
 
-    std::unique_ptr<double[]> m_weights;
+    std::unique_ptr<double[]> m_weightsStorage;
+    double *m_weights;
 
     int m_nEquations;
 
@@ -289,11 +306,53 @@ private:
     mutable std::vector<double> m_S;
     mutable std::vector<double> m_Vt;
     mutable std::vector<double> m_SVDWorkspace;
+    mutable std::vector<double> m_QR;
+    mutable std::vector<double> m_QRTau;
     mutable std::vector<double> m_w;
 
     double * _addEquation(ReconstructionType type, double scaleFactor);
 
     void computePseudoInverse(int m, int n, double tolerance, double *A) const;
+    bool computeInverseQR(int n, double zeroThreshold, double *A) const;
+
+};
+
+class ReconstructionKernelPool {
+
+public:
+    typedef std::function<void(std::size_t kernel, ReconstructionAssembler *assembler)> AssemblerInitializer;
+
+    ReconstructionKernelPool();
+    ReconstructionKernelPool(uint8_t dimensions, std::size_t nKernels, const uint8_t *degrees, const int *nEquations);
+
+    ReconstructionKernelPool(const ReconstructionKernelPool &other) = delete;
+    ReconstructionKernelPool(ReconstructionKernelPool &&other) = default;
+    ReconstructionKernelPool & operator = (const ReconstructionKernelPool &other) = delete;
+    ReconstructionKernelPool & operator=(ReconstructionKernelPool &&other) = default;
+
+    void swap(ReconstructionKernelPool &other) noexcept;
+
+    void initialize(uint8_t dimensions, std::size_t nKernels, const uint8_t *degrees, const int *nEquations, bool release = true);
+    void clear(bool release = true);
+
+    uint8_t getDimensions() const;
+
+    std::size_t getKernelCount() const;
+
+    const ReconstructionKernel & getKernel(std::size_t n) const;
+    ReconstructionKernel & getKernel(std::size_t n);
+
+    void assemble(const AssemblerInitializer &initializeAssembler, int nThreads = 1);
+
+private:
+    uint8_t m_dimensions;
+
+    std::size_t m_weightsSize;
+    std::unique_ptr<double[]> m_weights;
+
+    std::vector<ReconstructionKernel> m_kernels;
+
+    std::vector<std::size_t> evalAssemblyOrder() const;
 
 };
 
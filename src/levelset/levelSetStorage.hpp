@@ -112,6 +112,8 @@ public:
     virtual std::size_t getItemBinarySize() const = 0;
     virtual void writeItem(const KernelIterator &kernelIterator, SendBuffer &dataBufferbuffer) = 0;
     virtual void readItem(const KernelIterator &kernelIterator, RecvBuffer &dataBufferbuffer) = 0;
+    virtual void writeItems(const std::vector<KernelIterator> &kernelIterators, SendBuffer &dataBufferbuffer);
+    virtual void readItems(const std::vector<KernelIterator> &kernelIterators, RecvBuffer &dataBufferbuffer);
 #endif
 
     void swap(LevelSetBaseStorage<kernel_iterator_t> &other) noexcept;
@@ -168,6 +170,8 @@ public:
     std::size_t getItemBinarySize() const override;
     void writeItem(const KernelIterator &kernelIterator, SendBuffer &buffer) override;
     void readItem(const KernelIterator &kernelIterator, RecvBuffer &buffer) override;
+    void writeItems(const std::vector<KernelIterator> &kernelIterators, SendBuffer &buffer) override;
+    void readItems(const std::vector<KernelIterator> &kernelIterators, RecvBuffer &buffer) override;
 #endif
 
     void swap(LevelSetPiercedStorage<value_t, id_t> &other) noexcept;
@@ -193,6 +197,8 @@ public:
     std::size_t getItemBinarySize() const override;
     void writeItem(const KernelIterator &kernelIterator, SendBuffer &buffer) override;
     void readItem(const KernelIterator &kernelIterator, RecvBuffer &buffer) override;
+    void writeItems(const std::vector<KernelIterator> &kernelIterators, SendBuffer &buffer) override;
+    void readItems(const std::vector<KernelIterator> &kernelIterators, RecvBuffer &buffer) override;
 #endif
 
     void swap(LevelSetDirectStorage<value_t> &other) noexcept;
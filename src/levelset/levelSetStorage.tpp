@@ -151,6 +151,42 @@ const void * LevelSetBaseStorage<kernel_iterator_t>::getContainer() const
     return m_containerWrapper->getContainer();
 }
 
+#if BITPIT_ENABLE_MPI
+/*!
+ * Write the specified narrow band entries into the communication buffer.
+ *
+ * Default implementation writes the entries one at a time.
+ *
+ * \param kernelIterators are the kernel iterators pointing to the entries
+ * associated to the items
+ * \param[in,out] buffer buffer for data communication
+ */
+template<typename kernel_iterator_t>
+void LevelSetBaseStorage<kernel_iterator_t>::writeItems(const std::vector<KernelIterator> &kernelIterators, SendBuffer &buffer)
+{
+    for (const KernelIterator &kernelIterator : kernelIterators) {
+        writeItem(kernelIterator, buffer);
+    }
+}
+
+/*!
+ * Read the specified narrow band entries from the communication buffer.
+ *
+ * Default implementation reads the entries one at a time.
+ *
+ * \param kernelIterators are the kernel iterators pointing to the entries
+ * associated to the items
+ * \param[in,out] buffer buffer containing data
+ */
+template<typename kernel_iterator_t>
+void LevelSetBaseStorage<kernel_iterator_t>::readItems(const std::vector<KernelIterator> &kernelIterators, RecvBuffer &buffer)
+{
+    for (const KernelIterator &kernelIterator : kernelIterators) {
+        readItem(kernelIterator, buffer);
+    }
+}
+#endif
+
 /*!
  * Exchanges the content of the storage with the content the specified other
  * storage.
@@ -387,6 +423,48 @@ void LevelSetPiercedStorage<value_t, id_t>::readItem(const KernelIterator &kerne
 
     buffer >> container->rawAt(itemRawId);
 }
+
+/*!
+ * Write the specified narrow band entries into the communication buffer.
+ *
+ * Entries are written as a single contiguous block.
+ *
+ * \param kernelIterators are the kernel iterators pointing to the entries
+ * associated to the items
+ * \param[in,out] buffer buffer for data communication
+ */
+template<typename value_t, typename id_t>
+void LevelSetPiercedStorage<value_t, id_t>::writeItems(const std::vector<KernelIterator> &kernelIterators, SendBuffer &buffer)
+{
+    const Container *container = static_cast<const Container *>(this->getContainer());
+
+    std::size_t nItems = kernelIterators.size();
+    value_t *items = buffer.reserve<value_t>(nItems);
+    for (std::size_t n = 0; n < nItems; ++n) {
+        items[n] = container->rawAt(kernelIterators[n].getRawIndex());
+    }
+}
+
+/*!
+ * Read the specified narrow band entries from the communication buffer.
+ *
+ * Entries are read from a single contiguous block.
+ *
+ * \param kernelIterators are the kernel iterators pointing to the entries
+ * associated to the items
+ * \param[in,out] buffer buffer containing data
+ */
+template<typename value_t, typename id_t>
+void LevelSetPiercedStorage<value_t, id_t>::readItems(const std::vector<KernelIterator> &kernelIterators, RecvBuffer &buffer)
+{
+    Container *container = static_cast<Container *>(this->getContainer());
+
+    std::size_t nItems = kernelIterators.size();
+    const value_t *items = buffer.read<value_t>(nItems);
+    for (std::size_t n = 0; n < nItems; ++n) {
+        container->rawAt(kernelIterators[n].getRawIndex()) = items[n];
+    }
+}
 #endif
 
 /*!
@@ -501,6 +579,48 @@ void LevelSetDirectStorage<value_t>::readItem(const KernelIterator &kernelIterat
 
     buffer >> (*container)[kernelIterator];
 }
+
+/*!
+ * Write the specified narrow band entries into the communication buffer.
+ *
+ * Entries are written as a single contiguous block.
+ *
+ * \param kernelIterators are the kernel iterators pointing to the entries
+ * associated to the items
+ * \param[in,out] buffer buffer for data communication
+ */
+template<typename value_t>
+void LevelSetDirectStorage<value_t>::writeItems(const std::vector<KernelIterator> &kernelIterators, SendBuffer &buffer)
+{
+    const Container *container = static_cast<const Container *>(this->getContainer());
+
+    std::size_t nItems = kernelIterators.size();
+    value_t *items = buffer.reserve<value_t>(nItems);
+    for (std::size_t n = 0; n < nItems; ++n) {
+        items[n] = (*container)[kernelIterators[n]];
+    }
+}
+
+/*!
+ * Read the specified narrow band entries from the communication buffer.
+ *
+ * Entries are read from a single contiguous block.
+ *
+ * \param kernelIterators are the kernel iterators pointing to the entries
+ * associated to the items
+ * \param[in,out] buffer buffer containing data
+ */
+template<typename value_t>
+void LevelSetDirectStorage<value_t>::readItems(const std::vector<KernelIterator> &kernelIterators, RecvBuffer &buffer)
+{
+    Container *container = static_cast<Container *>(this->getContainer());
+
+    std::size_t nItems = kernelIterators.size();
+    const value_t *items = buffer.read<value_t>(nItems);
+    for (std::size_t n = 0; n < nItems; ++n) {
+        (*container)[kernelIterators[n]] = items[n];
+    }
+}
 #endif
 
 /*!
@@ -780,37 +900,43 @@ void LevelSetStorageManager<kernel_t, kernel_iterator_t>::restore(std::istream &
 template<typename kernel_t, typename kernel_iterator_t>
 void LevelSetStorageManager<kernel_t, kernel_iterator_t>::write(const std::vector<long> &ids, SendBuffer &buffer)
 {
-    // Evaluate the size of the buffer
-    std::size_t nBufferItems = 0;
-    for (long id : ids) {
-        if (contains(id)) {
-            ++nBufferItems;
+    // Identify the items that will be written
+    std::vector<std::size_t> itemIndexes;
+    std::vector<KernelIterator> itemIterators;
+    for (std::size_t k = 0; k < ids.size(); ++k) {
+        KernelIterator itr = find(ids[k]);
+        if (itr == end()) {
+            continue;
         }
+
+        itemIndexes.push_back(k);
+        itemIterators.push_back(itr);
     }
 
+    std::size_t nBufferItems = itemIndexes.size();
+
+    // Evaluate the size of the buffer
+    //
+    // Data are written in contiguous blocks, each block may be preceded by
+    // some padding needed to align its items.
     std::size_t bufferSize = buffer.getSize() + sizeof(std::size_t);
+    bufferSize += nBufferItems * sizeof(std::size_t);
     for (const auto &storage : m_storages) {
-        bufferSize += nBufferItems * storage.second->getItemBinarySize();
+        bufferSize += nBufferItems * storage.second->getItemBinarySize() + alignof(std::max_align_t);
     }
     buffer.setSize(bufferSize);
 
     // Fill the buffer
+    //
+    // The indexes of the items are written first, followed by one block of
+    // data for each storage.
     buffer << nBufferItems;
-    for (std::size_t k = 0; k < ids.size(); ++k) {
-        // Get an iterator pointing to the item
-        long id = ids[k];
-        KernelIterator itr = find(id);
-        if (itr == end()) {
-            continue;
-        }
 
-        // Write the index of the cell
-        buffer << k;
+    std::size_t *bufferItemIndexes = buffer.reserve<std::size_t>(nBufferItems);
+    std::copy(itemIndexes.begin(), itemIndexes.end(), bufferItemIndexes);
 
-        // Write item data
-        for (const auto &storage : m_storages) {
-            storage.second->writeItem(itr, buffer);
-        }
+    for (const auto &storage : m_storages) {
+        storage.second->writeItems(itemIterators, buffer);
     }
 }
 
@@ -829,23 +955,36 @@ void LevelSetStorageManager<kernel_t, kernel_iterator_t>::read(const std::vector
     std::size_t nReceviedItems;
     buffer >> nReceviedItems;
 
+    const std::size_t *itemIndexes = buffer.read<std::size_t>(nReceviedItems);
+
+    // Create the items
+    //
+    // Creating an item may invalidate the iterators of the other items,
+    // hence, if new items have been created, iterators are evaluated again.
+    bool itemsCreated = false;
+    std::vector<KernelIterator> itemIterators(nReceviedItems);
     for (std::size_t i = 0; i < nReceviedItems; ++i) {
-        // Read the id of the item
-        std::size_t k;
-        buffer >> k;
-        long id = ids[k];
+        long id = ids[itemIndexes[i]];
 
-        // Create the item
         KernelIterator itr = find(id);
         if (itr == end()) {
             itr = insert(id);
+            itemsCreated = true;
         }
 
-        // Read item data
-        for (auto &storage : m_storages) {
-            storage.second->readItem(itr, buffer);
+        itemIterators[i] = itr;
+    }
+
+    if (itemsCreated) {
+        for (std::size_t i = 0; i < nReceviedItems; ++i) {
+            itemIterators[i] = find(ids[itemIndexes[i]]);
         }
     }
+
+    // Read item data
+    for (auto &storage : m_storages) {
+        storage.second->readItems(itemIterators, buffer);
+    }
 }
 #endif
 
@@ -230,9 +230,9 @@ void LineUnstructured::_restore(std::istream &stream)
  * Locates the cell the contains the point.
  *
  * If the point is not inside the patch, the function returns the id of the
- * null element.
- *
- * NOTE: this function is not implemented yet.
+ * null element. A point is inside a cell if its distance from the cell is
+ * less than the tolerance of the patch. Cells are searched using a tree
+ * that is built the first time a point is located.
  *
  * \param[in] point is the point to be checked
  * \result Returns the linear id of the cell the contains the point. If the
@@ -241,11 +241,41 @@ void LineUnstructured::_restore(std::istream &stream)
  */
 long LineUnstructured::locatePoint(const std::array<double, 3> &point) const
 {
-    BITPIT_UNUSED(point);
+    long id;
+    getPointLocationTree().findPointContainingCell(point, &id);
 
-    throw std::runtime_error ("The function 'locatePoint' is not implemented yet");
+    return id;
+}
 
-    return false;
+/*!
+ * Locates the cells that contain the specified points.
+ *
+ * Consecutive points are expected to be close to each other: the search
+ * of a point starts from the cell that contains the previous point and,
+ * if the adjacencies of the patch are available, walks through the
+ * neighbours of that cell. Points not found by the walk are searched using
+ * the tree that is also used by locatePoint. Lookups are thread safe, hence
+ * different threads can locate different sets of points concurrently.
+ *
+ * \param[in] nPoints is the number of points
+ * \param[in] points are the points to be checked
+ * \param[out] ids on output will contain the ids of the cells that contain
+ * the points. If a point is not inside the patch, the related id will be set
+ * to the id of the null element.
+ */
+void LineUnstructured::locatePoints(int nPoints, const std::array<double, 3> *points, long *ids) const
+{
+    getPointLocationTree().findPointContainingCell(nPoints, points, ids);
+}
+
+/*!
+ * Creates the tree used for locating points inside the patch.
+ *
+ * \result The tree used for locating points inside the patch.
+ */
+std::unique_ptr<PatchSkdTree> LineUnstructured::_createPointLocationTree() const
+{
+    return std::unique_ptr<PatchSkdTree>(new LineSkdTree(this));
 }
 
 /*!
@@ -0,0 +1,275 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#ifndef __BITPIT_EXPRESSION_OPERATORS_HPP__
+#define __BITPIT_EXPRESSION_OPERATORS_HPP__
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bitpit {
+
+namespace expression {
+
+/*!
+    \ingroup MathOperators
+
+    \brief Base class of the element-wise expressions.
+
+    Expressions are evaluated lazily: no element is computed until the
+    expression is assigned to a container or reduced to a scalar. The
+    derived class is passed as template argument and it has to define the
+    value_type of the expression, the method size() and the operator[].
+*/
+template<typename E>
+class Expression {
+
+public:
+    const E & derived() const;
+
+    std::size_t size() const;
+
+    template<typename T>
+    operator std::vector<T>() const;
+
+    template<typename T, std::size_t d>
+    operator std::array<T, d>() const;
+
+protected:
+    Expression() = default;
+
+};
+
+/*!
+    \ingroup MathOperators
+
+    \brief Expression that wraps a container.
+
+    The container is stored by reference, hence it has to outlive the
+    expression.
+*/
+template<typename C>
+class Terminal : public Expression<Terminal<C>> {
+
+public:
+    typedef typename C::value_type value_type;
+
+    explicit Terminal(const C &container);
+
+    std::size_t size() const;
+
+    const value_type & operator[](std::size_t i) const;
+
+private:
+    const C &m_container;
+
+};
+
+/*!
+    \ingroup MathOperators
+
+    \brief Expression that represents a constant value.
+
+    A constant is compatible with expressions of any size, for this reason
+    its size is the maximum size representable by std::size_t.
+*/
+template<typename T>
+class Constant : public Expression<Constant<T>> {
+
+public:
+    typedef T value_type;
+
+    explicit Constant(const T &value);
+
+    std::size_t size() const;
+
+    const value_type & operator[](std::size_t i) const;
+
+private:
+    T m_value;
+
+};
+
+/*!
+    \ingroup MathOperators
+
+    \brief Element-wise unary expression.
+*/
+template<typename E, typename Op>
+class UnaryExpression : public Expression<UnaryExpression<E, Op>> {
+
+public:
+    typedef typename std::decay<decltype(Op::apply(std::declval<typename E::value_type>()))>::type value_type;
+
+    explicit UnaryExpression(const E &operand);
+
+    std::size_t size() const;
+
+    value_type operator[](std::size_t i) const;
+
+private:
+    E m_operand;
+
+};
+
+/*!
+    \ingroup MathOperators
+
+    \brief Element-wise binary expression.
+*/
+template<typename L, typename R, typename Op>
+class BinaryExpression : public Expression<BinaryExpression<L, R, Op>> {
+
+public:
+    typedef typename std::decay<decltype(Op::apply(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()))>::type value_type;
+
+    BinaryExpression(const L &left, const R &right);
+
+    std::size_t size() const;
+
+    value_type operator[](std::size_t i) const;
+
+private:
+    L m_left;
+    R m_right;
+
+};
+
+/*!
+    \ingroup MathOperators
+
+    \brief Element-wise operations used by the expressions.
+*/
+namespace operation {
+
+struct Negate {
+    template<typename A>
+    static auto apply(const A &a) -> decltype(-a) { return -a; }
+};
+
+struct Sum {
+    template<typename A, typename B>
+    static auto apply(const A &a, const B &b) -> decltype(a + b) { return a + b; }
+};
+
+struct Difference {
+    template<typename A, typename B>
+    static auto apply(const A &a, const B &b) -> decltype(a - b) { return a - b; }
+};
+
+struct Product {
+    template<typename A, typename B>
+    static auto apply(const A &a, const B &b) -> decltype(a * b) { return a * b; }
+};
+
+struct Division {
+    template<typename A, typename B>
+    static auto apply(const A &a, const B &b) -> decltype(a / b) { return a / b; }
+};
+
+}
+
+// Wrapping of containers
+template<typename T>
+Terminal<std::vector<T>> lazy(const std::vector<T> &container);
+
+template<typename T, std::size_t d>
+Terminal<std::array<T, d>> lazy(const std::array<T, d> &container);
+
+// Operator "-"
+template<typename E>
+UnaryExpression<E, operation::Negate> operator-(const Expression<E> &operand);
+
+// Operator "+"
+template<typename L, typename R>
+BinaryExpression<L, R, operation::Sum> operator+(const Expression<L> &left, const Expression<R> &right);
+
+template<typename L, typename S, typename std::enable_if<std::is_arithmetic<S>::value>::type * = nullptr>
+BinaryExpression<L, Constant<S>, operation::Sum> operator+(const Expression<L> &left, const S &right);
+
+template<typename S, typename R, typename std::enable_if<std::is_arithmetic<S>::value>::type * = nullptr>
+BinaryExpression<Constant<S>, R, operation::Sum> operator+(const S &left, const Expression<R> &right);
+
+// Operator "-"
+template<typename L, typename R>
+BinaryExpression<L, R, operation::Difference> operator-(const Expression<L> &left, const Expression<R> &right);
+
+template<typename L, typename S, typename std::enable_if<std::is_arithmetic<S>::value>::type * = nullptr>
+BinaryExpression<L, Constant<S>, operation::Difference> operator-(const Expression<L> &left, const S &right);
+
+template<typename S, typename R, typename std::enable_if<std::is_arithmetic<S>::value>::type * = nullptr>
+BinaryExpression<Constant<S>, R, operation::Difference> operator-(const S &left, const Expression<R> &right);
+
+// Operator "*"
+template<typename L, typename R>
+BinaryExpression<L, R, operation::Product> operator*(const Expression<L> &left, const Expression<R> &right);
+
+template<typename L, typename S, typename std::enable_if<std::is_arithmetic<S>::value>::type * = nullptr>
+BinaryExpression<L, Constant<S>, operation::Product> operator*(const Expression<L> &left, const S &right);
+
+template<typename S, typename R, typename std::enable_if<std::is_arithmetic<S>::value>::type * = nullptr>
+BinaryExpression<Constant<S>, R, operation::Product> operator*(const S &left, const Expression<R> &right);
+
+// Operator "/"
+template<typename L, typename R>
+BinaryExpression<L, R, operation::Division> operator/(const Expression<L> &left, const Expression<R> &right);
+
+template<typename L, typename S, typename std::enable_if<std::is_arithmetic<S>::value>::type * = nullptr>
+BinaryExpression<L, Constant<S>, operation::Division> operator/(const Expression<L> &left, const S &right);
+
+template<typename S, typename R, typename std::enable_if<std::is_arithmetic<S>::value>::type * = nullptr>
+BinaryExpression<Constant<S>, R, operation::Division> operator/(const S &left, const Expression<R> &right);
+
+// Evaluation
+template<typename T, typename E>
+void assign(std::vector<T> *target, const Expression<E> &expression);
+
+template<typename T, std::size_t d, typename E>
+void assign(std::array<T, d> *target, const Expression<E> &expression);
+
+template<typename T, typename E>
+void increment(std::vector<T> *target, const Expression<E> &expression);
+
+template<typename T, std::size_t d, typename E>
+void increment(std::array<T, d> *target, const Expression<E> &expression);
+
+// Reductions
+template<typename L, typename R>
+typename BinaryExpression<L, R, operation::Product>::value_type dotProduct(const Expression<L> &left, const Expression<R> &right);
+
+template<typename E>
+double norm2(const Expression<E> &expression);
+
+}
+
+}
+
+// Include template implementations
+#include "ExpressionOperators.tpp"
+
+#endif
@@ -0,0 +1,613 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#ifndef __BITPIT_EXPRESSION_OPERATORS_TPP__
+#define __BITPIT_EXPRESSION_OPERATORS_TPP__
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace bitpit {
+
+namespace expression {
+
+/*!
+    Get a reference to the derived expression.
+
+    \result A reference to the derived expression.
+*/
+template<typename E>
+const E & Expression<E>::derived() const
+{
+    return static_cast<const E &>(*this);
+}
+
+/*!
+    Get the number of elements of the expression.
+
+    \result The number of elements of the expression.
+*/
+template<typename E>
+std::size_t Expression<E>::size() const
+{
+    return derived().size();
+}
+
+/*!
+    Evaluate the expression into a newly created std::vector.
+
+    All the elements are evaluated with a single loop, without creating any
+    intermediate container.
+
+    \result The values of the expression.
+*/
+template<typename E>
+template<typename T>
+Expression<E>::operator std::vector<T>() const
+{
+    std::vector<T> values;
+    assign(&values, *this);
+
+    return values;
+}
+
+/*!
+    Evaluate the expression into a newly created std::array.
+
+    The size of the expression should match the size of the array.
+
+    \result The values of the expression.
+*/
+template<typename E>
+template<typename T, std::size_t d>
+Expression<E>::operator std::array<T, d>() const
+{
+    std::array<T, d> values;
+    assign(&values, *this);
+
+    return values;
+}
+
+/*!
+    Constructor.
+
+    \param container is the container that will be wrapped
+*/
+template<typename C>
+Terminal<C>::Terminal(const C &container)
+    : m_container(container)
+{
+}
+
+/*!
+    Get the number of elements of the expression.
+
+    \result The number of elements of the expression.
+*/
+template<typename C>
+std::size_t Terminal<C>::size() const
+{
+    return m_container.size();
+}
+
+/*!
+    Get the specified element of the expression.
+
+    \param i is the index of the element
+    \result The specified element of the expression.
+*/
+template<typename C>
+const typename Terminal<C>::value_type & Terminal<C>::operator[](std::size_t i) const
+{
+    return m_container[i];
+}
+
+/*!
+    Constructor.
+
+    \param value is the value of the constant
+*/
+template<typename T>
+Constant<T>::Constant(const T &value)
+    : m_value(value)
+{
+}
+
+/*!
+    Get the number of elements of the expression.
+
+    \result The maximum size representable by std::size_t.
+*/
+template<typename T>
+std::size_t Constant<T>::size() const
+{
+    return std::numeric_limits<std::size_t>::max();
+}
+
+/*!
+    Get the specified element of the expression.
+
+    Since the expression represents a constant, all the elements have the
+    same value.
+
+    \result The value of the constant.
+*/
+template<typename T>
+const typename Constant<T>::value_type & Constant<T>::operator[](std::size_t) const
+{
+    return m_value;
+}
+
+/*!
+    Constructor.
+
+    \param operand is the operand of the expression
+*/
+template<typename E, typename Op>
+UnaryExpression<E, Op>::UnaryExpression(const E &operand)
+    : m_operand(operand)
+{
+}
+
+/*!
+    Get the number of elements of the expression.
+
+    \result The number of elements of the expression.
+*/
+template<typename E, typename Op>
+std::size_t UnaryExpression<E, Op>::size() const
+{
+    return m_operand.size();
+}
+
+/*!
+    Evaluate the specified element of the expression.
+
+    \param i is the index of the element
+    \result The specified element of the expression.
+*/
+template<typename E, typename Op>
+typename UnaryExpression<E, Op>::value_type UnaryExpression<E, Op>::operator[](std::size_t i) const
+{
+    return Op::apply(m_operand[i]);
+}
+
+/*!
+    Constructor.
+
+    The two operands should have the same size, unless one of them is a
+    constant.
+
+    \param left is the left operand of the expression
+    \param right is the right operand of the expression
+*/
+template<typename L, typename R, typename Op>
+BinaryExpression<L, R, Op>::BinaryExpression(const L &left, const R &right)
+    : m_left(left), m_right(right)
+{
+    assert(m_left.size() == m_right.size() || m_left.size() == std::numeric_limits<std::size_t>::max() || m_right.size() == std::numeric_limits<std::size_t>::max());
+}
+
+/*!
+    Get the number of elements of the expression.
+
+    \result The number of elements of the expression.
+*/
+template<typename L, typename R, typename Op>
+std::size_t BinaryExpression<L, R, Op>::size() const
+{
+    return std::min(m_left.size(), m_right.size());
+}
+
+/*!
+    Evaluate the specified element of the expression.
+
+    \param i is the index of the element
+    \result The specified element of the expression.
+*/
+template<typename L, typename R, typename Op>
+typename BinaryExpression<L, R, Op>::value_type BinaryExpression<L, R, Op>::operator[](std::size_t i) const
+{
+    return Op::apply(m_left[i], m_right[i]);
+}
+
+/*!
+    \ingroup MathOperators
+    Wrap a std::vector into an expression.
+
+    Arithmetic operations involving the returned expression are evaluated
+    lazily, e.g., the expression lazy(a) + 2. * lazy(b) - lazy(c) is
+    evaluated with a single loop when it is assigned to a container.
+
+    \param container is the container that will be wrapped, the container
+    has to outlive the expression
+    \result The expression that wraps the container.
+*/
+template<typename T>
+Terminal<std::vector<T>> lazy(const std::vector<T> &container)
+{
+    return Terminal<std::vector<T>>(container);
+}
+
+/*!
+    \ingroup MathOperators
+    Wrap a std::array into an expression.
+
+    Standard operators for arrays don't allocate heap memory, hence lazy
+    evaluation of arrays is mainly useful to write mixed expressions or to
+    evaluate expressions in place.
+
+    \param container is the container that will be wrapped, the container
+    has to outlive the expression
+    \result The expression that wraps the container.
+*/
+template<typename T, std::size_t d>
+Terminal<std::array<T, d>> lazy(const std::array<T, d> &container)
+{
+    return Terminal<std::array<T, d>>(container);
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise opposite of an expression.
+
+    \param operand is the operand
+    \result The expression that evaluates the opposite of the operand.
+*/
+template<typename E>
+UnaryExpression<E, operation::Negate> operator-(const Expression<E> &operand)
+{
+    return UnaryExpression<E, operation::Negate>(operand.derived());
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise sum of two expressions.
+
+    \param left is the left operand
+    \param right is the right operand
+    \result The expression that evaluates the sum.
+*/
+template<typename L, typename R>
+BinaryExpression<L, R, operation::Sum> operator+(const Expression<L> &left, const Expression<R> &right)
+{
+    return BinaryExpression<L, R, operation::Sum>(left.derived(), right.derived());
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise sum of an expression and a constant.
+
+    \param left is the left operand
+    \param right is the constant
+    \result The expression that evaluates the sum.
+*/
+template<typename L, typename S, typename std::enable_if<std::is_arithmetic<S>::value>::type *>
+BinaryExpression<L, Constant<S>, operation::Sum> operator+(const Expression<L> &left, const S &right)
+{
+    return BinaryExpression<L, Constant<S>, operation::Sum>(left.derived(), Constant<S>(right));
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise sum of a constant and an expression.
+
+    \param left is the constant
+    \param right is the right operand
+    \result The expression that evaluates the sum.
+*/
+template<typename S, typename R, typename std::enable_if<std::is_arithmetic<S>::value>::type *>
+BinaryExpression<Constant<S>, R, operation::Sum> operator+(const S &left, const Expression<R> &right)
+{
+    return BinaryExpression<Constant<S>, R, operation::Sum>(Constant<S>(left), right.derived());
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise difference of two expressions.
+
+    \param left is the left operand
+    \param right is the right operand
+    \result The expression that evaluates the difference.
+*/
+template<typename L, typename R>
+BinaryExpression<L, R, operation::Difference> operator-(const Expression<L> &left, const Expression<R> &right)
+{
+    return BinaryExpression<L, R, operation::Difference>(left.derived(), right.derived());
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise difference of an expression and a constant.
+
+    \param left is the left operand
+    \param right is the constant
+    \result The expression that evaluates the difference.
+*/
+template<typename L, typename S, typename std::enable_if<std::is_arithmetic<S>::value>::type *>
+BinaryExpression<L, Constant<S>, operation::Difference> operator-(const Expression<L> &left, const S &right)
+{
+    return BinaryExpression<L, Constant<S>, operation::Difference>(left.derived(), Constant<S>(right));
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise difference of a constant and an expression.
+
+    \param left is the constant
+    \param right is the right operand
+    \result The expression that evaluates the difference.
+*/
+template<typename S, typename R, typename std::enable_if<std::is_arithmetic<S>::value>::type *>
+BinaryExpression<Constant<S>, R, operation::Difference> operator-(const S &left, const Expression<R> &right)
+{
+    return BinaryExpression<Constant<S>, R, operation::Difference>(Constant<S>(left), right.derived());
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise product of two expressions.
+
+    \param left is the left operand
+    \param right is the right operand
+    \result The expression that evaluates the product.
+*/
+template<typename L, typename R>
+BinaryExpression<L, R, operation::Product> operator*(const Expression<L> &left, const Expression<R> &right)
+{
+    return BinaryExpression<L, R, operation::Product>(left.derived(), right.derived());
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise product of an expression and a constant.
+
+    \param left is the left operand
+    \param right is the constant
+    \result The expression that evaluates the product.
+*/
+template<typename L, typename S, typename std::enable_if<std::is_arithmetic<S>::value>::type *>
+BinaryExpression<L, Constant<S>, operation::Product> operator*(const Expression<L> &left, const S &right)
+{
+    return BinaryExpression<L, Constant<S>, operation::Product>(left.derived(), Constant<S>(right));
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise product of a constant and an expression.
+
+    \param left is the constant
+    \param right is the right operand
+    \result The expression that evaluates the product.
+*/
+template<typename S, typename R, typename std::enable_if<std::is_arithmetic<S>::value>::type *>
+BinaryExpression<Constant<S>, R, operation::Product> operator*(const S &left, const Expression<R> &right)
+{
+    return BinaryExpression<Constant<S>, R, operation::Product>(Constant<S>(left), right.derived());
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise division of two expressions.
+
+    \param left is the left operand
+    \param right is the right operand
+    \result The expression that evaluates the division.
+*/
+template<typename L, typename R>
+BinaryExpression<L, R, operation::Division> operator/(const Expression<L> &left, const Expression<R> &right)
+{
+    return BinaryExpression<L, R, operation::Division>(left.derived(), right.derived());
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise division of an expression by a constant.
+
+    \param left is the left operand
+    \param right is the constant
+    \result The expression that evaluates the division.
+*/
+template<typename L, typename S, typename std::enable_if<std::is_arithmetic<S>::value>::type *>
+BinaryExpression<L, Constant<S>, operation::Division> operator/(const Expression<L> &left, const S &right)
+{
+    return BinaryExpression<L, Constant<S>, operation::Division>(left.derived(), Constant<S>(right));
+}
+
+/*!
+    \ingroup MathOperators
+    Element-wise division of a constant by an expression.
+
+    \param left is the constant
+    \param right is the right operand
+    \result The expression that evaluates the division.
+*/
+template<typename S, typename R, typename std::enable_if<std::is_arithmetic<S>::value>::type *>
+BinaryExpression<Constant<S>, R, operation::Division> operator/(const S &left, const Expression<R> &right)
+{
+    return BinaryExpression<Constant<S>, R, operation::Division>(Constant<S>(left), right.derived());
+}
+
+/*!
+    \ingroup MathOperators
+    Evaluate an expression into the specified std::vector.
+
+    The vector is resized to the size of the expression and all the elements
+    are evaluated with a single loop. The target may be one of the operands
+    of the expression, since each element of the expression only depends on
+    the elements of the operands with the same index.
+
+    \param[out] target on output will contain the values of the expression
+    \param expression is the expression to evaluate
+*/
+template<typename T, typename E>
+void assign(std::vector<T> *target, const Expression<E> &expression)
+{
+    const E &derived = expression.derived();
+
+    std::size_t n = derived.size();
+    target->resize(n);
+
+    T *values = target->data();
+    for (std::size_t i = 0; i < n; ++i) {
+        values[i] = derived[i];
+    }
+}
+
+/*!
+    \ingroup MathOperators
+    Evaluate an expression into the specified std::array.
+
+    The size of the expression should match the size of the array.
+
+    \param[out] target on output will contain the values of the expression
+    \param expression is the expression to evaluate
+*/
+template<typename T, std::size_t d, typename E>
+void assign(std::array<T, d> *target, const Expression<E> &expression)
+{
+    const E &derived = expression.derived();
+    assert(derived.size() == d);
+
+    for (std::size_t i = 0; i < d; ++i) {
+        (*target)[i] = derived[i];
+    }
+}
+
+/*!
+    \ingroup MathOperators
+    Increment the specified std::vector by the values of an expression.
+
+    The size of the expression should match the size of the vector.
+
+    \param[in,out] target is the vector that will be incremented
+    \param expression is the expression to evaluate
+*/
+template<typename T, typename E>
+void increment(std::vector<T> *target, const Expression<E> &expression)
+{
+    const E &derived = expression.derived();
+
+    std::size_t n = target->size();
+    assert(derived.size() == n);
+
+    T *values = target->data();
+    for (std::size_t i = 0; i < n; ++i) {
+        values[i] += derived[i];
+    }
+}
+
+/*!
+    \ingroup MathOperators
+    Increment the specified std::array by the values of an expression.
+
+    The size of the expression should match the size of the array.
+
+    \param[in,out] target is the array that will be incremented
+    \param expression is the expression to evaluate
+*/
+template<typename T, std::size_t d, typename E>
+void increment(std::array<T, d> *target, const Expression<E> &expression)
+{
+    const E &derived = expression.derived();
+    assert(derived.size() == d);
+
+    for (std::size_t i = 0; i < d; ++i) {
+        (*target)[i] += derived[i];
+    }
+}
+
+/*!
+    \ingroup MathOperators
+    Compute the scalar product of two expressions.
+
+    Products of long expressions are accumulated in four independent partial
+    sums, this breaks the dependency chain of the accumulation and allows the
+    compiler to vectorize the loop. For this reason, the result may differ
+    from the one evaluated by the sequential accumulation by round-off errors.
+
+    \param left is the first argument
+    \param right is the second argument
+    \result The scalar product of the two expressions.
+*/
+template<typename L, typename R>
+typename BinaryExpression<L, R, operation::Product>::value_type dotProduct(const Expression<L> &left, const Expression<R> &right)
+{
+    typedef typename BinaryExpression<L, R, operation::Product>::value_type value_type;
+
+    const L &leftDerived  = left.derived();
+    const R &rightDerived = right.derived();
+
+    std::size_t n = std::min(leftDerived.size(), rightDerived.size());
+    assert(leftDerived.size() == rightDerived.size());
+
+    // Short expressions (e.g., coordinates) are accumulated sequentially
+    if (n < 16) {
+        value_type result = value_type(0);
+        for (std::size_t i = 0; i < n; ++i) {
+            result += leftDerived[i] * rightDerived[i];
+        }
+
+        return result;
+    }
+
+    value_type partials[4] = {value_type(0), value_type(0), value_type(0), value_type(0)};
+
+    std::size_t nBlocks = n / 4;
+    for (std::size_t k = 0; k < nBlocks; ++k) {
+        std::size_t i = 4 * k;
+        partials[0] += leftDerived[i]     * rightDerived[i];
+        partials[1] += leftDerived[i + 1] * rightDerived[i + 1];
+        partials[2] += leftDerived[i + 2] * rightDerived[i + 2];
+        partials[3] += leftDerived[i + 3] * rightDerived[i + 3];
+    }
+
+    for (std::size_t i = 4 * nBlocks; i < n; ++i) {
+        partials[0] += leftDerived[i] * rightDerived[i];
+    }
+
+    return ((partials[0] + partials[1]) + (partials[2] + partials[3]));
+}
+
+/*!
+    \ingroup MathOperators
+    Compute the 2-norm of an expression.
+
+    See dotProduct for details about the accumulation of the squares.
+
+    \param expression is the expression
+    \result The 2-norm of the expression.
+*/
+template<typename E>
+double norm2(const Expression<E> &expression)
+{
+    return std::sqrt(dotProduct(expression, expression));
+}
+
+}
+
+}
+
+#endif
@@ -37,6 +37,7 @@
  */
 
 #include "Operators.hpp"
+#include "ExpressionOperators.hpp"
 
 #include "moduleEnd.hpp"
 #endif
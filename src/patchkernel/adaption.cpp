@@ -22,6 +22,7 @@
  *
 \*---------------------------------------------------------------------------*/
 
+#include <cassert>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -224,6 +225,601 @@ std::vector<Info> InfoCollection::dump()
 	return exportedCollection;
 }
 
+/*!
+	\struct InfoView
+
+	\brief The InfoView struct provides a read-only view of an adaption
+	info stored in a FlatInfoCollection.
+*/
+
+/*!
+	\class FlatInfoCollection
+
+	\brief The FlatInfoCollection class is a container that holds one or
+	more adaption info items using a compressed storage.
+
+	Type, entity and rank of the adaption info items are stored in separate
+	arrays, whereas the lists of previous and current ids of all the items
+	are stored in two flat arrays using a compressed sparse row layout.
+	Unlike a vector of adaption::Info, the memory needed by the collection
+	doesn't grow with the number of items through a multitude of small
+	allocations, hence large adaptions can be tracked efficiently.
+
+	Ids can be appended to any item of the collection. Ids appended to
+	the last item are stored directly in the compressed arrays, whereas
+	ids appended to other items are stored in a buffer of pending ids that
+	will be moved in the compressed arrays when the collection is flushed.
+	The ids of an item can only be accessed when the collection is flushed.
+
+	As for the InfoCollection, items associated with creations, deletions
+	and partitioning are shared among all the requests with the same type,
+	entity and rank.
+*/
+
+/*!
+	Default constructor.
+*/
+FlatInfoCollection::FlatInfoCollection()
+	: m_previousOffsets(1, 0), m_currentOffsets(1, 0)
+{
+	m_cachedTypes.insert(adaption::TYPE_DELETION);
+	m_cachedTypes.insert(adaption::TYPE_CREATION);
+	m_cachedTypes.insert(adaption::TYPE_PARTITION_RECV);
+	m_cachedTypes.insert(adaption::TYPE_PARTITION_SEND);
+}
+
+/*!
+	Creates a collection importing the specified adaption info items.
+
+	\param infos are the adaption info items that will be imported, the
+	items are released while being imported
+*/
+FlatInfoCollection::FlatInfoCollection(std::vector<Info> &&infos)
+	: FlatInfoCollection()
+{
+	append(std::move(infos));
+}
+
+/*!
+	Creates an empty adaption info.
+
+	\result The id of the adaption info.
+*/
+std::size_t FlatInfoCollection::create()
+{
+	m_types.push_back(TYPE_UNKNOWN);
+	m_entities.push_back(ENTITY_UNKNOWN);
+	m_ranks.push_back(-1);
+
+	m_previousOffsets.push_back(m_previousOffsets.back());
+	m_currentOffsets.push_back(m_currentOffsets.back());
+
+	return (m_types.size() - 1);
+}
+
+/*!
+	Creates an adaption info with the requested data.
+
+	If an adaption info with the requested data already exists and the
+	type of the adaption info is shareable, the id of the existing info
+	will be returned, otherwise a new adaption info will be created.
+
+	\param type is the type of adaption info
+	\param entity is the entity associated to the adaption info
+	\param rank is the rank associated to the adaption info
+	\result The id of the requested adaption info.
+*/
+std::size_t FlatInfoCollection::create(Type type, Entity entity, int rank)
+{
+	infoData_t infoData = infoData_t(type, entity, rank);
+	bool useCache = (m_cachedTypes.count(type) > 0);
+
+	if (useCache) {
+		auto cacheItr = m_cache.find(infoData);
+		if (cacheItr != m_cache.end()) {
+			return cacheItr->second;
+		}
+	}
+
+	std::size_t id = create();
+	m_types[id]    = type;
+	m_entities[id] = entity;
+	m_ranks[id]    = rank;
+
+	if (useCache) {
+		m_cache.insert({{infoData, id}});
+	}
+
+	return id;
+}
+
+/*!
+	Appends a previous id to the specified adaption info.
+
+	\param id is the id of the adaption info
+	\param previous is the previous id that will be appended
+*/
+void FlatInfoCollection::appendPrevious(std::size_t id, long previous)
+{
+	append(id, previous, &m_previousOffsets, &m_previous, &m_pendingPrevious);
+}
+
+/*!
+	Appends a current id to the specified adaption info.
+
+	\param id is the id of the adaption info
+	\param current is the current id that will be appended
+*/
+void FlatInfoCollection::appendCurrent(std::size_t id, long current)
+{
+	append(id, current, &m_currentOffsets, &m_current, &m_pendingCurrent);
+}
+
+/*!
+	Appends an id to the specified adaption info.
+
+	If the adaption info is the last one, the id is stored directly in the
+	compressed arrays, otherwise the id is added to the list of pending ids.
+	Since an adaption info can't become the last one again after another
+	info has been created, the order in which the ids are appended is
+	preserved.
+
+	\param id is the id of the adaption info
+	\param value is the id that will be appended
+	\param offsets are the offsets of the compressed arrays
+	\param values are the values of the compressed arrays
+	\param pendings are the pending ids
+*/
+void FlatInfoCollection::append(std::size_t id, long value, std::vector<std::size_t> *offsets,
+                                std::vector<long> *values, std::vector<std::pair<std::size_t, long>> *pendings)
+{
+	assert(id < size());
+
+	if ((id + 1) == size()) {
+		values->push_back(value);
+		++(offsets->back());
+	} else {
+		pendings->emplace_back(id, value);
+	}
+}
+
+/*!
+	Appends the specified adaption info items.
+
+	Items are always appended at the end of the collection, they are not
+	merged with existing items. The items are released while being
+	imported.
+
+	\param infos are the adaption info items that will be imported
+*/
+void FlatInfoCollection::append(std::vector<Info> &&infos)
+{
+	flush();
+
+	std::size_t nAppendedPrevious = 0;
+	std::size_t nAppendedCurrent  = 0;
+	for (const Info &info : infos) {
+		nAppendedPrevious += info.previous.size();
+		nAppendedCurrent  += info.current.size();
+	}
+
+	reserve(size() + infos.size(), m_previous.size() + nAppendedPrevious, m_current.size() + nAppendedCurrent);
+
+	for (Info &info : infos) {
+		m_types.push_back(info.type);
+		m_entities.push_back(info.entity);
+		m_ranks.push_back(info.rank);
+
+		m_previous.insert(m_previous.end(), info.previous.begin(), info.previous.end());
+		m_previousOffsets.push_back(m_previous.size());
+
+		m_current.insert(m_current.end(), info.current.begin(), info.current.end());
+		m_currentOffsets.push_back(m_current.size());
+
+		std::vector<long>().swap(info.previous);
+		std::vector<long>().swap(info.current);
+	}
+
+	std::vector<Info>().swap(infos);
+}
+
+/*!
+	Appends the adaption info items of the specified collection.
+
+	Items are always appended at the end of the collection, they are not
+	merged with existing items. The source collection is cleared.
+
+	\param other is the collection whose items will be appended
+*/
+void FlatInfoCollection::append(FlatInfoCollection &&other)
+{
+	if (empty()) {
+		std::swap(*this, other);
+		other.clear();
+		flush();
+		return;
+	}
+
+	flush();
+	other.flush();
+
+	std::size_t nInfos = size();
+
+	m_types.insert(m_types.end(), other.m_types.begin(), other.m_types.end());
+	m_entities.insert(m_entities.end(), other.m_entities.begin(), other.m_entities.end());
+	m_ranks.insert(m_ranks.end(), other.m_ranks.begin(), other.m_ranks.end());
+
+	std::size_t previousOffset = m_previous.size();
+	for (std::size_t id = 1; id < other.m_previousOffsets.size(); ++id) {
+		m_previousOffsets.push_back(previousOffset + other.m_previousOffsets[id]);
+	}
+	m_previous.insert(m_previous.end(), other.m_previous.begin(), other.m_previous.end());
+
+	std::size_t currentOffset = m_current.size();
+	for (std::size_t id = 1; id < other.m_currentOffsets.size(); ++id) {
+		m_currentOffsets.push_back(currentOffset + other.m_currentOffsets[id]);
+	}
+	m_current.insert(m_current.end(), other.m_current.begin(), other.m_current.end());
+
+	for (const auto &cacheEntry : other.m_cache) {
+		m_cache.insert({cacheEntry.first, nInfos + cacheEntry.second});
+	}
+
+	other.clear();
+}
+
+/*!
+	Moves the pending ids into the compressed arrays.
+
+	Pending ids are appended after the ids already stored in the item,
+	preserving the order in which they have been appended.
+*/
+void FlatInfoCollection::flush()
+{
+	flush(&m_previousOffsets, &m_previous, &m_pendingPrevious);
+	flush(&m_currentOffsets, &m_current, &m_pendingCurrent);
+}
+
+/*!
+	Moves the specified pending ids into the specified compressed arrays.
+
+	\param offsets are the offsets of the compressed arrays
+	\param values are the values of the compressed arrays
+	\param pendings are the pending ids
+*/
+void FlatInfoCollection::flush(std::vector<std::size_t> *offsets, std::vector<long> *values,
+                               std::vector<std::pair<std::size_t, long>> *pendings)
+{
+	if (pendings->empty()) {
+		return;
+	}
+
+	std::size_t nInfos = size();
+
+	// Evaluate the updated offsets
+	std::vector<std::size_t> updatedOffsets(nInfos + 1, 0);
+	for (std::size_t id = 0; id < nInfos; ++id) {
+		updatedOffsets[id + 1] = (*offsets)[id + 1] - (*offsets)[id];
+	}
+
+	for (const auto &pending : *pendings) {
+		++updatedOffsets[pending.first + 1];
+	}
+
+	for (std::size_t id = 0; id < nInfos; ++id) {
+		updatedOffsets[id + 1] += updatedOffsets[id];
+	}
+
+	// Fill the updated values
+	std::vector<long> updatedValues(updatedOffsets.back());
+
+	std::vector<std::size_t> fillPositions(nInfos);
+	for (std::size_t id = 0; id < nInfos; ++id) {
+		std::size_t fillPos = updatedOffsets[id];
+		for (std::size_t k = (*offsets)[id]; k < (*offsets)[id + 1]; ++k) {
+			updatedValues[fillPos++] = (*values)[k];
+		}
+		fillPositions[id] = fillPos;
+	}
+
+	for (const auto &pending : *pendings) {
+		updatedValues[fillPositions[pending.first]++] = pending.second;
+	}
+
+	// Update the storage
+	offsets->swap(updatedOffsets);
+	values->swap(updatedValues);
+	std::vector<std::pair<std::size_t, long>>().swap(*pendings);
+}
+
+/*!
+	Checks if the collection is flushed, i.e., if there are no pending
+	ids.
+
+	\result Returns true if the collection is flushed, false otherwise.
+*/
+bool FlatInfoCollection::isFlushed() const
+{
+	return (m_pendingPrevious.empty() && m_pendingCurrent.empty());
+}
+
+/*!
+	Checks if the collection is empty.
+
+	\result Returns true if the collection is empty, false otherwise.
+*/
+bool FlatInfoCollection::empty() const
+{
+	return m_types.empty();
+}
+
+/*!
+	Gets the number of adaption info items in the collection.
+
+	\result The number of adaption info items in the collection.
+*/
+std::size_t FlatInfoCollection::size() const
+{
+	return m_types.size();
+}
+
+/*!
+	Requests a change in the capacity of the collection.
+
+	\param nInfos is the number of adaption info items
+	\param nPrevious is the total number of previous ids
+	\param nCurrent is the total number of current ids
+*/
+void FlatInfoCollection::reserve(std::size_t nInfos, std::size_t nPrevious, std::size_t nCurrent)
+{
+	m_types.reserve(nInfos);
+	m_entities.reserve(nInfos);
+	m_ranks.reserve(nInfos);
+
+	m_previousOffsets.reserve(nInfos + 1);
+	m_previous.reserve(nPrevious);
+
+	m_currentOffsets.reserve(nInfos + 1);
+	m_current.reserve(nCurrent);
+}
+
+/*!
+	Requests the collection to reduce its capacity to fit its size.
+
+	Pending ids are moved into the compressed arrays before reducing the
+	capacity.
+*/
+void FlatInfoCollection::squeeze()
+{
+	flush();
+
+	m_types.shrink_to_fit();
+	m_entities.shrink_to_fit();
+	m_ranks.shrink_to_fit();
+
+	m_previousOffsets.shrink_to_fit();
+	m_previous.shrink_to_fit();
+
+	m_currentOffsets.shrink_to_fit();
+	m_current.shrink_to_fit();
+}
+
+/*!
+	Removes all the adaption info items from the collection.
+*/
+void FlatInfoCollection::clear()
+{
+	m_cache.clear();
+
+	m_types.clear();
+	m_entities.clear();
+	m_ranks.clear();
+
+	m_previousOffsets.assign(1, 0);
+	m_previous.clear();
+	m_pendingPrevious.clear();
+
+	m_currentOffsets.assign(1, 0);
+	m_current.clear();
+	m_pendingCurrent.clear();
+}
+
+/*!
+	Gets the type of the specified adaption info.
+
+	\param id is the id of the adaption info
+	\result The type of the specified adaption info.
+*/
+Type FlatInfoCollection::getType(std::size_t id) const
+{
+	return m_types[id];
+}
+
+/*!
+	Gets the entity of the specified adaption info.
+
+	\param id is the id of the adaption info
+	\result The entity of the specified adaption info.
+*/
+Entity FlatInfoCollection::getEntity(std::size_t id) const
+{
+	return m_entities[id];
+}
+
+/*!
+	Gets the rank of the specified adaption info.
+
+	\param id is the id of the adaption info
+	\result The rank of the specified adaption info.
+*/
+int FlatInfoCollection::getRank(std::size_t id) const
+{
+	return m_ranks[id];
+}
+
+/*!
+	Gets the previous ids of the specified adaption info.
+
+	The collection should be flushed.
+
+	\param id is the id of the adaption info
+	\result The previous ids of the specified adaption info.
+*/
+ProxyVector<long> FlatInfoCollection::getPrevious(std::size_t id)
+{
+	assert(isFlushed());
+
+	std::size_t begin = m_previousOffsets[id];
+	std::size_t end   = m_previousOffsets[id + 1];
+
+	if (begin == end) {
+		return ProxyVector<long>();
+	}
+
+	return ProxyVector<long>(m_previous.data() + begin, end - begin);
+}
+
+/*!
+	Gets the previous ids of the specified adaption info.
+
+	The collection should be flushed.
+
+	\param id is the id of the adaption info
+	\result The previous ids of the specified adaption info.
+*/
+ConstProxyVector<long> FlatInfoCollection::getPrevious(std::size_t id) const
+{
+	assert(isFlushed());
+
+	std::size_t begin = m_previousOffsets[id];
+	std::size_t end   = m_previousOffsets[id + 1];
+
+	return ConstProxyVector<long>(m_previous.data() + begin, end - begin);
+}
+
+/*!
+	Gets the current ids of the specified adaption info.
+
+	The collection should be flushed.
+
+	\param id is the id of the adaption info
+	\result The current ids of the specified adaption info.
+*/
+ProxyVector<long> FlatInfoCollection::getCurrent(std::size_t id)
+{
+	assert(isFlushed());
+
+	std::size_t begin = m_currentOffsets[id];
+	std::size_t end   = m_currentOffsets[id + 1];
+
+	if (begin == end) {
+		return ProxyVector<long>();
+	}
+
+	return ProxyVector<long>(m_current.data() + begin, end - begin);
+}
+
+/*!
+	Gets the current ids of the specified adaption info.
+
+	The collection should be flushed.
+
+	\param id is the id of the adaption info
+	\result The current ids of the specified adaption info.
+*/
+ConstProxyVector<long> FlatInfoCollection::getCurrent(std::size_t id) const
+{
+	assert(isFlushed());
+
+	std::size_t begin = m_currentOffsets[id];
+	std::size_t end   = m_currentOffsets[id + 1];
+
+	return ConstProxyVector<long>(m_current.data() + begin, end - begin);
+}
+
+/*!
+	Returns a view of the adaption info at the specified position in the
+	collection.
+
+	\param id is the id of the adaption info
+	\result Returns a view of the requested adaption info.
+*/
+InfoView FlatInfoCollection::at(std::size_t id) const
+{
+	if (id >= size()) {
+		throw std::out_of_range("Requested adaption info is not in the collection");
+	} else if (!isFlushed()) {
+		throw std::runtime_error("The collection has pending ids, it should be flushed before accessing its items");
+	}
+
+	return (*this)[id];
+}
+
+/*!
+	Returns a view of the adaption info at the specified position in the
+	collection.
+
+	The collection should be flushed.
+
+	\param id is the id of the adaption info
+	\result Returns a view of the requested adaption info.
+*/
+InfoView FlatInfoCollection::operator[](std::size_t id) const
+{
+	return InfoView(m_types[id], m_entities[id], m_ranks[id], getPrevious(id), getCurrent(id));
+}
+
+/*!
+	Evaluates the size, expressed in bytes, of the storage used by the
+	collection to hold its items.
+
+	\result The size, expressed in bytes, of the storage used by the
+	collection to hold its items.
+*/
+std::size_t FlatInfoCollection::evalStorageSize() const
+{
+	std::size_t storageSize = 0;
+	storageSize += m_types.capacity() * sizeof(Type);
+	storageSize += m_entities.capacity() * sizeof(Entity);
+	storageSize += m_ranks.capacity() * sizeof(int);
+	storageSize += m_previousOffsets.capacity() * sizeof(std::size_t);
+	storageSize += m_previous.capacity() * sizeof(long);
+	storageSize += m_pendingPrevious.capacity() * sizeof(std::pair<std::size_t, long>);
+	storageSize += m_currentOffsets.capacity() * sizeof(std::size_t);
+	storageSize += m_current.capacity() * sizeof(long);
+	storageSize += m_pendingCurrent.capacity() * sizeof(std::pair<std::size_t, long>);
+
+	return storageSize;
+}
+
+/*!
+	Dumps the collection into a vector of adaption info.
+
+	Once the collection is dumped, the collection is cleared.
+
+	\result The adaption info items of the collection.
+*/
+std::vector<Info> FlatInfoCollection::dump()
+{
+	flush();
+
+	std::size_t nInfos = size();
+
+	std::vector<Info> exportedCollection;
+	exportedCollection.reserve(nInfos);
+	for (std::size_t id = 0; id < nInfos; ++id) {
+		exportedCollection.emplace_back(m_types[id], m_entities[id], m_ranks[id]);
+		Info &info = exportedCollection.back();
+
+		info.previous.assign(m_previous.begin() + m_previousOffsets[id], m_previous.begin() + m_previousOffsets[id + 1]);
+		info.current.assign(m_current.begin() + m_currentOffsets[id], m_current.begin() + m_currentOffsets[id + 1]);
+	}
+
+	clear();
+
+	return exportedCollection;
+}
+
 }
 
 /*!
@@ -29,6 +29,8 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "bitpit_containers.hpp"
+
 namespace bitpit {
 
 namespace adaption
@@ -105,6 +107,84 @@ namespace adaption
 		std::unordered_set<int> m_cachedTypes;
 		std::vector<Info> m_collection;
 	};
+
+	struct InfoView
+	{
+		InfoView(Type user_type, Entity user_entity, int user_rank, ConstProxyVector<long> &&user_previous, ConstProxyVector<long> &&user_current)
+			: type(user_type), entity(user_entity), rank(user_rank),
+			  previous(std::move(user_previous)), current(std::move(user_current))
+		{
+		}
+
+		Type type;
+		Entity entity;
+		int rank;
+		ConstProxyVector<long> previous;
+		ConstProxyVector<long> current;
+	};
+
+	class FlatInfoCollection
+	{
+
+	public:
+		FlatInfoCollection();
+		FlatInfoCollection(std::vector<Info> &&infos);
+
+		std::size_t create();
+		std::size_t create(Type type, Entity entity, int rank = -1);
+
+		void appendPrevious(std::size_t id, long previous);
+		void appendCurrent(std::size_t id, long current);
+
+		void append(std::vector<Info> &&infos);
+		void append(FlatInfoCollection &&other);
+
+		void flush();
+		bool isFlushed() const;
+
+		bool empty() const;
+		std::size_t size() const;
+		void reserve(std::size_t nInfos, std::size_t nPrevious, std::size_t nCurrent);
+		void squeeze();
+		void clear();
+
+		Type getType(std::size_t id) const;
+		Entity getEntity(std::size_t id) const;
+		int getRank(std::size_t id) const;
+
+		ProxyVector<long> getPrevious(std::size_t id);
+		ConstProxyVector<long> getPrevious(std::size_t id) const;
+		ProxyVector<long> getCurrent(std::size_t id);
+		ConstProxyVector<long> getCurrent(std::size_t id) const;
+
+		InfoView at(std::size_t id) const;
+		InfoView operator[](std::size_t id) const;
+
+		std::size_t evalStorageSize() const;
+
+		std::vector<Info> dump();
+
+	private:
+		typedef std::tuple<int, int, int> infoData_t;
+
+		std::unordered_map<infoData_t, std::size_t, utils::hashing::hash<infoData_t>> m_cache;
+		std::unordered_set<int> m_cachedTypes;
+
+		std::vector<Type> m_types;
+		std::vector<Entity> m_entities;
+		std::vector<int> m_ranks;
+
+		std::vector<std::size_t> m_previousOffsets;
+		std::vector<long> m_previous;
+		std::vector<std::pair<std::size_t, long>> m_pendingPrevious;
+
+		std::vector<std::size_t> m_currentOffsets;
+		std::vector<long> m_current;
+		std::vector<std::pair<std::size_t, long>> m_pendingCurrent;
+
+		void append(std::size_t id, long value, std::vector<std::size_t> *offsets, std::vector<long> *values, std::vector<std::pair<std::size_t, long>> *pendings);
+		void flush(std::vector<std::size_t> *offsets, std::vector<long> *values, std::vector<std::pair<std::size_t, long>> *pendings);
+	};
 }
 
 class PatchKernel;
@@ -40,6 +40,7 @@
 
 
 #include "line_kernel.hpp"
+#include "line_skd_tree.hpp"
 #include "patch_info.hpp"
 #include "patch_kernel.hpp"
 #include "patch_manager.hpp"
@@ -49,6 +50,7 @@
 #include "volume_kernel.hpp"
 #include "volume_skd_tree.hpp"
 #include "volume_mapper.hpp"
+#include "volume_transfer_operator.hpp"
 #include "adaption.hpp"
 
 #include "moduleEnd.hpp"
@@ -22,6 +22,7 @@
  *
 \*---------------------------------------------------------------------------*/
 
+#include <cmath>
 #include <set>
 
 #include "bitpit_CG.hpp"
@@ -419,6 +420,36 @@ double ReferenceTetraInfo::evalVolume(const std::array<double, 3> *vertexCoords)
     return volume;
 }
 
+/*!
+    Evaluates the volumes of a set of elements with the specified vertex
+    coordinates.
+
+    Coordinates are stored element after element, each element contributes
+    with the coordinates of its four vertices.
+
+    \param nElements is the number of elements
+    \param vertexCoords are the coordinate of the vertices of the elements
+    \param[out] volumes on output will contain the volumes of the elements
+*/
+void ReferenceTetraInfo::evalVolumes(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *volumes) const
+{
+    for (std::size_t k = 0; k < nElements; ++k) {
+        const std::array<double, 3> *elementCoords = vertexCoords + 4 * k;
+        const std::array<double, 3> &V_A = elementCoords[0];
+        const std::array<double, 3> &V_B = elementCoords[1];
+        const std::array<double, 3> &V_C = elementCoords[2];
+        const std::array<double, 3> &V_D = elementCoords[3];
+
+        double a0 = V_A[0] - V_D[0], a1 = V_A[1] - V_D[1], a2 = V_A[2] - V_D[2];
+        double b0 = V_B[0] - V_D[0], b1 = V_B[1] - V_D[1], b2 = V_B[2] - V_D[2];
+        double c0 = V_C[0] - V_D[0], c1 = V_C[1] - V_D[1], c2 = V_C[2] - V_D[2];
+
+        double tripleProduct = a0 * (b1 * c2 - b2 * c1) + a1 * (b2 * c0 - b0 * c2) + a2 * (b0 * c1 - b1 * c0);
+
+        volumes[k] = std::abs(tripleProduct) / 6.;
+    }
+}
+
 /*!
     Evaluates the characteristics size of an element with the specified vertex
     coordinates.
@@ -733,6 +764,74 @@ double ReferenceHexahedronInfo::evalVolume(const std::array<double, 3> *vertexCo
     return volume;
 }
 
+/*!
+    Evaluates the volumes of a set of elements with the specified vertex
+    coordinates.
+
+    Coordinates are stored element after element, each element contributes
+    with the coordinates of its eight vertices. The volume of each element
+    is evaluated with the same pyramid decomposition used by evalVolume(),
+    but without going through the reference information of the faces and
+    of the pyramids.
+
+    \param nElements is the number of elements
+    \param vertexCoords are the coordinate of the vertices of the elements
+    \param[out] volumes on output will contain the volumes of the elements
+*/
+void ReferenceHexahedronInfo::evalVolumes(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *volumes) const
+{
+    // Vertices of the pyramid bases, listed in the order the pyramid expects
+    int pyramidBases[6][4];
+    for (int i = 0; i < 6; ++i) {
+        for (int n = 0; n < 4; ++n) {
+            pyramidBases[i][n] = faceConnectStorage[i][3 - n];
+        }
+    }
+
+    for (std::size_t k = 0; k < nElements; ++k) {
+        const std::array<double, 3> *elementCoords = vertexCoords + 8 * k;
+
+        // The centroid is the apex of all the pyramids
+        double R[3] = {0., 0., 0.};
+        for (int i = 0; i < 8; ++i) {
+            R[0] += elementCoords[i][0];
+            R[1] += elementCoords[i][1];
+            R[2] += elementCoords[i][2];
+        }
+        R[0] /= 8.;
+        R[1] /= 8.;
+        R[2] /= 8.;
+
+        // Sum the volume of the pyramids having a face as the base and the
+        // centroid as the apex.
+        double volume = 0.;
+        for (int i = 0; i < 6; ++i) {
+            const std::array<double, 3> &P_0 = elementCoords[pyramidBases[i][0]];
+            const std::array<double, 3> &P_1 = elementCoords[pyramidBases[i][1]];
+            const std::array<double, 3> &P_2 = elementCoords[pyramidBases[i][2]];
+            const std::array<double, 3> &P_3 = elementCoords[pyramidBases[i][3]];
+
+            double RA[3] = {P_0[0] - R[0], P_0[1] - R[1], P_0[2] - R[2]};
+            double DB[3] = {P_3[0] - P_1[0], P_3[1] - P_1[1], P_3[2] - P_1[2]};
+            double AC[3] = {P_2[0] - P_0[0], P_2[1] - P_0[1], P_2[2] - P_0[2]};
+            double AD[3] = {P_1[0] - P_0[0], P_1[1] - P_0[1], P_1[2] - P_0[2]};
+            double AB[3] = {P_3[0] - P_0[0], P_3[1] - P_0[1], P_3[2] - P_0[2]};
+
+            double apexTerm = RA[0] * (DB[1] * AC[2] - DB[2] * AC[1])
+                            + RA[1] * (DB[2] * AC[0] - DB[0] * AC[2])
+                            + RA[2] * (DB[0] * AC[1] - DB[1] * AC[0]);
+
+            double baseTerm = AC[0] * (AD[1] * AB[2] - AD[2] * AB[1])
+                            + AC[1] * (AD[2] * AB[0] - AD[0] * AB[2])
+                            + AC[2] * (AD[0] * AB[1] - AD[1] * AB[0]);
+
+            volume += apexTerm / 6. + baseTerm / 12.;
+        }
+
+        volumes[k] = volume;
+    }
+}
+
 /*!
     Evaluates the characteristics size of an element with the specified vertex
     coordinates.
@@ -1279,6 +1378,69 @@ std::array<double, 3> ReferenceTriangleInfo::evalNormal(const std::array<double,
     return normal;
 }
 
+/*!
+    Evaluates the areas of a set of elements with the specified vertex
+    coordinates.
+
+    Coordinates are stored element after element, each element contributes
+    with the coordinates of its three vertices.
+
+    \param nElements is the number of elements
+    \param vertexCoords are the coordinate of the vertices of the elements
+    \param[out] areas on output will contain the areas of the elements
+*/
+void ReferenceTriangleInfo::evalAreas(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *areas) const
+{
+    for (std::size_t k = 0; k < nElements; ++k) {
+        const std::array<double, 3> *elementCoords = vertexCoords + 3 * k;
+        const std::array<double, 3> &V_A = elementCoords[0];
+        const std::array<double, 3> &V_B = elementCoords[1];
+        const std::array<double, 3> &V_C = elementCoords[2];
+
+        double u0 = V_B[0] - V_A[0], u1 = V_B[1] - V_A[1], u2 = V_B[2] - V_A[2];
+        double v0 = V_C[0] - V_A[0], v1 = V_C[1] - V_A[1], v2 = V_C[2] - V_A[2];
+
+        double n0 = u1 * v2 - u2 * v1;
+        double n1 = u2 * v0 - u0 * v2;
+        double n2 = u0 * v1 - u1 * v0;
+
+        areas[k] = 0.5 * std::sqrt(n0 * n0 + n1 * n1 + n2 * n2);
+    }
+}
+
+/*!
+    Evaluates the normals of a set of elements with the specified vertex
+    coordinates.
+
+    Coordinates are stored element after element, each element contributes
+    with the coordinates of its three vertices.
+
+    \param nElements is the number of elements
+    \param vertexCoords are the coordinate of the vertices of the elements
+    \param[out] normals on output will contain the normals of the elements
+*/
+void ReferenceTriangleInfo::evalNormals(std::size_t nElements, const std::array<double, 3> *vertexCoords, std::array<double, 3> *normals) const
+{
+    for (std::size_t k = 0; k < nElements; ++k) {
+        const std::array<double, 3> *elementCoords = vertexCoords + 3 * k;
+        const std::array<double, 3> &V_A = elementCoords[0];
+        const std::array<double, 3> &V_B = elementCoords[1];
+        const std::array<double, 3> &V_C = elementCoords[2];
+
+        double u0 = V_B[0] - V_A[0], u1 = V_B[1] - V_A[1], u2 = V_B[2] - V_A[2];
+        double v0 = V_C[0] - V_A[0], v1 = V_C[1] - V_A[1], v2 = V_C[2] - V_A[2];
+
+        double n0 = u1 * v2 - u2 * v1;
+        double n1 = u2 * v0 - u0 * v2;
+        double n2 = u0 * v1 - u1 * v0;
+        double normalNorm = std::sqrt(n0 * n0 + n1 * n1 + n2 * n2);
+
+        normals[k][0] = n0 / normalNorm;
+        normals[k][1] = n1 / normalNorm;
+        normals[k][2] = n2 / normalNorm;
+    }
+}
+
 /*!
     Evaluates the projection of the point on the element.
 
@@ -1568,6 +1730,77 @@ std::array<double, 3> ReferenceQuadInfo::evalNormal(const std::array<double, 3>
     return normal;
 }
 
+/*!
+    Evaluates the areas of a set of elements with the specified vertex
+    coordinates.
+
+    Coordinates are stored element after element, each element contributes
+    with the coordinates of its four vertices. As for evalArea(), the
+    quadrilaterals are assumed to be planar.
+
+    \param nElements is the number of elements
+    \param vertexCoords are the coordinate of the vertices of the elements
+    \param[out] areas on output will contain the areas of the elements
+*/
+void ReferenceQuadInfo::evalAreas(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *areas) const
+{
+    for (std::size_t k = 0; k < nElements; ++k) {
+        const std::array<double, 3> *elementCoords = vertexCoords + 4 * k;
+        const std::array<double, 3> &V_A = elementCoords[0];
+        const std::array<double, 3> &V_B = elementCoords[1];
+        const std::array<double, 3> &V_C = elementCoords[2];
+        const std::array<double, 3> &V_D = elementCoords[3];
+
+        double AB[3] = {V_B[0] - V_A[0], V_B[1] - V_A[1], V_B[2] - V_A[2]};
+        double AD[3] = {V_D[0] - V_A[0], V_D[1] - V_A[1], V_D[2] - V_A[2]};
+        double DC[3] = {V_C[0] - V_D[0], V_C[1] - V_D[1], V_C[2] - V_D[2]};
+        double BC[3] = {V_C[0] - V_B[0], V_C[1] - V_B[1], V_C[2] - V_B[2]};
+
+        double m0 = (AB[1] * AD[2] - AB[2] * AD[1]) + 0.5 * (AB[1] * DC[2] - AB[2] * DC[1]) + 0.5 * (BC[1] * AD[2] - BC[2] * AD[1]);
+        double m1 = (AB[2] * AD[0] - AB[0] * AD[2]) + 0.5 * (AB[2] * DC[0] - AB[0] * DC[2]) + 0.5 * (BC[2] * AD[0] - BC[0] * AD[2]);
+        double m2 = (AB[0] * AD[1] - AB[1] * AD[0]) + 0.5 * (AB[0] * DC[1] - AB[1] * DC[0]) + 0.5 * (BC[0] * AD[1] - BC[1] * AD[0]);
+
+        areas[k] = std::sqrt(m0 * m0 + m1 * m1 + m2 * m2);
+    }
+}
+
+/*!
+    Evaluates the normals of a set of elements with the specified vertex
+    coordinates.
+
+    Coordinates are stored element after element, each element contributes
+    with the coordinates of its four vertices. Normals are evaluated at the
+    center of the elements, using the same formula of evalNormal().
+
+    \param nElements is the number of elements
+    \param vertexCoords are the coordinate of the vertices of the elements
+    \param[out] normals on output will contain the normals of the elements
+*/
+void ReferenceQuadInfo::evalNormals(std::size_t nElements, const std::array<double, 3> *vertexCoords, std::array<double, 3> *normals) const
+{
+    for (std::size_t k = 0; k < nElements; ++k) {
+        const std::array<double, 3> *elementCoords = vertexCoords + 4 * k;
+        const std::array<double, 3> &V_0 = elementCoords[0];
+        const std::array<double, 3> &V_1 = elementCoords[1];
+        const std::array<double, 3> &V_2 = elementCoords[2];
+        const std::array<double, 3> &V_3 = elementCoords[3];
+
+        double AB[3] = {V_3[0] - V_0[0], V_3[1] - V_0[1], V_3[2] - V_0[2]};
+        double AD[3] = {V_1[0] - V_0[0], V_1[1] - V_0[1], V_1[2] - V_0[2]};
+        double BC[3] = {V_2[0] - V_3[0], V_2[1] - V_3[1], V_2[2] - V_3[2]};
+        double DC[3] = {V_2[0] - V_1[0], V_2[1] - V_1[1], V_2[2] - V_1[2]};
+
+        double n0 = (AB[1] * AD[2] - AB[2] * AD[1]) + 0.5 * (AB[1] * DC[2] - AB[2] * DC[1]) + 0.5 * (BC[1] * AD[2] - BC[2] * AD[1]);
+        double n1 = (AB[2] * AD[0] - AB[0] * AD[2]) + 0.5 * (AB[2] * DC[0] - AB[0] * DC[2]) + 0.5 * (BC[2] * AD[0] - BC[0] * AD[2]);
+        double n2 = (AB[0] * AD[1] - AB[1] * AD[0]) + 0.5 * (AB[0] * DC[1] - AB[1] * DC[0]) + 0.5 * (BC[0] * AD[1] - BC[1] * AD[0]);
+        double normalNorm = - std::sqrt(n0 * n0 + n1 * n1 + n2 * n2);
+
+        normals[k][0] = n0 / normalNorm;
+        normals[k][1] = n1 / normalNorm;
+        normals[k][2] = n2 / normalNorm;
+    }
+}
+
 /*!
     \class Reference1DElementInfo
     \ingroup patchelements
@@ -1659,6 +1892,32 @@ double ReferenceLineInfo::evalLength(const std::array<double, 3> *vertexCoords)
     return length;
 }
 
+/*!
+    Evaluates the lengths of a set of elements with the specified vertex
+    coordinates.
+
+    Coordinates are stored element after element, each element contributes
+    with the coordinates of its two vertices.
+
+    \param nElements is the number of elements
+    \param vertexCoords are the coordinate of the vertices of the elements
+    \param[out] lengths on output will contain the lengths of the elements
+*/
+void ReferenceLineInfo::evalLengths(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *lengths) const
+{
+    for (std::size_t k = 0; k < nElements; ++k) {
+        const std::array<double, 3> *elementCoords = vertexCoords + 2 * k;
+        const std::array<double, 3> &V_A = elementCoords[0];
+        const std::array<double, 3> &V_B = elementCoords[1];
+
+        double t0 = V_B[0] - V_A[0];
+        double t1 = V_B[1] - V_A[1];
+        double t2 = V_B[2] - V_A[2];
+
+        lengths[k] = std::sqrt(t0 * t0 + t1 * t1 + t2 * t2);
+    }
+}
+
 /*!
     Evaluates the normal of an element with the specified vertex coordinates.
 
@@ -98,6 +98,7 @@ public:
     double evalSize(const std::array<double, 3> *vertexCoords) const override;
 
     double evalVolume(const std::array<double, 3> *vertexCoords) const override;
+    void evalVolumes(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *volumes) const;
 
     const static ReferenceTetraInfo info;
 
@@ -136,6 +137,7 @@ public:
     double evalSize(const std::array<double, 3> *vertexCoords) const override;
 
     double evalVolume(const std::array<double, 3> *vertexCoords) const override;
+    void evalVolumes(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *volumes) const;
 
     const static ReferenceHexahedronInfo info;
 
@@ -217,6 +219,9 @@ public:
 
     std::array<double, 3> evalNormal(const std::array<double, 3> *vertexCoords, const std::array<double, 3> &point = {{0.5, 0.5, 0.5}}) const override;
 
+    void evalAreas(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *areas) const;
+    void evalNormals(std::size_t nElements, const std::array<double, 3> *vertexCoords, std::array<double, 3> *normals) const;
+
     void evalPointProjection(const std::array<double, 3> &point, const std::array<double, 3> *vertexCoords, std::array<double, 3> *projection, double *distance) const override;
     double evalPointDistance(const std::array<double, 3> &point, const std::array<double, 3> *vertexCoords) const override;
 
@@ -268,6 +273,9 @@ public:
 
     std::array<double, 3> evalNormal(const std::array<double, 3> *vertexCoords, const std::array<double, 3> &point = {{0.5, 0.5, 0.5}}) const override;
 
+    void evalAreas(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *areas) const;
+    void evalNormals(std::size_t nElements, const std::array<double, 3> *vertexCoords, std::array<double, 3> *normals) const;
+
     const static ReferenceQuadInfo info;
 
 protected:
@@ -306,6 +314,7 @@ public:
     double evalSize(const std::array<double, 3> *vertexCoords) const override;
 
     double evalLength(const std::array<double, 3> *vertexCoords) const override;
+    void evalLengths(std::size_t nElements, const std::array<double, 3> *vertexCoords, double *lengths) const;
 
     std::array<double, 3> evalNormal(const std::array<double, 3> *vertexCoords, const std::array<double, 3> &orientation = {{0., 0., 1.}}, const std::array<double, 3> &point = {{0.5, 0.5, 0.5}}) const override;
 
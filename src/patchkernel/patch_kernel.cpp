@@ -23,6 +23,7 @@
 \*---------------------------------------------------------------------------*/
 
 #include <sstream>
+#include <tuple>
 #include <typeinfo>
 #include <unordered_map>
 #include <unordered_set>
@@ -35,6 +36,7 @@
 #include "patch_info.hpp"
 #include "patch_kernel.hpp"
 #include "patch_manager.hpp"
+#include "patch_skd_tree.hpp"
 
 namespace bitpit {
 
@@ -230,6 +232,7 @@ PatchKernel::PatchKernel(const PatchKernel &other)
       m_dimension(other.m_dimension),
       m_toleranceCustom(other.m_toleranceCustom),
       m_tolerance(other.m_tolerance),
+      m_cellGeometryCacheDirty(true),
       m_rank(other.m_rank),
       m_nProcessors(other.m_nProcessors)
 #if BITPIT_ENABLE_MPI==1
@@ -248,7 +251,10 @@ PatchKernel::PatchKernel(const PatchKernel &other)
       m_ghostVertexExchangeSources(other.m_ghostVertexExchangeSources),
       m_ghostCellOwners(other.m_ghostCellOwners),
       m_ghostCellExchangeTargets(other.m_ghostCellExchangeTargets),
-      m_ghostCellExchangeSources(other.m_ghostCellExchangeSources)
+      m_ghostCellExchangeSources(other.m_ghostCellExchangeSources),
+      m_ghostCellExchangeRawInfoDirty(true),
+      m_partitioningBoxesDirty(true),
+      m_ghostUpdateTag(-1)
 #endif
 {
 	// Create index generators
@@ -320,6 +326,7 @@ PatchKernel::PatchKernel(PatchKernel &&other)
       m_dimension(std::move(other.m_dimension)),
       m_toleranceCustom(std::move(other.m_toleranceCustom)),
       m_tolerance(std::move(other.m_tolerance)),
+      m_cellGeometryCacheDirty(true),
       m_rank(std::move(other.m_rank)),
       m_nProcessors(std::move(other.m_nProcessors))
 #if BITPIT_ENABLE_MPI==1
@@ -338,7 +345,10 @@ PatchKernel::PatchKernel(PatchKernel &&other)
       m_ghostVertexExchangeSources(std::move(other.m_ghostVertexExchangeSources)),
       m_ghostCellOwners(std::move(other.m_ghostCellOwners)),
       m_ghostCellExchangeTargets(std::move(other.m_ghostCellExchangeTargets)),
-      m_ghostCellExchangeSources(std::move(other.m_ghostCellExchangeSources))
+      m_ghostCellExchangeSources(std::move(other.m_ghostCellExchangeSources)),
+      m_ghostCellExchangeRawInfoDirty(true),
+      m_partitioningBoxesDirty(true),
+      m_ghostUpdateTag(-1)
 #endif
 {
 	// Handle patch regstration
@@ -356,6 +366,7 @@ PatchKernel::PatchKernel(PatchKernel &&other)
 #if BITPIT_ENABLE_MPI==1
 	// Handle the communication
 	std::swap(m_communicator, other.m_communicator);
+	std::swap(m_ghostUpdateTag, other.m_ghostUpdateTag);
 #endif
 }
 
@@ -409,6 +420,10 @@ PatchKernel & PatchKernel::operator=(PatchKernel &&other)
 	m_dimension = std::move(other.m_dimension);
 	m_toleranceCustom = std::move(other.m_toleranceCustom);
 	m_tolerance = std::move(other.m_tolerance);
+	m_pointLocationTree.reset();
+	other.m_pointLocationTree.reset();
+	m_cellGeometryCacheDirty = true;
+	other.m_cellGeometryCacheDirty = true;
 	m_rank = std::move(other.m_rank);
 	m_nProcessors = std::move(other.m_nProcessors);
 #if BITPIT_ENABLE_MPI==1
@@ -428,6 +443,8 @@ PatchKernel & PatchKernel::operator=(PatchKernel &&other)
 	m_ghostCellOwners = std::move(other.m_ghostCellOwners);
 	m_ghostCellExchangeTargets = std::move(other.m_ghostCellExchangeTargets);
 	m_ghostCellExchangeSources = std::move(other.m_ghostCellExchangeSources);
+	m_ghostCellExchangeRawInfoDirty = true;
+	m_partitioningBoxesDirty = true;
 #endif
 
 	// Handle patch regstration
@@ -446,6 +463,7 @@ PatchKernel & PatchKernel::operator=(PatchKernel &&other)
 #if BITPIT_ENABLE_MPI==1
 	// Handle the communication
 	std::swap(m_communicator, other.m_communicator);
+	std::swap(m_ghostUpdateTag, other.m_ghostUpdateTag);
 #endif
 
 	return *this;
@@ -494,6 +512,9 @@ void PatchKernel::initialize()
 	// Dimension
 	m_dimension = -1;
 
+	// Cell geometry cache
+	m_cellGeometryCacheDirty = true;
+
 	// Index generators
 	setVertexAutoIndexing(true);
 	setInterfaceAutoIndexing(true);
@@ -535,6 +556,13 @@ void PatchKernel::initialize()
 	m_partitioningCellsTag    = -1;
 	m_partitioningVerticesTag = -1;
 
+	// Initialize ghost update information
+	m_ghostUpdateTag = -1;
+	m_ghostCellExchangeRawInfoDirty = true;
+
+	// Initialize the bounding boxes of the partitions
+	m_partitioningBoxesDirty = true;
+
 	// Update partitioning information
 	if (isPartitioned()) {
 		updatePartitioningInfo(true);
@@ -638,6 +666,49 @@ std::vector<adaption::Info> PatchKernel::update(bool trackAdaption, bool squeeze
 	return updateInfo;
 }
 
+/*!
+	Commit all pending changes.
+
+	Changes are tracked using a compressed collection of adaption info, this
+	avoids the allocation of a pair of vectors for each adaption info and
+	should be preferred when large alterations are tracked.
+
+	\param[in,out] adaptionData if a valid pointer is provided, the changes
+	done during the update will be appended to the specified collection,
+	otherwise the changes will not be tracked
+	\param squeezeStorage if set to true patch data structures will be
+	squeezed after the update
+*/
+void PatchKernel::update(adaption::FlatInfoCollection *adaptionData, bool squeezeStorage)
+{
+	// Early return if the patch is not dirty
+	//
+	// If we need to squeeze the storage we need to perform the update also
+	// if the patch is not dirty.
+	if (!squeezeStorage && !isDirty(true)) {
+		return;
+	}
+
+	// Finalize alterations
+	finalizeAlterations(squeezeStorage);
+
+	// Spawn
+	bool spawnNeeed = (getSpawnStatus() == SPAWN_NEEDED);
+	if (spawnNeeed) {
+		bool trackSpawn = (adaptionData != nullptr);
+		std::vector<adaption::Info> spawnData = spawn(trackSpawn);
+		if (trackSpawn) {
+			adaptionData->append(std::move(spawnData));
+		}
+	}
+
+	// Adaption
+	bool adaptionDirty = (getAdaptionStatus(true) == ADAPTION_DIRTY);
+	if (adaptionDirty) {
+		adaption(adaptionData, squeezeStorage);
+	}
+}
+
 /*!
 	Simulate the adaption of the specified cell.
 
@@ -727,6 +798,34 @@ std::vector<adaption::Info> PatchKernel::adaption(bool trackAdaption, bool squee
 	return adaptionInfo;
 }
 
+/*!
+	Execute patch adaption.
+
+	Changes are tracked using a compressed collection of adaption info.
+
+	\param[in,out] adaptionData if a valid pointer is provided, the changes
+	done during the adaption will be appended to the specified collection,
+	otherwise the changes will not be tracked
+	\param squeezeStorage if set to true patch data structures will be
+	squeezed after the update
+*/
+void PatchKernel::adaption(adaption::FlatInfoCollection *adaptionData, bool squeezeStorage)
+{
+	// Check adaption status
+	AdaptionStatus adaptionStatus = getAdaptionStatus(true);
+	if (adaptionStatus == ADAPTION_UNSUPPORTED || adaptionStatus == ADAPTION_CLEAN) {
+		return;
+	} else if (adaptionStatus != ADAPTION_DIRTY) {
+		throw std::runtime_error ("An adaption is already in progress.");
+	}
+
+	adaptionPrepare(false);
+
+	adaptionAlter(adaptionData, squeezeStorage);
+
+	adaptionCleanup();
+}
+
 /*!
 	Prepares the patch for performing the adaption.
 
@@ -800,6 +899,41 @@ std::vector<adaption::Info> PatchKernel::adaptionAlter(bool trackAdaption, bool
 	return adaptionInfo;
 }
 
+/*!
+	Alter the patch performing the adaption.
+
+	Changes are tracked using a compressed collection of adaption info.
+
+	\param[in,out] adaptionData if a valid pointer is provided, the changes
+	done during the adaption will be appended to the specified collection,
+	otherwise the changes will not be tracked
+	\param squeezeStorage if set to true patch data structures will be
+	squeezed after the adaption
+*/
+void PatchKernel::adaptionAlter(adaption::FlatInfoCollection *adaptionData, bool squeezeStorage)
+{
+	// Check adaption status
+	AdaptionStatus adaptionStatus = getAdaptionStatus();
+	if (adaptionStatus == ADAPTION_UNSUPPORTED || adaptionStatus == ADAPTION_CLEAN) {
+		return;
+	} else if (adaptionStatus != ADAPTION_PREPARED) {
+		throw std::runtime_error ("The prepare function has not been called.");
+	}
+
+	// Adapt the patch
+	if (adaptionData) {
+		_adaptionAlter(adaptionData);
+	} else {
+		_adaptionAlter(false);
+	}
+
+	// Finalize patch alterations
+	finalizeAlterations(squeezeStorage);
+
+	// Update the status
+	setAdaptionStatus(ADAPTION_ALTERED);
+}
+
 /*!
 	Cleanup patch data structured after the adaption.
 
@@ -978,6 +1112,9 @@ void PatchKernel::reset()
 */
 void PatchKernel::resetVertices()
 {
+	resetPointLocationTree();
+	setCellGeometryCacheDirty(true);
+
 	m_vertices.clear();
 	if (m_vertexIdGenerator) {
 		m_vertexIdGenerator->reset();
@@ -1001,6 +1138,13 @@ void PatchKernel::resetVertices()
 */
 void PatchKernel::resetCells()
 {
+	resetPointLocationTree();
+	setCellGeometryCacheDirty(true);
+
+#if BITPIT_ENABLE_MPI==1
+	m_ghostCellExchangeRawInfoDirty = true;
+#endif
+
 	m_cells.clear();
 	if (m_cellIdGenerator) {
 		m_cellIdGenerator->reset();
@@ -1929,6 +2073,132 @@ PatchKernel::VertexIterator PatchKernel::_addInternalVertex(const std::array<dou
 	return iterator;
 }
 
+/*!
+	Adds a set of new vertices with the specified coordinates.
+
+	This is the bulk version of addVertex: the storage is reserved only once,
+	the vertices are assigned contiguous ids and partitioning information is
+	marked as dirty only once for the whole set.
+
+	All new vertices will be temporarily added as internal vertices, is needed
+	they will be converted to ghost vertices when updating ghost information.
+
+	If valid, the specified id will we assigned to the first vertex and the
+	following vertices will be assigned the subsequent ids, otherwise new
+	contiguous unique ids will be generated. However, it is not possible to
+	create vertices with ids already assigned to existing vertices of the
+	patch. If this happens, an exception is thrown and no vertices are added.
+	Ids are considered valid if they are greater or equal than zero.
+
+	\param nVertices is the number of vertices that will be added
+	\param coords are the coordinates of the vertices
+	\param firstId is the id that will be assigned to the first vertex.
+	If a negative id value is specified, new unique ids will be generated
+	for the vertices
+	\return The id of the first added vertex, the other vertices have
+	contiguous ids. If no vertices have been added, a null id is returned.
+*/
+long PatchKernel::addVertices(std::size_t nVertices, const std::array<double, 3> *coords, long firstId)
+{
+	if (!isExpert()) {
+		return Vertex::NULL_ID;
+	}
+
+	if (nVertices == 0) {
+		return Vertex::NULL_ID;
+	}
+
+	// Add the vertices
+	firstId = _addInternalVertices(nVertices, coords, firstId);
+
+	return firstId;
+}
+
+/*!
+	Internal function to add a set of internal vertices.
+
+	It is not possible to create vertices with ids already assigned to
+	existing vertices of the patch or with invalid ids. If this happens,
+	an exception is thrown. Ids are considered valid if they are greater
+	or equal than zero.
+
+	\param nVertices is the number of vertices that will be added
+	\param coords are the coordinates of the vertices
+	\param firstId is the id that will be assigned to the first vertex.
+	If a negative id value is specified, new unique ids will be generated
+	for the vertices
+	\return The id of the first added vertex.
+*/
+long PatchKernel::_addInternalVertices(std::size_t nVertices, const std::array<double, 3> *coords, long firstId)
+{
+	// Get the ids
+	if (m_vertexIdGenerator) {
+		if (firstId < 0) {
+			firstId = m_vertexIdGenerator->generate(nVertices);
+		} else {
+			// Check the whole range before assigning any id, this way
+			// the generator is left untouched if the range is not valid.
+			for (std::size_t n = 0; n < nVertices; ++n) {
+				if (m_vertexIdGenerator->isAssigned(firstId + static_cast<long>(n))) {
+					throw std::runtime_error("Requested id has already been assigned.");
+				}
+			}
+
+			for (std::size_t n = 0; n < nVertices; ++n) {
+				m_vertexIdGenerator->setAssigned(firstId + static_cast<long>(n));
+			}
+		}
+	} else if (firstId < 0) {
+		throw std::runtime_error("No valid id has been provided for the vertices.");
+	}
+
+	// Get the id of the vertex before which the new vertices should be inserted
+#if BITPIT_ENABLE_MPI==1
+	//
+	// If there are ghosts vertices, the internal vertices should be inserted
+	// before the first ghost vertex.
+#endif
+	long referenceId;
+#if BITPIT_ENABLE_MPI==1
+	referenceId = m_firstGhostVertexId;
+#else
+	referenceId = Vertex::NULL_ID;
+#endif
+
+	// Reserve the storage
+	m_vertices.reserve(m_vertices.size() + nVertices);
+
+	// Create the vertices
+	for (std::size_t n = 0; n < nVertices; ++n) {
+		long id = firstId + static_cast<long>(n);
+
+		VertexIterator iterator;
+		if (referenceId == Vertex::NULL_ID) {
+			iterator = m_vertices.emreclaim(id, id, coords[n], true);
+		} else {
+			iterator = m_vertices.emreclaimBefore(referenceId, id, id, coords[n], true);
+		}
+
+		// Update the id of the last internal vertex
+		if (m_lastInternalVertexId < 0) {
+			m_lastInternalVertexId = id;
+		} else if (m_vertices.rawIndex(m_lastInternalVertexId) < iterator.getRawIndex()) {
+			m_lastInternalVertexId = id;
+		}
+
+		// Update the bounding box
+		addPointToBoundingBox(coords[n]);
+	}
+	m_nInternalVertices += static_cast<long>(nVertices);
+
+#if BITPIT_ENABLE_MPI==1
+	// Set partitioning information as dirty
+	setPartitioningInfoDirty(true);
+#endif
+
+	return firstId;
+}
+
 #if BITPIT_ENABLE_MPI==0
 /*!
 	Restore the vertex with the specified id.
@@ -1975,6 +2245,9 @@ void PatchKernel::_restoreInternalVertex(const VertexIterator &iterator, const s
 
 	// Update the bounding box
 	addPointToBoundingBox(vertex.getCoords());
+
+	// The cell geometry cache is no longer valid
+	setCellGeometryCacheDirty(true);
 }
 
 /*!
@@ -2871,6 +3144,14 @@ PatchKernel::CellIterator PatchKernel::addCell(ElementType type, std::unique_ptr
 PatchKernel::CellIterator PatchKernel::_addInternalCell(ElementType type, std::unique_ptr<long[]> &&connectStorage,
 													long id)
 {
+	// The point location tree is no longer valid
+	resetPointLocationTree();
+
+#if BITPIT_ENABLE_MPI==1
+	// Raw indexes of the cells are no longer valid
+	m_ghostCellExchangeRawInfoDirty = true;
+#endif
+
 	// Get the id of the cell
 	if (m_cellIdGenerator) {
 		if (id < 0) {
@@ -2925,6 +3206,172 @@ PatchKernel::CellIterator PatchKernel::_addInternalCell(ElementType type, std::u
 	return iterator;
 }
 
+/*!
+	Adds a set of new cells with the specified types and connectivities.
+
+	This is the bulk version of addCell: the storage is reserved only once,
+	the cells are assigned contiguous ids, the point location tree is reset
+	and partitioning information is marked as dirty only once for the whole
+	set. Alteration flags are still set for each added cell, however the
+	storage of the flags is reserved only once.
+
+	The connectivities of the cells are stored contiguously: the connectivity
+	of the i-th cell is stored in the range [connectOffsets[i],
+	connectOffsets[i + 1]) of the connectivity array and follows the same
+	layout expected by addCell (i.e., for polygons and polyhedra the number
+	of vertices/faces is stored within the connectivity). The offsets array
+	should therefore contain nCells + 1 entries.
+
+	If valid, the specified id will we assigned to the first cell and the
+	following cells will be assigned the subsequent ids, otherwise new
+	contiguous unique ids will be generated. However, it is not possible to
+	create cells with ids already assigned to existing cells of the patch.
+	If this happens, an exception is thrown and no cells are added. Ids are
+	considered valid if they are greater or equal than zero.
+
+	If the dimension of any of the specified types is greater than the
+	dimension of the patch, no cells will be added.
+
+	\param nCells is the number of cells that will be added
+	\param types are the types of the cells
+	\param connectOffsets are the offsets of the cell connectivities
+	\param connectivity is the connectivity of the cells
+	\param firstId is the id that will be assigned to the first cell.
+	If a negative id value is specified, new unique ids will be generated
+	for the cells
+	\return The id of the first added cell, the other cells have contiguous
+	ids. If no cells have been added, a null id is returned.
+*/
+long PatchKernel::addCells(std::size_t nCells, const ElementType *types, const long *connectOffsets,
+						   const long *connectivity, long firstId)
+{
+	if (!isExpert()) {
+		return Cell::NULL_ID;
+	}
+
+	if (nCells == 0) {
+		return Cell::NULL_ID;
+	}
+
+	int patchDimension = getDimension();
+	for (std::size_t n = 0; n < nCells; ++n) {
+		if (Cell::getDimension(types[n]) > patchDimension) {
+			return Cell::NULL_ID;
+		}
+	}
+
+	firstId = _addInternalCells(nCells, types, connectOffsets, connectivity, firstId);
+
+	return firstId;
+}
+
+/*!
+	Internal function to add a set of internal cells.
+
+	It is not possible to create cells with ids already assigned to existing
+	cells of the patch or with invalid ids. If this happens, an exception is
+	thrown. Ids are considered valid if they are greater or equal than zero.
+
+	\param nCells is the number of cells that will be added
+	\param types are the types of the cells
+	\param connectOffsets are the offsets of the cell connectivities
+	\param connectivity is the connectivity of the cells
+	\param firstId is the id that will be assigned to the first cell.
+	If a negative id value is specified, new unique ids will be generated
+	for the cells
+	\return The id of the first added cell.
+*/
+long PatchKernel::_addInternalCells(std::size_t nCells, const ElementType *types, const long *connectOffsets,
+									const long *connectivity, long firstId)
+{
+	// The point location tree is no longer valid
+	resetPointLocationTree();
+
+#if BITPIT_ENABLE_MPI==1
+	// Raw indexes of the cells are no longer valid
+	m_ghostCellExchangeRawInfoDirty = true;
+#endif
+
+	// Get the ids of the cells
+	if (m_cellIdGenerator) {
+		if (firstId < 0) {
+			firstId = m_cellIdGenerator->generate(nCells);
+		} else {
+			// Check the whole range before assigning any id, this way
+			// the generator is left untouched if the range is not valid.
+			for (std::size_t n = 0; n < nCells; ++n) {
+				if (m_cellIdGenerator->isAssigned(firstId + static_cast<long>(n))) {
+					throw std::runtime_error("Requested id has already been assigned.");
+				}
+			}
+
+			for (std::size_t n = 0; n < nCells; ++n) {
+				m_cellIdGenerator->setAssigned(firstId + static_cast<long>(n));
+			}
+		}
+	} else if (firstId < 0) {
+		throw std::runtime_error("No valid id has been provided for the cells.");
+	}
+
+	// Get the id of the cell before which the new cells should be inserted
+#if BITPIT_ENABLE_MPI==1
+	//
+	// If there are ghosts cells, the internal cells should be inserted
+	// before the first ghost cell.
+#endif
+	long referenceId;
+#if BITPIT_ENABLE_MPI==1
+	referenceId = m_firstGhostCellId;
+#else
+	referenceId = Cell::NULL_ID;
+#endif
+
+	// Reserve the storage
+	m_cells.reserve(m_cells.size() + nCells);
+	m_alteredCells.reserve(m_alteredCells.size() + nCells);
+
+	// Create the cells
+	//
+	// Cells own their connectivity, hence a connectivity storage is still
+	// allocated for each cell.
+	bool storeInterfaces  = (getInterfacesBuildStrategy() != INTERFACES_NONE);
+	bool storeAdjacencies = storeInterfaces || (getAdjacenciesBuildStrategy() != ADJACENCIES_NONE);
+
+	for (std::size_t n = 0; n < nCells; ++n) {
+		long id = firstId + static_cast<long>(n);
+
+		const long *cellConnect = connectivity + connectOffsets[n];
+		std::size_t cellConnectSize = static_cast<std::size_t>(connectOffsets[n + 1] - connectOffsets[n]);
+		std::unique_ptr<long[]> connectStorage = std::unique_ptr<long[]>(new long[cellConnectSize]);
+		std::copy(cellConnect, cellConnect + cellConnectSize, connectStorage.get());
+
+		CellIterator iterator;
+		if (referenceId == Cell::NULL_ID) {
+			iterator = m_cells.emreclaim(id, id, types[n], std::move(connectStorage), true, storeInterfaces, storeAdjacencies);
+		} else {
+			iterator = m_cells.emreclaimBefore(referenceId, id, id, types[n], std::move(connectStorage), true, storeInterfaces, storeAdjacencies);
+		}
+
+		// Update the id of the last internal cell
+		if (m_lastInternalCellId < 0) {
+			m_lastInternalCellId = id;
+		} else if (m_cells.rawIndex(m_lastInternalCellId) < iterator.getRawIndex()) {
+			m_lastInternalCellId = id;
+		}
+
+		// Set the alteration flags of the cell
+		setAddedCellAlterationFlags(id);
+	}
+	m_nInternalCells += static_cast<long>(nCells);
+
+#if BITPIT_ENABLE_MPI==1
+	// Set partitioning information as dirty
+	setPartitioningInfoDirty(true);
+#endif
+
+	return firstId;
+}
+
 /*!
 	Set the alteration flags for an added cell.
 
@@ -3096,6 +3543,14 @@ bool PatchKernel::deleteCells(const std::vector<long> &ids)
 */
 void PatchKernel::_deleteInternalCell(long id)
 {
+	// The point location tree is no longer valid
+	resetPointLocationTree();
+
+#if BITPIT_ENABLE_MPI==1
+	// Raw indexes of the cells are no longer valid
+	m_ghostCellExchangeRawInfoDirty = true;
+#endif
+
 	// Set the alteration flags of the cell
 	setDeletedCellAlterationFlags(id);
 
@@ -5100,6 +5555,23 @@ std::vector<adaption::Info> PatchKernel::_adaptionAlter(bool trackAdaption)
 	return std::vector<adaption::Info>();
 }
 
+/*!
+	Alter the patch performing the adaption, tracking the changes using a
+	compressed collection of adaption info.
+
+	Default implementation tracks the changes using the function that
+	returns a vector of adaption::Info and then imports the vector into
+	the collection. Patches that perform large alterations should fill the
+	collection directly.
+
+	\param[in,out] adaptionData is the collection the changes done to the
+	patch during the adaption will be appended to
+*/
+void PatchKernel::_adaptionAlter(adaption::FlatInfoCollection *adaptionData)
+{
+	adaptionData->append(_adaptionAlter(true));
+}
+
 /*!
 	Cleanup patch data structured after the adaption.
 
@@ -5243,6 +5715,15 @@ bool PatchKernel::sortCells()
 	// Synchronize storage
 	m_cells.sync();
 
+	// Raw indexes of the cells may have changed
+	resetPointLocationTree();
+	setCellGeometryCacheDirty(true);
+
+#if BITPIT_ENABLE_MPI==1
+	// Raw indexes of the cells may have changed
+	m_ghostCellExchangeRawInfoDirty = true;
+#endif
+
 	return true;
 }
 
@@ -5276,13 +5757,530 @@ bool PatchKernel::sort()
 }
 
 /*!
-	Requests the patch to compact the vertex data structure and reduce
-	its capacity to fit its size.
+	Reorders the storage of cells and vertices to improve memory locality.
 
-	The request is non-binding, and after the function call the vertex
-	data structure can still occupy more memory than it actually needs.
+	Cells are reordered using the specified strategy, then vertices are
+	reordered following the updated order of the cells (see reorderVertices).
+
+	Only the storage is reordered, the ids of the cells and of the vertices
+	are not modified. To obtain ids that follow the updated storage order,
+	consecutiveRenumber can be called after the reordering.
+
+	\param strategy is the strategy that will be used to reorder the cells
+	\result Returns true if the storage has been reordered, false otherwise.
 */
-bool PatchKernel::squeezeVertices()
+bool PatchKernel::reorder(ReorderingStrategy strategy)
+{
+	bool status = reorderCells(strategy);
+	status |= reorderVertices();
+
+	return status;
+}
+
+/*!
+	Reorders vertex storage following the order of the cells.
+
+	Vertices are sorted according to the first cell, in storage order, that
+	uses them. This way, vertices of cells that are close in the storage will
+	also be close in the storage. Vertices not used by any cell are placed
+	after the other vertices, keeping their relative order.
+
+	Internal vertices and ghost vertices are reordered separately. Only the
+	storage is reordered, the ids of the vertices are not modified.
+
+	\result Returns true if the storage has been reordered, false otherwise.
+*/
+bool PatchKernel::reorderVertices()
+{
+	if (!isExpert()) {
+		return false;
+	}
+
+	// Squeeze the vertices
+	//
+	// Ranks are indexed by raw index, raw indexes should not change while
+	// the vertices are sorted. After the squeeze there are no holes, hence
+	// raw indexes go from zero to the number of vertices.
+	m_vertices.squeeze();
+
+	// Evaluate the ranks of the vertices
+	const std::size_t UNRANKED = std::numeric_limits<std::size_t>::max();
+
+	std::vector<std::size_t> ranks(m_vertices.size(), UNRANKED);
+	std::size_t nRankedVertices = 0;
+	for (const Cell &cell : m_cells) {
+		for (long vertexId : cell.getVertexIds()) {
+			std::size_t &rank = ranks[m_vertices.rawIndex(vertexId)];
+			if (rank == UNRANKED) {
+				rank = nRankedVertices++;
+			}
+		}
+	}
+
+	VertexConstIterator endItr = m_vertices.cend();
+	for (VertexConstIterator itr = m_vertices.cbegin(); itr != endItr; ++itr) {
+		std::size_t &rank = ranks[itr.getRawIndex()];
+		if (rank == UNRANKED) {
+			rank = nRankedVertices++;
+		}
+	}
+
+	auto rankLess = [&ranks](std::size_t rawIndex_1, std::size_t rawIndex_2) {
+		return (ranks[rawIndex_1] < ranks[rawIndex_2]);
+	};
+
+	// Reorder internal vertices
+	if (m_nInternalVertices > 0) {
+		m_vertices.rawSortBefore(m_lastInternalVertexId, true, rankLess);
+		updateLastInternalVertexId();
+	}
+
+#if BITPIT_ENABLE_MPI==1
+	// Reorder ghost vertices
+	if (m_nGhostVertices > 0) {
+		m_vertices.rawSortAfter(m_firstGhostVertexId, true, rankLess);
+		updateFirstGhostVertexId();
+	}
+#endif
+
+	// Synchronize storage
+	m_vertices.sync();
+
+	return true;
+}
+
+/*!
+	Reorders cell storage to improve memory locality.
+
+	The following strategies are available:
+	  - REORDERING_MORTON, cells are sorted along a Morton (Z-order) curve
+	    evaluated on their centroids;
+	  - REORDERING_HILBERT, cells are sorted along a Hilbert curve evaluated
+	    on their centroids;
+	  - REORDERING_RCM, cells are sorted using the reverse Cuthill-McKee
+	    algorithm on the graph defined by the cell adjacencies, this
+	    reduces the bandwidth of matrices built on the adjacencies. This
+	    strategy requires the adjacencies of the patch.
+
+	Space-filling curves keep close in the storage the cells that are close
+	in space, the reverse Cuthill-McKee ordering keeps close in the storage
+	the cells that are close in the adjacency graph.
+
+	Internal cells and ghost cells are reordered separately. Only the storage
+	is reordered, the ids of the cells are not modified. Data stored in the
+	PiercedStorage objects synchronized with the cells will be reordered
+	accordingly.
+
+	\param strategy is the strategy that will be used to reorder the cells
+	\result Returns true if the storage has been reordered, false otherwise.
+*/
+bool PatchKernel::reorderCells(ReorderingStrategy strategy)
+{
+	if (!isExpert()) {
+		return false;
+	}
+
+	if (strategy == REORDERING_RCM) {
+		if (getAdjacenciesBuildStrategy() == ADJACENCIES_NONE || areAdjacenciesDirty()) {
+			throw std::runtime_error("Reverse Cuthill-McKee reordering requires up-to-date cell adjacencies.");
+		}
+	}
+
+	// Squeeze the cells
+	//
+	// Ranks are indexed by raw index, raw indexes should not change while
+	// the cells are sorted.
+	m_cells.squeeze();
+
+	// Reorder internal cells
+	if (m_nInternalCells > 0) {
+		std::vector<std::size_t> ranks = evalCellReorderingRanks(strategy, CellConstRange(internalCellConstBegin(), internalCellConstEnd()));
+		auto rankLess = [&ranks](std::size_t rawIndex_1, std::size_t rawIndex_2) {
+			return (ranks[rawIndex_1] < ranks[rawIndex_2]);
+		};
+
+		m_cells.rawSortBefore(m_lastInternalCellId, true, rankLess);
+		updateLastInternalCellId();
+	}
+
+#if BITPIT_ENABLE_MPI==1
+	// Reorder ghost cells
+	if (m_nGhostCells > 0) {
+		std::vector<std::size_t> ranks = evalCellReorderingRanks(strategy, CellConstRange(ghostCellConstBegin(), ghostCellConstEnd()));
+		auto rankLess = [&ranks](std::size_t rawIndex_1, std::size_t rawIndex_2) {
+			return (ranks[rawIndex_1] < ranks[rawIndex_2]);
+		};
+
+		m_cells.rawSortAfter(m_firstGhostCellId, true, rankLess);
+		updateFirstGhostCellId();
+	}
+#endif
+
+	// Synchronize storage
+	m_cells.sync();
+
+	// Raw indexes of the cells may have changed
+	resetPointLocationTree();
+	setCellGeometryCacheDirty(true);
+
+#if BITPIT_ENABLE_MPI==1
+	// Raw indexes of the cells may have changed
+	m_ghostCellExchangeRawInfoDirty = true;
+#endif
+
+	return true;
+}
+
+/*!
+	Evaluates the position that the specified cells will have after being
+	reordered using the specified strategy.
+
+	\param strategy is the reordering strategy
+	\param cellRange is the range of cells that will be reordered
+	\result The ranks of the cells, i.e., the position each cell will have
+	after the reordering. Ranks are indexed by the raw index of the cells,
+	the ranks of the cells outside the specified range are undefined.
+*/
+std::vector<std::size_t> PatchKernel::evalCellReorderingRanks(ReorderingStrategy strategy, const CellConstRange &cellRange) const
+{
+	switch (strategy) {
+
+	case REORDERING_MORTON:
+	case REORDERING_HILBERT:
+		return evalCellSpaceFillingCurveRanks(strategy, cellRange);
+
+	case REORDERING_RCM:
+		return evalCellRCMRanks(cellRange);
+
+	default:
+		throw std::runtime_error("Unsupported reordering strategy.");
+
+	}
+}
+
+/*!
+	Evaluates the position the specified cells will have after being sorted
+	along a space-filling curve.
+
+	The centroids of the cells are mapped on an integer grid that covers the
+	bounding box of the centroids, the key of each cell is then evaluated
+	from the integer coordinates of its centroid. Cells with the same key
+	are sorted by id.
+
+	\param strategy is the reordering strategy, only space-filling curve
+	strategies are supported
+	\param cellRange is the range of cells that will be reordered
+	\result The ranks of the cells, indexed by raw index (see
+	evalCellReorderingRanks).
+*/
+std::vector<std::size_t> PatchKernel::evalCellSpaceFillingCurveRanks(ReorderingStrategy strategy, const CellConstRange &cellRange) const
+{
+	const int N_KEY_BITS = 21;
+
+	// Evaluate cell centroids
+	std::vector<long> cellIds;
+	std::vector<std::size_t> cellRawIndexes;
+	std::vector<std::array<double, 3>> cellCentroids;
+	for (auto itr = cellRange.cbegin(); itr != cellRange.cend(); ++itr) {
+		long cellId = itr.getId();
+		cellIds.push_back(cellId);
+		cellRawIndexes.push_back(itr.getRawIndex());
+		cellCentroids.push_back(evalCellCentroid(cellId));
+	}
+
+	std::size_t nCells = cellIds.size();
+
+	// Evaluate the bounding box of the centroids
+	std::array<double, 3> boxMin = {{  std::numeric_limits<double>::max(),   std::numeric_limits<double>::max(),   std::numeric_limits<double>::max()}};
+	std::array<double, 3> boxMax = {{- std::numeric_limits<double>::max(), - std::numeric_limits<double>::max(), - std::numeric_limits<double>::max()}};
+	for (const std::array<double, 3> &centroid : cellCentroids) {
+		for (int d = 0; d < 3; ++d) {
+			boxMin[d] = std::min(centroid[d], boxMin[d]);
+			boxMax[d] = std::max(centroid[d], boxMax[d]);
+		}
+	}
+
+	// Evaluate the keys
+	const double maxCoordinate = static_cast<double>((uint32_t(1) << N_KEY_BITS) - 1);
+
+	std::array<double, 3> scale;
+	for (int d = 0; d < 3; ++d) {
+		double length = boxMax[d] - boxMin[d];
+		if (length > 0.) {
+			scale[d] = maxCoordinate / length;
+		} else {
+			scale[d] = 0.;
+		}
+	}
+
+	std::vector<std::tuple<uint64_t, long, std::size_t>> cellKeys(nCells);
+	for (std::size_t n = 0; n < nCells; ++n) {
+		const std::array<double, 3> &centroid = cellCentroids[n];
+
+		std::array<uint32_t, 3> coords;
+		for (int d = 0; d < 3; ++d) {
+			coords[d] = static_cast<uint32_t>(std::min(std::max((centroid[d] - boxMin[d]) * scale[d], 0.), maxCoordinate));
+		}
+
+		uint64_t key;
+		if (strategy == REORDERING_HILBERT) {
+			key = evalHilbertKey(coords, N_KEY_BITS);
+		} else {
+			key = evalMortonKey(coords, N_KEY_BITS);
+		}
+
+		cellKeys[n] = std::make_tuple(key, cellIds[n], cellRawIndexes[n]);
+	}
+
+	// Evaluate the ranks
+	std::sort(cellKeys.begin(), cellKeys.end());
+
+	std::vector<std::size_t> ranks(*std::max_element(cellRawIndexes.begin(), cellRawIndexes.end()) + 1);
+	for (std::size_t n = 0; n < nCells; ++n) {
+		ranks[std::get<2>(cellKeys[n])] = n;
+	}
+
+	return ranks;
+}
+
+/*!
+	Evaluates the position the specified cells will have after being sorted
+	using the reverse Cuthill-McKee algorithm.
+
+	The graph is defined by the adjacencies of the cells, only adjacencies
+	between cells of the specified range are considered. Each connected
+	component of the graph is visited breadth-first starting from a
+	pseudo-peripheral cell, found using the algorithm by George and Liu;
+	the neighbours of each cell are visited in ascending degree order.
+	The final order is obtained reversing the order of the visit.
+
+	\param cellRange is the range of cells that will be reordered
+	\result The ranks of the cells, indexed by raw index (see
+	evalCellReorderingRanks).
+*/
+std::vector<std::size_t> PatchKernel::evalCellRCMRanks(const CellConstRange &cellRange) const
+{
+	// Build the graph
+	//
+	// Cells are identified by their position in the range.
+	std::unordered_map<long, std::size_t> cellIndexes;
+	std::vector<std::size_t> cellRawIndexes;
+	for (auto itr = cellRange.cbegin(); itr != cellRange.cend(); ++itr) {
+		cellIndexes.insert({itr.getId(), cellRawIndexes.size()});
+		cellRawIndexes.push_back(itr.getRawIndex());
+	}
+
+	std::size_t nCells = cellRawIndexes.size();
+
+	std::vector<std::size_t> graphOffsets(nCells + 1, 0);
+	std::vector<std::size_t> graphNeighs;
+	for (std::size_t n = 0; n < nCells; ++n) {
+		const Cell &cell = m_cells.rawAt(cellRawIndexes[n]);
+		const long *adjacencies = cell.getAdjacencies();
+		int nCellAdjacencies = cell.getAdjacencyCount();
+		for (int k = 0; k < nCellAdjacencies; ++k) {
+			auto neighIndexItr = cellIndexes.find(adjacencies[k]);
+			if (neighIndexItr != cellIndexes.end()) {
+				graphNeighs.push_back(neighIndexItr->second);
+			}
+		}
+		graphOffsets[n + 1] = graphNeighs.size();
+	}
+
+	auto evalDegree = [&graphOffsets](std::size_t n) {
+		return graphOffsets[n + 1] - graphOffsets[n];
+	};
+
+	// Visit the graph
+	//
+	// Breadth-first visits evaluate the level structure rooted at the
+	// specified cell, the visit order is stored in the specified vector
+	// and the function returns the number of levels.
+	std::vector<int> levels(nCells, -1);
+	std::vector<std::size_t> visitNeighs;
+
+	auto visit = [&](std::size_t root, std::vector<std::size_t> *order) {
+		std::size_t orderBegin = order->size();
+
+		order->push_back(root);
+		levels[root] = 0;
+		for (std::size_t k = orderBegin; k < order->size(); ++k) {
+			std::size_t n = (*order)[k];
+
+			visitNeighs.clear();
+			for (std::size_t j = graphOffsets[n]; j < graphOffsets[n + 1]; ++j) {
+				std::size_t neigh = graphNeighs[j];
+				if (levels[neigh] < 0) {
+					levels[neigh] = levels[n] + 1;
+					visitNeighs.push_back(neigh);
+				}
+			}
+
+			std::stable_sort(visitNeighs.begin(), visitNeighs.end(), [&evalDegree](std::size_t n_1, std::size_t n_2) {
+				return (evalDegree(n_1) < evalDegree(n_2));
+			});
+			order->insert(order->end(), visitNeighs.begin(), visitNeighs.end());
+		}
+
+		return levels[order->back()] + 1;
+	};
+
+	auto resetLevels = [&levels](const std::vector<std::size_t> &order, std::size_t orderBegin) {
+		for (std::size_t k = orderBegin; k < order.size(); ++k) {
+			levels[order[k]] = -1;
+		}
+	};
+
+	std::vector<std::size_t> candidates(nCells);
+	for (std::size_t n = 0; n < nCells; ++n) {
+		candidates[n] = n;
+	}
+
+	std::stable_sort(candidates.begin(), candidates.end(), [&evalDegree](std::size_t n_1, std::size_t n_2) {
+		return (evalDegree(n_1) < evalDegree(n_2));
+	});
+
+	std::vector<std::size_t> order;
+	order.reserve(nCells);
+	std::vector<std::size_t> componentOrder;
+	for (std::size_t candidate : candidates) {
+		if (levels[candidate] >= 0) {
+			continue;
+		}
+
+		// Find a pseudo-peripheral cell
+		//
+		// Starting from a cell with minimum degree, the cell with minimum
+		// degree in the last level of the level structure becomes the new
+		// root, until the number of levels stops increasing.
+		std::size_t root = candidate;
+
+		componentOrder.clear();
+		int nLevels = visit(root, &componentOrder);
+		while (true) {
+			std::size_t lastLevelCandidate = root;
+			std::size_t lastLevelCandidateDegree = std::numeric_limits<std::size_t>::max();
+			for (std::size_t k = componentOrder.size(); k > 0; --k) {
+				std::size_t n = componentOrder[k - 1];
+				if (levels[n] != nLevels - 1) {
+					break;
+				}
+
+				std::size_t degree = evalDegree(n);
+				if (degree <= lastLevelCandidateDegree) {
+					lastLevelCandidate       = n;
+					lastLevelCandidateDegree = degree;
+				}
+			}
+
+			resetLevels(componentOrder, 0);
+
+			std::vector<std::size_t> candidateOrder;
+			int candidateLevels = visit(lastLevelCandidate, &candidateOrder);
+			if (candidateLevels <= nLevels) {
+				resetLevels(candidateOrder, 0);
+				componentOrder.clear();
+				visit(root, &componentOrder);
+				break;
+			}
+
+			root = lastLevelCandidate;
+			nLevels = candidateLevels;
+			componentOrder.swap(candidateOrder);
+		}
+
+		// Add the component to the order
+		order.insert(order.end(), componentOrder.begin(), componentOrder.end());
+	}
+
+	// Evaluate the ranks
+	std::vector<std::size_t> ranks(*std::max_element(cellRawIndexes.begin(), cellRawIndexes.end()) + 1);
+	for (std::size_t k = 0; k < nCells; ++k) {
+		ranks[cellRawIndexes[order[nCells - k - 1]]] = k;
+	}
+
+	return ranks;
+}
+
+/*!
+	Evaluates the Morton key associated to the specified integer coordinates.
+
+	The key is evaluated interleaving the bits of the coordinates.
+
+	\param coords are the integer coordinates
+	\param nBits is the number of bits of each coordinate that will be used
+	\result The Morton key associated to the specified integer coordinates.
+*/
+uint64_t PatchKernel::evalMortonKey(std::array<uint32_t, 3> coords, int nBits)
+{
+	uint64_t key = 0;
+	for (int bit = nBits - 1; bit >= 0; --bit) {
+		for (int d = 0; d < 3; ++d) {
+			key = (key << 1) | ((coords[d] >> bit) & 1);
+		}
+	}
+
+	return key;
+}
+
+/*!
+	Evaluates the Hilbert key associated to the specified integer coordinates.
+
+	The coordinates are transformed into the transposed Hilbert index using
+	the algorithm by Skilling ("Programming the Hilbert curve", AIP Conference
+	Proceedings 707, 2004), the key is then evaluated interleaving the bits of
+	the transposed index.
+
+	\param coords are the integer coordinates
+	\param nBits is the number of bits of each coordinate that will be used
+	\result The Hilbert key associated to the specified integer coordinates.
+*/
+uint64_t PatchKernel::evalHilbertKey(std::array<uint32_t, 3> coords, int nBits)
+{
+	const uint32_t M = uint32_t(1) << (nBits - 1);
+
+	// Inverse undo
+	for (uint32_t Q = M; Q > 1; Q >>= 1) {
+		uint32_t P = Q - 1;
+		for (int d = 0; d < 3; ++d) {
+			if (coords[d] & Q) {
+				coords[0] ^= P;
+			} else {
+				uint32_t t = (coords[0] ^ coords[d]) & P;
+				coords[0] ^= t;
+				coords[d] ^= t;
+			}
+		}
+	}
+
+	// Gray encode
+	for (int d = 1; d < 3; ++d) {
+		coords[d] ^= coords[d - 1];
+	}
+
+	uint32_t t = 0;
+	for (uint32_t Q = M; Q > 1; Q >>= 1) {
+		if (coords[2] & Q) {
+			t ^= Q - 1;
+		}
+	}
+
+	for (int d = 0; d < 3; ++d) {
+		coords[d] ^= t;
+	}
+
+	// Interleave the bits of the transposed index
+	return evalMortonKey(coords, nBits);
+}
+
+/*!
+	Requests the patch to compact the vertex data structure and reduce
+	its capacity to fit its size.
+
+	The request is non-binding, and after the function call the vertex
+	data structure can still occupy more memory than it actually needs.
+*/
+bool PatchKernel::squeezeVertices()
 {
 	if (!isExpert()) {
 		return false;
@@ -5312,6 +6310,15 @@ bool PatchKernel::squeezeCells()
 
 	m_cells.sync();
 
+	// Raw indexes of the cells may have changed
+	resetPointLocationTree();
+	setCellGeometryCacheDirty(true);
+
+#if BITPIT_ENABLE_MPI==1
+	// Raw indexes of the cells may have changed
+	m_ghostCellExchangeRawInfoDirty = true;
+#endif
+
 	return true;
 }
 
@@ -5364,6 +6371,73 @@ std::array<double, 3> PatchKernel::evalCellCentroid(long id) const
 	return evalElementCentroid(cell);
 }
 
+/*!
+	Evaluates the centroids of all the cells of the patch.
+
+	Centroids are evaluated looping over the cells in storage order, this
+	avoids the look-up of each cell and the virtual call needed to evaluate
+	the centroid of a single cell. Patches that provide a specialized
+	implementation of evalCellCentroid should also provide a specialized
+	implementation of this function.
+
+	\param[out] centroids is the storage that will be filled with the
+	centroids of the cells, the storage should be associated with the
+	kernel of the cells of the patch
+*/
+void PatchKernel::evalCellCentroids(PiercedStorage<std::array<double, 3>, long> *centroids) const
+{
+	if (centroids->getKernel() != &m_cells) {
+		throw std::runtime_error("The storage is not associated with the cells of the patch.");
+	}
+
+	CellConstIterator endItr = cellConstEnd();
+	for (CellConstIterator itr = cellConstBegin(); itr != endItr; ++itr) {
+		const Cell &cell = *itr;
+		ConstProxyVector<long> cellVertexIds = cell.getVertexIds();
+		int nCellVertices = cellVertexIds.size();
+
+		std::array<double, 3> &centroid = centroids->rawAt(itr.getRawIndex());
+		centroid = {{0., 0., 0.}};
+		if (nCellVertices == 0) {
+			continue;
+		}
+
+		for (int i = 0; i < nCellVertices; ++i) {
+			const std::array<double, 3> &vertexCoordinates = getVertexCoords(cellVertexIds[i]);
+			for (int k = 0; k < 3; ++k) {
+				centroid[k] += vertexCoordinates[k];
+			}
+		}
+
+		for (int k = 0; k < 3; ++k) {
+			centroid[k] /= nCellVertices;
+		}
+	}
+}
+
+/*!
+	Gets the cached centroids of the cells.
+
+	The cache is evaluated in bulk the first time it is requested and it
+	is automatically invalidated when the cells or the vertices of the
+	patch are altered through the patch interface (i.e., when the alteration
+	flags of a cell are modified, when the storage is reordered or when the
+	patch is transformed). The cache is not aware of changes performed
+	directly on the vertices (e.g., when vertex coordinates are modified
+	calling Vertex::setCoords).
+
+	The returned storage is associated with the kernel of the cells and it
+	is valid until the patch is modified.
+
+	\result The cached centroids of the cells.
+*/
+const PiercedStorage<std::array<double, 3>, long> & PatchKernel::getCachedCellCentroids() const
+{
+	updateCellGeometryCache();
+
+	return m_cellCentroidsCache;
+}
+
 /*!
 	Evaluates the bounding box of the specified cell.
 
@@ -5562,6 +6636,140 @@ long PatchKernel::locatePoint(double x, double y, double z) const
 	return locatePoint({{x, y, z}});
 }
 
+/*!
+	Locates the cells that contain the specified points.
+
+	The default implementation locates the points one at a time, patches
+	that can take advantage of the spatial coherence of the points should
+	override this function.
+
+	\param[in] nPoints is the number of points
+	\param[in] points are the points to be checked
+	\param[out] ids on output will contain the ids of the cells that contain
+	the points. If a point is not inside the patch, the related id will be
+	set to the id of the null element.
+*/
+void PatchKernel::locatePoints(int nPoints, const std::array<double, 3> *points, long *ids) const
+{
+	for (int i = 0; i < nPoints; ++i) {
+		ids[i] = locatePoint(points[i]);
+	}
+}
+
+/*!
+	Gets the tree used for locating points inside the patch.
+
+	The tree is built the first time it is requested and it is kept until
+	the cells of the patch are modified. Lookups performed on the tree are
+	thread safe and the tree can be safely requested by multiple threads.
+
+	Changing the coordinates of the vertices without using the functions
+	provided by the patch (e.g., translate, scale) will not invalidate the
+	tree, in this case the tree should be explicitly reset.
+
+	\result The tree used for locating points inside the patch.
+*/
+const PatchSkdTree & PatchKernel::getPointLocationTree() const
+{
+	std::lock_guard<std::mutex> lock(m_pointLocationTreeMutex);
+
+	if (!m_pointLocationTree) {
+		m_pointLocationTree = _createPointLocationTree();
+		if (!m_pointLocationTree) {
+			throw std::runtime_error("The patch doesn't support point location trees.");
+		}
+
+		m_pointLocationTree->build();
+		m_pointLocationTree->enableThreadSafeLookups(true);
+	}
+
+	return *m_pointLocationTree;
+}
+
+/*!
+	Resets the tree used for locating points inside the patch.
+
+	The tree will be re-built the next time it will be requested.
+*/
+void PatchKernel::resetPointLocationTree()
+{
+	m_pointLocationTree.reset();
+
+#if BITPIT_ENABLE_MPI==1
+	// The bounding boxes of the partitions are used for locating points
+	// among the partitions, hence they are no longer valid
+	m_partitioningBoxesDirty = true;
+#endif
+}
+
+/*!
+	Creates the tree used for locating points inside the patch.
+
+	The default implementation doesn't support point location trees and
+	returns a null pointer.
+
+	\result The tree used for locating points inside the patch.
+*/
+std::unique_ptr<PatchSkdTree> PatchKernel::_createPointLocationTree() const
+{
+	return nullptr;
+}
+
+/*!
+	Checks if the cell geometry cache is dirty.
+
+	\result Returns true if the cell geometry cache is dirty, false otherwise.
+*/
+bool PatchKernel::isCellGeometryCacheDirty() const
+{
+	return m_cellGeometryCacheDirty;
+}
+
+/*!
+	Sets the dirty flag of the cell geometry cache.
+
+	A dirty cache will be re-evaluated the next time it will be requested.
+
+	\param dirty controls if the cell geometry cache will be set as dirty
+*/
+void PatchKernel::setCellGeometryCacheDirty(bool dirty)
+{
+	m_cellGeometryCacheDirty = dirty;
+}
+
+/*!
+	Updates the cell geometry cache.
+
+	The cache is updated only if it is dirty.
+*/
+void PatchKernel::updateCellGeometryCache() const
+{
+	std::lock_guard<std::mutex> lock(m_cellGeometryCacheMutex);
+
+	if (!m_cellGeometryCacheDirty) {
+		return;
+	}
+
+	_updateCellGeometryCache();
+
+	m_cellGeometryCacheDirty = false;
+}
+
+/*!
+	Internal function to update the cell geometry cache.
+
+	The default implementation caches the centroids of the cells, patches
+	that cache additional geometrical information should call the base
+	implementation.
+*/
+void PatchKernel::_updateCellGeometryCache() const
+{
+	m_cellCentroidsCache.unsetKernel(true);
+	m_cellCentroidsCache.setStaticKernel(&m_cells);
+
+	evalCellCentroids(&m_cellCentroidsCache);
+}
+
 /*!
  * Check whether the face "face_A" on cell "cell_A" is the same as the face
  * "face_B" on cell "cell_B".
@@ -6622,6 +7830,9 @@ PatchKernel::AlterationFlags PatchKernel::getCellAlterationFlags(long id) const
 void PatchKernel::resetCellAlterationFlags(long id, AlterationFlags flags)
 {
 	resetElementAlterationFlags(id, flags, &m_alteredCells);
+
+	// The cell geometry cache is no longer valid
+	setCellGeometryCacheDirty(true);
 }
 
 /*!
@@ -6646,6 +7857,9 @@ void PatchKernel::setCellAlterationFlags(AlterationFlags flags)
 void PatchKernel::setCellAlterationFlags(long id, AlterationFlags flags)
 {
 	setElementAlterationFlags(id, flags, &m_alteredCells);
+
+	// The cell geometry cache is no longer valid
+	setCellGeometryCacheDirty(true);
 }
 
 /*!
@@ -7216,6 +8430,10 @@ void PatchKernel::translate(const std::array<double, 3> &translation)
 		vertex.translate(translation);
 	}
 
+	// The point location tree and the cell geometry cache are no longer valid
+	resetPointLocationTree();
+	setCellGeometryCacheDirty(true);
+
 	// Update the bounding box
 	if (!isBoundingBoxFrozen() || isBoundingBoxDirty()) {
 		m_boxMinPoint += translation;
@@ -7260,6 +8478,10 @@ void PatchKernel::scale(const std::array<double, 3> &scaling, const std::array<d
 		vertex.scale(scaling, center);
 	}
 
+	// The point location tree and the cell geometry cache are no longer valid
+	resetPointLocationTree();
+	setCellGeometryCacheDirty(true);
+
 	// Update the bounding box
 	if (!isBoundingBoxFrozen() || isBoundingBoxDirty()) {
 		for (int k = 0; k < 3; ++k) {
@@ -27,8 +27,10 @@
 
 #include <cstddef>
 #include <deque>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #if BITPIT_ENABLE_MPI==1
 #	include <mpi.h>
 #endif
@@ -50,6 +52,8 @@
 
 namespace bitpit {
 
+class PatchSkdTree;
+
 class PatchKernel : public VTKBaseStreamer {
 
 friend class PatchInfo;
@@ -349,6 +353,15 @@ public:
 		ADAPTION_ALTERED
 	};
 
+	/*!
+		Reordering strategy
+	*/
+	enum ReorderingStrategy {
+		REORDERING_MORTON,
+		REORDERING_HILBERT,
+		REORDERING_RCM
+	};
+
 	/*!
 		Partitioning status
 	*/
@@ -381,6 +394,7 @@ public:
 	bool reserveInterfaces(size_t nInterfaces);
 
 	std::vector<adaption::Info> update(bool trackAdaption = true, bool squeezeStorage = false);
+	void update(adaption::FlatInfoCollection *adaptionData, bool squeezeStorage = false);
 
 	virtual void simulateCellUpdate(const long id, adaption::Marker marker, std::vector<Cell> *virtualCells, PiercedVector<Vertex, long> *virtualVertices) const;
 
@@ -390,8 +404,10 @@ public:
 	bool isAdaptionSupported() const;
 	AdaptionStatus getAdaptionStatus(bool global = false) const;
 	std::vector<adaption::Info> adaption(bool trackAdaption = true, bool squeezeStorage = false);
+	void adaption(adaption::FlatInfoCollection *adaptionData, bool squeezeStorage = false);
 	std::vector<adaption::Info> adaptionPrepare(bool trackAdaption = true);
 	std::vector<adaption::Info> adaptionAlter(bool trackAdaption = true, bool squeezeStorage = false);
+	void adaptionAlter(adaption::FlatInfoCollection *adaptionData, bool squeezeStorage = false);
 	void adaptionCleanup();
 
 	virtual void settleAdaptionMarkers();
@@ -441,6 +457,7 @@ public:
 	VertexIterator addVertex(const Vertex &source, long id = Vertex::NULL_ID);
 	VertexIterator addVertex(Vertex &&source, long id = Vertex::NULL_ID);
 	VertexIterator addVertex(const std::array<double, 3> &coords, long id = Vertex::NULL_ID);
+	long addVertices(std::size_t nVertices, const std::array<double, 3> *coords, long firstId = Vertex::NULL_ID);
 	long countFreeVertices() const;
 	long countOrphanVertices() const;
 	std::vector<long> findOrphanVertices();
@@ -496,6 +513,7 @@ public:
 	CellIterator addCell(ElementType type, long id = Element::NULL_ID);
 	CellIterator addCell(ElementType type, const std::vector<long> &connectivity, long id = Element::NULL_ID);
 	CellIterator addCell(ElementType type, std::unique_ptr<long[]> &&connectStorage, long id = Element::NULL_ID);
+	long addCells(std::size_t nCells, const ElementType *types, const long *connectOffsets, const long *connectivity, long firstId = Element::NULL_ID);
 #if BITPIT_ENABLE_MPI==1
 	CellIterator addCell(const Cell &source, int rank, long id = Element::NULL_ID);
 	CellIterator addCell(Cell &&source, int rank, long id = Element::NULL_ID);
@@ -513,6 +531,8 @@ public:
 	long countFreeCells() const;
 	long countOrphanCells() const;
 	virtual std::array<double, 3> evalCellCentroid(long id) const;
+	virtual void evalCellCentroids(PiercedStorage<std::array<double, 3>, long> *centroids) const;
+	const PiercedStorage<std::array<double, 3>, long> & getCachedCellCentroids() const;
 	virtual void evalCellBoundingBox(long id, std::array<double,3> *minPoint, std::array<double,3> *maxPoint) const;
 	BITPIT_DEPRECATED(ConstProxyVector<std::array<double BITPIT_COMMA 3>> getCellVertexCoordinates(long id) const);
 	void getCellVertexCoordinates(long id, std::unique_ptr<std::array<double, 3>[]> *coordinates) const;
@@ -614,6 +634,10 @@ public:
 	bool sortCells();
 	bool sortInterfaces();
 
+	bool reorder(ReorderingStrategy strategy);
+	bool reorderVertices();
+	bool reorderCells(ReorderingStrategy strategy);
+
 	bool squeeze();
 	bool squeezeVertices();
 	bool squeezeCells();
@@ -621,6 +645,7 @@ public:
 
 	long locatePoint(double x, double y, double z) const;
 	virtual long locatePoint(const std::array<double, 3> &point) const = 0;
+	virtual void locatePoints(int nPoints, const std::array<double, 3> *points, long *ids) const;
 
 	AdjacenciesBuildStrategy getAdjacenciesBuildStrategy() const;
 	bool areAdjacenciesDirty(bool global = false) const;
@@ -698,6 +723,8 @@ public:
 	bool isRankNeighbour(int rank);
 	std::vector<int> getNeighbourRanks();
 
+	void locateGlobalPoints(int nPoints, const std::array<double, 3> *points, long *ids, int *ranks) const;
+
 	const std::unordered_map<int, std::vector<long>> & getGhostVertexExchangeTargets() const;
 	const std::vector<long> & getGhostVertexExchangeTargets(int rank) const;
 	const std::unordered_map<int, std::vector<long>> & getGhostVertexExchangeSources() const;
@@ -712,6 +739,14 @@ public:
 	const std::vector<long> & getGhostCellExchangeSources(int rank) const;
 	BITPIT_DEPRECATED(const std::vector<long> & getGhostExchangeSources(int rank) const);
 
+	const std::vector<std::size_t> & getInteriorCellRawIndexes() const;
+	const std::vector<std::size_t> & getBorderCellRawIndexes() const;
+
+	template<typename T>
+	void startGhostUpdate(PiercedStorage<T, long> &storage);
+	void finishGhostUpdate();
+	bool isGhostUpdateActive() const;
+
 	bool isPartitioned() const;
 	bool isPartitioningSupported() const;
 	bool arePartitioningInfoDirty(bool global = true) const;
@@ -720,10 +755,13 @@ public:
 	double evalPartitioningUnbalance(const std::unordered_map<long, double> &cellWeights) const;
 	BITPIT_DEPRECATED(std::vector<adaption::Info> partition(MPI_Comm communicator, const std::unordered_map<long, int> &cellRanks, bool trackPartitioning, bool squeezeStorage = false, std::size_t haloSize = 1));
 	std::vector<adaption::Info> partition(const std::unordered_map<long, int> &cellRanks, bool trackPartitioning, bool squeezeStorage = false);
+	void partition(const std::unordered_map<long, int> &cellRanks, adaption::FlatInfoCollection *partitioningData, bool squeezeStorage = false);
 	BITPIT_DEPRECATED(std::vector<adaption::Info> partition(MPI_Comm communicator, const std::unordered_map<long, double> &cellWeights, bool trackPartitioning, bool squeezeStorage = false, std::size_t haloSize = 1));
 	std::vector<adaption::Info> partition(const std::unordered_map<long, double> &cellWeights, bool trackPartitioning, bool squeezeStorage = false);
+	void partition(const std::unordered_map<long, double> &cellWeights, adaption::FlatInfoCollection *partitioningData, bool squeezeStorage = false);
 	BITPIT_DEPRECATED(std::vector<adaption::Info> partition(MPI_Comm communicator, bool trackPartitioning, bool squeezeStorage = false, std::size_t haloSize = 1));
 	std::vector<adaption::Info> partition(bool trackPartitioning, bool squeezeStorage = false);
+	void partition(adaption::FlatInfoCollection *partitioningData, bool squeezeStorage = false);
 	BITPIT_DEPRECATED(std::vector<adaption::Info> partitioningPrepare(MPI_Comm communicator, const std::unordered_map<long, int> &cellRanks, bool trackPartitioning, std::size_t haloSize = 1));
 	std::vector<adaption::Info> partitioningPrepare(const std::unordered_map<long, int> &cellRanks, bool trackPartitioning);
 	BITPIT_DEPRECATED(std::vector<adaption::Info> partitioningPrepare(MPI_Comm communicator, const std::unordered_map<long, double> &cellWeights, bool trackPartitioning, std::size_t haloSize = 1));
@@ -731,6 +769,7 @@ public:
 	BITPIT_DEPRECATED(std::vector<adaption::Info> partitioningPrepare(MPI_Comm communicator, bool trackPartitioning, std::size_t haloSize = 1));
 	std::vector<adaption::Info> partitioningPrepare(bool trackPartitioning);
 	std::vector<adaption::Info> partitioningAlter(bool trackPartitioning = true, bool squeezeStorage = false);
+	void partitioningAlter(adaption::FlatInfoCollection *partitioningData, bool squeezeStorage = false);
 	void partitioningCleanup();
 #endif
 
@@ -862,6 +901,7 @@ protected:
 	void setAdaptionStatus(AdaptionStatus status);
 	virtual std::vector<adaption::Info> _adaptionPrepare(bool trackAdaption);
 	virtual std::vector<adaption::Info> _adaptionAlter(bool trackAdaption);
+	virtual void _adaptionAlter(adaption::FlatInfoCollection *adaptionData);
 	virtual void _adaptionCleanup();
 	virtual bool _markCellForRefinement(long id);
 	virtual bool _markCellForCoarsening(long id);
@@ -883,6 +923,15 @@ protected:
 	virtual void _findCellEdgeNeighs(long id, int edge, const std::vector<long> *blackList, std::vector<long> *neighs) const;
 	virtual void _findCellVertexNeighs(long id, int vertex, const std::vector<long> *blackList, std::vector<long> *neighs) const;
 
+	const PatchSkdTree & getPointLocationTree() const;
+	void resetPointLocationTree();
+	virtual std::unique_ptr<PatchSkdTree> _createPointLocationTree() const;
+
+	bool isCellGeometryCacheDirty() const;
+	void setCellGeometryCacheDirty(bool dirty);
+	void updateCellGeometryCache() const;
+	virtual void _updateCellGeometryCache() const;
+
 	void setExpert(bool expert);
 
 	void extractEnvelope(PatchKernel &envelope) const;
@@ -897,9 +946,12 @@ protected:
 	void setPartitioningStatus(PartitioningStatus status);
 	virtual std::vector<adaption::Info> _partitioningPrepare(const std::unordered_map<long, double> &cellWeights, double defaultWeight, bool trackPartitioning);
 	virtual std::vector<adaption::Info> _partitioningAlter(bool trackPartitioning);
+	virtual void _partitioningAlter(adaption::FlatInfoCollection *partitioningData);
 	virtual void _partitioningCleanup();
 
 	virtual std::vector<long> _findGhostCellExchangeSources(int rank);
+
+	virtual void _findPointsCandidateRanks(int nPoints, const std::array<double, 3> *points, FlatVector2D<int> *candidateRanks) const;
 #endif
 
 	template<typename item_t, typename id_t = long>
@@ -963,6 +1015,13 @@ private:
 	bool m_toleranceCustom;
 	double m_tolerance;
 
+	mutable std::unique_ptr<PatchSkdTree> m_pointLocationTree;
+	mutable std::mutex m_pointLocationTreeMutex;
+
+	mutable bool m_cellGeometryCacheDirty;
+	mutable PiercedStorage<std::array<double, 3>, long> m_cellCentroidsCache;
+	mutable std::mutex m_cellGeometryCacheMutex;
+
 	int m_rank;
 	int m_nProcessors;
 #if BITPIT_ENABLE_MPI==1
@@ -989,6 +1048,28 @@ private:
 	std::unordered_map<int, std::vector<long>> m_ghostCellExchangeTargets;
 	std::unordered_map<int, std::vector<long>> m_ghostCellExchangeSources;
 
+	mutable bool m_ghostCellExchangeRawInfoDirty;
+	mutable std::unordered_map<int, std::vector<std::size_t>> m_ghostCellExchangeRawTargets;
+	mutable std::unordered_map<int, std::vector<std::size_t>> m_ghostCellExchangeRawSources;
+	mutable std::vector<std::size_t> m_interiorCellRawIndexes;
+	mutable std::vector<std::size_t> m_borderCellRawIndexes;
+
+	mutable bool m_partitioningBoxesDirty;
+	mutable std::vector<std::array<double, 6>> m_partitioningBoxes;
+	mutable std::array<double, 3> m_partitioningBoxesBinOrigin;
+	mutable std::array<double, 3> m_partitioningBoxesBinSpacing;
+	mutable std::array<int, 3> m_partitioningBoxesBinCounts;
+	mutable FlatVector2D<int> m_partitioningBoxesBinRanks;
+
+	int m_ghostUpdateTag;
+	std::vector<int> m_ghostUpdateSendRanks;
+	std::vector<OBinaryStream> m_ghostUpdateSendBuffers;
+	std::vector<MPI_Request> m_ghostUpdateSendRequests;
+	std::vector<int> m_ghostUpdateRecvRanks;
+	std::vector<IBinaryStream> m_ghostUpdateRecvBuffers;
+	std::vector<MPI_Request> m_ghostUpdateRecvRequests;
+	std::function<void(int, IBinaryStream &)> m_ghostUpdateUnpacker;
+
 	void setGhostVertexOwner(int id, int rank);
 	void unsetGhostVertexOwner(int id);
 	void clearGhostVertexOwners();
@@ -1009,6 +1090,15 @@ private:
 
 	void updatePartitioningInfo(bool forcedUpdated = false);
 
+	void updateGhostCellExchangeRawInfo() const;
+
+	void updatePartitioningBoxes() const;
+	const std::unordered_map<int, std::vector<std::size_t>> & getGhostCellExchangeRawTargets() const;
+	const std::unordered_map<int, std::vector<std::size_t>> & getGhostCellExchangeRawSources() const;
+
+	void prepareGhostUpdate(const std::unordered_map<int, std::vector<std::size_t>> &rawSources, const std::unordered_map<int, std::vector<std::size_t>> &rawTargets, std::size_t itemSize);
+	void sendGhostUpdate(std::size_t index);
+
 	void updateGhostCellExchangeInfo();
 
 	void updateGhostVertexOwners();
@@ -1069,6 +1159,7 @@ private:
 	void importInterfaceIndexGenerator(const PatchKernel &source);
 
 	VertexIterator _addInternalVertex(const std::array<double, 3> &coords, long id);
+	long _addInternalVertices(std::size_t nVertices, const std::array<double, 3> *coords, long firstId);
 
 	void _restoreInternalVertex(const VertexIterator &iterator, const std::array<double, 3> &coords);
 #if BITPIT_ENABLE_MPI==1
@@ -1081,6 +1172,7 @@ private:
 #endif
 
 	CellIterator _addInternalCell(ElementType type, std::unique_ptr<long[]> &&connectStorage, long id);
+	long _addInternalCells(std::size_t nCells, const ElementType *types, const long *connectOffsets, const long *connectivity, long firstId);
 #if BITPIT_ENABLE_MPI==1
 	CellIterator _addGhostCell(ElementType type, std::unique_ptr<long[]> &&connectStorage, int rank, long id);
 #endif
@@ -1103,6 +1195,13 @@ private:
 
 	void replaceVTKStreamer(const VTKBaseStreamer *original, VTKBaseStreamer *updated);
 
+	std::vector<std::size_t> evalCellReorderingRanks(ReorderingStrategy strategy, const CellConstRange &cellRange) const;
+	std::vector<std::size_t> evalCellSpaceFillingCurveRanks(ReorderingStrategy strategy, const CellConstRange &cellRange) const;
+	std::vector<std::size_t> evalCellRCMRanks(const CellConstRange &cellRange) const;
+
+	static uint64_t evalMortonKey(std::array<uint32_t, 3> coords, int nBits);
+	static uint64_t evalHilbertKey(std::array<uint32_t, 3> coords, int nBits);
+
 };
 
 }
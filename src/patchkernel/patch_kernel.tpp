@@ -26,6 +26,7 @@
 #define __BITPIT_PATCH_KERNEL_TPP__
 
 #include <stdexcept>
+#include <type_traits>
 
 namespace bitpit {
 
@@ -169,6 +170,81 @@ void PatchKernel::mappedItemRenumbering(PiercedVector<item_t, id_t> &container,
 	}
 }
 
+#if BITPIT_ENABLE_MPI==1
+/*!
+	Starts updating the ghost entries of the specified storage.
+
+	The storage should be synchronized with the cells of the patch, the
+	values of its internal entries are sent to the processes that have the
+	corresponding cells among their ghosts. The update is
+	non-blocking: the function returns as soon as the data has been packed
+	and the communications have been started. The update should be completed
+	calling finishGhostUpdate(), until then the ghost entries of the storage
+	should not be accessed and the storage should not be modified.
+
+	While the update is in progress, it is possible to process the interior
+	cells (see getInteriorCellRawIndexes()), since they don't depend on the
+	values of the ghost cells.
+
+	Data is packed using the raw indexes of the exchange sources, these
+	indexes are evaluated once and re-used until the patch is updated,
+	sorted or squeezed. Partitioning information should be up-to-date when
+	a ghost update is started.
+
+	This is a collective function and only one ghost update can be in
+	progress at the same time.
+
+	\param storage is the storage whose ghost entries will be updated
+*/
+template<typename T>
+void PatchKernel::startGhostUpdate(PiercedStorage<T, long> &storage)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Ghost update is supported only for trivially copyable types");
+
+	if (storage.getKernel() != &(m_cells.getKernel())) {
+		throw std::runtime_error("The storage is not synchronized with the cells of the patch.");
+	}
+
+	// Exchange information
+	const std::unordered_map<int, std::vector<std::size_t>> &rawSources = getGhostCellExchangeRawSources();
+	const std::unordered_map<int, std::vector<std::size_t>> &rawTargets = getGhostCellExchangeRawTargets();
+
+	// Prepare the update
+	std::size_t nFields = storage.getFieldCount();
+	prepareGhostUpdate(rawSources, rawTargets, nFields * sizeof(T));
+
+	// Pack and send the data
+	for (std::size_t i = 0; i < m_ghostUpdateSendRanks.size(); ++i) {
+		const std::vector<std::size_t> &rankSources = rawSources.at(m_ghostUpdateSendRanks[i]);
+
+		OBinaryStream &buffer = m_ghostUpdateSendBuffers[i];
+		T *values = reinterpret_cast<T *>(buffer.reserve(rankSources.size() * nFields * sizeof(T)));
+		for (std::size_t rawIndex : rankSources) {
+			for (std::size_t k = 0; k < nFields; ++k) {
+				*values = storage.rawAt(rawIndex, k);
+				++values;
+			}
+		}
+
+		sendGhostUpdate(i);
+	}
+
+	// Set the function that will unpack the data
+	m_ghostUpdateUnpacker = [&storage, &rawTargets, nFields](int rank, IBinaryStream &buffer)
+	{
+		const std::vector<std::size_t> &rankTargets = rawTargets.at(rank);
+
+		const T *values = reinterpret_cast<const T *>(buffer.consume(rankTargets.size() * nFields * sizeof(T)));
+		for (std::size_t rawIndex : rankTargets) {
+			for (std::size_t k = 0; k < nFields; ++k) {
+				storage.rawAt(rawIndex, k) = *values;
+				++values;
+			}
+		}
+	};
+}
+#endif
+
 }
 
 #endif
@@ -27,7 +27,10 @@
 // INCLUDES                                                                   //
 // ========================================================================== //
 #include <mpi.h>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <limits>
 #include <unordered_set>
 
 #include "bitpit_communications.hpp"
@@ -140,6 +143,11 @@ void PatchKernel::freeCommunicator()
 		return;
 	}
 
+	if (m_ghostUpdateTag >= 0) {
+		communications::tags().trash(m_ghostUpdateTag, m_communicator);
+		m_ghostUpdateTag = -1;
+	}
+
 	MPI_Comm_free(&m_communicator);
 }
 
@@ -505,6 +513,9 @@ void PatchKernel::_restoreGhostVertex(const VertexIterator &iterator, const std:
 	// Update the bounding box
 	addPointToBoundingBox(vertex.getCoords());
 
+	// The cell geometry cache is no longer valid
+	setCellGeometryCacheDirty(true);
+
 	// Set owner
 	setGhostVertexOwner(vertex.getId(), rank);
 }
@@ -617,6 +628,11 @@ PatchKernel::CellIterator PatchKernel::internalCell2GhostCell(long id, int owner
 		m_cells.swap(id, m_lastInternalCellId);
 	}
 
+	// Raw indexes of the cells have changed
+	resetPointLocationTree();
+	setCellGeometryCacheDirty(true);
+	m_ghostCellExchangeRawInfoDirty = true;
+
 	// Get the iterator pointing to the updated position of the element
 	CellIterator iterator = m_cells.find(id);
 
@@ -658,6 +674,11 @@ PatchKernel::CellIterator PatchKernel::ghostCell2InternalCell(long id)
 		m_cells.swap(id, m_firstGhostCellId);
 	}
 
+	// Raw indexes of the cells have changed
+	resetPointLocationTree();
+	setCellGeometryCacheDirty(true);
+	m_ghostCellExchangeRawInfoDirty = true;
+
 	// Get the iterator pointing to the updated position of the element
 	CellIterator iterator = m_cells.find(id);
 
@@ -921,6 +942,12 @@ PatchKernel::CellIterator PatchKernel::addCell(ElementType type, std::unique_ptr
 PatchKernel::CellIterator PatchKernel::_addGhostCell(ElementType type, std::unique_ptr<long[]> &&connectStorage,
 												 int rank, long id)
 {
+	// The point location tree is no longer valid
+	resetPointLocationTree();
+
+	// Raw indexes of the cells are no longer valid
+	m_ghostCellExchangeRawInfoDirty = true;
+
 	// Get the id of the cell
 	if (m_cellIdGenerator) {
 		if (id < 0) {
@@ -1044,6 +1071,12 @@ void PatchKernel::_restoreGhostCell(const CellIterator &iterator, ElementType ty
 */
 void PatchKernel::_deleteGhostCell(long id)
 {
+	// The point location tree is no longer valid
+	resetPointLocationTree();
+
+	// Raw indexes of the cells are no longer valid
+	m_ghostCellExchangeRawInfoDirty = true;
+
 	// Unset ghost owner
 	unsetGhostCellOwner(id);
 
@@ -1213,6 +1246,28 @@ std::vector<adaption::Info> PatchKernel::partition(const std::unordered_map<long
 	return partitioningData;
 }
 
+/*!
+	Partitions the patch among the processes. Each cell will be assigned
+	to a specific process according to the specified input.
+
+	Changes are tracked using a compressed collection of adaption info.
+
+	\param cellRanks are the ranks of the cells after the partitioning
+	\param[in,out] partitioningData if a valid pointer is provided, the
+	changes done during the partitioning will be appended to the specified
+	collection, otherwise the changes will not be tracked
+	\param squeezeStorage if set to true the vector that store patch information
+	will be squeezed after the synchronization
+*/
+void PatchKernel::partition(const std::unordered_map<long, int> &cellRanks, adaption::FlatInfoCollection *partitioningData, bool squeezeStorage)
+{
+	partitioningPrepare(cellRanks, false);
+
+	partitioningAlter(partitioningData, squeezeStorage);
+
+	partitioningCleanup();
+}
+
 /*!
 	Partitions the patch among the processes. The partitioning is done using
 	a criteria that tries to balance the load among the processes.
@@ -1262,6 +1317,25 @@ std::vector<adaption::Info> PatchKernel::partition(bool trackPartitioning, bool
 	return partitioningData;
 }
 
+/*!
+	Partitions the patch among the processes. The partitioning is done using
+	a criteria that tries to balance the load among the processes.
+
+	Changes are tracked using a compressed collection of adaption info.
+
+	\param[in,out] partitioningData if a valid pointer is provided, the
+	changes done during the partitioning will be appended to the specified
+	collection, otherwise the changes will not be tracked
+	\param squeezeStorage if set to true the vector that store patch information
+	will be squeezed after the synchronization
+*/
+void PatchKernel::partition(adaption::FlatInfoCollection *partitioningData, bool squeezeStorage)
+{
+	std::unordered_map<long, double> dummyCellWeights;
+
+	partition(dummyCellWeights, partitioningData, squeezeStorage);
+}
+
 /*!
 	Partitions the patch among the processes. Each cell will be assigned
 	to a specific process according to the specified input.
@@ -1313,6 +1387,30 @@ std::vector<adaption::Info> PatchKernel::partition(const std::unordered_map<long
 	return partitioningData;
 }
 
+/*!
+	Partitions the patch among the processes. Each cell will be assigned
+	to a specific process according to the specified input.
+
+	Changes are tracked using a compressed collection of adaption info.
+
+	\param cellWeights are the weights of the cells, the weight represents the
+	relative computational cost associated with a specified cell. If no weight
+	is specified for a cell, a weight equal to one is used
+	\param[in,out] partitioningData if a valid pointer is provided, the
+	changes done during the partitioning will be appended to the specified
+	collection, otherwise the changes will not be tracked
+	\param squeezeStorage if set to true the vector that store patch information
+	will be squeezed after the synchronization
+*/
+void PatchKernel::partition(const std::unordered_map<long, double> &cellWeights, adaption::FlatInfoCollection *partitioningData, bool squeezeStorage)
+{
+	partitioningPrepare(cellWeights, false);
+
+	partitioningAlter(partitioningData, squeezeStorage);
+
+	partitioningCleanup();
+}
+
 /*!
 	Partitions the patch among the processes. The partitioning is done using
 	a criteria that tries to balance the load among the processes.
@@ -1619,6 +1717,45 @@ std::vector<adaption::Info> PatchKernel::partitioningAlter(bool trackPartitionin
 	return partitioningData;
 }
 
+/*!
+	Alter the patch performing the partitioning.
+
+	Changes are tracked using a compressed collection of adaption info.
+
+	\param[in,out] partitioningData if a valid pointer is provided, the
+	changes done during the partitioning will be appended to the specified
+	collection, otherwise the changes will not be tracked
+	\param squeezeStorage if set to true the vector that store patch information
+	will be squeezed after the synchronization
+*/
+void PatchKernel::partitioningAlter(adaption::FlatInfoCollection *partitioningData, bool squeezeStorage)
+{
+	if (!isPartitioningSupported()) {
+		return;
+	}
+
+	// Check partitioning status
+	PartitioningStatus partitioningStatus = getPartitioningStatus();
+	if (partitioningStatus == PARTITIONING_CLEAN) {
+		return;
+	} else if (partitioningStatus != PARTITIONING_PREPARED) {
+		throw std::runtime_error ("The prepare function has no been called.");
+	}
+
+	// Partition the patch
+	if (partitioningData) {
+		_partitioningAlter(partitioningData);
+	} else {
+		_partitioningAlter(false);
+	}
+
+	// Finalize patch alterations
+	finalizeAlterations(squeezeStorage);
+
+	// Update the status
+	setPartitioningStatus(PARTITIONING_ALTERED);
+}
+
 /*!
 	Cleanup patch data structured after the partitioning.
 
@@ -1902,6 +2039,22 @@ std::vector<adaption::Info> PatchKernel::_partitioningAlter(bool trackPartitioni
     return partitioningData;
 }
 
+/*!
+    Alter the patch performing the partitioning, tracking the changes using a
+    compressed collection of adaption info.
+
+    Default implementation tracks the changes using the function that returns
+    a vector of adaption::Info and then imports the vector into the collection.
+    Patches that perform large alterations should fill the collection directly.
+
+    \param[in,out] partitioningData is the collection the changes done to the
+    patch during the partitioning will be appended to
+*/
+void PatchKernel::_partitioningAlter(adaption::FlatInfoCollection *partitioningData)
+{
+    partitioningData->append(_partitioningAlter(true));
+}
+
 /*!
     Get the ghost that will change ownership after partitioning.
 
@@ -1942,15 +2095,14 @@ std::unordered_map<long, int> PatchKernel::_partitioningAlter_evalGhostCellOwner
 
         notificationCommunicator.setSend(rank, sourceCells.size() * notificationDataSize);
         SendBuffer &buffer = notificationCommunicator.getSendBuffer(rank);
-        for (long id : sourceCells) {
-            int finalOwner;
-            if (m_partitioningOutgoings.count(id) > 0) {
-                finalOwner = m_partitioningOutgoings.at(id);
+        int *finalOwners = buffer.reserve<int>(sourceCells.size());
+        for (std::size_t k = 0; k < sourceCells.size(); ++k) {
+            auto outgoingItr = m_partitioningOutgoings.find(sourceCells[k]);
+            if (outgoingItr != m_partitioningOutgoings.end()) {
+                finalOwners[k] = outgoingItr->second;
             } else {
-                finalOwner = patchRank;
+                finalOwners[k] = patchRank;
             }
-
-            buffer << finalOwner;
         }
         notificationCommunicator.startSend(rank);
     }
@@ -1967,10 +2119,10 @@ std::unordered_map<long, int> PatchKernel::_partitioningAlter_evalGhostCellOwner
         const auto &list = getGhostCellExchangeTargets(rank);
 
         RecvBuffer &buffer = notificationCommunicator.getRecvBuffer(rank);
-        for (long id : list) {
-            int finalOwner;
-            buffer >> finalOwner;
-
+        const int *finalOwners = buffer.read<int>(list.size());
+        for (std::size_t k = 0; k < list.size(); ++k) {
+            long id = list[k];
+            int finalOwner = finalOwners[k];
             if (finalOwner != m_ghostCellOwners.at(id)) {
                 ghostCellOwnershipChanges[id] = finalOwner;
             }
@@ -3451,6 +3603,375 @@ std::vector<int> PatchKernel::getNeighbourRanks()
 	return neighRanks;
 }
 
+/*!
+	Locates the specified points among the cells of all the partitions.
+
+	Every point is sent only to the processes whose partition may contain it
+	(see _findPointsCandidateRanks), the receiving processes locate the points
+	in batch among their interior cells and send back the ids of the cells
+	that contain them. The data exchanged scales with the number of points
+	rather than with the number of processes.
+
+	If a point is contained in the cells of more than one partition (e.g., a
+	point lying on a partition boundary), it will be associated with the
+	partition with the lowest rank.
+
+	This is a collective operation, all the processes should call it, even
+	those that have no points to locate.
+
+	\param[in] nPoints is the number of points
+	\param[in] points are the points to be located
+	\param[out] ids on output will contain the ids of the cells that contain
+	the points, ids are local to the processes that own the cells. If a point
+	is not inside the patch, the related id will be set to the id of the null
+	element
+	\param[out] ranks on output will contain the ranks of the processes that
+	own the cells containing the points. If a point is not inside the patch,
+	the related rank will be set to a negative value
+*/
+void PatchKernel::locateGlobalPoints(int nPoints, const std::array<double, 3> *points, long *ids, int *ranks) const
+{
+	// If the patch is not partitioned, every process owns all the cells
+	if (!isPartitioned()) {
+		locatePoints(nPoints, points, ids);
+
+		int rank = getRank();
+		for (int i = 0; i < nPoints; ++i) {
+			if (ids[i] != Cell::NULL_ID) {
+				ranks[i] = rank;
+			} else {
+				ranks[i] = -1;
+			}
+		}
+
+		return;
+	}
+
+	const MPI_Comm &communicator = getCommunicator();
+	int nProcessors = getProcessorCount();
+
+	// Identify the candidate ranks of the points
+	FlatVector2D<int> candidateRanks;
+	_findPointsCandidateRanks(nPoints, points, &candidateRanks);
+
+	// Group the points by candidate rank
+	std::vector<int> sendCounts(nProcessors, 0);
+	for (int i = 0; i < nPoints; ++i) {
+		std::size_t nPointCandidates = candidateRanks.getItemCount(i);
+		const int *pointCandidates = candidateRanks.get(i);
+		for (std::size_t k = 0; k < nPointCandidates; ++k) {
+			++sendCounts[pointCandidates[k]];
+		}
+	}
+
+	std::vector<int> sendOffsets(nProcessors, 0);
+	for (int rank = 1; rank < nProcessors; ++rank) {
+		sendOffsets[rank] = sendOffsets[rank - 1] + sendCounts[rank - 1];
+	}
+
+	std::size_t nSends = sendOffsets[nProcessors - 1] + sendCounts[nProcessors - 1];
+	std::vector<std::array<double, 3>> sendPoints(nSends);
+	std::vector<int> sendPointIndexes(nSends);
+
+	std::vector<int> sendPositions(sendOffsets);
+	for (int i = 0; i < nPoints; ++i) {
+		std::size_t nPointCandidates = candidateRanks.getItemCount(i);
+		const int *pointCandidates = candidateRanks.get(i);
+		for (std::size_t k = 0; k < nPointCandidates; ++k) {
+			int &position = sendPositions[pointCandidates[k]];
+			sendPoints[position]       = points[i];
+			sendPointIndexes[position] = i;
+			++position;
+		}
+	}
+
+	// Exchange the points
+	std::vector<int> recvCounts(nProcessors);
+	MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, communicator);
+
+	std::vector<int> recvOffsets(nProcessors, 0);
+	for (int rank = 1; rank < nProcessors; ++rank) {
+		recvOffsets[rank] = recvOffsets[rank - 1] + recvCounts[rank - 1];
+	}
+
+	std::size_t nRecvs = recvOffsets[nProcessors - 1] + recvCounts[nProcessors - 1];
+	std::vector<std::array<double, 3>> recvPoints(nRecvs);
+
+	std::vector<int> sendCoordsCounts(nProcessors);
+	std::vector<int> sendCoordsOffsets(nProcessors);
+	std::vector<int> recvCoordsCounts(nProcessors);
+	std::vector<int> recvCoordsOffsets(nProcessors);
+	for (int rank = 0; rank < nProcessors; ++rank) {
+		sendCoordsCounts[rank]  = 3 * sendCounts[rank];
+		sendCoordsOffsets[rank] = 3 * sendOffsets[rank];
+		recvCoordsCounts[rank]  = 3 * recvCounts[rank];
+		recvCoordsOffsets[rank] = 3 * recvOffsets[rank];
+	}
+
+	MPI_Alltoallv(sendPoints.data(), sendCoordsCounts.data(), sendCoordsOffsets.data(), MPI_DOUBLE,
+	              recvPoints.data(), recvCoordsCounts.data(), recvCoordsOffsets.data(), MPI_DOUBLE,
+	              communicator);
+
+	// Locate the received points among the interior cells
+	std::vector<long> recvIds(nRecvs);
+	locatePoints(static_cast<int>(nRecvs), recvPoints.data(), recvIds.data());
+	for (long &id : recvIds) {
+		if (id == Cell::NULL_ID) {
+			continue;
+		}
+
+		if (!m_cells.at(id).isInterior()) {
+			id = Cell::NULL_ID;
+		}
+	}
+
+	// Send the ids back to the processes that requested them
+	std::vector<long> sendIds(nSends);
+	MPI_Alltoallv(recvIds.data(), recvCounts.data(), recvOffsets.data(), MPI_LONG,
+	              sendIds.data(), sendCounts.data(), sendOffsets.data(), MPI_LONG,
+	              communicator);
+
+	// Assign each point to the lowest rank that contains it
+	for (int i = 0; i < nPoints; ++i) {
+		ids[i]   = Cell::NULL_ID;
+		ranks[i] = -1;
+	}
+
+	for (int rank = 0; rank < nProcessors; ++rank) {
+		int rankBegin = sendOffsets[rank];
+		int rankEnd   = rankBegin + sendCounts[rank];
+		for (int k = rankBegin; k < rankEnd; ++k) {
+			long id = sendIds[k];
+			if (id == Cell::NULL_ID) {
+				continue;
+			}
+
+			int i = sendPointIndexes[k];
+			if (ranks[i] >= 0) {
+				continue;
+			}
+
+			ids[i]   = id;
+			ranks[i] = rank;
+		}
+	}
+}
+
+/*!
+	Finds the ranks of the processes whose partition may contain the
+	specified points.
+
+	The default implementation compares the points with the bounding boxes
+	of the partitions, hence a point may be associated with more than one
+	candidate rank. The bounding boxes are gathered only when the cells of
+	some partition have changed since the previous call (see
+	updatePartitioningBoxes), checking if the boxes are still valid is a
+	collective operation. Patches that can identify the owner of a point
+	without looking at the cells should override this function.
+
+	\param[in] nPoints is the number of points
+	\param[in] points are the points
+	\param[out] candidateRanks on output will contain, for each point, the
+	list of candidate ranks sorted in ascending order
+*/
+void PatchKernel::_findPointsCandidateRanks(int nPoints, const std::array<double, 3> *points, FlatVector2D<int> *candidateRanks) const
+{
+	// Update the bounding boxes of the partitions
+	updatePartitioningBoxes();
+
+	// Identify the candidates
+	//
+	// Only the partitions whose boxes overlap the bin that contains the
+	// point need to be checked. Bins are evaluated on the boxes enlarged
+	// by the tolerance, hence a point outside the grid has no candidates.
+	double tolerance = getTol();
+
+	candidateRanks->clear();
+	candidateRanks->reserve(nPoints, nPoints);
+	for (int i = 0; i < nPoints; ++i) {
+		const std::array<double, 3> &point = points[i];
+
+		candidateRanks->pushBack();
+
+		long binIndex = 0;
+		for (int d = 2; d >= 0; --d) {
+			double binCoordinate = (point[d] - m_partitioningBoxesBinOrigin[d]) / m_partitioningBoxesBinSpacing[d];
+			if (!(binCoordinate >= 0.) || binCoordinate > m_partitioningBoxesBinCounts[d]) {
+				binIndex = -1;
+				break;
+			}
+
+			int binCoordinateIndex = std::min(static_cast<int>(binCoordinate), m_partitioningBoxesBinCounts[d] - 1);
+			binIndex = binIndex * m_partitioningBoxesBinCounts[d] + binCoordinateIndex;
+		}
+
+		if (binIndex < 0) {
+			continue;
+		}
+
+		std::size_t nBinRanks = m_partitioningBoxesBinRanks.getItemCount(binIndex);
+		const int *binRanks = m_partitioningBoxesBinRanks.get(binIndex);
+		for (std::size_t k = 0; k < nBinRanks; ++k) {
+			int rank = binRanks[k];
+			const std::array<double, 6> &box = m_partitioningBoxes[rank];
+
+			bool isCandidate = true;
+			for (int d = 0; d < 3; ++d) {
+				if (point[d] < box[d] - tolerance || point[d] > box[3 + d] + tolerance) {
+					isCandidate = false;
+					break;
+				}
+			}
+
+			if (isCandidate) {
+				candidateRanks->pushBackItem(rank);
+			}
+		}
+	}
+}
+
+/*!
+	Updates the bounding boxes of the partitions and the uniform grid of
+	bins used for finding the partitions whose boxes contain a point.
+
+	The boxes are evaluated only if the cells of at least one partition have
+	been changed since the last update (the boxes are marked as dirty every
+	time the point location tree is reset). This function should be called
+	by all the processes, because checking if the boxes are dirty requires
+	a reduction among all the partitions.
+
+	The grid covers the union of the boxes enlarged by the tolerance and has
+	roughly as many bins as the number of processes. Every bin stores, in
+	ascending order, the ranks whose enlarged boxes overlap the bin.
+*/
+void PatchKernel::updatePartitioningBoxes() const
+{
+	// Check if the boxes are dirty
+	bool partitioningBoxesDirty = m_partitioningBoxesDirty;
+	MPI_Allreduce(MPI_IN_PLACE, &partitioningBoxesDirty, 1, MPI_C_BOOL, MPI_LOR, getCommunicator());
+	if (!partitioningBoxesDirty) {
+		return;
+	}
+
+	int nProcessors = getProcessorCount();
+
+	// Evaluate the bounding box of the partition
+	//
+	// If the stored bounding box is dirty, it may not contain all the
+	// vertices, in that case it has to be evaluated from scratch.
+	std::array<double, 3> partitionBoxMin;
+	std::array<double, 3> partitionBoxMax;
+	if (!isBoundingBoxDirty()) {
+		getBoundingBox(partitionBoxMin, partitionBoxMax);
+	} else {
+		partitionBoxMin.fill(std::numeric_limits<double>::max());
+		partitionBoxMax.fill(-std::numeric_limits<double>::max());
+		for (const Vertex &vertex : m_vertices) {
+			const std::array<double, 3> &coords = vertex.getCoords();
+			for (int d = 0; d < 3; ++d) {
+				partitionBoxMin[d] = std::min(coords[d], partitionBoxMin[d]);
+				partitionBoxMax[d] = std::max(coords[d], partitionBoxMax[d]);
+			}
+		}
+	}
+
+	// Gather the bounding boxes of all the partitions
+	std::array<double, 6> partitionBox;
+	for (int d = 0; d < 3; ++d) {
+		partitionBox[d]     = partitionBoxMin[d];
+		partitionBox[3 + d] = partitionBoxMax[d];
+	}
+
+	m_partitioningBoxes.resize(nProcessors);
+	MPI_Allgather(partitionBox.data(), 6, MPI_DOUBLE, m_partitioningBoxes.data(), 6, MPI_DOUBLE, getCommunicator());
+
+	// Evaluate the extent of the grid
+	//
+	// Partitions without vertices have an empty box and are ignored.
+	double tolerance = getTol();
+
+	std::array<double, 3> gridMin;
+	std::array<double, 3> gridMax;
+	gridMin.fill(std::numeric_limits<double>::max());
+	gridMax.fill(-std::numeric_limits<double>::max());
+	for (const std::array<double, 6> &box : m_partitioningBoxes) {
+		if (box[0] > box[3]) {
+			continue;
+		}
+
+		for (int d = 0; d < 3; ++d) {
+			gridMin[d] = std::min(box[d] - tolerance, gridMin[d]);
+			gridMax[d] = std::max(box[3 + d] + tolerance, gridMax[d]);
+		}
+	}
+
+	if (gridMin[0] > gridMax[0]) {
+		gridMin.fill(0.);
+		gridMax.fill(0.);
+	}
+
+	// Evaluate the bins
+	//
+	// Only the directions along which the grid has a non-negligible extent
+	// are subdivided.
+	std::array<bool, 3> isDirectionSubdivided;
+	int nSubdividedDirections = 0;
+	for (int d = 0; d < 3; ++d) {
+		isDirectionSubdivided[d] = ((gridMax[d] - gridMin[d]) > 2 * tolerance);
+		if (isDirectionSubdivided[d]) {
+			++nSubdividedDirections;
+		}
+	}
+
+	int nDirectionBins = 1;
+	if (nSubdividedDirections > 0) {
+		nDirectionBins = static_cast<int>(std::ceil(std::pow(nProcessors, 1. / nSubdividedDirections)));
+	}
+
+	long nBins = 1;
+	for (int d = 0; d < 3; ++d) {
+		m_partitioningBoxesBinOrigin[d]  = gridMin[d];
+		m_partitioningBoxesBinCounts[d]  = isDirectionSubdivided[d] ? nDirectionBins : 1;
+		m_partitioningBoxesBinSpacing[d] = std::max(gridMax[d] - gridMin[d], tolerance) / m_partitioningBoxesBinCounts[d];
+
+		nBins *= m_partitioningBoxesBinCounts[d];
+	}
+
+	// Identify the ranks whose boxes overlap the bins
+	std::vector<std::vector<int>> binRanks(nBins);
+	for (int rank = 0; rank < nProcessors; ++rank) {
+		const std::array<double, 6> &box = m_partitioningBoxes[rank];
+		if (box[0] > box[3]) {
+			continue;
+		}
+
+		std::array<int, 3> binBegin;
+		std::array<int, 3> binEnd;
+		for (int d = 0; d < 3; ++d) {
+			int binCount      = m_partitioningBoxesBinCounts[d];
+			double binSpacing = m_partitioningBoxesBinSpacing[d];
+			double binOrigin  = m_partitioningBoxesBinOrigin[d];
+
+			binBegin[d] = std::max(static_cast<int>((box[d] - tolerance - binOrigin) / binSpacing), 0);
+			binEnd[d]   = std::min(static_cast<int>((box[3 + d] + tolerance - binOrigin) / binSpacing), binCount - 1) + 1;
+		}
+
+		for (int k = binBegin[2]; k < binEnd[2]; ++k) {
+			for (int j = binBegin[1]; j < binEnd[1]; ++j) {
+				for (int i = binBegin[0]; i < binEnd[0]; ++i) {
+					long binIndex = (static_cast<long>(k) * m_partitioningBoxesBinCounts[1] + j) * m_partitioningBoxesBinCounts[0] + i;
+					binRanks[binIndex].push_back(rank);
+				}
+			}
+		}
+	}
+
+	m_partitioningBoxesBinRanks = FlatVector2D<int>(binRanks);
+
+	// Boxes are now updated
+	m_partitioningBoxesDirty = false;
+}
+
 /*!
 	Gets a constant reference to the vertices that define the "targets" for the
 	exchange of data on ghost vertices. For each process, the corresponding list
@@ -3709,6 +4230,96 @@ const std::vector<long> & PatchKernel::getGhostExchangeSources(int rank) const
 	return getGhostCellExchangeSources(rank);
 }
 
+/*!
+	Gets a constant reference to the raw indexes of the interior cells.
+
+	Interior cells are internal cells that have no ghost cells among their
+	neighbours. Data defined on interior cells can be evaluated without
+	knowing the values on ghost cells, therefore they can be processed while
+	a ghost update is in progress (see startGhostUpdate()).
+
+	Raw indexes are sorted in ascending order and can be used to access
+	directly the cell storage and the storages synchronized with it. They
+	are evaluated on demand and remain valid until cells are added or
+	deleted, or the patch is updated, sorted or squeezed.
+
+	\result A constant reference to the raw indexes of the interior cells.
+*/
+const std::vector<std::size_t> & PatchKernel::getInteriorCellRawIndexes() const
+{
+	if (m_ghostCellExchangeRawInfoDirty) {
+		updateGhostCellExchangeRawInfo();
+	}
+
+	return m_interiorCellRawIndexes;
+}
+
+/*!
+	Gets a constant reference to the raw indexes of the border cells.
+
+	Border cells are internal cells that have at least one ghost cell among
+	their neighbours. Data defined on border cells should be processed only
+	after ghost updates are finished (see finishGhostUpdate()).
+
+	Raw indexes are sorted in ascending order and can be used to access
+	directly the cell storage and the storages synchronized with it. They
+	are evaluated on demand and remain valid until cells are added or
+	deleted, or the patch is updated, sorted or squeezed.
+
+	\result A constant reference to the raw indexes of the border cells.
+*/
+const std::vector<std::size_t> & PatchKernel::getBorderCellRawIndexes() const
+{
+	if (m_ghostCellExchangeRawInfoDirty) {
+		updateGhostCellExchangeRawInfo();
+	}
+
+	return m_borderCellRawIndexes;
+}
+
+/*!
+	Waits for the completion of the ghost update that is currently in
+	progress.
+
+	Data received from the other processes is copied into the ghost entries
+	of the storage specified when the update was started. Data is unpacked
+	as soon as it arrives, following the order in which the receives are
+	completed.
+*/
+void PatchKernel::finishGhostUpdate()
+{
+	if (!isGhostUpdateActive()) {
+		throw std::runtime_error("There is no ghost update in progress.");
+	}
+
+	// Unpack received data
+	int nRecvs = m_ghostUpdateRecvRanks.size();
+	for (int i = 0; i < nRecvs; ++i) {
+		int recvIndex;
+		MPI_Waitany(nRecvs, m_ghostUpdateRecvRequests.data(), &recvIndex, MPI_STATUS_IGNORE);
+
+		IBinaryStream &buffer = m_ghostUpdateRecvBuffers[recvIndex];
+		m_ghostUpdateUnpacker(m_ghostUpdateRecvRanks[recvIndex], buffer);
+	}
+
+	// Wait for the sends to complete
+	MPI_Waitall(m_ghostUpdateSendRequests.size(), m_ghostUpdateSendRequests.data(), MPI_STATUSES_IGNORE);
+
+	// The update is now complete
+	m_ghostUpdateUnpacker = nullptr;
+}
+
+/*!
+	Checks if a ghost update is in progress.
+
+	\result Returns true if a ghost update has been started and not yet
+	finished, false otherwise.
+*/
+bool PatchKernel::isGhostUpdateActive() const
+{
+	return static_cast<bool>(m_ghostUpdateUnpacker);
+}
+
 /*!
 	Sets the owner of the specified ghost vertex.
 
@@ -3863,6 +4474,9 @@ void PatchKernel::updatePartitioningInfo(bool forcedUpdated)
 	// Vertex exchange data
 	updateGhostVertexExchangeInfo();
 
+	// Raw exchange information need to be re-evaluated
+	m_ghostCellExchangeRawInfoDirty = true;
+
 	// Update patch owner
 	updateOwner();
 
@@ -4226,10 +4840,12 @@ std::unordered_map<long, int> PatchKernel::evaluateExchangeVertexOwners() const
 		vertexOwnerCommunicator.setSend(rank, bufferSize);
 
 		SendBuffer &buffer = vertexOwnerCommunicator.getSendBuffer(rank);
+		int *vertexOwners = buffer.reserve<int>(bufferSize / sizeof(int));
 		for (long cellId : cellIds) {
 			const Cell &cell = getCell(cellId);
 			for (long vertexId : cell.getVertexIds()) {
-				buffer << exchangeVertexOwners.at(vertexId);
+				*vertexOwners = exchangeVertexOwners.at(vertexId);
+				++vertexOwners;
 			}
 		}
 		vertexOwnerCommunicator.startSend(rank);
@@ -4241,12 +4857,13 @@ std::unordered_map<long, int> PatchKernel::evaluateExchangeVertexOwners() const
 		int rank = vertexOwnerCommunicator.waitAnyRecv();
 		const std::vector<long> &cellIds = m_ghostCellExchangeTargets.at(rank);
 		RecvBuffer &buffer = vertexOwnerCommunicator.getRecvBuffer(rank);
+		const int *remoteVertexOwners = buffer.read<int>(buffer.getSize() / sizeof(int));
 
 		for (long cellId : cellIds) {
 			const Cell &cell = getCell(cellId);
 			for (long vertexId : cell.getVertexIds()) {
-				int remoteVertexOwner;
-				buffer >> remoteVertexOwner;
+				int remoteVertexOwner = *remoteVertexOwners;
+				++remoteVertexOwners;
 
 				int &currentVertexOwner = exchangeVertexOwners.at(vertexId);
 				if (remoteVertexOwner < currentVertexOwner) {
@@ -4264,6 +4881,183 @@ std::unordered_map<long, int> PatchKernel::evaluateExchangeVertexOwners() const
 	return exchangeVertexOwners;
 }
 
+/*!
+	Update the raw indexes of the cells involved in ghost updates and the
+	raw indexes of interior and border cells.
+*/
+void PatchKernel::updateGhostCellExchangeRawInfo() const
+{
+	if (arePartitioningInfoDirty(false)) {
+		throw std::runtime_error("Partitioning information are dirty, the patch should be updated.");
+	}
+
+	// Exchange information
+	m_ghostCellExchangeRawTargets.clear();
+	for (const auto &entry : m_ghostCellExchangeTargets) {
+		std::vector<std::size_t> &rawTargets = m_ghostCellExchangeRawTargets[entry.first];
+		rawTargets.reserve(entry.second.size());
+		for (long cellId : entry.second) {
+			rawTargets.push_back(m_cells.rawIndex(cellId));
+		}
+	}
+
+	m_ghostCellExchangeRawSources.clear();
+	for (const auto &entry : m_ghostCellExchangeSources) {
+		std::vector<std::size_t> &rawSources = m_ghostCellExchangeRawSources[entry.first];
+		rawSources.reserve(entry.second.size());
+		for (long cellId : entry.second) {
+			rawSources.push_back(m_cells.rawIndex(cellId));
+		}
+	}
+
+	// Border cells
+	//
+	// Border cells are the internal neighbours of the ghost cells.
+	PiercedStorage<bool, long> borderFlags(1, &m_cells);
+	borderFlags.fill(false);
+	if (m_nGhostCells > 0) {
+		assert(getAdjacenciesBuildStrategy() != ADJACENCIES_NONE);
+
+		std::vector<long> neighIds;
+		CellConstIterator endItr = ghostCellConstEnd();
+		for (CellConstIterator itr = ghostCellConstBegin(); itr != endItr; ++itr) {
+			neighIds.clear();
+			findCellNeighs(itr.getId(), &neighIds);
+			for (long neighId : neighIds) {
+				if (m_ghostCellOwners.count(neighId) > 0) {
+					continue;
+				}
+
+				borderFlags[neighId] = true;
+			}
+		}
+	}
+
+	// Interior and border raw indexes
+	m_interiorCellRawIndexes.clear();
+	m_borderCellRawIndexes.clear();
+
+	CellConstIterator endItr = internalCellConstEnd();
+	for (CellConstIterator itr = internalCellConstBegin(); itr != endItr; ++itr) {
+		std::size_t rawIndex = itr.getRawIndex();
+		if (borderFlags.rawAt(rawIndex)) {
+			m_borderCellRawIndexes.push_back(rawIndex);
+		} else {
+			m_interiorCellRawIndexes.push_back(rawIndex);
+		}
+	}
+
+	m_ghostCellExchangeRawInfoDirty = false;
+}
+
+/*!
+	Gets the raw indexes of the cells that define the "targets" for the
+	exchange of data on ghost cells.
+
+	\result The raw indexes of the cells that define the "targets" for the
+	exchange of data on ghost cells.
+*/
+const std::unordered_map<int, std::vector<std::size_t>> & PatchKernel::getGhostCellExchangeRawTargets() const
+{
+	if (m_ghostCellExchangeRawInfoDirty) {
+		updateGhostCellExchangeRawInfo();
+	}
+
+	return m_ghostCellExchangeRawTargets;
+}
+
+/*!
+	Gets the raw indexes of the cells that define the "sources" for the
+	exchange of data on ghost cells.
+
+	\result The raw indexes of the cells that define the "sources" for the
+	exchange of data on ghost cells.
+*/
+const std::unordered_map<int, std::vector<std::size_t>> & PatchKernel::getGhostCellExchangeRawSources() const
+{
+	if (m_ghostCellExchangeRawInfoDirty) {
+		updateGhostCellExchangeRawInfo();
+	}
+
+	return m_ghostCellExchangeRawSources;
+}
+
+/*!
+	Prepares the buffers for a ghost update and starts the receives.
+
+	Send buffers are resized to fit the data that will be sent, but no
+	data is sent until the buffers are filled (see sendGhostUpdate()).
+
+	\param rawSources are the raw indexes of the sources
+	\param rawTargets are the raw indexes of the targets
+	\param itemSize is the size, expressed in bytes, of the data associated
+	with each item
+*/
+void PatchKernel::prepareGhostUpdate(const std::unordered_map<int, std::vector<std::size_t>> &rawSources,
+                                     const std::unordered_map<int, std::vector<std::size_t>> &rawTargets,
+                                     std::size_t itemSize)
+{
+	if (isGhostUpdateActive()) {
+		throw std::runtime_error("A ghost update is already in progress.");
+	}
+
+	// Generate the tag
+	//
+	// The tag is generated the first time an update is requested and it is
+	// kept until the communicator is freed.
+	if (m_ghostUpdateTag < 0) {
+		m_ghostUpdateTag = communications::tags().generate(m_communicator);
+	}
+
+	// Start the receives
+	std::size_t nRecvs = rawTargets.size();
+	m_ghostUpdateRecvRanks.resize(nRecvs);
+	m_ghostUpdateRecvBuffers.resize(nRecvs);
+	m_ghostUpdateRecvRequests.resize(nRecvs);
+
+	std::size_t recvIndex = 0;
+	for (const auto &entry : rawTargets) {
+		int rank = entry.first;
+
+		IBinaryStream &buffer = m_ghostUpdateRecvBuffers[recvIndex];
+		buffer.open(entry.second.size() * itemSize);
+
+		m_ghostUpdateRecvRanks[recvIndex] = rank;
+		MPI_Irecv(buffer.data(), buffer.getSize(), MPI_CHAR, rank, m_ghostUpdateTag, m_communicator, m_ghostUpdateRecvRequests.data() + recvIndex);
+
+		++recvIndex;
+	}
+
+	// Prepare the sends
+	std::size_t nSends = rawSources.size();
+	m_ghostUpdateSendRanks.resize(nSends);
+	m_ghostUpdateSendBuffers.resize(nSends);
+	m_ghostUpdateSendRequests.assign(nSends, MPI_REQUEST_NULL);
+
+	std::size_t sendIndex = 0;
+	for (const auto &entry : rawSources) {
+		OBinaryStream &buffer = m_ghostUpdateSendBuffers[sendIndex];
+		buffer.open(entry.second.size() * itemSize);
+
+		m_ghostUpdateSendRanks[sendIndex] = entry.first;
+
+		++sendIndex;
+	}
+}
+
+/*!
+	Starts sending the specified buffer of the current ghost update.
+
+	\param index is the index of the buffer
+*/
+void PatchKernel::sendGhostUpdate(std::size_t index)
+{
+	OBinaryStream &buffer = m_ghostUpdateSendBuffers[index];
+	int rank = m_ghostUpdateSendRanks[index];
+
+	MPI_Isend(buffer.data(), buffer.getSize(), MPI_CHAR, rank, m_ghostUpdateTag, m_communicator, m_ghostUpdateSendRequests.data() + index);
+}
+
 /*!
 	Update the information needed for exchanging data on ghost cells.
 */
@@ -24,6 +24,8 @@
 
 #include <cmath>
 #include <queue>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "bitpit_CG.hpp"
 
@@ -68,35 +70,67 @@ void SkdPatchInfo::buildCache()
 * \param cellRange is the range of cells fow which the cache has to be built
 */
 void SkdPatchInfo::buildCache(const PatchKernel::CellConstRange &cellRange)
+{
+    initializeCache();
+    for (auto itr = cellRange.cbegin(); itr != cellRange.cend(); ++itr) {
+        updateCachedCell(itr.getRawIndex(), *itr);
+    }
+}
+
+/*!
+* Build the cache.
+*
+* \param cellRawIds are the raw ids of the cells for which the cache has to
+* be built
+*/
+void SkdPatchInfo::buildCache(const std::vector<std::size_t> &cellRawIds)
+{
+    const PiercedVector<Cell, long> &cells = m_patch->getCells();
+
+    initializeCache();
+    for (std::size_t rawCellId : cellRawIds) {
+        updateCachedCell(rawCellId, cells.rawAt(rawCellId));
+    }
+}
+
+/*!
+* Initialize the storage of the cache.
+*/
+void SkdPatchInfo::initializeCache()
 {
     m_cellBoxes     = std::unique_ptr<BoxCache>(new BoxCache(2, &(m_patch->getCells())));
     m_cellCentroids = std::unique_ptr<BoxCache>(new CentroidCache(1, &(m_patch->getCells())));
-    for (auto itr = cellRange.cbegin(); itr != cellRange.cend(); ++itr) {
-        std::size_t rawCellId = itr.getRawIndex();
-
-        // Cell info
-        const Cell &cell = *itr;
-        ConstProxyVector<long> cellConnect = cell.getVertexIds();
-        int nCellVertices = cellConnect.size();
-
-        // Bounding box
-        std::array<double, 3> &cellBoxMin   = m_cellBoxes->rawAt(rawCellId, 0);
-        std::array<double, 3> &cellBoxMax   = m_cellBoxes->rawAt(rawCellId, 1);
-        std::array<double, 3> &cellCentroid = m_cellCentroids->rawAt(rawCellId, 0);
-
-        cellBoxMin   = m_patch->getVertexCoords(cellConnect[0]);
-        cellBoxMax   = cellBoxMin;
-        cellCentroid = cellBoxMin;
-        for (int i = 1; i < nCellVertices; ++i) {
-            const std::array<double, 3> &coords = m_patch->getVertexCoords(cellConnect[i]);
-            for (int d = 0; d < 3; ++d) {
-                cellBoxMin[d]    = std::min(coords[d], cellBoxMin[d]);
-                cellBoxMax[d]    = std::max(coords[d], cellBoxMax[d]);
-                cellCentroid[d] += coords[d];
-            }
+}
+
+/*!
+* Update the cached information of the specified cell.
+*
+* \param rawCellId is the raw id of the cell
+* \param cell is the cell
+*/
+void SkdPatchInfo::updateCachedCell(std::size_t rawCellId, const Cell &cell)
+{
+    // Cell info
+    ConstProxyVector<long> cellConnect = cell.getVertexIds();
+    int nCellVertices = cellConnect.size();
+
+    // Bounding box
+    std::array<double, 3> &cellBoxMin   = m_cellBoxes->rawAt(rawCellId, 0);
+    std::array<double, 3> &cellBoxMax   = m_cellBoxes->rawAt(rawCellId, 1);
+    std::array<double, 3> &cellCentroid = m_cellCentroids->rawAt(rawCellId, 0);
+
+    cellBoxMin   = m_patch->getVertexCoords(cellConnect[0]);
+    cellBoxMax   = cellBoxMin;
+    cellCentroid = cellBoxMin;
+    for (int i = 1; i < nCellVertices; ++i) {
+        const std::array<double, 3> &coords = m_patch->getVertexCoords(cellConnect[i]);
+        for (int d = 0; d < 3; ++d) {
+            cellBoxMin[d]    = std::min(coords[d], cellBoxMin[d]);
+            cellBoxMax[d]    = std::max(coords[d], cellBoxMax[d]);
+            cellCentroid[d] += coords[d];
         }
-        cellCentroid /= double(nCellVertices);
     }
+    cellCentroid /= double(nCellVertices);
 }
 
 /*!
@@ -449,6 +483,37 @@ bool SkdBox::boxIntersectsSphere(const std::array<double, 3> &center, double rad
     return (distance < radius * radius);
 }
 
+/*!
+* Evaluates the surface area of the box.
+*
+* The surface area of an empty box is zero.
+*
+* \result The surface area of the box.
+*/
+double SkdBox::evalSurfaceArea() const
+{
+    if (isEmpty()) {
+        return 0.;
+    }
+
+    std::array<double, 3> lengths = m_boxMax - m_boxMin;
+
+    return 2. * (lengths[0] * lengths[1] + lengths[1] * lengths[2] + lengths[2] * lengths[0]);
+}
+
+/*!
+* Extends the box to include the specified box.
+*
+* \param box is the box that will be included
+*/
+void SkdBox::extend(const SkdBox &box)
+{
+    for (int d = 0; d < 3; ++d) {
+        m_boxMin[d] = std::min(box.m_boxMin[d], m_boxMin[d]);
+        m_boxMax[d] = std::max(box.m_boxMax[d], m_boxMax[d]);
+    }
+}
+
 /*!
 * \class SkdNode
 *
@@ -1037,7 +1102,9 @@ PatchSkdTree::PatchSkdTree(const PatchKernel *patch, bool interiorCellsOnly)
     : m_patchInfo(patch, &m_cellRawIds),
       m_cellRawIds(interiorCellsOnly ? patch->getInternalCellCount() : patch->getCellCount()),
       m_nLeafs(0), m_nMinLeafCells(0), m_nMaxLeafCells(0),
+      m_leafThreshold(1),
       m_interiorCellsOnly(interiorCellsOnly),
+      m_splitStrategy(SPLIT_WEIGHTED_MEAN),
       m_threadSafeLookups(false)
 #if BITPIT_ENABLE_MPI
     , m_rank(0), m_nProcessors(1), m_communicator(MPI_COMM_NULL)
@@ -1046,6 +1113,28 @@ PatchSkdTree::PatchSkdTree(const PatchKernel *patch, bool interiorCellsOnly)
 
 }
 
+/*!
+* Sets the strategy that will be used for splitting the nodes.
+*
+* The strategy will be used the next time the tree is built.
+*
+* \param strategy is the strategy that will be used for splitting the nodes
+*/
+void PatchSkdTree::setSplitStrategy(SplitStrategy strategy)
+{
+    m_splitStrategy = strategy;
+}
+
+/*!
+* Gets the strategy that will be used for splitting the nodes.
+*
+* \result The strategy that will be used for splitting the nodes.
+*/
+PatchSkdTree::SplitStrategy PatchSkdTree::getSplitStrategy() const
+{
+    return m_splitStrategy;
+}
+
 /*!
 * Gets the minimum number of elements contained in a leaf.
 *
@@ -1083,6 +1172,12 @@ std::size_t PatchSkdTree::getLeafMaxCellCount() const
 * When there are cells with the same characteristic position, a node may
 * contain a number of cells that is greater than the leaf threshold.
 *
+* If the SAH split strategy is selected, the split threshold is chosen
+* among a set of equally spaced candidate planes, picking the plane that
+* minimizes the surface area heuristic (SAH) cost of the children. Nodes
+* for which a valid SAH split cannot be found are split using the weighted
+* average of the characteristic positions.
+*
 * \param leafThreshold is the maximum number of "characteristic positions"
 * a node can contain to be considered a leaf
 * * \param[in] squeezeStorage if set to true tree data structures will be
@@ -1096,6 +1191,11 @@ void PatchSkdTree::build(std::size_t leafThreshold, bool squeezeStorage)
     // Clear existing tree
     clear();
 
+    // Store the leaf threshold
+    //
+    // The threshold will be used also when the tree is updated.
+    m_leafThreshold = leafThreshold;
+
     // Initialize list of cell raw ids
     std::size_t nCells;
     PatchKernel::CellConstRange cellRange;
@@ -1173,6 +1273,305 @@ void PatchSkdTree::build(std::size_t leafThreshold, bool squeezeStorage)
 #endif
 }
 
+/*!
+* Refit the tree.
+*
+* The bounding boxes of the nodes are re-evaluated using the current
+* coordinates of the vertices, while the topology of the tree is kept
+* unchanged. Bounding boxes of the leaves are evaluated from the cells
+* they contain, bounding boxes of the other nodes are evaluated bottom-up
+* merging the bounding boxes of their children.
+*
+* Refitting the tree is much cheaper than building it from scratch, but
+* the quality of the tree will degrade if the cells are moved far from
+* their original position. The tree can be refitted only if the cells of
+* the patch have not been changed since the last build or update.
+*
+* If the patch is partitioned, this is a collective operation.
+*/
+void PatchSkdTree::refit()
+{
+    if (getNodeCount() == 0) {
+        return;
+    }
+
+    // Update the bounding boxes of the leaves
+    m_patchInfo.buildCache(m_cellRawIds);
+
+    std::size_t nNodes = getNodeCount();
+    for (std::size_t nodeId = 0; nodeId < nNodes; ++nodeId) {
+        SkdNode &node = _getNode(nodeId);
+        if (node.isLeaf()) {
+            node.initializeBoundingBox();
+        }
+    }
+
+    m_patchInfo.destroyCache();
+
+    // Update the bounding boxes of the internal nodes
+    updateInternalBoundingBoxes();
+
+#if BITPIT_ENABLE_MPI
+    // Update partition information
+    if (isCommunicatorSet()) {
+        buildPartitionBoxes();
+    }
+#endif
+}
+
+/*!
+* Update the tree after a change of the patch.
+*
+* Cells deleted by the adaption are removed from the leaves that contain
+* them, while cells created by the adaption are added to the leaf whose
+* bounding box is closest to their centroid. Only the leaves whose cells
+* have changed are updated: their bounding boxes are re-evaluated and, if
+* they contain more cells than the leaf threshold used to build the tree,
+* the subtree rooted at the leaf is rebuilt. Bounding boxes of the other
+* nodes are then updated bottom-up.
+*
+* The tree can be updated only if the raw indices of the cells not involved
+* in the adaption have not changed (e.g., cells have not been sorted or
+* squeezed). The quality of the tree will degrade after many updates, in
+* that case the tree should be rebuilt.
+*
+* If the patch is partitioned, this is a collective operation.
+*
+* \param adaptionData are the information about the adaption
+*/
+void PatchSkdTree::update(const std::vector<adaption::Info> &adaptionData)
+{
+    // If the tree is empty, build it from scratch
+    if (getNodeCount() == 0 || getNode(0).getCellCount() == 0) {
+        build(m_leafThreshold);
+        return;
+    }
+
+    const PatchKernel &patch = m_patchInfo.getPatch();
+    const PiercedVector<Cell, long> &cells = patch.getCells();
+
+    // Identify the cells created by the adaption
+    std::vector<long> createdCellIds;
+    std::unordered_set<long> createdCellIdsSet;
+    for (const adaption::Info &adaptionInfo : adaptionData) {
+        if (adaptionInfo.entity != adaption::Entity::ENTITY_CELL) {
+            continue;
+        }
+
+        for (long cellId : adaptionInfo.current) {
+            if (!cells.exists(cellId)) {
+                continue;
+            } else if (m_interiorCellsOnly && !cells.at(cellId).isInterior()) {
+                continue;
+            }
+
+            if (createdCellIdsSet.insert(cellId).second) {
+                createdCellIds.push_back(cellId);
+            }
+        }
+    }
+
+    // Identify the raw ids of the cells that are still valid
+    //
+    // A cell contained in the tree is still valid if its raw position is
+    // occupied by a cell that was not created by the adaption.
+    PatchKernel::CellConstRange cellRange;
+    if (m_interiorCellsOnly) {
+        cellRange.initialize(patch.internalCellConstBegin(), patch.internalCellConstEnd());
+    } else {
+        cellRange.initialize(patch.cellConstBegin(), patch.cellConstEnd());
+    }
+
+    std::size_t rawIdsSize = 0;
+    for (std::size_t rawCellId : m_cellRawIds) {
+        rawIdsSize = std::max(rawCellId + 1, rawIdsSize);
+    }
+
+    for (auto itr = cellRange.cbegin(); itr != cellRange.cend(); ++itr) {
+        rawIdsSize = std::max(itr.getRawIndex() + 1, rawIdsSize);
+    }
+
+    std::vector<bool> validRawIds(rawIdsSize, false);
+    for (auto itr = cellRange.cbegin(); itr != cellRange.cend(); ++itr) {
+        if (createdCellIdsSet.count(itr.getId()) == 0) {
+            validRawIds[itr.getRawIndex()] = true;
+        }
+    }
+
+    // Assign the created cells to the leaves
+    //
+    // Each cell is assigned to the leaf reached descending the tree towards
+    // the child whose bounding box is closer to the centroid of the cell.
+    // The centroid is evaluated as the average of the vertices, as done
+    // when building the tree.
+    std::unordered_map<std::size_t, std::vector<std::size_t>> createdLeafCellRawIds;
+    for (long cellId : createdCellIds) {
+        std::size_t rawCellId = cells.getRawIndex(cellId);
+
+        ConstProxyVector<long> cellVertexIds = cells.rawAt(rawCellId).getVertexIds();
+        std::size_t nCellVertices = cellVertexIds.size();
+
+        std::array<double, 3> cellCentroid = {{0., 0., 0.}};
+        for (long vertexId : cellVertexIds) {
+            cellCentroid += patch.getVertexCoords(vertexId);
+        }
+        cellCentroid /= double(nCellVertices);
+
+        std::size_t nodeId = 0;
+        while (!getNode(nodeId).isLeaf()) {
+            const SkdNode &node = getNode(nodeId);
+
+            std::size_t leftId  = node.getChildId(SkdNode::CHILD_LEFT);
+            std::size_t rightId = node.getChildId(SkdNode::CHILD_RIGHT);
+            if (leftId == SkdNode::NULL_ID) {
+                nodeId = rightId;
+            } else if (rightId == SkdNode::NULL_ID) {
+                nodeId = leftId;
+            } else {
+                const SkdNode &leftNode  = getNode(leftId);
+                const SkdNode &rightNode = getNode(rightId);
+
+                double leftSquareDistance  = leftNode.evalPointMinSquareDistance(cellCentroid);
+                double rightSquareDistance = rightNode.evalPointMinSquareDistance(cellCentroid);
+                if (leftSquareDistance < rightSquareDistance) {
+                    nodeId = leftId;
+                } else if (rightSquareDistance < leftSquareDistance) {
+                    nodeId = rightId;
+                } else if (leftNode.getCellCount() <= rightNode.getCellCount()) {
+                    nodeId = leftId;
+                } else {
+                    nodeId = rightId;
+                }
+            }
+        }
+
+        createdLeafCellRawIds[nodeId].push_back(rawCellId);
+    }
+
+    // Update the cells of the nodes
+    //
+    // The tree is visited depth-first, left children are visited before
+    // the right ones. This way the cells of each node remain contiguous.
+    std::vector<std::size_t> updatedCellRawIds;
+    updatedCellRawIds.reserve(m_cellRawIds.size() + createdCellIds.size());
+
+    std::vector<std::size_t> updatedLeafIds;
+
+    std::vector<std::pair<std::size_t, bool>> nodeStack;
+    nodeStack.emplace_back(0, false);
+    while (!nodeStack.empty()) {
+        std::size_t nodeId = nodeStack.back().first;
+        bool childrenVisited = nodeStack.back().second;
+        nodeStack.pop_back();
+
+        SkdNode &node = _getNode(nodeId);
+        if (node.isLeaf()) {
+            std::size_t cellRangeBegin = updatedCellRawIds.size();
+            for (std::size_t n = node.m_cellRangeBegin; n < node.m_cellRangeEnd; ++n) {
+                std::size_t rawCellId = m_cellRawIds[n];
+                if (validRawIds[rawCellId]) {
+                    updatedCellRawIds.push_back(rawCellId);
+                }
+            }
+
+            auto createdLeafCellsItr = createdLeafCellRawIds.find(nodeId);
+            if (createdLeafCellsItr != createdLeafCellRawIds.end()) {
+                const std::vector<std::size_t> &createdCellRawIds = createdLeafCellsItr->second;
+                updatedCellRawIds.insert(updatedCellRawIds.end(), createdCellRawIds.begin(), createdCellRawIds.end());
+            }
+
+            std::size_t cellRangeEnd = updatedCellRawIds.size();
+            bool leafUpdated = (cellRangeEnd - cellRangeBegin) != node.getCellCount();
+            if (!leafUpdated) {
+                for (std::size_t n = 0; n < node.getCellCount(); ++n) {
+                    if (updatedCellRawIds[cellRangeBegin + n] != m_cellRawIds[node.m_cellRangeBegin + n]) {
+                        leafUpdated = true;
+                        break;
+                    }
+                }
+            }
+
+            node.m_cellRangeBegin = cellRangeBegin;
+            node.m_cellRangeEnd   = cellRangeEnd;
+            if (leafUpdated) {
+                updatedLeafIds.push_back(nodeId);
+            }
+        } else if (!childrenVisited) {
+            nodeStack.emplace_back(nodeId, true);
+            for (int i = SkdNode::CHILD_END - 1; i >= SkdNode::CHILD_BEGIN; --i) {
+                std::size_t childId = node.getChildId(static_cast<SkdNode::ChildLocation>(i));
+                if (childId != SkdNode::NULL_ID) {
+                    nodeStack.emplace_back(childId, false);
+                }
+            }
+        } else {
+            node.m_cellRangeBegin = std::numeric_limits<std::size_t>::max();
+            node.m_cellRangeEnd   = 0;
+            for (int i = SkdNode::CHILD_BEGIN; i != SkdNode::CHILD_END; ++i) {
+                std::size_t childId = node.getChildId(static_cast<SkdNode::ChildLocation>(i));
+                if (childId != SkdNode::NULL_ID) {
+                    const SkdNode &child = getNode(childId);
+                    node.m_cellRangeBegin = std::min(child.m_cellRangeBegin, node.m_cellRangeBegin);
+                    node.m_cellRangeEnd   = std::max(child.m_cellRangeEnd, node.m_cellRangeEnd);
+                }
+            }
+        }
+    }
+
+    m_cellRawIds.swap(updatedCellRawIds);
+
+    // Update the leaves whose cells have changed
+    //
+    // The bounding boxes of the updated leaves are re-evaluated and, if a
+    // leaf contains too many cells, the subtree rooted at the leaf is
+    // rebuilt.
+    if (!updatedLeafIds.empty()) {
+        std::vector<std::size_t> updatedLeafCellRawIds;
+        for (std::size_t leafId : updatedLeafIds) {
+            const SkdNode &leaf = getNode(leafId);
+            updatedLeafCellRawIds.insert(updatedLeafCellRawIds.end(), m_cellRawIds.begin() + leaf.m_cellRangeBegin, m_cellRawIds.begin() + leaf.m_cellRangeEnd);
+        }
+
+        m_patchInfo.buildCache(updatedLeafCellRawIds);
+
+        std::queue<std::size_t> nodeQueue;
+        for (std::size_t leafId : updatedLeafIds) {
+            _getNode(leafId).initializeBoundingBox();
+            nodeQueue.push(leafId);
+        }
+
+        while (!nodeQueue.empty()) {
+            std::size_t nodeId = nodeQueue.front();
+            nodeQueue.pop();
+
+            createChildren(nodeId, m_leafThreshold);
+
+            const SkdNode &node = getNode(nodeId);
+            for (int i = SkdNode::CHILD_BEGIN; i != SkdNode::CHILD_END; ++i) {
+                std::size_t childId = node.getChildId(static_cast<SkdNode::ChildLocation>(i));
+                if (childId != SkdNode::NULL_ID) {
+                    nodeQueue.push(childId);
+                }
+            }
+        }
+
+        m_patchInfo.destroyCache();
+    }
+
+    // Update the bounding boxes of the internal nodes
+    updateInternalBoundingBoxes();
+
+    // Update leaf statistics
+    updateLeafStatistics();
+
+#if BITPIT_ENABLE_MPI
+    // Update partition information
+    if (isCommunicatorSet()) {
+        buildPartitionBoxes();
+    }
+#endif
+}
+
 /*!
 * Clear the tree.
 *
@@ -1279,6 +1678,283 @@ std::size_t PatchSkdTree::evalMaxDepth(std::size_t rootId) const
     return depth;
 }
 
+/*!
+* Evaluate the average number of cells contained in the leaves.
+*
+* \result The average number of cells contained in the leaves.
+*/
+double PatchSkdTree::evalLeafMeanCellCount() const
+{
+    if (m_nLeafs == 0) {
+        return 0.;
+    }
+
+    return static_cast<double>(m_cellRawIds.size()) / m_nLeafs;
+}
+
+/*!
+* Evaluate the surface area heuristic (SAH) cost of the tree.
+*
+* The cost estimates the expected effort of a query that traverses the
+* tree. The probability of visiting a node is assumed to be proportional
+* to the ratio between the surface area of its bounding box and the
+* surface area of the bounding box of the root. Visiting an internal
+* node costs the specified traversal cost, visiting a leaf costs the
+* specified intersection cost for each of the cells it contains.
+*
+* \param traversalCost is the cost of visiting an internal node
+* \param intersectionCost is the cost of checking a cell
+* \result The surface area heuristic cost of the tree.
+*/
+double PatchSkdTree::evalSAHCost(double traversalCost, double intersectionCost) const
+{
+    if (getNodeCount() == 0) {
+        return 0.;
+    }
+
+    double rootArea = getNode(0).evalSurfaceArea();
+    if (rootArea <= 0.) {
+        return intersectionCost * getNode(0).getCellCount();
+    }
+
+    double cost = 0.;
+    for (const SkdNode &node : m_nodes) {
+        double probability = node.evalSurfaceArea() / rootArea;
+        if (node.isLeaf()) {
+            cost += probability * intersectionCost * node.getCellCount();
+        } else {
+            cost += probability * traversalCost;
+        }
+    }
+
+    return cost;
+}
+
+/*!
+* Find the cell that contains the specified point.
+*
+* Only the nodes whose bounding box contains the point (inflated by the
+* patch tolerance) are visited, the cells of the visited leaves are then
+* checked one at a time until a cell that contains the point is found.
+*
+* \param point is the point
+* \param[out] id on output it will contain the id of the cell that contains
+* the point, if the point is not contained in any of the cells of the tree,
+* the id will be set to the null id
+* \result The number of cells that have been checked for the inclusion of the
+* point.
+*/
+long PatchSkdTree::findPointContainingCell(const std::array<double, 3> &point, long *id) const
+{
+    *id = Cell::NULL_ID;
+
+    // Early return if the tree is empty
+    if (getNodeCount() == 0) {
+        return 0;
+    }
+
+    const SkdNode &root = getNode(0);
+    if (root.getCellCount() == 0) {
+        return 0;
+    }
+
+    // Get the stack of nodes to visit
+    //
+    // If threads safe lookups are not needed, the stack is declared as member
+    // of the class to avoid its reallocation every time the function is called.
+    std::unique_ptr<std::vector<std::size_t>> privateNodeStack;
+
+    std::vector<std::size_t> *nodeStack;
+    if (areLookupsThreadSafe()) {
+        privateNodeStack = std::unique_ptr<std::vector<std::size_t>>(new std::vector<std::size_t>());
+
+        nodeStack = privateNodeStack.get();
+    } else {
+        m_lookupNodeStack.clear();
+
+        nodeStack = &m_lookupNodeStack;
+    }
+
+    // Visit the tree
+    double tolerance = m_patchInfo.getPatch().getTol();
+
+    long nCellChecks = 0;
+
+    nodeStack->push_back(0);
+    while (!nodeStack->empty()) {
+        std::size_t nodeId = nodeStack->back();
+        const SkdNode &node = m_nodes[nodeId];
+        nodeStack->pop_back();
+
+        // Do not consider nodes that don't contain the point
+        if (!node.boxContainsPoint(point, tolerance)) {
+            continue;
+        }
+
+        // If the node is not a leaf add its children to the stack
+        bool isLeaf = true;
+        for (int i = SkdNode::CHILD_BEGIN; i != SkdNode::CHILD_END; ++i) {
+            SkdNode::ChildLocation childLocation = static_cast<SkdNode::ChildLocation>(i);
+            std::size_t childId = node.getChildId(childLocation);
+            if (childId != SkdNode::NULL_ID) {
+                isLeaf = false;
+                nodeStack->push_back(childId);
+            }
+        }
+
+        if (!isLeaf) {
+            continue;
+        }
+
+        // Check the cells of the leaf
+        std::size_t nLeafCells = node.getCellCount();
+        for (std::size_t n = 0; n < nLeafCells; ++n) {
+            long cellId = node.getCell(n);
+
+            ++nCellChecks;
+            if (isPointInsideCell(cellId, point)) {
+                *id = cellId;
+                return nCellChecks;
+            }
+        }
+    }
+
+    return nCellChecks;
+}
+
+/*!
+* For each of the specified points find the cell that contains the point.
+*
+* Consecutive points are usually close to each other, hence the search of
+* a point starts from the cell that contains the previous point. If the
+* adjacencies of the patch are available, the search walks through the
+* neighbours of that cell, moving towards the point. If the walk fails to
+* find the cell that contains the point, the point is searched using the
+* tree.
+*
+* \param nPoints is the number of the points
+* \param points are the points coordinates
+* \param[out] ids on output it will contain the ids of the cells that contain
+* the points, if a point is not contained in any of the cells of the tree,
+* the related id will be set to the null id
+* \result The number of cells that have been checked for the inclusion of the
+* points.
+*/
+long PatchSkdTree::findPointContainingCell(int nPoints, const std::array<double, 3> *points, long *ids) const
+{
+    const PatchKernel &patch = m_patchInfo.getPatch();
+    bool walkAllowed = (patch.getAdjacenciesBuildStrategy() != PatchKernel::ADJACENCIES_NONE) && !patch.areAdjacenciesDirty();
+
+    long nCellChecks = 0;
+    long previousId  = Cell::NULL_ID;
+    for (int i = 0; i < nPoints; ++i) {
+        const std::array<double, 3> &point = points[i];
+
+        ids[i] = Cell::NULL_ID;
+        if (walkAllowed && previousId != Cell::NULL_ID) {
+            nCellChecks += walkPointContainingCell(point, previousId, ids + i);
+        }
+
+        if (ids[i] == Cell::NULL_ID) {
+            nCellChecks += findPointContainingCell(point, ids + i);
+        }
+
+        if (ids[i] != Cell::NULL_ID) {
+            previousId = ids[i];
+        }
+    }
+
+    return nCellChecks;
+}
+
+/*!
+* Find the cell that contains the specified point walking through the
+* adjacencies of the patch.
+*
+* Starting from the specified cell, the walk moves to the neighbour whose
+* centroid is closest to the point, until a cell that contains the point is
+* found. The walk stops if none of the neighbours is closer to the point than
+* the current cell or if the maximum number of steps is reached.
+*
+* \param point is the point
+* \param startId is the id of the cell the walk will start from
+* \param[out] id on output it will contain the id of the cell that contains
+* the point, if the walk was not able to find the cell that contains the
+* point, the id will be set to the null id
+* \result The number of cells that have been checked for the inclusion of the
+* point.
+*/
+long PatchSkdTree::walkPointContainingCell(const std::array<double, 3> &point, long startId, long *id) const
+{
+    const PatchKernel &patch = m_patchInfo.getPatch();
+
+    *id = Cell::NULL_ID;
+
+    long nCellChecks = 0;
+    long cellId = startId;
+    double cellDistance = norm2(point - patch.evalCellCentroid(cellId));
+    for (int step = 0; step < MAX_WALK_STEPS; ++step) {
+        // Check if the current cell contains the point
+        ++nCellChecks;
+        if (isPointInsideCell(cellId, point)) {
+            *id = cellId;
+            break;
+        }
+
+        // Move towards the point
+        const Cell &cell = patch.getCell(cellId);
+        const long *adjacencies = cell.getAdjacencies();
+        int nAdjacencies = cell.getAdjacencyCount();
+
+        long nextId = Cell::NULL_ID;
+        for (int k = 0; k < nAdjacencies; ++k) {
+            long neighId = adjacencies[k];
+            if (m_interiorCellsOnly && !patch.getCell(neighId).isInterior()) {
+                continue;
+            }
+
+            double neighDistance = norm2(point - patch.evalCellCentroid(neighId));
+            if (neighDistance < cellDistance) {
+                nextId       = neighId;
+                cellDistance = neighDistance;
+            }
+        }
+
+        if (nextId == Cell::NULL_ID) {
+            break;
+        }
+
+        cellId = nextId;
+    }
+
+    return nCellChecks;
+}
+
+/*!
+* Checks if the specified point is inside the given cell.
+*
+* The point is considered inside the cell if its distance from the cell is
+* less than the tolerance of the patch. Trees whose cells have a volume
+* should override this function.
+*
+* \param id is the id of the cell
+* \param point is the point
+* \result Returns true if the point is inside the cell, false otherwise.
+*/
+bool PatchSkdTree::isPointInsideCell(long id, const std::array<double, 3> &point) const
+{
+    const PatchKernel &patch = m_patchInfo.getPatch();
+    const Cell &cell = patch.getCell(id);
+
+    int nCellVertices = cell.getVertexCount();
+    BITPIT_CREATE_WORKSPACE(cellVertexCoordinates, std::array<double BITPIT_COMMA 3>, nCellVertices, ReferenceElementInfo::MAX_ELEM_VERTICES);
+    patch.getElementVertexCoordinates(cell, cellVertexCoordinates);
+
+    double distance = cell.evalPointDistance(point, cellVertexCoordinates);
+
+    return (distance <= patch.getTol());
+}
+
 /*!
 * Create the children of the specified node.
 *
@@ -1297,6 +1973,17 @@ void PatchSkdTree::createChildren(std::size_t parentId, std::size_t leafThreshol
         return;
     }
 
+    // Split the elements using the surface area heuristic.
+    if (m_splitStrategy == SPLIT_SAH) {
+        int splitDirection;
+        double splitThreshold;
+        if (evalSAHSplit(parentId, &splitDirection, &splitThreshold)) {
+            if (splitNode(parentId, splitDirection, splitThreshold)) {
+                return;
+            }
+        }
+    }
+
     // Evaluate the preferred direction along which elements will be split.
     //
     // The elements will be split along a plane normal to the direction
@@ -1323,71 +2010,198 @@ void PatchSkdTree::createChildren(std::size_t parentId, std::size_t leafThreshol
     // along one of the other directions.
     std::array<double, 3> parentWeightedCentroid = parent.evalBoxWeightedMean();
     for (int d = 0; d < 3; ++d) {
-        // Update the split direction
         int splitDirection = (largerDirection + d) % 3;
+        if (splitNode(parentId, splitDirection, parentWeightedCentroid[splitDirection])) {
+            return;
+        }
+    }
 
-        // Get the threshold for the split
-        double splitThreshold = parentWeightedCentroid[splitDirection];
+    // It was not possible to split the elements. They have all the same
+    // characteristic position and therefore they will be clustered together
+    // in a leaf node.
+    createLeaf(parentId);
+}
 
-        // Order the elements
-        //
-        // All the elements with a centroid coordinate less or equal than the
-        // threshold will be assigned to the left child, the others will be
-        // assigned to the right child.
-        std::size_t leftBegin  = parent.m_cellRangeBegin;
-        std::size_t leftEnd    = parent.m_cellRangeEnd;
-        std::size_t rightBegin = parent.m_cellRangeBegin;
-        std::size_t rightEnd   = parent.m_cellRangeEnd;
-        while (true) {
-            // Update the right begin
-            while (rightBegin != leftEnd && m_patchInfo.getCachedCentroid(m_cellRawIds[rightBegin])[splitDirection] <= splitThreshold) {
-                rightBegin++;
-            }
+/*!
+* Split the specified node creating its children.
+*
+* All the cells with a centroid coordinate less or equal than the threshold
+* will be assigned to the left child, the others will be assigned to the
+* right child. If one of the children would be empty, no children will be
+* created.
+*
+* \param parentId is the index of the node that will be split
+* \param splitDirection is the direction normal to the split plane
+* \param splitThreshold is the coordinate of the split plane
+* \result Returns true if the children have been created, false otherwise.
+*/
+bool PatchSkdTree::splitNode(std::size_t parentId, int splitDirection, double splitThreshold)
+{
+    const SkdNode &parent = getNode(parentId);
 
-            // Update the left end
-            while (rightBegin != leftEnd && m_patchInfo.getCachedCentroid(m_cellRawIds[leftEnd - 1])[splitDirection] > splitThreshold) {
-                leftEnd--;
-            }
+    // Order the elements
+    std::size_t leftBegin  = parent.m_cellRangeBegin;
+    std::size_t leftEnd    = parent.m_cellRangeEnd;
+    std::size_t rightBegin = parent.m_cellRangeBegin;
+    std::size_t rightEnd   = parent.m_cellRangeEnd;
+    while (true) {
+        // Update the right begin
+        while (rightBegin != leftEnd && m_patchInfo.getCachedCentroid(m_cellRawIds[rightBegin])[splitDirection] <= splitThreshold) {
+            rightBegin++;
+        }
+
+        // Update the left end
+        while (rightBegin != leftEnd && m_patchInfo.getCachedCentroid(m_cellRawIds[leftEnd - 1])[splitDirection] > splitThreshold) {
+            leftEnd--;
+        }
+
+        // If all the elements are in the right position we can exit
+        if (rightBegin == leftEnd) {
+            break;
+        }
+
+        // If left end and and right begin are not equal, that the two ids
+        // point to misplaced elements. Swap the elements, advance the ids
+        // and continue iterating.
+        std::iter_swap(m_cellRawIds.begin() + (leftEnd - 1), m_cellRawIds.begin() + rightBegin);
+    }
+
+    if (leftEnd <= leftBegin || rightEnd <= rightBegin) {
+        return false;
+    }
 
-            // If all the elements are in the right position we can exit
-            if (rightBegin == leftEnd) {
-                break;
+    // Create the left child
+    //
+    // Adding new nodes may invalidate any pointer and reference to the
+    // nodes, we cannot store a reference to the parent node.
+    long leftId = m_nodes.size();
+    m_nodes.emplace_back(&m_patchInfo, leftBegin, leftEnd);
+    _getNode(parentId).m_children[static_cast<std::size_t>(SkdNode::CHILD_LEFT)] = leftId;
+
+    // Create the right child
+    //
+    // Adding new nodes may invalidate any pointer and reference to the
+    // nodes, we cannot store a reference to the parent node.
+    long rightId = m_nodes.size();
+    m_nodes.emplace_back(&m_patchInfo, rightBegin, rightEnd);
+    _getNode(parentId).m_children[static_cast<std::size_t>(SkdNode::CHILD_RIGHT)] = rightId;
+
+    return true;
+}
+
+/*!
+* Evaluate the split plane that minimizes the surface area heuristic (SAH)
+* cost of the children of the specified node.
+*
+* For each direction, the range spanned by the centroids of the cells is
+* divided into equally spaced bins and the cells are assigned to the bins
+* according to their centroid. The boundaries between the bins are the
+* candidate split planes: the cost of a candidate plane is evaluated as
+* the sum of the surface areas of the bounding boxes of the children,
+* weighted by the number of cells each child contains.
+*
+* \param nodeId is the index of the node
+* \param[out] splitDirection on output will contain the direction normal
+* to the split plane
+* \param[out] splitThreshold on output will contain the coordinate of the
+* split plane
+* \result Returns true if a valid split plane has been found, false
+* otherwise.
+*/
+bool PatchSkdTree::evalSAHSplit(std::size_t nodeId, int *splitDirection, double *splitThreshold) const
+{
+    const SkdNode &node = getNode(nodeId);
+
+    // Evaluate the range spanned by the centroids
+    std::array<double, 3> centroidMin = {{  std::numeric_limits<double>::max(),   std::numeric_limits<double>::max(),   std::numeric_limits<double>::max()}};
+    std::array<double, 3> centroidMax = {{- std::numeric_limits<double>::max(), - std::numeric_limits<double>::max(), - std::numeric_limits<double>::max()}};
+    for (std::size_t n = node.m_cellRangeBegin; n < node.m_cellRangeEnd; ++n) {
+        const std::array<double, 3> &centroid = m_patchInfo.getCachedCentroid(m_cellRawIds[n]);
+        for (int d = 0; d < 3; ++d) {
+            centroidMin[d] = std::min(centroid[d], centroidMin[d]);
+            centroidMax[d] = std::max(centroid[d], centroidMax[d]);
+        }
+    }
+
+    // Assign the cells to the bins
+    //
+    // Bins of all the directions are filled with a single pass over the
+    // cells.
+    std::array<double, 3> binScales;
+    for (int d = 0; d < 3; ++d) {
+        double centroidRange = centroidMax[d] - centroidMin[d];
+        if (centroidRange > 0.) {
+            binScales[d] = SAH_BIN_COUNT / centroidRange;
+        } else {
+            binScales[d] = 0.;
+        }
+    }
+
+    std::array<std::array<std::size_t, SAH_BIN_COUNT>, 3> binCellCounts;
+    std::array<std::array<SkdBox, SAH_BIN_COUNT>, 3> binBoxes;
+    for (int d = 0; d < 3; ++d) {
+        binCellCounts[d].fill(0);
+        binBoxes[d].fill(SkdBox());
+    }
+
+    for (std::size_t n = node.m_cellRangeBegin; n < node.m_cellRangeEnd; ++n) {
+        std::size_t cellRawId = m_cellRawIds[n];
+        const std::array<double, 3> &centroid = m_patchInfo.getCachedCentroid(cellRawId);
+        SkdBox cellBox(m_patchInfo.getCachedBoxMin(cellRawId), m_patchInfo.getCachedBoxMax(cellRawId));
+        for (int d = 0; d < 3; ++d) {
+            if (binScales[d] == 0.) {
+                continue;
             }
 
-            // If left end and and right begin are not equal, that the two ids
-            // point to misplaced elements. Swap the elements, advance the ids
-            // and continue iterating.
-            std::iter_swap(m_cellRawIds.begin() + (leftEnd - 1), m_cellRawIds.begin() + rightBegin);
+            int bin = std::min(static_cast<int>((centroid[d] - centroidMin[d]) * binScales[d]), SAH_BIN_COUNT - 1);
+            ++binCellCounts[d][bin];
+            binBoxes[d][bin].extend(cellBox);
         }
+    }
+
+    // Evaluate the best split plane
+    std::array<double, SAH_BIN_COUNT> rightAreas;
+    std::array<std::size_t, SAH_BIN_COUNT> rightCellCounts;
 
-        if (leftEnd <= leftBegin || rightEnd <= rightBegin) {
+    double bestCost = std::numeric_limits<double>::max();
+    *splitDirection = -1;
+    for (int d = 0; d < 3; ++d) {
+        if (binScales[d] == 0.) {
             continue;
         }
 
-        // Create the left child
-        //
-        // Adding new nodes may invalidate any pointer and reference to the
-        // nodes, we cannot store a reference to the parent node.
-        long leftId = m_nodes.size();
-        m_nodes.emplace_back(&m_patchInfo, leftBegin, leftEnd);
-        _getNode(parentId).m_children[static_cast<std::size_t>(SkdNode::CHILD_LEFT)] = leftId;
+        // Sweep the bins from the right to evaluate the right children
+        SkdBox rightBox;
+        std::size_t rightCellCount = 0;
+        for (int bin = SAH_BIN_COUNT - 1; bin > 0; --bin) {
+            rightBox.extend(binBoxes[d][bin]);
+            rightCellCount += binCellCounts[d][bin];
 
-        // Create the right child
-        //
-        // Adding new nodes may invalidate any pointer and reference to the
-        // nodes, we cannot store a reference to the parent node.
-        long rightId = m_nodes.size();
-        m_nodes.emplace_back(&m_patchInfo, rightBegin, rightEnd);
-        _getNode(parentId).m_children[static_cast<std::size_t>(SkdNode::CHILD_RIGHT)] = rightId;
+            rightAreas[bin]      = rightBox.evalSurfaceArea();
+            rightCellCounts[bin] = rightCellCount;
+        }
 
-        // Done
-        return;
+        // Sweep the bins from the left to evaluate the cost of the planes
+        SkdBox leftBox;
+        std::size_t leftCellCount = 0;
+        for (int bin = 0; bin < SAH_BIN_COUNT - 1; ++bin) {
+            leftBox.extend(binBoxes[d][bin]);
+            leftCellCount += binCellCounts[d][bin];
+
+            if (leftCellCount == 0 || rightCellCounts[bin + 1] == 0) {
+                continue;
+            }
+
+            double cost = leftBox.evalSurfaceArea() * leftCellCount + rightAreas[bin + 1] * rightCellCounts[bin + 1];
+            if (cost < bestCost) {
+                bestCost        = cost;
+                *splitDirection = d;
+                *splitThreshold = centroidMin[d] + (bin + 1) / binScales[d];
+            }
+        }
     }
 
-    // It was not possible to split the elements. They have all the same
-    // characteristic position and therefore they will be clustered together
-    // in a leaf node.
-    createLeaf(parentId);
+    return (*splitDirection >= 0);
 }
 
 /*!
@@ -1400,9 +2214,60 @@ void PatchSkdTree::createLeaf(std::size_t nodeId)
     const SkdNode &node = getNode(nodeId);
     std::size_t nodeCellCount = node.getCellCount();
 
+    if (m_nLeafs == 0) {
+        m_nMinLeafCells = nodeCellCount;
+        m_nMaxLeafCells = nodeCellCount;
+    } else {
+        m_nMinLeafCells = std::min(nodeCellCount, m_nMinLeafCells);
+        m_nMaxLeafCells = std::max(nodeCellCount, m_nMaxLeafCells);
+    }
     ++m_nLeafs;
-    m_nMinLeafCells = std::min(nodeCellCount, m_nMinLeafCells);
-    m_nMaxLeafCells = std::max(nodeCellCount, m_nMaxLeafCells);
+}
+
+/*!
+* Update the bounding boxes of the internal nodes.
+*
+* The bounding box of an internal node is evaluated merging the bounding
+* boxes of its children. Children are always created after their parent,
+* hence visiting the nodes in reverse order guarantees that the bounding
+* boxes of the children are updated before the one of their parent.
+*/
+void PatchSkdTree::updateInternalBoundingBoxes()
+{
+    for (std::size_t nodeId = getNodeCount(); nodeId > 0; --nodeId) {
+        SkdNode &node = _getNode(nodeId - 1);
+        if (node.isLeaf()) {
+            continue;
+        }
+
+        SkdBox box;
+        for (int i = SkdNode::CHILD_BEGIN; i != SkdNode::CHILD_END; ++i) {
+            std::size_t childId = node.getChildId(static_cast<SkdNode::ChildLocation>(i));
+            if (childId != SkdNode::NULL_ID) {
+                box.extend(getNode(childId).getBoundingBox());
+            }
+        }
+
+        node.m_boxMin = box.getBoxMin();
+        node.m_boxMax = box.getBoxMax();
+    }
+}
+
+/*!
+* Update the statistics about the leaves.
+*/
+void PatchSkdTree::updateLeafStatistics()
+{
+    m_nLeafs        = 0;
+    m_nMinLeafCells = 0;
+    m_nMaxLeafCells = 0;
+
+    std::size_t nNodes = getNodeCount();
+    for (std::size_t nodeId = 0; nodeId < nNodes; ++nodeId) {
+        if (getNode(nodeId).isLeaf()) {
+            createLeaf(nodeId);
+        }
+    }
 }
 
 /*!
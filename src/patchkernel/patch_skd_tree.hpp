@@ -38,6 +38,7 @@ friend class PatchSkdTree;
 public:
     void buildCache();
     void buildCache(const PatchKernel::CellConstRange &cellRange);
+    void buildCache(const std::vector<std::size_t> &cellRawIds);
     void destroyCache();
 
     const PatchKernel & getPatch() const;
@@ -56,6 +57,9 @@ protected:
 
     SkdPatchInfo(const PatchKernel *patch, const std::vector<std::size_t> *cellRawIds);
 
+    void initializeCache();
+    void updateCachedCell(std::size_t rawId, const Cell &cell);
+
     const PatchKernel *m_patch;
     const std::vector<std::size_t> *m_cellRawIds;
 
@@ -88,6 +92,10 @@ public:
     bool boxContainsPoint(const std::array<double,3> &point, double offset) const;
     bool boxIntersectsSphere(const std::array<double,3> &center, double radius) const;
 
+    double evalSurfaceArea() const;
+
+    void extend(const SkdBox &box);
+
 protected:
     std::array<double, 3> m_boxMin;
     std::array<double, 3> m_boxMax;
@@ -188,9 +196,22 @@ private:
 class PatchSkdTree {
 
 public:
+    /*!
+    * Strategy used for splitting the nodes while building the tree.
+    */
+    enum SplitStrategy {
+        SPLIT_WEIGHTED_MEAN, //!< Split at the weighted mean of the cell centroids
+        SPLIT_SAH            //!< Split minimizing the binned surface area heuristic
+    };
+
     virtual ~PatchSkdTree() = default;
 
+    void setSplitStrategy(SplitStrategy strategy);
+    SplitStrategy getSplitStrategy() const;
+
     void build(std::size_t leaftThreshold = 1, bool squeezeStorage = false);
+    void refit();
+    void update(const std::vector<adaption::Info> &adaptionData);
     void clear(bool release = false);
 
     const PatchKernel & getPatch() const;
@@ -204,6 +225,11 @@ public:
     const SkdNode & getNode(std::size_t nodeId) const;
 
     std::size_t evalMaxDepth(std::size_t rootId = 0) const;
+    double evalLeafMeanCellCount() const;
+    double evalSAHCost(double traversalCost = 1., double intersectionCost = 1.) const;
+
+    long findPointContainingCell(const std::array<double, 3> &point, long *id) const;
+    long findPointContainingCell(int nPoints, const std::array<double, 3> *points, long *ids) const;
 
     void enableThreadSafeLookups(bool enable);
     bool areLookupsThreadSafe() const;
@@ -222,8 +248,12 @@ protected:
 
     std::vector<SkdNode, SkdNode::Allocator> m_nodes;
 
+    std::size_t m_leafThreshold;
+
     bool m_interiorCellsOnly;
 
+    SplitStrategy m_splitStrategy;
+
     bool m_threadSafeLookups;                                       /*! Controls if the tree lookups should be thread safe */
 
 #if BITPIT_ENABLE_MPI
@@ -237,6 +267,8 @@ protected:
 
     SkdNode & _getNode(std::size_t nodeId);
 
+    virtual bool isPointInsideCell(long id, const std::array<double, 3> &point) const;
+
 #if BITPIT_ENABLE_MPI
     bool isCommunicatorSet() const;
     const MPI_Comm & getCommunicator() const;
@@ -245,9 +277,21 @@ protected:
 #endif
 
 private:
+    static const int MAX_WALK_STEPS = 16;
+    static const int SAH_BIN_COUNT = 16;
+
+    mutable std::vector<std::size_t> m_lookupNodeStack;
+
     void createChildren(std::size_t parentId, std::size_t leaftThreshold);
+    bool splitNode(std::size_t parentId, int splitDirection, double splitThreshold);
+    bool evalSAHSplit(std::size_t nodeId, int *splitDirection, double *splitThreshold) const;
     void createLeaf(std::size_t nodeId);
 
+    void updateInternalBoundingBoxes();
+    void updateLeafStatistics();
+
+    long walkPointContainingCell(const std::array<double, 3> &point, long startId, long *id) const;
+
 #if BITPIT_ENABLE_MPI
     void buildPartitionBoxes();
 #endif
@@ -441,10 +441,21 @@ long SurfaceSkdTree::findPointClosestCell(const std::array<double, 3> &point, do
 
         // If the node is a leaf add it to the candidates, otherwise add its
         // children to the stack.
+        //
+        // The child closer to the point is added last, this way it will be
+        // visited first and the distance estimate will be tightened earlier.
+        std::size_t leftId  = node.getChildId(SkdNode::CHILD_LEFT);
+        std::size_t rightId = node.getChildId(SkdNode::CHILD_RIGHT);
+        if (leftId != SkdNode::NULL_ID && rightId != SkdNode::NULL_ID) {
+            double leftMinSquareDistance  = m_nodes[leftId].evalPointMinSquareDistance(point);
+            double rightMinSquareDistance = m_nodes[rightId].evalPointMinSquareDistance(point);
+            if (leftMinSquareDistance < rightMinSquareDistance) {
+                std::swap(leftId, rightId);
+            }
+        }
+
         bool isLeaf = true;
-        for (int i = SkdNode::CHILD_BEGIN; i != SkdNode::CHILD_END; ++i) {
-            SkdNode::ChildLocation childLocation = static_cast<SkdNode::ChildLocation>(i);
-            std::size_t childId = node.getChildId(childLocation);
+        for (std::size_t childId : {leftId, rightId}) {
             if (childId != SkdNode::NULL_ID) {
                 isLeaf = false;
                 nodeStack->push_back(childId);
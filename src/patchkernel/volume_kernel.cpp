@@ -182,6 +182,106 @@ void VolumeKernel::extractEnvelope(SurfaceKernel &envelope) const
 	PatchKernel::extractEnvelope(envelope);
 }
 
+/*!
+	Evaluates the volumes of all the cells of the patch.
+
+	The default implementation evaluates the volume of each cell calling
+	evalCellVolume, patches can provide a specialized implementation that
+	evaluates the volumes in bulk.
+
+	\param[out] volumes is the storage that will be filled with the volumes
+	of the cells, the storage should be associated with the kernel of the
+	cells of the patch
+*/
+void VolumeKernel::evalCellVolumes(PiercedStorage<double, long> *volumes) const
+{
+	if (volumes->getKernel() != &m_cells) {
+		throw std::runtime_error("The storage is not associated with the cells of the patch.");
+	}
+
+	CellConstIterator endItr = cellConstEnd();
+	for (CellConstIterator itr = cellConstBegin(); itr != endItr; ++itr) {
+		volumes->rawAt(itr.getRawIndex()) = evalCellVolume(itr.getId());
+	}
+}
+
+/*!
+	Gets the cached volumes of the cells.
+
+	The cache is handled as the cache of the cell centroids, see
+	PatchKernel::getCachedCellCentroids for further details.
+
+	\result The cached volumes of the cells.
+*/
+const PiercedStorage<double, long> & VolumeKernel::getCachedCellVolumes() const
+{
+	updateCellGeometryCache();
+
+	return m_cellVolumesCache;
+}
+
+/*!
+	Evaluates the areas of all the interfaces of the patch.
+
+	The default implementation evaluates the area of each interface calling
+	evalInterfaceArea, patches can provide a specialized implementation that
+	evaluates the areas in bulk.
+
+	\param[out] areas is the storage that will be filled with the areas of
+	the interfaces, the storage should be associated with the kernel of the
+	interfaces of the patch
+*/
+void VolumeKernel::evalInterfaceAreas(PiercedStorage<double, long> *areas) const
+{
+	if (areas->getKernel() != &m_interfaces) {
+		throw std::runtime_error("The storage is not associated with the interfaces of the patch.");
+	}
+
+	InterfaceConstIterator endItr = interfaceConstEnd();
+	for (InterfaceConstIterator itr = interfaceConstBegin(); itr != endItr; ++itr) {
+		areas->rawAt(itr.getRawIndex()) = evalInterfaceArea(itr.getId());
+	}
+}
+
+/*!
+	Evaluates the normals of all the interfaces of the patch.
+
+	The default implementation evaluates the normal of each interface calling
+	evalInterfaceNormal, patches can provide a specialized implementation that
+	evaluates the normals in bulk.
+
+	\param[out] normals is the storage that will be filled with the normals
+	of the interfaces, the storage should be associated with the kernel of
+	the interfaces of the patch
+*/
+void VolumeKernel::evalInterfaceNormals(PiercedStorage<std::array<double, 3>, long> *normals) const
+{
+	if (normals->getKernel() != &m_interfaces) {
+		throw std::runtime_error("The storage is not associated with the interfaces of the patch.");
+	}
+
+	InterfaceConstIterator endItr = interfaceConstEnd();
+	for (InterfaceConstIterator itr = interfaceConstBegin(); itr != endItr; ++itr) {
+		normals->rawAt(itr.getRawIndex()) = evalInterfaceNormal(itr.getId());
+	}
+}
+
+/*!
+	Internal function to update the cell geometry cache.
+
+	In addition to the information cached by the base class, the volumes of
+	the cells are cached.
+*/
+void VolumeKernel::_updateCellGeometryCache() const
+{
+	PatchKernel::_updateCellGeometryCache();
+
+	m_cellVolumesCache.unsetKernel(true);
+	m_cellVolumesCache.setStaticKernel(&m_cells);
+
+	evalCellVolumes(&m_cellVolumesCache);
+}
+
 /*!
 	Checks if the specified point is inside the patch.
 
@@ -46,9 +46,13 @@ public:
 	virtual bool isPointInside(long id, const std::array<double, 3> &point) const = 0;
 
 	virtual double evalCellVolume(long id)const = 0;
+	virtual void evalCellVolumes(PiercedStorage<double, long> *volumes) const;
+	const PiercedStorage<double, long> & getCachedCellVolumes() const;
 
 	virtual double evalInterfaceArea(long id)const = 0;
         virtual std::array<double,3> evalInterfaceNormal(long id)const = 0;
+	virtual void evalInterfaceAreas(PiercedStorage<double, long> *areas) const;
+	virtual void evalInterfaceNormals(PiercedStorage<std::array<double, 3>, long> *normals) const;
 
 protected:
 #if BITPIT_ENABLE_MPI==1
@@ -61,6 +65,11 @@ protected:
 	VolumeKernel(int id, int dimension, bool expert);
 #endif
 
+	void _updateCellGeometryCache() const override;
+
+private:
+	mutable PiercedStorage<double, long> m_cellVolumesCache;
+
 };
 
 }
@@ -101,6 +101,8 @@ struct Info
 
 class VolumeMapper {
 
+friend class VolumeTransferOperator;
+
 public:
     virtual ~VolumeMapper() = default;
 
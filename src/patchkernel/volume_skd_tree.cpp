@@ -44,4 +44,20 @@ VolumeSkdTree::VolumeSkdTree(const VolumeKernel *patch, bool interiorCellsOnly)
 {
 }
 
+/*!
+* Checks if the specified point is inside the given cell.
+*
+* The check is delegated to the patch.
+*
+* \param id is the id of the cell
+* \param point is the point
+* \result Returns true if the point is inside the cell, false otherwise.
+*/
+bool VolumeSkdTree::isPointInsideCell(long id, const std::array<double, 3> &point) const
+{
+    const VolumeKernel &patch = static_cast<const VolumeKernel &>(getPatch());
+
+    return patch.isPointInside(id, point);
+}
+
 }
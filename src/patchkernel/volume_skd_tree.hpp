@@ -35,6 +35,9 @@ class VolumeSkdTree : public PatchSkdTree {
 public:
     VolumeSkdTree(const VolumeKernel *patch, bool interiorCellsOnly = false);
 
+protected:
+    bool isPointInsideCell(long id, const std::array<double, 3> &point) const override;
+
 };
 
 }
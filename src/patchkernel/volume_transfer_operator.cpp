@@ -0,0 +1,514 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <cassert>
+#include <map>
+#include <unordered_map>
+
+#include "bitpit_common.hpp"
+
+#include "volume_mapper.hpp"
+#include "volume_transfer_operator.hpp"
+
+namespace bitpit {
+
+/**
+ * \class VolumeTransferOperator
+ * \ingroup volumepatches
+ *
+ * \brief The VolumeTransferOperator is a sparse linear operator that
+ * transfers cell fields from the mapped mesh to the reference mesh of a
+ * VolumeMapper.
+ *
+ * The weights of the transfer are evaluated once from the mapping info of
+ * the mapper and are stored in compressed sparse row format: each row is
+ * associated with a cell of the reference mesh and each column with a cell
+ * of the mapped mesh. The operator can then be applied to any number of
+ * fields and time steps without looking at the mapping again.
+ *
+ * Two kinds of weights are available:
+ *  - volume fraction weights, suitable for intensive quantities, evaluate
+ *    the target value as the volume average of the overlapping source
+ *    values;
+ *  - conservative weights, suitable for extensive quantities, distribute
+ *    the source values among the target cells proportionally to the
+ *    overlapping volumes, hence the integral of the field is preserved.
+ *
+ * When the meshes have different partitionings, values of the mapped cells
+ * owned by other processes are exchanged using a persistent communicator
+ * set up when the operator is built.
+ *
+ * The operator references cells through their raw indexes, therefore it
+ * remains valid as long as the two meshes are not modified. The operator can
+ * be dumped and restored, allowing to reuse the weights across runs that
+ * work on the same meshes.
+ */
+
+/**
+ * Default constructor.
+ */
+VolumeTransferOperator::VolumeTransferOperator()
+    : m_weights(mapping::TRANSFER_VOLUME_FRACTION)
+#if BITPIT_ENABLE_MPI
+      , m_communicator(MPI_COMM_NULL), m_exchangeItemSize(0)
+#endif
+{
+    m_rowOffsets.push_back(0);
+}
+
+/**
+ * Constructor.
+ *
+ * \param[in] mapper is the mapper whose mapping will be used to build the
+ * operator, the mapping should have already been initialized
+ * \param[in] weights are the weights that will be used by the operator
+ */
+VolumeTransferOperator::VolumeTransferOperator(VolumeMapper *mapper, mapping::TransferWeights weights)
+    : VolumeTransferOperator()
+{
+    build(mapper, weights);
+}
+
+/**
+ * Destructor.
+ */
+VolumeTransferOperator::~VolumeTransferOperator()
+{
+#if BITPIT_ENABLE_MPI
+    m_exchangeCommunicator.reset();
+
+    freeCommunicator();
+#endif
+}
+
+/**
+ * Build the operator using the mapping info of the specified mapper.
+ *
+ * The mapping info describes how the cells of the reference mesh are
+ * related to the cells of the mapped mesh: a renumbered cell receives the
+ * value of its mapped cell, a refined cell (i.e., a reference cell finer
+ * than the mapped one) receives the value of the cell that contains it and
+ * a coarsened cell (i.e., a reference cell coarser than the mapped ones)
+ * receives a combination of the values of the cells it contains.
+ *
+ * \param[in] mapper is the mapper whose mapping will be used to build the
+ * operator, the mapping should have already been initialized
+ * \param[in] weights are the weights that will be used by the operator
+ */
+void VolumeTransferOperator::build(VolumeMapper *mapper, mapping::TransferWeights weights)
+{
+    clear();
+
+    m_weights = weights;
+
+    const VolumeKernel *referencePatch = mapper->m_referencePatch;
+    const VolumeKernel *mappedPatch    = mapper->m_mappedPatch;
+
+    const PiercedVector<Cell, long> &referenceCells = referencePatch->getCells();
+    const PiercedVector<Cell, long> &mappedCells    = mappedPatch->getCells();
+
+    const PiercedStorage<mapping::Info> &mapping = mapper->getMapping();
+
+#if BITPIT_ENABLE_MPI
+    // Initialize communicator
+    initializeCommunicator(mapper->getCommunicator());
+
+    int rank = mapper->m_rank;
+#endif
+
+    // Identify local columns
+    //
+    // Only the mapped cells that contribute to at least one reference cell
+    // are associated with a column.
+    std::unordered_map<long, std::size_t> localColumns;
+    for (auto itr = referenceCells.cbegin(); itr != referenceCells.cend(); ++itr) {
+        const mapping::Info &info = mapping.rawAt(itr.getRawIndex());
+        std::size_t nMappedIds = info.ids.size();
+        for (std::size_t n = 0; n < nMappedIds; ++n) {
+#if BITPIT_ENABLE_MPI
+            if (info.ranks[n] != rank) {
+                continue;
+            }
+#endif
+
+            long mappedId = info.ids[n];
+            if (localColumns.count(mappedId) > 0) {
+                continue;
+            }
+
+            localColumns.insert({mappedId, m_localColumnRawIndexes.size()});
+            m_localColumnRawIndexes.push_back(mappedCells.getRawIndex(mappedId));
+        }
+    }
+
+    std::size_t nLocalColumns = m_localColumnRawIndexes.size();
+
+#if BITPIT_ENABLE_MPI
+    // Identify remote columns
+    //
+    // The order of the received cells is the one defined by the mapper, it
+    // is the same order used by the owners of the cells to send them.
+    std::unordered_map<int, std::unordered_map<long, std::size_t>> remoteColumns;
+
+    m_recvOffsets.push_back(0);
+    for (const auto &rankEntry : mapper->getReceivedMappedIds()) {
+        const std::vector<long> &rankIds = rankEntry.second;
+        if (rankIds.empty()) {
+            continue;
+        }
+
+        int recvRank = rankEntry.first;
+        std::unordered_map<long, std::size_t> &rankColumns = remoteColumns[recvRank];
+        for (long mappedId : rankIds) {
+            rankColumns.insert({mappedId, nLocalColumns + m_recvOffsets.back() + rankColumns.size()});
+        }
+
+        m_recvRanks.push_back(recvRank);
+        m_recvOffsets.push_back(m_recvOffsets.back() + rankIds.size());
+    }
+
+    m_sendOffsets.push_back(0);
+    for (const auto &rankEntry : mapper->getSentMappedIds()) {
+        const std::vector<long> &rankIds = rankEntry.second;
+        if (rankIds.empty()) {
+            continue;
+        }
+
+        for (long mappedId : rankIds) {
+            m_sendRawIndexes.push_back(mappedCells.getRawIndex(mappedId));
+        }
+
+        m_sendRanks.push_back(rankEntry.first);
+        m_sendOffsets.push_back(m_sendRawIndexes.size());
+    }
+
+    // Initialize the exchange
+    initializeExchange();
+#endif
+
+    // Gather the volumes of the mapped cells
+    std::vector<double> columnVolumes;
+    gatherColumnValues(mappedPatch->getCachedCellVolumes(), &columnVolumes);
+
+    // Evaluate the weights
+    const PiercedStorage<double, long> &referenceVolumes = referencePatch->getCachedCellVolumes();
+    for (auto itr = referenceCells.cbegin(); itr != referenceCells.cend(); ++itr) {
+        std::size_t rawIndex = itr.getRawIndex();
+        const mapping::Info &info = mapping.rawAt(rawIndex);
+        if (info.type == mapping::TYPE_UNKNOWN || info.ids.empty()) {
+            continue;
+        }
+
+        double referenceVolume = referenceVolumes.rawAt(rawIndex);
+        std::size_t nMappedIds = info.ids.size();
+        for (std::size_t n = 0; n < nMappedIds; ++n) {
+            long mappedId = info.ids[n];
+
+            std::size_t column;
+#if BITPIT_ENABLE_MPI
+            int mappedRank = info.ranks[n];
+            if (mappedRank != rank) {
+                column = remoteColumns.at(mappedRank).at(mappedId);
+            } else {
+                column = localColumns.at(mappedId);
+            }
+#else
+            column = localColumns.at(mappedId);
+#endif
+
+            double weight;
+            switch (info.type) {
+
+            case mapping::TYPE_RENUMBERING:
+                weight = 1.;
+                break;
+
+            case mapping::TYPE_REFINEMENT:
+                if (m_weights == mapping::TRANSFER_CONSERVATIVE) {
+                    weight = referenceVolume / columnVolumes[column];
+                } else {
+                    weight = 1.;
+                }
+                break;
+
+            case mapping::TYPE_COARSENING:
+                if (m_weights == mapping::TRANSFER_CONSERVATIVE) {
+                    weight = 1.;
+                } else {
+                    weight = columnVolumes[column] / referenceVolume;
+                }
+                break;
+
+            default:
+                throw std::runtime_error("Unsupported mapping type.");
+
+            }
+
+            m_columns.push_back(column);
+            m_values.push_back(weight);
+        }
+
+        m_rowRawIndexes.push_back(rawIndex);
+        m_rowOffsets.push_back(m_columns.size());
+    }
+}
+
+/**
+ * Clear the operator.
+ */
+void VolumeTransferOperator::clear()
+{
+    m_rowRawIndexes.clear();
+    m_rowOffsets.assign(1, 0);
+    m_columns.clear();
+    m_values.clear();
+
+    m_localColumnRawIndexes.clear();
+
+#if BITPIT_ENABLE_MPI
+    m_sendRanks.clear();
+    m_sendOffsets.clear();
+    m_sendRawIndexes.clear();
+
+    m_recvRanks.clear();
+    m_recvOffsets.clear();
+
+    m_exchangeCommunicator.reset();
+    m_exchangeItemSize = 0;
+
+    freeCommunicator();
+#endif
+}
+
+/**
+ * Checks if the operator is empty.
+ *
+ * \result Returns true if the operator is empty, false otherwise.
+ */
+bool VolumeTransferOperator::isEmpty() const
+{
+    return m_rowRawIndexes.empty();
+}
+
+/**
+ * Get the weights used by the operator.
+ *
+ * \result The weights used by the operator.
+ */
+mapping::TransferWeights VolumeTransferOperator::getWeights() const
+{
+    return m_weights;
+}
+
+/**
+ * Get the number of rows of the operator.
+ *
+ * \result The number of rows of the operator.
+ */
+std::size_t VolumeTransferOperator::getRowCount() const
+{
+    return m_rowRawIndexes.size();
+}
+
+/**
+ * Get the number of columns of the operator.
+ *
+ * Columns include both local and remote source cells.
+ *
+ * \result The number of columns of the operator.
+ */
+std::size_t VolumeTransferOperator::getColumnCount() const
+{
+    std::size_t nColumns = m_localColumnRawIndexes.size();
+#if BITPIT_ENABLE_MPI
+    if (!m_recvOffsets.empty()) {
+        nColumns += m_recvOffsets.back();
+    }
+#endif
+
+    return nColumns;
+}
+
+/**
+ * Get the number of non-zero weights of the operator.
+ *
+ * \result The number of non-zero weights of the operator.
+ */
+std::size_t VolumeTransferOperator::getNonZeroCount() const
+{
+    return m_values.size();
+}
+
+/**
+ * Write the operator to the specified stream.
+ *
+ * \param stream is the stream to write to
+ */
+void VolumeTransferOperator::dump(std::ostream &stream) const
+{
+    utils::binary::write(stream, static_cast<int>(m_weights));
+
+    utils::binary::write(stream, m_rowRawIndexes);
+    utils::binary::write(stream, m_rowOffsets);
+    utils::binary::write(stream, m_columns);
+    utils::binary::write(stream, m_values);
+
+    utils::binary::write(stream, m_localColumnRawIndexes);
+
+#if BITPIT_ENABLE_MPI
+    utils::binary::write(stream, m_sendRanks);
+    utils::binary::write(stream, m_sendOffsets);
+    utils::binary::write(stream, m_sendRawIndexes);
+
+    utils::binary::write(stream, m_recvRanks);
+    utils::binary::write(stream, m_recvOffsets);
+#else
+    utils::binary::write(stream, std::vector<int>());
+    utils::binary::write(stream, std::vector<std::size_t>());
+    utils::binary::write(stream, std::vector<std::size_t>());
+
+    utils::binary::write(stream, std::vector<int>());
+    utils::binary::write(stream, std::vector<std::size_t>());
+#endif
+}
+
+/**
+ * Restore the operator from the specified stream.
+ *
+ * The operator can only be applied to the same meshes it was built with.
+ *
+ * \param stream is the stream to read from
+ */
+#if BITPIT_ENABLE_MPI
+/**
+ * \param communicator is the MPI communicator that will be used to exchange
+ * data among the processes, it should be equivalent to the communicator of
+ * the mapper the operator was built with. A valid communicator is mandatory
+ * if the operator was built from meshes with different partitionings.
+ */
+void VolumeTransferOperator::restore(std::istream &stream, MPI_Comm communicator)
+#else
+void VolumeTransferOperator::restore(std::istream &stream)
+#endif
+{
+    clear();
+
+    int weights;
+    utils::binary::read(stream, weights);
+    m_weights = static_cast<mapping::TransferWeights>(weights);
+
+    utils::binary::read(stream, m_rowRawIndexes);
+    utils::binary::read(stream, m_rowOffsets);
+    utils::binary::read(stream, m_columns);
+    utils::binary::read(stream, m_values);
+
+    utils::binary::read(stream, m_localColumnRawIndexes);
+
+    std::vector<int> sendRanks;
+    std::vector<std::size_t> sendOffsets;
+    std::vector<std::size_t> sendRawIndexes;
+    utils::binary::read(stream, sendRanks);
+    utils::binary::read(stream, sendOffsets);
+    utils::binary::read(stream, sendRawIndexes);
+
+    std::vector<int> recvRanks;
+    std::vector<std::size_t> recvOffsets;
+    utils::binary::read(stream, recvRanks);
+    utils::binary::read(stream, recvOffsets);
+
+#if BITPIT_ENABLE_MPI
+    m_sendRanks.swap(sendRanks);
+    m_sendOffsets.swap(sendOffsets);
+    m_sendRawIndexes.swap(sendRawIndexes);
+
+    m_recvRanks.swap(recvRanks);
+    m_recvOffsets.swap(recvOffsets);
+
+    if (communicator != MPI_COMM_NULL) {
+        initializeCommunicator(communicator);
+        initializeExchange();
+    } else if (!m_sendRanks.empty() || !m_recvRanks.empty()) {
+        throw std::runtime_error("A valid communicator is needed to restore a transfer operator that exchanges data.");
+    }
+#else
+    if (!sendRanks.empty() || !recvRanks.empty()) {
+        throw std::runtime_error("Unable to restore a transfer operator that exchanges data in a serial build.");
+    }
+#endif
+}
+
+#if BITPIT_ENABLE_MPI
+/**
+ * Initialize the MPI communicator to be used for parallel communications.
+ *
+ * \param communicator is the communicator.
+ */
+void VolumeTransferOperator::initializeCommunicator(MPI_Comm communicator)
+{
+    freeCommunicator();
+
+    MPI_Comm_dup(communicator, &m_communicator);
+}
+
+/**
+ * Frees the MPI communicator associated to the operator.
+ */
+void VolumeTransferOperator::freeCommunicator()
+{
+    if (m_communicator == MPI_COMM_NULL) {
+        return;
+    }
+
+    int finalizedCalled;
+    MPI_Finalized(&finalizedCalled);
+    if (finalizedCalled) {
+        return;
+    }
+
+    MPI_Comm_free(&m_communicator);
+}
+
+/**
+ * Initialize the persistent communicator used to exchange the values of
+ * the remote columns.
+ *
+ * Buffers are sized when the operator is applied, since their size depends
+ * on the type and on the number of the transferred fields.
+ */
+void VolumeTransferOperator::initializeExchange()
+{
+    m_exchangeCommunicator = std::unique_ptr<DataCommunicator>(new DataCommunicator(m_communicator));
+    for (int rank : m_sendRanks) {
+        m_exchangeCommunicator->setSend(rank, 0);
+    }
+
+    for (int rank : m_recvRanks) {
+        m_exchangeCommunicator->setRecv(rank, 0);
+    }
+
+    m_exchangeItemSize = 0;
+}
+#endif
+
+}
@@ -0,0 +1,133 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#ifndef __BITPIT_VOLUME_TRANSFER_OPERATOR_HPP__
+#define __BITPIT_VOLUME_TRANSFER_OPERATOR_HPP__
+
+#if BITPIT_ENABLE_MPI
+#    include <mpi.h>
+#endif
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#if BITPIT_ENABLE_MPI
+#    include "bitpit_communications.hpp"
+#endif
+#include "bitpit_containers.hpp"
+
+#include "volume_kernel.hpp"
+
+namespace bitpit {
+
+class VolumeMapper;
+
+namespace mapping
+{
+
+/*!
+* Weights used for transferring fields between mapped meshes.
+*/
+enum TransferWeights {
+    TRANSFER_VOLUME_FRACTION = 0,
+    TRANSFER_CONSERVATIVE
+};
+
+}
+
+class VolumeTransferOperator {
+
+public:
+    VolumeTransferOperator();
+    VolumeTransferOperator(VolumeMapper *mapper, mapping::TransferWeights weights = mapping::TRANSFER_VOLUME_FRACTION);
+
+    VolumeTransferOperator(const VolumeTransferOperator &other) = delete;
+    VolumeTransferOperator & operator=(const VolumeTransferOperator &other) = delete;
+
+    virtual ~VolumeTransferOperator();
+
+    void build(VolumeMapper *mapper, mapping::TransferWeights weights = mapping::TRANSFER_VOLUME_FRACTION);
+    void clear();
+
+    bool isEmpty() const;
+
+    mapping::TransferWeights getWeights() const;
+    std::size_t getRowCount() const;
+    std::size_t getColumnCount() const;
+    std::size_t getNonZeroCount() const;
+
+    template<typename T>
+    void apply(const PiercedStorage<T, long> &source, PiercedStorage<T, long> *target) const;
+
+    void dump(std::ostream &stream) const;
+#if BITPIT_ENABLE_MPI
+    void restore(std::istream &stream, MPI_Comm communicator = MPI_COMM_NULL);
+#else
+    void restore(std::istream &stream);
+#endif
+
+private:
+    mapping::TransferWeights m_weights;                 /**< Weights used by the operator. */
+
+    std::vector<std::size_t> m_rowRawIndexes;           /**< Raw indexes of the target cells associated with the rows. */
+    std::vector<std::size_t> m_rowOffsets;              /**< Offsets of the rows in the column/value arrays. */
+    std::vector<std::size_t> m_columns;                 /**< Columns of the non-zero weights. */
+    std::vector<double> m_values;                       /**< Values of the non-zero weights. */
+
+    std::vector<std::size_t> m_localColumnRawIndexes;   /**< Raw indexes of the local source cells associated with the
+                                                             leading columns. Remaining columns are associated with the
+                                                             source cells received from other processes. */
+
+#if BITPIT_ENABLE_MPI
+    MPI_Comm m_communicator;                            /**< MPI communicator */
+
+    std::vector<int> m_sendRanks;                       /**< Ranks of the processes the source data is sent to. */
+    std::vector<std::size_t> m_sendOffsets;             /**< Offsets of the send lists. */
+    std::vector<std::size_t> m_sendRawIndexes;          /**< Raw indexes of the source cells to be sent. */
+
+    std::vector<int> m_recvRanks;                       /**< Ranks of the processes the source data is received from. */
+    std::vector<std::size_t> m_recvOffsets;             /**< Offsets of the received data among the remote columns. */
+
+    mutable std::unique_ptr<DataCommunicator> m_exchangeCommunicator;   /**< Persistent communicator for the source data. */
+    mutable std::size_t m_exchangeItemSize;                             /**< Size, expressed in bytes, of the exchanged items. */
+#endif
+
+    template<typename T>
+    void gatherColumnValues(const PiercedStorage<T, long> &source, std::vector<T> *columnValues) const;
+
+#if BITPIT_ENABLE_MPI
+    void initializeCommunicator(MPI_Comm communicator);
+    void freeCommunicator();
+
+    void initializeExchange();
+#endif
+
+};
+
+}
+
+// Template implementation
+#include "volume_transfer_operator.tpp"
+
+#endif
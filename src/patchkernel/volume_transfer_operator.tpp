@@ -0,0 +1,173 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#ifndef __BITPIT_VOLUME_TRANSFER_OPERATOR_TPP__
+#define __BITPIT_VOLUME_TRANSFER_OPERATOR_TPP__
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace bitpit {
+
+/**
+ * Transfer the specified source field to the target field.
+ *
+ * The source field has to be defined on the cells of the mapped mesh and the
+ * target field on the cells of the reference mesh, using the same meshes the
+ * operator was built with. Only the target values associated with mapped
+ * cells are updated. All the fields stored in the storages are transferred
+ * at once.
+ *
+ * \param[in] source is the source field
+ * \param[out] target is the target field
+ */
+template<typename T>
+void VolumeTransferOperator::apply(const PiercedStorage<T, long> &source, PiercedStorage<T, long> *target) const
+{
+    // Check fields
+    std::size_t nFields = source.getFieldCount();
+    if (target->getFieldCount() != nFields) {
+        throw std::runtime_error("Source and target fields should have the same number of fields.");
+    }
+
+    // Gather values of the columns
+    std::vector<T> columnValues;
+    gatherColumnValues(source, &columnValues);
+
+    // Evaluate target values
+    std::size_t nRows = m_rowRawIndexes.size();
+    for (std::size_t row = 0; row < nRows; ++row) {
+        std::size_t rowBegin = m_rowOffsets[row];
+        std::size_t rowEnd   = m_rowOffsets[row + 1];
+
+        T *targetValues = target->rawData(m_rowRawIndexes[row]);
+        for (std::size_t k = 0; k < nFields; ++k) {
+            targetValues[k] = m_values[rowBegin] * columnValues[nFields * m_columns[rowBegin] + k];
+        }
+
+        for (std::size_t n = rowBegin + 1; n < rowEnd; ++n) {
+            double weight = m_values[n];
+            const T *rowColumnValues = columnValues.data() + nFields * m_columns[n];
+            for (std::size_t k = 0; k < nFields; ++k) {
+                targetValues[k] += weight * rowColumnValues[k];
+            }
+        }
+    }
+}
+
+/**
+ * Gather the source values associated with the columns of the operator.
+ *
+ * Values of the local columns are copied from the source storage, values
+ * of the remote columns are received from the processes that own them.
+ *
+ * \param[in] source is the source field
+ * \param[out] columnValues on output will contain the values associated
+ * with the columns, values of the fields of each column are contiguous
+ */
+template<typename T>
+void VolumeTransferOperator::gatherColumnValues(const PiercedStorage<T, long> &source, std::vector<T> *columnValues) const
+{
+    std::size_t nFields = source.getFieldCount();
+    std::size_t nLocalColumns = m_localColumnRawIndexes.size();
+
+    columnValues->resize(nFields * getColumnCount());
+
+#if BITPIT_ENABLE_MPI
+    // Start the exchange of remote values
+    if (m_exchangeCommunicator) {
+        // Update the size of the buffers
+        std::size_t itemSize = nFields * sizeof(T);
+        if (itemSize != m_exchangeItemSize) {
+            m_exchangeCommunicator->cancelAllRecvs(false);
+            m_exchangeCommunicator->cancelAllSends(false);
+
+            std::size_t nSendRanks = m_sendRanks.size();
+            for (std::size_t i = 0; i < nSendRanks; ++i) {
+                std::size_t nItems = m_sendOffsets[i + 1] - m_sendOffsets[i];
+                m_exchangeCommunicator->resizeSend(m_sendRanks[i], nItems * itemSize);
+            }
+
+            std::size_t nRecvRanks = m_recvRanks.size();
+            for (std::size_t i = 0; i < nRecvRanks; ++i) {
+                std::size_t nItems = m_recvOffsets[i + 1] - m_recvOffsets[i];
+                m_exchangeCommunicator->resizeRecv(m_recvRanks[i], nItems * itemSize);
+            }
+
+            m_exchangeItemSize = itemSize;
+        }
+
+        // Start receives
+        m_exchangeCommunicator->startAllRecvs();
+
+        // Fill send buffers and start sends
+        std::size_t nSendRanks = m_sendRanks.size();
+        for (std::size_t i = 0; i < nSendRanks; ++i) {
+            int rank = m_sendRanks[i];
+            m_exchangeCommunicator->waitSend(rank);
+
+            SendBuffer &buffer = m_exchangeCommunicator->getSendBuffer(rank);
+            buffer.seekg(0);
+            for (std::size_t n = m_sendOffsets[i]; n < m_sendOffsets[i + 1]; ++n) {
+                const T *sourceValues = source.rawData(m_sendRawIndexes[n]);
+                for (std::size_t k = 0; k < nFields; ++k) {
+                    buffer << sourceValues[k];
+                }
+            }
+
+            m_exchangeCommunicator->startSend(rank);
+        }
+    }
+#endif
+
+    // Gather local values
+    for (std::size_t column = 0; column < nLocalColumns; ++column) {
+        const T *sourceValues = source.rawData(m_localColumnRawIndexes[column]);
+        std::copy_n(sourceValues, nFields, columnValues->data() + nFields * column);
+    }
+
+#if BITPIT_ENABLE_MPI
+    // Receive remote values
+    if (m_exchangeCommunicator) {
+        std::size_t nRecvRanks = m_recvRanks.size();
+        for (std::size_t i = 0; i < nRecvRanks; ++i) {
+            int rank = m_exchangeCommunicator->waitAnyRecv();
+            std::size_t rankIndex = std::distance(m_recvRanks.begin(), std::find(m_recvRanks.begin(), m_recvRanks.end(), rank));
+
+            RecvBuffer &buffer = m_exchangeCommunicator->getRecvBuffer(rank);
+            T *rankValues = columnValues->data() + nFields * (nLocalColumns + m_recvOffsets[rankIndex]);
+            std::size_t nRankValues = nFields * (m_recvOffsets[rankIndex + 1] - m_recvOffsets[rankIndex]);
+            for (std::size_t n = 0; n < nRankValues; ++n) {
+                buffer >> rankValues[n];
+            }
+        }
+
+        m_exchangeCommunicator->waitAllSends();
+    }
+#endif
+}
+
+}
+
+#endif
@@ -59,6 +59,7 @@ public:
 
     // Search algorithms
     long locatePoint(const std::array<double, 3> &point) const override;
+    void locatePoints(int nPoints, const std::array<double, 3> *points, long *ids) const override;
 
     // Evaluations
     void extractEdgeNetwork(LineUnstructured &net);
@@ -78,6 +79,8 @@ protected:
     void _dump(std::ostream &stream) const override;
     void _restore(std::istream &stream) override;
 
+    std::unique_ptr<PatchSkdTree> _createPointLocationTree() const override;
+
     static ElementType getDGFFacetType(int nFacetVertices);
 
     int exportSTLSingle(const std::string &name, bool isBinary);
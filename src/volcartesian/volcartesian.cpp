@@ -2262,6 +2262,30 @@ std::array<double, 3> VolCartesian::evalCellCentroid(long id) const
 	return evalCellCentroid(ijk);
 }
 
+/*!
+	Evaluates the centroids of all the cells of the patch.
+
+	Centroids are evaluated from the cartesian indices of the cells, looping
+	over the cells in storage order.
+
+	\param[out] centroids is the storage that will be filled with the
+	centroids of the cells, the storage should be associated with the
+	kernel of the cells of the patch
+*/
+void VolCartesian::evalCellCentroids(PiercedStorage<std::array<double, 3>, long> *centroids) const
+{
+	if (centroids->getKernel() != &m_cells) {
+		throw std::runtime_error("The storage is not associated with the cells of the patch.");
+	}
+
+	CellConstIterator endItr = cellConstEnd();
+	for (CellConstIterator itr = cellConstBegin(); itr != endItr; ++itr) {
+		std::array<int, 3> ijk = getCellCartesianId(itr.getId());
+
+		centroids->rawAt(itr.getRawIndex()) = evalCellCentroid(ijk);
+	}
+}
+
 /*!
 	Evaluates the centroid of the specified cell.
 
@@ -91,6 +91,7 @@ public:
 	double evalCellSize(const std::array<int, 3> &ijk) const;
 	std::array<double, 3> evalCellCentroid(long id) const override;
 	std::array<double, 3> evalCellCentroid(const std::array<int, 3> &ijk) const;
+	void evalCellCentroids(PiercedStorage<std::array<double, 3>, long> *centroids) const override;
 	const std::vector<double> & getCellCentroids(int direction) const;
 
 	void evalCellBoundingBox(long id, std::array<double,3> *minPoint, std::array<double,3> *maxPoint) const override;
@@ -700,6 +700,31 @@ double VolOctree::evalCellVolume(long id) const
 	return m_tree->getVolume(octant);
 }
 
+/*!
+	Evaluates the volumes of all the cells of the patch.
+
+	Volumes are evaluated directly from the octants associated with the
+	cells, looping over the cells in storage order.
+
+	\param[out] volumes is the storage that will be filled with the volumes
+	of the cells, the storage should be associated with the kernel of the
+	cells of the patch
+*/
+void VolOctree::evalCellVolumes(PiercedStorage<double, long> *volumes) const
+{
+	if (volumes->getKernel() != &m_cells) {
+		throw std::runtime_error("The storage is not associated with the cells of the patch.");
+	}
+
+	CellConstIterator endItr = cellConstEnd();
+	for (CellConstIterator itr = cellConstBegin(); itr != endItr; ++itr) {
+		OctantInfo octantInfo = getCellOctant(itr.getId());
+		const Octant *octant = getOctantPointer(octantInfo);
+
+		volumes->rawAt(itr.getRawIndex()) = m_tree->getVolume(octant);
+	}
+}
+
 /*!
 	Evaluates the centroid of the specified cell.
 
@@ -714,6 +739,31 @@ std::array<double, 3> VolOctree::evalCellCentroid(long id) const
 	return m_tree->getCenter(octant);
 }
 
+/*!
+	Evaluates the centroids of all the cells of the patch.
+
+	Centroids are evaluated directly from the octants associated with the
+	cells, looping over the cells in storage order.
+
+	\param[out] centroids is the storage that will be filled with the
+	centroids of the cells, the storage should be associated with the
+	kernel of the cells of the patch
+*/
+void VolOctree::evalCellCentroids(PiercedStorage<std::array<double, 3>, long> *centroids) const
+{
+	if (centroids->getKernel() != &m_cells) {
+		throw std::runtime_error("The storage is not associated with the cells of the patch.");
+	}
+
+	CellConstIterator endItr = cellConstEnd();
+	for (CellConstIterator itr = cellConstBegin(); itr != endItr; ++itr) {
+		OctantInfo octantInfo = getCellOctant(itr.getId());
+		const Octant *octant = getOctantPointer(octantInfo);
+
+		m_tree->getCenter(octant, centroids->rawAt(itr.getRawIndex()));
+	}
+}
+
 /*!
 	Evaluates the bounding box of the specified cell.
 
@@ -761,6 +811,31 @@ double VolOctree::evalInterfaceArea(long id) const
 	return m_tree->getArea(octant);
 }
 
+/*!
+	Evaluates the areas of all the interfaces of the patch.
+
+	Areas are evaluated directly from the octants associated with the owners
+	of the interfaces, looping over the interfaces in storage order.
+
+	\param[out] areas is the storage that will be filled with the areas of
+	the interfaces, the storage should be associated with the kernel of the
+	interfaces of the patch
+*/
+void VolOctree::evalInterfaceAreas(PiercedStorage<double, long> *areas) const
+{
+	if (areas->getKernel() != &m_interfaces) {
+		throw std::runtime_error("The storage is not associated with the interfaces of the patch.");
+	}
+
+	InterfaceConstIterator endItr = interfaceConstEnd();
+	for (InterfaceConstIterator itr = interfaceConstBegin(); itr != endItr; ++itr) {
+		OctantInfo octantInfo = getCellOctant(itr->getOwner());
+		const Octant *octant = getOctantPointer(octantInfo);
+
+		areas->rawAt(itr.getRawIndex()) = m_tree->getArea(octant);
+	}
+}
+
 /*!
 	Evaluates the normal of the specified interface.
 
@@ -779,6 +854,33 @@ std::array<double, 3> VolOctree::evalInterfaceNormal(long id) const
 	return m_tree->getNormal(octant, (uint8_t) ownerFace);
 }
 
+/*!
+	Evaluates the normals of all the interfaces of the patch.
+
+	Normals are evaluated directly from the octants associated with the
+	owners of the interfaces, looping over the interfaces in storage order.
+
+	\param[out] normals is the storage that will be filled with the normals
+	of the interfaces, the storage should be associated with the kernel of
+	the interfaces of the patch
+*/
+void VolOctree::evalInterfaceNormals(PiercedStorage<std::array<double, 3>, long> *normals) const
+{
+	if (normals->getKernel() != &m_interfaces) {
+		throw std::runtime_error("The storage is not associated with the interfaces of the patch.");
+	}
+
+	InterfaceConstIterator endItr = interfaceConstEnd();
+	for (InterfaceConstIterator itr = interfaceConstBegin(); itr != endItr; ++itr) {
+		const Interface &interface = *itr;
+
+		OctantInfo octantInfo = getCellOctant(interface.getOwner());
+		const Octant *octant = getOctantPointer(octantInfo);
+
+		normals->rawAt(itr.getRawIndex()) = m_tree->getNormal(octant, (uint8_t) interface.getOwnerFace());
+	}
+}
+
 /*!
 	Gets the octant of the cell with the specified id.
 
@@ -1058,6 +1160,25 @@ std::vector<adaption::Info> VolOctree::_adaptionPrepare(bool trackAdaption)
 	empty vector will be returned.
 */
 std::vector<adaption::Info> VolOctree::_adaptionAlter(bool trackAdaption)
+{
+	adaption::FlatInfoCollection adaptionData;
+	if (trackAdaption) {
+		_adaptionAlter(&adaptionData);
+	} else {
+		_adaptionAlter(nullptr);
+	}
+
+	return adaptionData.dump();
+}
+
+/*!
+	Alter the patch performing the adpation.
+
+	\param[in,out] adaptionData if a valid pointer is provided, the changes
+	done to the patch during the adaption will be appended to the specified
+	collection, otherwise the changes will not be tracked
+*/
+void VolOctree::_adaptionAlter(adaption::FlatInfoCollection *adaptionData)
 {
 	// Updating the tree
 	log::cout() << ">> Adapting tree...";
@@ -1068,12 +1189,12 @@ std::vector<adaption::Info> VolOctree::_adaptionAlter(bool trackAdaption)
 
 	if (!updated && !emtpyPatch) {
 		log::cout() << " Already updated" << std::endl;
-		return std::vector<adaption::Info>();
+		return;
 	}
 	log::cout() << " Done" << std::endl;
 
 	// Sync the patch
-	return sync(trackAdaption);
+	sync(adaptionData);
 }
 
 /*!
@@ -1106,6 +1227,30 @@ void VolOctree::settleAdaptionMarkers()
 */
 std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 {
+	adaption::FlatInfoCollection syncData;
+	if (trackChanges) {
+		sync(&syncData);
+	} else {
+		sync(nullptr);
+	}
+
+	return syncData.dump();
+}
+
+/*!
+	Syncronizes the patch with the underlying octree.
+
+	Changes are tracked directly in a compressed collection of adaption info,
+	this avoids allocating a pair of vectors for each modified octant.
+
+	\param[in,out] syncData if a valid pointer is provided, the changes
+	applied to the patch will be appended to the specified collection,
+	otherwise the changes will not be tracked
+*/
+void VolOctree::sync(adaption::FlatInfoCollection *syncData)
+{
+	bool trackChanges = (syncData != nullptr);
+
 	log::cout() << ">> Syncing patch..." << std::endl;
 
 	// Detect if we are in import-from-scratch mode
@@ -1132,7 +1277,7 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 	long nPreviousGhosts = m_ghostToCell.size();
 
 	// Initialize tracking data
-	adaption::InfoCollection adaptionData;
+	adaption::FlatInfoCollection adaptionData;
 
 	// Current rank
 	int currentRank = -1;
@@ -1293,7 +1438,6 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 
 			// Get the adaption info
 			std::size_t infoId = adaptionData.create(adaptionType, adaption::ENTITY_CELL, rank);
-			adaption::Info &adaptionInfo = adaptionData[infoId];
 
 			// Current status
 			//
@@ -1303,12 +1447,9 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 			//
 			// WARNING: tree id are uint32_t wherase adaptionInfo stores
 			//          id as long.
-			adaptionInfo.current.reserve(nCurrentTreeIds);
 			auto addedOctantsIter = addedOctants.cend() - nCurrentTreeIds;
 			while (addedOctantsIter != addedOctants.cend()) {
-				adaptionInfo.current.emplace_back();
-				long &adaptionId = adaptionInfo.current.back();
-				adaptionId = (*addedOctantsIter).id;
+				adaptionData.appendCurrent(infoId, (*addedOctantsIter).id);
 
 				addedOctantsIter++;
 			}
@@ -1320,7 +1461,6 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 			// previous cells will always be internal or among the ghost of
 			// the current process.
 			int nPreviousCellIds = mapper_octantMap.size();
-			adaptionInfo.previous.reserve(nPreviousCellIds);
 			for (int k = 0; k < nPreviousCellIds; ++k) {
 				long previousCellId;
 #if BITPIT_ENABLE_MPI==1
@@ -1333,9 +1473,7 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 					previousCellId = getOctantId(previousOctantInfo);
 				}
 
-				adaptionInfo.previous.emplace_back();
-				long &adaptionId = adaptionInfo.previous.back();
-				adaptionId = previousCellId;
+				adaptionData.appendPrevious(infoId, previousCellId);
 			}
 		}
 
@@ -1445,10 +1583,7 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 				if (adaptionIsDeletion || adaptionIsSend) {
 					int rank = deleteInfo.rank;
 					std::size_t adaptionInfoId = adaptionData.create(adaptionType, adaption::ENTITY_CELL, rank);
-					adaption::Info &adaptionInfo = adaptionData[adaptionInfoId];
-					adaptionInfo.previous.emplace_back();
-					long &deletedId = adaptionInfo.previous.back();
-					deletedId = cellId;
+					adaptionData.appendPrevious(adaptionInfoId, cellId);
 
 					// Keep track of adaption info for the send cells
 					if (adaptionIsSend) {
@@ -1475,20 +1610,17 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 			// cells because the octants associated to the cells no longer
 			// exist on the octree. The cells are still there, therefore we
 			// can evaluate the cell positions using generic patch functions.
+			adaptionData.flush();
 			for (int adaptionInfoId : sendAdaptionInfo) {
-				adaption::Info &adaptionInfo = adaptionData[adaptionInfoId];
-				std::sort(adaptionInfo.previous.begin(), adaptionInfo.previous.end(), CellPositionLess(*this, false));
+				ProxyVector<long> sendCellIds = adaptionData.getPrevious(adaptionInfoId);
+				std::sort(sendCellIds.data(), sendCellIds.data() + sendCellIds.size(), CellPositionLess(*this, false));
 			}
 #endif
 
 			// Adaption info for the deleted interfaces
 			std::size_t adaptionInfoId = adaptionData.create(adaption::TYPE_DELETION, adaption::ENTITY_INTERFACE, currentRank);
-			adaption::Info &adaptionInfo = adaptionData[adaptionInfoId];
-			adaptionInfo.previous.reserve(removedInterfaces.size());
 			for (long interfaceId : removedInterfaces) {
-				adaptionInfo.previous.emplace_back();
-				long &deletedInterfaceId = adaptionInfo.previous.back();
-				deletedInterfaceId = interfaceId;
+				adaptionData.appendPrevious(adaptionInfoId, interfaceId);
 			}
 		}
 
@@ -1520,16 +1652,20 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 	// Track mesh adaption
 	if (trackChanges) {
 		// Complete mesh adaption info for the cells
-		for (auto &adaptionInfo : adaptionData.data()) {
-			if (adaptionInfo.entity != adaption::ENTITY_CELL) {
+		adaptionData.flush();
+
+		std::size_t nAdaptionInfos = adaptionData.size();
+		for (std::size_t adaptionInfoId = 0; adaptionInfoId < nAdaptionInfos; ++adaptionInfoId) {
+			if (adaptionData.getEntity(adaptionInfoId) != adaption::ENTITY_CELL) {
 				continue;
 			}
 
 			// Map ids of the added cells
-			int nCurrentIds = adaptionInfo.current.size();
-			for (int k = 0; k < nCurrentIds; ++k) {
-				long cellId = m_octantToCell.at(adaptionInfo.current[k]);
-				adaptionInfo.current[k] = cellId;
+			ProxyVector<long> currentIds = adaptionData.getCurrent(adaptionInfoId);
+			std::size_t nCurrentIds = currentIds.size();
+			for (std::size_t k = 0; k < nCurrentIds; ++k) {
+				long cellId = m_octantToCell.at(currentIds[k]);
+				currentIds[k] = cellId;
 			}
 
 #if BITPIT_ENABLE_MPI==1
@@ -1538,9 +1674,9 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 			// To match the sorting done on the procesor that sent the cells,
 			// we don't use the native functions to evaluate the position of
 			// the cells.
-			adaption::Type adaptionType = adaptionInfo.type;
+			adaption::Type adaptionType = adaptionData.getType(adaptionInfoId);
 			if (adaptionType == adaption::TYPE_PARTITION_RECV) {
-				std::sort(adaptionInfo.current.begin(), adaptionInfo.current.end(), CellPositionLess(*this, false));
+				std::sort(currentIds.data(), currentIds.data() + nCurrentIds, CellPositionLess(*this, false));
 			}
 #endif
 		}
@@ -1549,14 +1685,10 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 		// Track created ghosts cells
 		if (nGhostsOctants > 0) {
 			std::size_t adaptionInfoId = adaptionData.create(adaption::TYPE_CREATION, adaption::ENTITY_CELL, currentRank);
-			adaption::Info &adaptionInfo = adaptionData[adaptionInfoId];
 
-			adaptionInfo.current.reserve(nGhostsOctants);
 			auto cellIterator = m_cellToGhost.cbegin();
 			while (cellIterator != m_cellToGhost.cend()) {
-				adaptionInfo.current.emplace_back();
-				long &adaptionId = adaptionInfo.current.back();
-				adaptionId = cellIterator->first;
+				adaptionData.appendCurrent(adaptionInfoId, cellIterator->first);
 
 				cellIterator++;
 			}
@@ -1581,18 +1713,15 @@ std::vector<adaption::Info> VolOctree::sync(bool trackChanges)
 
 			// Adaption info
 			std::size_t infoId = adaptionData.create(adaption::TYPE_CREATION, adaption::ENTITY_INTERFACE, currentRank);
-			adaption::Info &adaptionInfo = adaptionData[infoId];
-			adaptionInfo.current.reserve(createdInterfaces.size());
 			for (long interfaceId : createdInterfaces) {
-				adaptionInfo.current.emplace_back();
-				long &createdInterfaceId = adaptionInfo.current.back();
-				createdInterfaceId = interfaceId;
+				adaptionData.appendCurrent(infoId, interfaceId);
 			}
 		}
-	}
 
-	// Done
-	return adaptionData.dump();
+		// Export tracking data
+		adaptionData.squeeze();
+		syncData->append(std::move(adaptionData));
+	}
 }
 
 
@@ -2232,6 +2361,41 @@ long VolOctree::locatePoint(const std::array<double, 3> &point) const
 	return getOctantId(octantInfo);
 }
 
+/*!
+	Locates the cells that contain the specified points.
+
+	Points are located all together using the batched point location of the
+	octree, which sorts the points by Morton number and visits the octants
+	only once.
+
+	\param[in] nPoints is the number of points
+	\param[in] points are the points to be checked
+	\param[out] ids on output will contain the ids of the cells that contain
+	the points. If a point is not inside the patch, the related id will be
+	set to the id of the null element.
+*/
+void VolOctree::locatePoints(int nPoints, const std::array<double, 3> *points, long *ids) const
+{
+	if (nPoints <= 0) {
+		return;
+	}
+
+	std::vector<uint32_t> treeIds(nPoints);
+	std::unique_ptr<bool[]> isGhost(new bool[nPoints]);
+	m_tree->getPointOwnerIdx(nPoints, points, treeIds.data(), isGhost.get());
+
+	for (int i = 0; i < nPoints; ++i) {
+		uint32_t treeId = treeIds[i];
+		if (treeId == std::numeric_limits<uint32_t>::max()) {
+			ids[i] = Element::NULL_ID;
+			continue;
+		}
+
+		OctantInfo octantInfo(treeId, !isGhost[i]);
+		ids[i] = getOctantId(octantInfo);
+	}
+}
+
 /*!
 	Internal function to set the tolerance for the geometrical checks.
 
@@ -93,15 +93,19 @@ public:
 	void settleAdaptionMarkers() override;
 
 	double evalCellVolume(long id) const override;
+	void evalCellVolumes(PiercedStorage<double, long> *volumes) const override;
 	double evalCellSize(long id) const override;
 	std::array<double, 3> evalCellCentroid(long id) const override;
+	void evalCellCentroids(PiercedStorage<std::array<double, 3>, long> *centroids) const override;
 
 	void simulateCellUpdate(long id, adaption::Marker marker, std::vector<Cell> *virtualCells, PiercedVector<Vertex, long> *virtualVertices) const override;
 
 	void evalCellBoundingBox(long id, std::array<double,3> *minPoint, std::array<double,3> *maxPoint) const override;
 
 	double evalInterfaceArea(long id) const override;
+	void evalInterfaceAreas(PiercedStorage<double, long> *areas) const override;
 	std::array<double, 3> evalInterfaceNormal(long id) const override;
+	void evalInterfaceNormals(PiercedStorage<std::array<double, 3>, long> *normals) const override;
 
 	OctantInfo getCellOctant(long id) const;
 	int getCellLevel(long id) const;
@@ -118,6 +122,7 @@ public:
 	bool isPointInside(const std::array<double, 3> &point) const override;
 	bool isPointInside(long id, const std::array<double, 3> &point) const override;
 	long locatePoint(const std::array<double, 3> &point) const override;
+	void locatePoints(int nPoints, const std::array<double, 3> *points, long *ids) const override;
 
 	std::array<double, 3> getOrigin() const;
 	void setOrigin(const std::array<double, 3> &origin);
@@ -143,6 +148,7 @@ protected:
 
 	std::vector<adaption::Info> _adaptionPrepare(bool trackAdaption) override;
 	std::vector<adaption::Info> _adaptionAlter(bool trackAdaption) override;
+	void _adaptionAlter(adaption::FlatInfoCollection *adaptionData) override;
 	void _adaptionCleanup() override;
 	bool _markCellForRefinement(long id) override;
 	bool _markCellForCoarsening(long id) override;
@@ -168,9 +174,12 @@ protected:
 
 	std::vector<adaption::Info> _partitioningPrepare(const std::unordered_map<long, double> &cellWeights, double defaultWeight, bool trackPartitioning) override;
 	std::vector<adaption::Info> _partitioningAlter(bool trackPartitioning) override;
+	void _partitioningAlter(adaption::FlatInfoCollection *partitioningData) override;
 	void _partitioningCleanup() override;
 
 	std::vector<long> _findGhostCellExchangeSources(int rank) override;
+
+	void _findPointsCandidateRanks(int nPoints, const std::array<double, 3> *points, FlatVector2D<int> *candidateRanks) const override;
 #endif
 
 	int findAdjoinNeighFace(const Cell &cell, int cellFace, const Cell &neigh) const override;
@@ -273,6 +282,7 @@ private:
 	std::vector<long> importCells(const std::vector<OctantInfo> &octantTreeIds, StitchInfo &stitchInfo, std::istream *stream = nullptr);
 
 	std::vector<adaption::Info> sync(bool trackChanges);
+	void sync(adaption::FlatInfoCollection *syncData);
 
 	void findOctantCodimensionNeighs(const OctantInfo &octantInfo, int index, int codimension,
 	                                 const std::vector<long> *blackList, std::vector<long> *neighs) const;
@@ -1202,19 +1202,23 @@ bool VolOctreeMapper::_recoverPartition()
     std::map<int, std::vector<Octant>> list_octant;
     std::map<int, std::vector<long>> list_id;
     std::map<int, std::vector<long>> list_globalId;
+    uint32_t nOctants = mappedPatch->getTree().getNumOctants();
     uint32_t idx = 0;
-    uint64_t morton = mappedPatch->getTree().getLastDescMorton(idx);
     for (int reference_rank : toreference_rank[m_rank]) {
         uint64_t reference_first_morton = partitionFDReference[reference_rank];
         uint64_t reference_last_morton = partitionLDReference[reference_rank];
-        while (morton < reference_first_morton) {
+
+        // An octant may overlap more than one reference partition, in that
+        // case it has to be sent to all the overlapped partitions.
+        while (idx > 0 && mappedPatch->getTree().getLastDescMorton(idx - 1) >= reference_first_morton) {
+            idx--;
+        }
+
+        while (idx < nOctants && mappedPatch->getTree().getLastDescMorton(idx) < reference_first_morton) {
             idx++;
-            if (idx == mappedPatch->getTree().getNumOctants()) {
-                break;
-            }
-            morton = mappedPatch->getTree().getLastDescMorton(idx);
         }
-        while (morton < reference_last_morton) {
+
+        while (idx < nOctants && mappedPatch->getTree().getMorton(idx) <= reference_last_morton) {
             Octant oct = *mappedPatch->getTree().getOctant(idx);
             list_octant[reference_rank].push_back(oct);
             VolOctree::OctantInfo octantIfo(idx, true);
@@ -1224,10 +1228,6 @@ bool VolOctreeMapper::_recoverPartition()
             list_globalId[reference_rank].push_back(globalId);
             m_partitionIR.list_sent_octantIR.emplace_back(oct, id, globalId, reference_rank);
             idx++;
-            if (idx == mappedPatch->getTree().getNumOctants()) {
-                break;
-            }
-            morton = mappedPatch->getTree().getMorton(idx);
         }
     }
 
@@ -32,9 +32,10 @@
 #include <vector>
 #include <unordered_map>
 
-#include "volume_mapper.hpp"
+// The octree must be included before the mapper: the stream operators of the
+// octants have to be visible when the communication buffers are instantiated.
 #include "voloctree.hpp"
-#include "voloctree_mapper.hpp"
+#include "volume_mapper.hpp"
 
 namespace bitpit {
 
@@ -192,23 +192,38 @@ std::vector<adaption::Info> VolOctree::_partitioningPrepare(const std::unordered
 */
 std::vector<adaption::Info> VolOctree::_partitioningAlter(bool trackPartitioning)
 {
-	std::vector<adaption::Info> partitioningData;
+	adaption::FlatInfoCollection partitioningData;
+	if (trackPartitioning) {
+		_partitioningAlter(&partitioningData);
+	} else {
+		_partitioningAlter(nullptr);
+	}
+
+	return partitioningData.dump();
+}
 
+/*!
+	Alter the patch performing the partitioning.
+
+	\param[in,out] partitioningData if a valid pointer is provided, the
+	changes done to the patch during the partitioning will be appended to
+	the specified collection, otherwise the changes will not be tracked
+*/
+void VolOctree::_partitioningAlter(adaption::FlatInfoCollection *partitioningData)
+{
 	// Early return if the dimension of the tree is null
 	if (m_tree->getDim() == 0) {
-		return partitioningData;
+		return;
 	}
 
 	// Updating the tree
 	m_tree->loadBalance(m_partitioningOctantWeights.get());
 
 	// Sync the patch
-	partitioningData = sync(trackPartitioning);
+	sync(partitioningData);
 
 	// The bounding box is frozen, it is not updated automatically
 	setBoundingBox();
-
-	return partitioningData;
 }
 
 /*!
@@ -241,6 +256,34 @@ std::vector<long> VolOctree::_findGhostCellExchangeSources(int rank)
 	return ghostCellSources;
 }
 
+/*!
+	Finds the ranks of the processes whose partition may contain the
+	specified points.
+
+	The partitions of the octree are defined by the Morton numbers of their
+	first and last descendants, hence the owner of a point can be identified
+	exactly without looking at the cells: every point inside the domain has
+	exactly one candidate rank, points outside the domain have none.
+
+	\param[in] nPoints is the number of points
+	\param[in] points are the points
+	\param[out] candidateRanks on output will contain, for each point, the
+	list of candidate ranks
+*/
+void VolOctree::_findPointsCandidateRanks(int nPoints, const std::array<double, 3> *points, FlatVector2D<int> *candidateRanks) const
+{
+	candidateRanks->clear();
+	candidateRanks->reserve(nPoints, nPoints);
+	for (int i = 0; i < nPoints; ++i) {
+		candidateRanks->pushBack();
+
+		int rank = m_tree->getPointOwnerRank(points[i]);
+		if (rank >= 0) {
+			candidateRanks->pushBackItem(rank);
+		}
+	}
+}
+
 /*!
 	Compute partitioning weights for the octants.
 
@@ -22,6 +22,9 @@
  *
 \*---------------------------------------------------------------------------*/
 
+#include <algorithm>
+#include <iterator>
+
 #include "bitpit_common.hpp"
 
 #include "volunstructured.hpp"
@@ -238,6 +241,290 @@ std::array<double, 3> VolUnstructured::evalInterfaceNormal(long id) const
 	return interface.evalNormal(vertexCoordinates, orientation);
 }
 
+/*!
+	Evaluates the volumes of all the cells of the patch.
+
+	Cells are grouped by type: triangles, quadrilaterals, tetrahedra and
+	hexahedra are evaluated with dedicated kernels, the other cells are
+	evaluated one at the time.
+
+	\param[out] volumes is the storage that will be filled with the volumes
+	of the cells, the storage should be associated with the kernel of the
+	cells of the patch
+*/
+void VolUnstructured::evalCellVolumes(PiercedStorage<double, long> *volumes) const
+{
+	if (volumes->getKernel() != &m_cells) {
+		throw std::runtime_error("The storage is not associated with the cells of the patch.");
+	}
+
+	if (isThreeDimensional()) {
+		auto bulkKernel = [](ElementType type, std::size_t nCells, const std::array<double, 3> *coordinates, double *cellVolumes) {
+			switch (type) {
+
+			case ElementType::TETRA:
+				ReferenceTetraInfo::info.evalVolumes(nCells, coordinates, cellVolumes);
+				return true;
+
+			case ElementType::HEXAHEDRON:
+				ReferenceHexahedronInfo::info.evalVolumes(nCells, coordinates, cellVolumes);
+				return true;
+
+			default:
+				return false;
+
+			}
+		};
+
+		auto kernel = [](const Cell &cell, const std::array<double, 3> *coordinates) {
+			return cell.evalVolume(coordinates);
+		};
+
+		evalElementData(m_cells, bulkKernel, kernel, volumes);
+	} else {
+		auto bulkKernel = [](ElementType type, std::size_t nCells, const std::array<double, 3> *coordinates, double *cellVolumes) {
+			switch (type) {
+
+			case ElementType::TRIANGLE:
+				ReferenceTriangleInfo::info.evalAreas(nCells, coordinates, cellVolumes);
+				return true;
+
+			case ElementType::QUAD:
+				ReferenceQuadInfo::info.evalAreas(nCells, coordinates, cellVolumes);
+				return true;
+
+			default:
+				return false;
+
+			}
+		};
+
+		auto kernel = [](const Cell &cell, const std::array<double, 3> *coordinates) {
+			return cell.evalArea(coordinates);
+		};
+
+		evalElementData(m_cells, bulkKernel, kernel, volumes);
+	}
+}
+
+/*!
+	Evaluates the areas of all the interfaces of the patch.
+
+	Interfaces are grouped by type: triangles, quadrilaterals and lines are
+	evaluated with dedicated kernels, the other interfaces are evaluated one
+	at the time.
+
+	\param[out] areas is the storage that will be filled with the areas of
+	the interfaces, the storage should be associated with the kernel of the
+	interfaces of the patch
+*/
+void VolUnstructured::evalInterfaceAreas(PiercedStorage<double, long> *areas) const
+{
+	if (areas->getKernel() != &m_interfaces) {
+		throw std::runtime_error("The storage is not associated with the interfaces of the patch.");
+	}
+
+	if (isThreeDimensional()) {
+		auto bulkKernel = [](ElementType type, std::size_t nInterfaces, const std::array<double, 3> *coordinates, double *interfaceAreas) {
+			switch (type) {
+
+			case ElementType::TRIANGLE:
+				ReferenceTriangleInfo::info.evalAreas(nInterfaces, coordinates, interfaceAreas);
+				return true;
+
+			case ElementType::QUAD:
+				ReferenceQuadInfo::info.evalAreas(nInterfaces, coordinates, interfaceAreas);
+				return true;
+
+			default:
+				return false;
+
+			}
+		};
+
+		auto kernel = [](const Interface &interface, const std::array<double, 3> *coordinates) {
+			return interface.evalArea(coordinates);
+		};
+
+		evalElementData(m_interfaces, bulkKernel, kernel, areas);
+	} else {
+		auto bulkKernel = [](ElementType type, std::size_t nInterfaces, const std::array<double, 3> *coordinates, double *interfaceAreas) {
+			if (type != ElementType::LINE) {
+				return false;
+			}
+
+			ReferenceLineInfo::info.evalLengths(nInterfaces, coordinates, interfaceAreas);
+			return true;
+		};
+
+		auto kernel = [](const Interface &interface, const std::array<double, 3> *coordinates) {
+			return interface.evalLength(coordinates);
+		};
+
+		evalElementData(m_interfaces, bulkKernel, kernel, areas);
+	}
+}
+
+/*!
+	Evaluates the normals of all the interfaces of the patch.
+
+	For three-dimensional patches, interfaces are grouped by type: triangles
+	and quadrilaterals are evaluated with dedicated kernels, the other
+	interfaces are evaluated one at the time. Normals of two-dimensional
+	patches depend on the orientation of the owner cell and are evaluated
+	one interface at the time.
+
+	\param[out] normals is the storage that will be filled with the normals
+	of the interfaces, the storage should be associated with the kernel of
+	the interfaces of the patch
+*/
+void VolUnstructured::evalInterfaceNormals(PiercedStorage<std::array<double, 3>, long> *normals) const
+{
+	if (!isThreeDimensional()) {
+		VolumeKernel::evalInterfaceNormals(normals);
+		return;
+	}
+
+	if (normals->getKernel() != &m_interfaces) {
+		throw std::runtime_error("The storage is not associated with the interfaces of the patch.");
+	}
+
+	auto bulkKernel = [](ElementType type, std::size_t nInterfaces, const std::array<double, 3> *coordinates, std::array<double, 3> *interfaceNormals) {
+		switch (type) {
+
+		case ElementType::TRIANGLE:
+			ReferenceTriangleInfo::info.evalNormals(nInterfaces, coordinates, interfaceNormals);
+			return true;
+
+		case ElementType::QUAD:
+			ReferenceQuadInfo::info.evalNormals(nInterfaces, coordinates, interfaceNormals);
+			return true;
+
+		default:
+			return false;
+
+		}
+	};
+
+	auto kernel = [](const Interface &interface, const std::array<double, 3> *coordinates) {
+		return interface.evalNormal(coordinates, {{0., 0., 0.}});
+	};
+
+	evalElementData(m_interfaces, bulkKernel, kernel, normals);
+}
+
+/*!
+	Evaluates element data for all the specified elements.
+
+	Elements whose type has a reference element are grouped by type. Each
+	group is processed in chunks: the coordinates of the vertices of the
+	elements of the chunk are gathered in a contiguous workspace and are
+	passed to the bulk kernel, which evaluates the data of all the elements
+	of the chunk at once. If the bulk kernel doesn't support the type of the
+	group, the elements are evaluated one at the time with the element
+	kernel. Elements without a reference element (e.g., polygons and
+	polyhedra) are always evaluated with the element kernel.
+
+	\param elements are the elements
+	\param bulkKernel is the kernel that evaluates the data of a set of
+	elements of the same type given the type, the number of elements and
+	the coordinates of their vertices; it should return false if the type
+	is not supported
+	\param kernel is the kernel that evaluates the data of an element given
+	the element and the coordinates of its vertices
+	\param[out] data is the storage that will be filled with the evaluated
+	data
+*/
+template<typename element_t, typename value_t, typename bulk_kernel_t, typename kernel_t>
+void VolUnstructured::evalElementData(const PiercedVector<element_t, long> &elements, const bulk_kernel_t &bulkKernel,
+                                      const kernel_t &kernel, PiercedStorage<value_t, long> *data) const
+{
+	const std::size_t CHUNK_SIZE = 256;
+
+	std::vector<std::array<double, 3>> coordinates(ReferenceElementInfo::MAX_ELEM_VERTICES);
+
+	// Group elements by type
+	//
+	// Elements without a reference element don't have a fixed number of
+	// vertices, they are evaluated right away.
+	std::vector<ElementType> groupTypes;
+	std::vector<std::vector<std::size_t>> groupRawIndexes;
+
+	ElementType currentType = ElementType::UNDEFINED;
+	std::size_t currentGroup = 0;
+
+	auto endItr = elements.cend();
+	for (auto itr = elements.cbegin(); itr != endItr; ++itr) {
+		const element_t &element = *itr;
+		ElementType type = element.getType();
+		if (!ReferenceElementInfo::hasInfo(type)) {
+			ConstProxyVector<long> elementVertexIds = element.getVertexIds();
+			std::size_t nElementVertices = elementVertexIds.size();
+
+			if (coordinates.size() < nElementVertices) {
+				coordinates.resize(nElementVertices);
+			}
+			getVertexCoords(nElementVertices, elementVertexIds.data(), coordinates.data());
+
+			data->rawAt(itr.getRawIndex()) = kernel(element, coordinates.data());
+			continue;
+		}
+
+		if (type != currentType) {
+			currentType  = type;
+			currentGroup = std::distance(groupTypes.begin(), std::find(groupTypes.begin(), groupTypes.end(), type));
+			if (currentGroup == groupTypes.size()) {
+				groupTypes.push_back(type);
+				groupRawIndexes.emplace_back();
+			}
+		}
+
+		groupRawIndexes[currentGroup].push_back(itr.getRawIndex());
+	}
+
+	// Evaluate the data of the groups
+	std::vector<value_t> values(CHUNK_SIZE);
+	for (std::size_t n = 0; n < groupTypes.size(); ++n) {
+		ElementType type = groupTypes[n];
+		const std::vector<std::size_t> &rawIndexes = groupRawIndexes[n];
+		std::size_t nGroupElements = rawIndexes.size();
+
+		std::size_t nTypeVertices = ReferenceElementInfo::getInfo(type).nVertices;
+		if (coordinates.size() < CHUNK_SIZE * nTypeVertices) {
+			coordinates.resize(CHUNK_SIZE * nTypeVertices);
+		}
+
+		bool isBulkSupported = true;
+		for (std::size_t chunkBegin = 0; chunkBegin < nGroupElements; chunkBegin += CHUNK_SIZE) {
+			std::size_t nChunkElements = std::min(CHUNK_SIZE, nGroupElements - chunkBegin);
+			const std::size_t *chunkRawIndexes = rawIndexes.data() + chunkBegin;
+
+			// Gather vertex coordinates
+			for (std::size_t k = 0; k < nChunkElements; ++k) {
+				const element_t &element = elements.rawAt(chunkRawIndexes[k]);
+				getVertexCoords(nTypeVertices, element.getVertexIds().data(), coordinates.data() + k * nTypeVertices);
+			}
+
+			// Evaluate element data
+			if (isBulkSupported) {
+				isBulkSupported = bulkKernel(type, nChunkElements, coordinates.data(), values.data());
+			}
+
+			if (!isBulkSupported) {
+				for (std::size_t k = 0; k < nChunkElements; ++k) {
+					const element_t &element = elements.rawAt(chunkRawIndexes[k]);
+					values[k] = kernel(element, coordinates.data() + k * nTypeVertices);
+				}
+			}
+
+			// Scatter element data
+			for (std::size_t k = 0; k < nChunkElements; ++k) {
+				data->rawAt(chunkRawIndexes[k]) = values[k];
+			}
+		}
+	}
+}
+
 /*!
  *  Get the version associated to the binary dumps.
  *
@@ -292,31 +579,153 @@ void VolUnstructured::_restore(std::istream &stream)
  */
 bool VolUnstructured::isPointInside(const std::array<double, 3> &point) const
 {
-	BITPIT_UNUSED(point);
-
-	return false;
+	return (locatePoint(point) != Cell::NULL_ID);
 }
 
 /*!
 	Checks if the specified point is inside a cell.
 
+	Three-dimensional cells are considered closed surfaces made of their
+	faces: the point is inside the cell if the winding number of the faces
+	around the point is not null. Faces with more than three vertices are
+	split in triangles connecting the edges of the face with its centroid,
+	this way faces shared by two cells are split in the same triangles.
+	Two-dimensional cells are checked evaluating the distance between the
+	point and the cell. In both cases, points whose distance from the cell
+	is less than the tolerance of the patch are considered inside the cell.
+
 	\param[in] id is the idof the cell
 	\param[in] point is the point to be checked
 	\result Returns true if the point is inside the cell, false otherwise.
  */
 bool VolUnstructured::isPointInside(long id, const std::array<double, 3> &point) const
 {
-	BITPIT_UNUSED(id);
-	BITPIT_UNUSED(point);
+	const Cell &cell = getCell(id);
+	const double tolerance = getTol();
+
+	// Get the coordinates of the vertices
+	int nCellVertices = cell.getVertexCount();
+	BITPIT_CREATE_WORKSPACE(cellVertexCoordinates, std::array<double BITPIT_COMMA 3>, nCellVertices, ReferenceElementInfo::MAX_ELEM_VERTICES);
+	getElementVertexCoordinates(cell, cellVertexCoordinates);
+
+	// Check if the point is inside the bounding box of the cell
+	for (int d = 0; d < 3; ++d) {
+		double minCoord = cellVertexCoordinates[0][d];
+		double maxCoord = cellVertexCoordinates[0][d];
+		for (int k = 1; k < nCellVertices; ++k) {
+			minCoord = std::min(cellVertexCoordinates[k][d], minCoord);
+			maxCoord = std::max(cellVertexCoordinates[k][d], maxCoord);
+		}
+
+		if (point[d] < minCoord - tolerance || point[d] > maxCoord + tolerance) {
+			return false;
+		}
+	}
+
+	// Check if the point is inside the cell
+	if (cell.getDimension() == 3) {
+		double windingNumber = evalCellWindingNumber(cell, cellVertexCoordinates, point);
+		if (std::abs(windingNumber) > 0.5) {
+			return true;
+		}
+	}
 
-	return false;
+	return (cell.evalPointDistance(point, cellVertexCoordinates) <= tolerance);
+}
+
+/*!
+	Evaluates the winding number of the faces of a three-dimensional cell
+	around the specified point.
+
+	The winding number is evaluated summing the solid angles subtended by
+	the triangles the faces are split into (see "The Solid Angle of a Plane
+	Triangle", A. Van Oosterom and J. Strackee, IEEE Transactions on
+	Biomedical Engineering, 1983). The winding number of a point inside the
+	cell is one (or minus one, depending on the orientation of the faces),
+	while the winding number of a point outside the cell is zero.
+
+	\param[in] cell is the cell
+	\param[in] vertexCoords are the coordinates of the vertices of the cell
+	\param[in] point is the point
+	\result The winding number of the faces of the cell around the point.
+ */
+double VolUnstructured::evalCellWindingNumber(const Cell &cell, const std::array<double, 3> *vertexCoords,
+                                              const std::array<double, 3> &point)
+{
+	double solidAngle = 0.;
+
+	int nFaces = cell.getFaceCount();
+	for (int i = 0; i < nFaces; ++i) {
+		ConstProxyVector<int> faceVertexIds = cell.getFaceLocalVertexIds(i);
+		std::size_t nFaceVertices = faceVertexIds.size();
+
+		if (nFaceVertices == 3) {
+			solidAngle += evalTriangleSolidAngle(vertexCoords[faceVertexIds[0]], vertexCoords[faceVertexIds[1]],
+			                                     vertexCoords[faceVertexIds[2]], point);
+		} else {
+			std::array<double, 3> faceCentroid = {{0., 0., 0.}};
+			for (std::size_t k = 0; k < nFaceVertices; ++k) {
+				faceCentroid += vertexCoords[faceVertexIds[k]];
+			}
+			faceCentroid /= static_cast<double>(nFaceVertices);
+
+			// Vertices of pixel faces are not ordered along the boundary
+			// of the face, they need to be visited in loop order.
+			static const std::array<std::size_t, 4> PIXEL_LOOP = {{0, 1, 3, 2}};
+			bool isPixel = (cell.getFaceType(i) == ElementType::PIXEL);
+
+			for (std::size_t k = 0; k < nFaceVertices; ++k) {
+				std::size_t k_1 = k;
+				std::size_t k_2 = (k + 1) % nFaceVertices;
+				if (isPixel) {
+					k_1 = PIXEL_LOOP[k_1];
+					k_2 = PIXEL_LOOP[k_2];
+				}
+
+				const std::array<double, 3> &vertexCoords_1 = vertexCoords[faceVertexIds[k_1]];
+				const std::array<double, 3> &vertexCoords_2 = vertexCoords[faceVertexIds[k_2]];
+
+				solidAngle += evalTriangleSolidAngle(faceCentroid, vertexCoords_1, vertexCoords_2, point);
+			}
+		}
+	}
+
+	return solidAngle / (4. * BITPIT_PI);
+}
+
+/*!
+	Evaluates the signed solid angle subtended by a triangle at the
+	specified point.
+
+	\param[in] V0 is the first vertex of the triangle
+	\param[in] V1 is the second vertex of the triangle
+	\param[in] V2 is the third vertex of the triangle
+	\param[in] point is the point
+	\result The signed solid angle subtended by the triangle at the point.
+ */
+double VolUnstructured::evalTriangleSolidAngle(const std::array<double, 3> &V0, const std::array<double, 3> &V1,
+                                               const std::array<double, 3> &V2, const std::array<double, 3> &point)
+{
+	std::array<double, 3> a = V0 - point;
+	std::array<double, 3> b = V1 - point;
+	std::array<double, 3> c = V2 - point;
+
+	double aNorm = norm2(a);
+	double bNorm = norm2(b);
+	double cNorm = norm2(c);
+
+	double numerator   = dotProduct(a, crossProduct(b, c));
+	double denominator = aNorm * bNorm * cNorm + dotProduct(a, b) * cNorm + dotProduct(a, c) * bNorm + dotProduct(b, c) * aNorm;
+
+	return 2. * std::atan2(numerator, denominator);
 }
 
 /*!
  * Locates the cell the contains the point.
  *
  * If the point is not inside the patch, the function returns the id of the
- * null element.
+ * null element. Cells are searched using a tree that is built the first
+ * time a point is located.
  *
  * \param[in] point is the point to be checked
  * \result Returns the linear id of the cell the contains the point. If the
@@ -325,9 +734,41 @@ bool VolUnstructured::isPointInside(long id, const std::array<double, 3> &point)
  */
 long VolUnstructured::locatePoint(const std::array<double, 3> &point) const
 {
-	BITPIT_UNUSED(point);
+	long id;
+	getPointLocationTree().findPointContainingCell(point, &id);
 
-	return false;
+	return id;
+}
+
+/*!
+ * Locates the cells that contain the specified points.
+ *
+ * Consecutive points are expected to be close to each other: the search
+ * of a point starts from the cell that contains the previous point and,
+ * if the adjacencies of the patch are available, walks through the
+ * neighbours of that cell. Points not found by the walk are searched using
+ * the tree that is also used by locatePoint. Lookups are thread safe, hence
+ * different threads can locate different sets of points concurrently.
+ *
+ * \param[in] nPoints is the number of points
+ * \param[in] points are the points to be checked
+ * \param[out] ids on output will contain the ids of the cells that contain
+ * the points. If a point is not inside the patch, the related id will be set
+ * to the id of the null element.
+ */
+void VolUnstructured::locatePoints(int nPoints, const std::array<double, 3> *points, long *ids) const
+{
+	getPointLocationTree().findPointContainingCell(nPoints, points, ids);
+}
+
+/*!
+ * Creates the tree used for locating points inside the patch.
+ *
+ * \result The tree used for locating points inside the patch.
+ */
+std::unique_ptr<PatchSkdTree> VolUnstructured::_createPointLocationTree() const
+{
+	return std::unique_ptr<PatchSkdTree>(new VolumeSkdTree(this));
 }
 
 }
@@ -53,21 +53,33 @@ public:
 	void setExpert(bool expert);
 
 	double evalCellVolume(long id) const override;
+	void evalCellVolumes(PiercedStorage<double, long> *volumes) const override;
 	double evalCellSize(long id) const override;
 
 	double evalInterfaceArea(long id) const override;
+	void evalInterfaceAreas(PiercedStorage<double, long> *areas) const override;
 	std::array<double, 3> evalInterfaceNormal(long id) const override;
+	void evalInterfaceNormals(PiercedStorage<std::array<double, 3>, long> *normals) const override;
 
 	bool isPointInside(const std::array<double, 3> &point) const override;
 	bool isPointInside(long id, const std::array<double, 3> &point) const override;
 	long locatePoint(const std::array<double, 3> &point) const override;
+	void locatePoints(int nPoints, const std::array<double, 3> *points, long *ids) const override;
 
 protected:
 	int _getDumpVersion() const override;
 	void _dump(std::ostream &stream) const override;
 	void _restore(std::istream &stream) override;
 
+	std::unique_ptr<PatchSkdTree> _createPointLocationTree() const override;
+
 private:
+	template<typename element_t, typename value_t, typename bulk_kernel_t, typename kernel_t>
+	void evalElementData(const PiercedVector<element_t, long> &elements, const bulk_kernel_t &bulkKernel,
+	                     const kernel_t &kernel, PiercedStorage<value_t, long> *data) const;
+
+	static double evalCellWindingNumber(const Cell &cell, const std::array<double, 3> *vertexCoords, const std::array<double, 3> &point);
+	static double evalTriangleSolidAngle(const std::array<double, 3> &V0, const std::array<double, 3> &V1, const std::array<double, 3> &V2, const std::array<double, 3> &point);
 
 };
 
@@ -0,0 +1,339 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+// ========================================================================== //
+// INCLUDES                                                                   //
+// ========================================================================== //
+# include <cmath>
+# include <array>
+# include <vector>
+# include <chrono>
+# include <random>
+# include <string>
+# include <iostream>
+#if BITPIT_ENABLE_MPI==1
+# include <mpi.h>
+#endif
+
+# include "bitpit_common.hpp"
+# include "bitpit_operators.hpp"
+# include "bitpit_CG.hpp"
+
+using namespace std;
+using namespace bitpit;
+
+/*!
+* Subtest 001
+*
+* Testing batched distances and projections between points and a triangle.
+*/
+int subtest_001()
+{
+    const double TOLERANCE = 1.e-10;
+
+    // Triangle ------------------------------------------------------------- //
+    array<double, 3> Q0 = {{0.1, 0.2, 0.0}};
+    array<double, 3> Q1 = {{1.3, 0.1, 0.2}};
+    array<double, 3> Q2 = {{0.4, 1.1, -0.1}};
+
+    // Points --------------------------------------------------------------- //
+    //
+    // Points are generated in a box that contains the triangle, this way
+    // all the Voronoi regions of the triangle will be sampled. The number
+    // of points is not a multiple of the vector width, to test also the
+    // evaluation of the remainder.
+    std::size_t nPoints = 1003;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> distribution(-1.5, 2.5);
+
+    vector<array<double, 3>> cloud(nPoints);
+    vector<double> points(3 * nPoints);
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        for (int d = 0; d < 3; ++d) {
+            cloud[n][d] = distribution(generator);
+            points[d * nPoints + n] = cloud[n][d];
+        }
+    }
+
+    // Points that lie on vertices and edges
+    cloud[0] = Q0;
+    cloud[1] = Q1;
+    cloud[2] = Q2;
+    cloud[3] = 0.5 * (Q0 + Q1);
+    cloud[4] = 0.5 * (Q1 + Q2);
+    cloud[5] = 0.5 * (Q2 + Q0);
+    for (std::size_t n = 0; n < 6; ++n) {
+        for (int d = 0; d < 3; ++d) {
+            points[d * nPoints + n] = cloud[n][d];
+        }
+    }
+
+    // Batched evaluation --------------------------------------------------- //
+    vector<double> distances(nPoints);
+    vector<double> projections(3 * nPoints);
+    vector<double> lambda(3 * nPoints);
+
+    CGElem::distancePointsTriangle(nPoints, points.data(), Q0, Q1, Q2, distances.data());
+    CGElem::projectPointsTriangle(nPoints, points.data(), Q0, Q1, Q2, projections.data(), lambda.data());
+
+    // Compare with the scalar functions ------------------------------------ //
+    log::cout() << " - Comparing batched and scalar point-triangle evaluation" << std::endl;
+
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        array<double, 3> expectedLambda;
+        array<double, 3> expectedProjection = CGElem::projectPointTriangle(cloud[n], Q0, Q1, Q2, expectedLambda);
+        double expectedDistance = CGElem::distancePointTriangle(cloud[n], Q0, Q1, Q2);
+
+        if (std::abs(distances[n] - expectedDistance) > TOLERANCE) {
+            log::cout() << "   Wrong distance for point " << cloud[n] << ": expected " << expectedDistance << ", got " << distances[n] << std::endl;
+            return 1;
+        }
+
+        for (int d = 0; d < 3; ++d) {
+            if (std::abs(projections[d * nPoints + n] - expectedProjection[d]) > TOLERANCE) {
+                log::cout() << "   Wrong projection for point " << cloud[n] << std::endl;
+                return 1;
+            }
+
+            if (std::abs(lambda[d * nPoints + n] - expectedLambda[d]) > TOLERANCE) {
+                log::cout() << "   Wrong barycentric coordinates for point " << cloud[n] << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    log::cout() << "   Batched evaluation matches scalar evaluation for " << nPoints << " points" << std::endl;
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing batched distances and projections between a point and a set of
+* triangles.
+*/
+int subtest_002()
+{
+    const double TOLERANCE = 1.e-10;
+
+    // Point ---------------------------------------------------------------- //
+    array<double, 3> P = {{0.3, 0.4, 0.2}};
+
+    // Triangles ------------------------------------------------------------ //
+    std::size_t nTriangles = 1005;
+
+    std::mt19937 generator(2);
+    std::uniform_real_distribution<double> distribution(-1., 1.);
+
+    vector<array<array<double, 3>, 3>> triangles(nTriangles);
+    vector<double> vertices(9 * nTriangles);
+    for (std::size_t n = 0; n < nTriangles; ++n) {
+        while (true) {
+            for (int k = 0; k < 3; ++k) {
+                for (int d = 0; d < 3; ++d) {
+                    triangles[n][k][d] = distribution(generator);
+                }
+            }
+
+            if (CGElem::validTriangle(triangles[n][0], triangles[n][1], triangles[n][2])) {
+                break;
+            }
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            for (int d = 0; d < 3; ++d) {
+                vertices[(3 * k + d) * nTriangles + n] = triangles[n][k][d];
+            }
+        }
+    }
+
+    // Batched evaluation --------------------------------------------------- //
+    vector<double> distances(nTriangles);
+    vector<double> projections(3 * nTriangles);
+    vector<double> lambda(3 * nTriangles);
+
+    CGElem::distancePointTriangles(P, nTriangles, vertices.data(), distances.data());
+    CGElem::projectPointTriangles(P, nTriangles, vertices.data(), projections.data(), lambda.data());
+
+    // Compare with the scalar functions ------------------------------------ //
+    log::cout() << " - Comparing batched and scalar point-triangles evaluation" << std::endl;
+
+    for (std::size_t n = 0; n < nTriangles; ++n) {
+        const array<array<double, 3>, 3> &triangle = triangles[n];
+
+        array<double, 3> expectedLambda;
+        array<double, 3> expectedProjection = CGElem::projectPointTriangle(P, triangle[0], triangle[1], triangle[2], expectedLambda);
+        double expectedDistance = CGElem::distancePointTriangle(P, triangle[0], triangle[1], triangle[2]);
+
+        if (std::abs(distances[n] - expectedDistance) > TOLERANCE) {
+            log::cout() << "   Wrong distance for triangle " << n << ": expected " << expectedDistance << ", got " << distances[n] << std::endl;
+            return 1;
+        }
+
+        for (int d = 0; d < 3; ++d) {
+            if (std::abs(projections[d * nTriangles + n] - expectedProjection[d]) > TOLERANCE) {
+                log::cout() << "   Wrong projection for triangle " << n << std::endl;
+                return 1;
+            }
+
+            if (std::abs(lambda[d * nTriangles + n] - expectedLambda[d]) > TOLERANCE) {
+                log::cout() << "   Wrong barycentric coordinates for triangle " << n << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    log::cout() << "   Batched evaluation matches scalar evaluation for " << nTriangles << " triangles" << std::endl;
+
+    return 0;
+}
+
+/*!
+* Subtest 003
+*
+* Benchmarking batched distances between points and a triangle.
+*/
+int subtest_003()
+{
+    // Triangle ------------------------------------------------------------- //
+    array<double, 3> Q0 = {{0.0, 0.0, 0.0}};
+    array<double, 3> Q1 = {{1.0, 0.0, 0.0}};
+    array<double, 3> Q2 = {{0.0, 1.0, 0.0}};
+
+    // Points --------------------------------------------------------------- //
+    std::size_t nPoints = 100000;
+
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> distribution(-1., 2.);
+
+    vector<array<double, 3>> cloud(nPoints);
+    vector<double> points(3 * nPoints);
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        for (int d = 0; d < 3; ++d) {
+            cloud[n][d] = distribution(generator);
+            points[d * nPoints + n] = cloud[n][d];
+        }
+    }
+
+    // Scalar evaluation ---------------------------------------------------- //
+    int nRepetitions = 10;
+
+    vector<double> scalarDistances(nPoints);
+
+    std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
+    for (int k = 0; k < nRepetitions; ++k) {
+        for (std::size_t n = 0; n < nPoints; ++n) {
+            scalarDistances[n] = CGElem::distancePointTriangle(cloud[n], Q0, Q1, Q2);
+        }
+    }
+    std::chrono::time_point<std::chrono::system_clock> end = std::chrono::system_clock::now();
+    double scalarElapsed = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Batched evaluation --------------------------------------------------- //
+    vector<double> batchDistances(nPoints);
+
+    start = std::chrono::system_clock::now();
+    for (int k = 0; k < nRepetitions; ++k) {
+        CGElem::distancePointsTriangle(nPoints, points.data(), Q0, Q1, Q2, batchDistances.data());
+    }
+    end = std::chrono::system_clock::now();
+    double batchElapsed = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // Output message ------------------------------------------------------- //
+    log::cout() << " - Benchmarking point-triangle distance evaluation" << std::endl;
+    log::cout() << "   Number of evaluations: " << nRepetitions * nPoints << std::endl;
+    log::cout() << "   Scalar evaluation time:  " << scalarElapsed << " ms" << std::endl;
+    log::cout() << "   Batched evaluation time: " << batchElapsed << " ms" << std::endl;
+
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        if (std::abs(batchDistances[n] - scalarDistances[n]) > 1.e-10) {
+            log::cout() << "   Batched and scalar distances don't match" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+    // ====================================================================== //
+    // INITIALIZE MPI                                                         //
+    // ====================================================================== //
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // ====================================================================== //
+    // INITIALIZE LOGGER                                                      //
+    // ====================================================================== //
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // ====================================================================== //
+    // VARIABLES DECLARATION                                                  //
+    // ====================================================================== //
+
+    // Local variabels
+    int                             status = 0;
+
+    // ====================================================================== //
+    // RUN SUB-TESTS                                                          //
+    // ====================================================================== //
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+
+        status = subtest_003();
+        if (status != 0) {
+            return (30 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+    // ====================================================================== //
+    // FINALIZE MPI                                                           //
+    // ====================================================================== //
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
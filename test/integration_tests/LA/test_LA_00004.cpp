@@ -0,0 +1,426 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#if BITPIT_ENABLE_MPI==1
+#   include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_LA.hpp"
+
+using namespace bitpit;
+
+/*!
+* Generate a diagonally dominant matrix (stored in row major order).
+*
+* \param generator is the random number generator
+* \param symmetric if set to true the matrix will be symmetric
+* \result The generated matrix.
+*/
+template<std::size_t m>
+std::array<double, m * m> generateMatrix(std::mt19937 &generator, bool symmetric)
+{
+    std::uniform_real_distribution<double> distribution(-1., 1.);
+
+    std::array<double, m * m> A;
+    for (std::size_t i = 0; i < m; ++i) {
+        for (std::size_t j = 0; j < m; ++j) {
+            if (symmetric && j < i) {
+                A[i * m + j] = A[j * m + i];
+            } else {
+                A[i * m + j] = distribution(generator);
+            }
+        }
+        A[i * m + i] += 2. * m;
+    }
+
+    return A;
+}
+
+/*!
+* Generate a vector.
+*
+* \param generator is the random number generator
+* \result The generated vector.
+*/
+template<std::size_t m>
+std::array<double, m> generateVector(std::mt19937 &generator)
+{
+    std::uniform_real_distribution<double> distribution(-1., 1.);
+
+    std::array<double, m> B;
+    for (std::size_t i = 0; i < m; ++i) {
+        B[i] = distribution(generator);
+    }
+
+    return B;
+}
+
+/*!
+* Solve a system using the LAPACK based solver.
+*
+* \param A is the matrix of the system
+* \param[in,out] B in input is the r.h.s., in output is the solution
+* \result The information returned by the solver.
+*/
+template<std::size_t m>
+int solveReference(std::array<double, m * m> A, std::array<double, m> &B)
+{
+    std::array<int, m> ipiv;
+
+    return linearalgebra::solveLU(linearalgebra::constants::ROW_MAJOR, m, A.data(), B.data(), ipiv.data());
+}
+
+/*!
+* Check if two solutions match.
+*
+* \param solution is the solution
+* \param expectedSolution is the expected solution
+* \result Returns true if the solutions match, false otherwise.
+*/
+template<std::size_t m>
+bool checkSolution(const std::array<double, m> &solution, const std::array<double, m> &expectedSolution)
+{
+    for (std::size_t i = 0; i < m; ++i) {
+        if (std::abs(solution[i] - expectedSolution[i]) > 1.e-12) {
+            log::cout() << "  Expected solution[" << i << "] = " << expectedSolution[i] << std::endl;
+            log::cout() << "  Evaluated solution[" << i << "] = " << solution[i] << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*!
+* Test the fixed-size solvers.
+*
+* \param generator is the random number generator
+* \result Returns 0 on success, 1 otherwise.
+*/
+template<std::size_t m>
+int testFixedSizeSolvers(std::mt19937 &generator)
+{
+    log::cout() << "  Testing systems of size " << m << std::endl;
+
+    for (int n = 0; n < 10; ++n) {
+        // LU factorization
+        std::array<double, m * m> A = generateMatrix<m>(generator, false);
+        std::array<double, m> B = generateVector<m>(generator);
+
+        std::array<double, m> expectedSolution = B;
+        solveReference<m>(A, expectedSolution);
+
+        std::array<double, m * m> LU = A;
+        std::array<double, m> solution = B;
+        if (linearalgebra::solveLU(LU, solution) != 0 || !checkSolution(solution, expectedSolution)) {
+            log::cout() << "  Wrong solution evaluated by LU solver" << std::endl;
+            return 1;
+        }
+
+        // QR factorization
+        std::array<double, m * m> QR = A;
+        std::array<double, m> QtB = B;
+        if (linearalgebra::solveQR<m, m>(QR, QtB, solution) != 0 || !checkSolution(solution, expectedSolution)) {
+            log::cout() << "  Wrong solution evaluated by QR solver" << std::endl;
+            return 1;
+        }
+
+        // Cholesky factorization
+        A = generateMatrix<m>(generator, true);
+
+        expectedSolution = B;
+        solveReference<m>(A, expectedSolution);
+
+        std::array<double, m * m> LLt = A;
+        solution = B;
+        if (linearalgebra::solveCholesky(LLt, solution) != 0 || !checkSolution(solution, expectedSolution)) {
+            log::cout() << "  Wrong solution evaluated by Cholesky solver" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Test the batched solvers.
+*
+* Solutions evaluated by the batched solvers are compared with the ones
+* evaluated by the fixed-size solvers.
+*
+* \param generator is the random number generator
+* \param nSystems is the number of systems
+* \result Returns 0 on success, 1 otherwise.
+*/
+template<std::size_t m>
+int testBatchSolvers(std::mt19937 &generator, std::size_t nSystems)
+{
+    log::cout() << "  Testing batches of systems of size " << m << std::endl;
+
+    for (int symmetric = 0; symmetric < 2; ++symmetric) {
+        // Generate the systems, the last system is singular
+        std::vector<std::array<double, m * m>> A(nSystems);
+        std::vector<std::array<double, m>> B(nSystems);
+        for (std::size_t s = 0; s < nSystems; ++s) {
+            A[s] = generateMatrix<m>(generator, (symmetric != 0));
+            B[s] = generateVector<m>(generator);
+        }
+        A[nSystems - 1].fill(0.);
+
+        std::vector<double> batchA(m * m * nSystems);
+        std::vector<double> batchB(m * nSystems);
+        for (std::size_t s = 0; s < nSystems; ++s) {
+            for (std::size_t e = 0; e < m * m; ++e) {
+                batchA[e * nSystems + s] = A[s][e];
+            }
+            for (std::size_t i = 0; i < m; ++i) {
+                batchB[i * nSystems + s] = B[s][i];
+            }
+        }
+
+        // Solve the systems
+        std::vector<int> info(nSystems);
+        if (symmetric) {
+            linearalgebra::solveCholesky<m>(nSystems, batchA.data(), batchB.data(), info.data());
+        } else {
+            linearalgebra::solveLU<m>(nSystems, batchA.data(), batchB.data(), info.data());
+        }
+
+        // Check the solutions
+        for (std::size_t s = 0; s < nSystems; ++s) {
+            std::array<double, m> solution;
+            for (std::size_t i = 0; i < m; ++i) {
+                solution[i] = batchB[i * nSystems + s];
+            }
+
+            std::array<double, m> expectedSolution = B[s];
+            int expectedInfo;
+            if (symmetric) {
+                expectedInfo = linearalgebra::solveCholesky(A[s], expectedSolution);
+            } else {
+                expectedInfo = linearalgebra::solveLU(A[s], expectedSolution);
+            }
+
+            if (info[s] != expectedInfo) {
+                log::cout() << "  Wrong information returned for system " << s << std::endl;
+                return 1;
+            } else if (expectedInfo != 0) {
+                expectedSolution = B[s];
+            }
+
+            if (!checkSolution(solution, expectedSolution)) {
+                log::cout() << "  Wrong solution evaluated for system " << s << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing fixed-size solvers.
+*/
+int subtest_001()
+{
+    std::mt19937 generator(1);
+
+    int status = 0;
+    status += testFixedSizeSolvers<2>(generator);
+    status += testFixedSizeSolvers<3>(generator);
+    status += testFixedSizeSolvers<4>(generator);
+    status += testFixedSizeSolvers<5>(generator);
+    status += testFixedSizeSolvers<6>(generator);
+
+    if (status != 0) {
+        return 1;
+    }
+
+    // Least squares problem
+    log::cout() << "  Testing least squares problem" << std::endl;
+
+    std::array<double, 4 * 2> A = {{1., 0., 1., 1., 1., 2., 1., 3.}};
+    std::array<double, 4> B = {{1., 3., 4., 8.}};
+    std::array<double, 2> solution;
+    if (linearalgebra::solveQR<4, 2>(A, B, solution) != 0) {
+        log::cout() << "  Unable to solve least squares problem" << std::endl;
+        return 1;
+    }
+
+    std::array<double, 2> expectedSolution = {{0.7, 2.2}};
+    if (!checkSolution(solution, expectedSolution)) {
+        log::cout() << "  Wrong solution of the least squares problem" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing batched solvers.
+*/
+int subtest_002()
+{
+    std::mt19937 generator(2);
+
+    int status = 0;
+    status += testBatchSolvers<2>(generator, 1);
+    status += testBatchSolvers<3>(generator, 103);
+    status += testBatchSolvers<4>(generator, 1002);
+    status += testBatchSolvers<6>(generator, 61);
+
+    if (status != 0) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 003
+*
+* Comparing the performance of the small system solvers.
+*/
+int subtest_003()
+{
+    const std::size_t SIZE = 4;
+    const std::size_t N_SYSTEMS = 20000;
+
+    std::mt19937 generator(3);
+
+    std::vector<std::array<double, SIZE * SIZE>> A(N_SYSTEMS);
+    std::vector<std::array<double, SIZE>> B(N_SYSTEMS);
+    for (std::size_t s = 0; s < N_SYSTEMS; ++s) {
+        A[s] = generateMatrix<SIZE>(generator, false);
+        B[s] = generateVector<SIZE>(generator);
+    }
+
+    std::vector<double> batchA(SIZE * SIZE * N_SYSTEMS);
+    std::vector<double> batchB(SIZE * N_SYSTEMS);
+    for (std::size_t s = 0; s < N_SYSTEMS; ++s) {
+        for (std::size_t e = 0; e < SIZE * SIZE; ++e) {
+            batchA[e * N_SYSTEMS + s] = A[s][e];
+        }
+        for (std::size_t i = 0; i < SIZE; ++i) {
+            batchB[i * N_SYSTEMS + s] = B[s][i];
+        }
+    }
+
+    // LAPACK solver
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+
+    double checksum = 0.;
+    for (std::size_t s = 0; s < N_SYSTEMS; ++s) {
+        std::array<double, SIZE> solution = B[s];
+        solveReference<SIZE>(A[s], solution);
+        checksum += solution[0];
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    log::cout() << "  LAPACK solver: " << elapsed.count() << " s (checksum " << checksum << ")" << std::endl;
+
+    // Fixed-size solver
+    start = std::chrono::steady_clock::now();
+
+    checksum = 0.;
+    for (std::size_t s = 0; s < N_SYSTEMS; ++s) {
+        std::array<double, SIZE * SIZE> LU = A[s];
+        std::array<double, SIZE> solution = B[s];
+        linearalgebra::solveLU(LU, solution);
+        checksum += solution[0];
+    }
+
+    elapsed = std::chrono::steady_clock::now() - start;
+    log::cout() << "  Fixed-size solver: " << elapsed.count() << " s (checksum " << checksum << ")" << std::endl;
+
+    // Batched solver
+    start = std::chrono::steady_clock::now();
+
+    std::vector<int> info(N_SYSTEMS);
+    linearalgebra::solveLU<SIZE>(N_SYSTEMS, batchA.data(), batchB.data(), info.data());
+
+    checksum = 0.;
+    for (std::size_t s = 0; s < N_SYSTEMS; ++s) {
+        checksum += batchB[s];
+    }
+
+    elapsed = std::chrono::steady_clock::now() - start;
+    log::cout() << "  Batched solver: " << elapsed.count() << " s (checksum " << checksum << ")" << std::endl;
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::COMBINED);
+
+    // Run the subtests
+    log::cout() << "Testing solvers for small linear systems." << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+
+        status = subtest_003();
+        if (status != 0) {
+            return (30 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+}
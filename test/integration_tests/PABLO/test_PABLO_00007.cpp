@@ -0,0 +1,216 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Check the connectivity of the specified octree.
+*
+* The nodes should be unique and sorted according to their XYZ key, and
+* every octant should list its nodes following their local numbering.
+*
+* \param octree is the octree
+* \result Returns zero if the connectivity is valid, a non-zero value
+* otherwise.
+*/
+int checkConnectivity(const ParaTree &octree)
+{
+    const u32vector2D &connectivity = octree.getConnectivity();
+    const u32arr3vector &nodes = octree.getNodes();
+
+    if (connectivity.size() != octree.getNumOctants()) {
+        log::cout() << " Connectivity size doesn't match the number of octants." << std::endl;
+        return 1;
+    }
+
+    int dimension = octree.getDim();
+    for (std::size_t k = 1; k < nodes.size(); ++k) {
+        uint64_t previousKey = PABLO::computeXYZKey(dimension, nodes[k - 1][0], nodes[k - 1][1], nodes[k - 1][2]);
+        uint64_t currentKey  = PABLO::computeXYZKey(dimension, nodes[k][0], nodes[k][1], nodes[k][2]);
+        if (previousKey >= currentKey) {
+            log::cout() << " Nodes are not unique or not sorted." << std::endl;
+            return 1;
+        }
+    }
+
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        const Octant *octant = octree.getOctant(i);
+        if (connectivity[i].size() != octree.getNnodes()) {
+            log::cout() << " Wrong number of nodes for octant " << i << "." << std::endl;
+            return 1;
+        }
+
+        for (uint8_t j = 0; j < octree.getNnodes(); ++j) {
+            if (nodes[connectivity[i][j]] != octant->getLogicalNode(j)) {
+                log::cout() << " Wrong node " << int(j) << " for octant " << i << "." << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing computation and update of the connectivity of a 3D octree.
+*/
+int subtest_001()
+{
+    PabloUniform octree(0., 0., 0., 1., 3);
+    const ParaTree &tree = octree;
+
+    // Uniform octree
+    for (int iter = 0; iter < 4; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+    octree.computeConnectivity();
+
+    log::cout() << " Uniform octree : " << octree.getNumOctants() << " octants, " << tree.getNodes().size() << " nodes" << std::endl;
+    if (tree.getNodes().size() != 17 * 17 * 17) {
+        log::cout() << " Wrong number of nodes." << std::endl;
+        return 1;
+    }
+
+    if (checkConnectivity(octree) != 0) {
+        return 1;
+    }
+
+    // Non-uniform octree
+    for (int iter = 0; iter < 2; ++iter) {
+        for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+            std::array<double, 3> center = octree.getCenter(i);
+            if (center[0] < 0.5 && center[1] < center[2]) {
+                octree.setMarker(i, 1);
+            } else if (center[0] > 0.75) {
+                octree.setMarker(i, -1);
+            }
+        }
+        octree.adapt();
+        octree.updateConnectivity();
+
+        log::cout() << " Adapted octree : " << octree.getNumOctants() << " octants, " << tree.getNodes().size() << " nodes" << std::endl;
+        if (checkConnectivity(octree) != 0) {
+            return 1;
+        }
+    }
+
+    // Updated connectivity should match the connectivity computed from scratch
+    u32vector2D updatedConnectivity = octree.getConnectivity();
+    u32arr3vector updatedNodes = tree.getNodes();
+
+    octree.clearConnectivity();
+    octree.computeConnectivity();
+    if (octree.getConnectivity() != updatedConnectivity || tree.getNodes() != updatedNodes) {
+        log::cout() << " Updated connectivity doesn't match the computed one." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing the connectivity of a large uniform octree.
+*/
+int subtest_002()
+{
+    PabloUniform octree(0., 0., 0., 1., 2);
+    const ParaTree &tree = octree;
+    for (int iter = 0; iter < 9; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+
+    octree.computeConnectivity();
+    octree.updateConnectivity();
+    log::cout() << " Connectivity of " << octree.getNumOctants() << " octants : " << tree.getNodes().size() << " nodes" << std::endl;
+
+    if (tree.getNodes().size() != 513 * 513) {
+        log::cout() << " Wrong number of nodes." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    int nProcs;
+    int rank;
+#if BITPIT_ENABLE_MPI==1
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#else
+    nProcs = 1;
+    rank   = 0;
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_SEPARATE, false, nProcs, rank);
+    log::cout() << log::fileVerbosity(log::INFO);
+    log::cout() << log::disableConsole();
+
+    // Run the subtests
+    log::cout() << "Testing octree connectivity" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+}
@@ -0,0 +1,389 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <cmath>
+#include <vector>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Check the octants of the specified octree.
+*
+* The octants should be sorted according to their Morton number, the Morton
+* number should match the logical coordinates of the octant and the boundary
+* information should match the position of the octant inside the domain.
+*
+* \param octree is the octree
+* \result Returns zero if the octants are valid, a non-zero value otherwise.
+*/
+int checkOctants(const ParaTree &octree)
+{
+    int dimension = octree.getDim();
+    uint32_t maxLength = octree.getMaxLength();
+
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        const Octant *octant = octree.getOctant(i);
+        u32array3 coords = octant->getLogicalCoordinates();
+        uint32_t size = octant->getLogicalSize();
+
+        if (i > 0 && octree.getMorton(i - 1) >= octree.getMorton(i)) {
+            log::cout() << " Octants are not sorted." << std::endl;
+            return 1;
+        }
+
+        if (octree.getMorton(i) != PABLO::computeMorton(dimension, coords[0], coords[1], coords[2])) {
+            log::cout() << " Wrong Morton number for octant " << i << "." << std::endl;
+            return 1;
+        }
+
+        for (int d = 0; d < dimension; ++d) {
+            bool negativeBound = (coords[d] == 0);
+            bool positiveBound = (coords[d] + size == maxLength);
+            if (octree.getBound(octant, 2 * d) != negativeBound || octree.getBound(octant, 2 * d + 1) != positiveBound) {
+                log::cout() << " Wrong boundary information for octant " << i << "." << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Check the mapping of the last adaption of the specified octree.
+*
+* Octants that have not been modified should map to an octant with the same
+* Morton number, new octants created by a refinement should map to their
+* father and new octants created by a coarsening should map to their first
+* child.
+*
+* \param octree is the octree
+* \param previousMortons are the Morton numbers of the octants before the
+* adaption
+* \param previousLevels are the levels of the octants before the adaption
+* \result Returns zero if the mapping is valid, a non-zero value otherwise.
+*/
+int checkMapping(const ParaTree &octree, const std::vector<uint64_t> &previousMortons,
+                 const std::vector<uint8_t> &previousLevels)
+{
+    u32vector mapper;
+    bvector isGhost;
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        octree.getMapping(i, mapper, isGhost);
+        uint32_t previousIdx = mapper[0];
+
+        const Octant *octant = octree.getOctant(i);
+        uint64_t morton = octree.getMorton(i);
+        uint8_t level = octree.getLevel(i);
+        if (octree.getIsNewR(i)) {
+            if (previousLevels[previousIdx] != level - 1 || octant->computeFatherMorton() != previousMortons[previousIdx]) {
+                log::cout() << " Wrong mapping for refined octant " << i << "." << std::endl;
+                return 1;
+            }
+        } else if (octree.getIsNewC(i)) {
+            if (previousLevels[previousIdx] != level + 1 || previousMortons[previousIdx] != morton) {
+                log::cout() << " Wrong mapping for coarsened octant " << i << "." << std::endl;
+                return 1;
+            }
+        } else {
+            if (previousLevels[previousIdx] != level || previousMortons[previousIdx] != morton) {
+                log::cout() << " Wrong mapping for octant " << i << "." << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Store the Morton numbers and the levels of the octants of the specified
+* octree.
+*
+* \param octree is the octree
+* \param[out] mortons on output will contain the Morton numbers of the octants
+* \param[out] levels on output will contain the levels of the octants
+*/
+void storeOctants(const ParaTree &octree, std::vector<uint64_t> *mortons, std::vector<uint8_t> *levels)
+{
+    mortons->resize(octree.getNumOctants());
+    levels->resize(octree.getNumOctants());
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        (*mortons)[i] = octree.getMorton(i);
+        (*levels)[i]  = octree.getLevel(i);
+    }
+}
+
+/*!
+* Subtest 001
+*
+* Testing global refinement and coarsening of a 3D octree.
+*/
+int subtest_001()
+{
+    PabloUniform octree(0., 0., 0., 1., 3);
+
+    std::vector<uint64_t> previousMortons;
+    std::vector<uint8_t> previousLevels;
+
+    // Global refinement
+    for (int iter = 0; iter < 6; ++iter) {
+        storeOctants(octree, &previousMortons, &previousLevels);
+
+        octree.adaptGlobalRefine(true);
+        log::cout() << " Global refinement to " << octree.getNumOctants() << " octants" << std::endl;
+
+        if (octree.getNumOctants() != (uint32_t(1) << (3 * (iter + 1)))) {
+            log::cout() << " Wrong number of octants." << std::endl;
+            return 1;
+        }
+
+        if (checkOctants(octree) != 0 || checkMapping(octree, previousMortons, previousLevels) != 0) {
+            return 1;
+        }
+    }
+
+    // Global coarsening
+    storeOctants(octree, &previousMortons, &previousLevels);
+
+    octree.adaptGlobalCoarse(true);
+    log::cout() << " Global coarsening to " << octree.getNumOctants() << " octants" << std::endl;
+
+    if (octree.getNumOctants() != (uint32_t(1) << (3 * 5))) {
+        log::cout() << " Wrong number of octants." << std::endl;
+        return 1;
+    }
+
+    if (checkOctants(octree) != 0 || checkMapping(octree, previousMortons, previousLevels) != 0) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing local refinement and coarsening of a 2D octree.
+*/
+int subtest_002()
+{
+    PabloUniform octree(0., 0., 0., 1., 2);
+    for (int iter = 0; iter < 4; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+
+    std::vector<uint64_t> previousMortons;
+    std::vector<uint8_t> previousLevels;
+    for (int iter = 0; iter < 6; ++iter) {
+        for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+            std::array<double, 3> center = octree.getCenter(i);
+            double radius = std::sqrt(center[0] * center[0] + center[1] * center[1]);
+            if (std::abs(radius - 0.1 * (iter + 3)) < 0.1) {
+                octree.setMarker(i, 1);
+            } else if (octree.getLevel(i) > 3) {
+                octree.setMarker(i, -1);
+            }
+        }
+
+        storeOctants(octree, &previousMortons, &previousLevels);
+        octree.adapt(true);
+
+        log::cout() << " Adapted octree : " << octree.getNumOctants() << " octants" << std::endl;
+        if (checkOctants(octree) != 0 || checkMapping(octree, previousMortons, previousLevels) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Compare the octants and the mapping of the last adaption of the specified
+* octrees.
+*
+* \param octree is the octree
+* \param referenceOctree is the reference octree
+* \result Returns zero if the octrees are equal, a non-zero value otherwise.
+*/
+int compareOctrees(const ParaTree &octree, const ParaTree &referenceOctree)
+{
+    if (octree.getNumOctants() != referenceOctree.getNumOctants()) {
+        log::cout() << " Number of octants doesn't match the reference." << std::endl;
+        return 1;
+    }
+
+    if (octree.getLocalMaxDepth() != referenceOctree.getLocalMaxDepth()) {
+        log::cout() << " Maximum depth doesn't match the reference." << std::endl;
+        return 1;
+    }
+
+    u32vector mapper;
+    u32vector referenceMapper;
+    bvector isGhost;
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        if (octree.getMorton(i) != referenceOctree.getMorton(i) || octree.getLevel(i) != referenceOctree.getLevel(i) ||
+            octree.getMarker(i) != referenceOctree.getMarker(i) || octree.getIsNewR(i) != referenceOctree.getIsNewR(i)) {
+            log::cout() << " Octant " << i << " doesn't match the reference." << std::endl;
+            return 1;
+        }
+
+        octree.getMapping(i, mapper, isGhost);
+        referenceOctree.getMapping(i, referenceMapper, isGhost);
+        if (mapper != referenceMapper) {
+            log::cout() << " Mapping of octant " << i << " doesn't match the reference." << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 003
+*
+* Testing threaded refinement of 2D and 3D octrees against serial refinement.
+*/
+int subtest_003()
+{
+    for (int dimension = 2; dimension <= 3; ++dimension) {
+        PabloUniform referenceOctree(0., 0., 0., 1., dimension);
+
+        PabloUniform octree(0., 0., 0., 1., dimension);
+        octree.setRefinementThreadCount(4);
+
+        // Global refinement
+        int nGlobalRefinements = (dimension == 2) ? 8 : 5;
+        for (int iter = 0; iter < nGlobalRefinements; ++iter) {
+            referenceOctree.adaptGlobalRefine(true);
+            octree.adaptGlobalRefine(true);
+            if (compareOctrees(octree, referenceOctree) != 0) {
+                return 1;
+            }
+        }
+
+        log::cout() << " Threaded global refinement to " << octree.getNumOctants() << " octants" << std::endl;
+
+        // Local refinement
+        //
+        // Octants near a sphere are refined, some of them twice. The band of
+        // refined octants is narrowed at the second iteration.
+        for (int iter = 0; iter < 2; ++iter) {
+            double bandWidth = (iter == 0) ? 0.05 : 0.01;
+            for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+                std::array<double, 3> center = octree.getCenter(i);
+                double radius = 0.;
+                for (int d = 0; d < dimension; ++d) {
+                    radius += center[d] * center[d];
+                }
+                radius = std::sqrt(radius);
+
+                if (std::abs(radius - 0.5) < bandWidth) {
+                    int8_t marker = (iter == 0 && center[0] < 0.5) ? 2 : 1;
+                    referenceOctree.setMarker(i, marker);
+                    octree.setMarker(i, marker);
+                }
+            }
+
+            referenceOctree.adapt(true);
+            octree.adapt(true);
+
+            log::cout() << " Threaded local refinement to " << octree.getNumOctants() << " octants" << std::endl;
+            if (compareOctrees(octree, referenceOctree) != 0) {
+                return 1;
+            }
+
+            if (checkOctants(octree) != 0) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    int nProcs;
+    int rank;
+#if BITPIT_ENABLE_MPI==1
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#else
+    nProcs = 1;
+    rank   = 0;
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_SEPARATE, false, nProcs, rank);
+    log::cout() << log::fileVerbosity(log::INFO);
+    log::cout() << log::disableConsole();
+
+    // Run the subtests
+    log::cout() << "Testing octree refinement and coarsening" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+
+        status = subtest_003();
+        if (status != 0) {
+            return (30 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
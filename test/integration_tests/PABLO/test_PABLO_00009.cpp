@@ -0,0 +1,239 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <cmath>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Check the intersections of the specified octree.
+*
+* The area of the boundary intersections should match the area of the
+* boundary of the domain and the area of the internal intersections should
+* be half the area of the faces of the octants not lying on the boundary.
+*
+* \param octree is the octree
+* \param expectedCount is the expected number of intersections, a negative
+* value disables the check
+* \result Returns zero if the intersections are valid, a non-zero value
+* otherwise.
+*/
+int checkIntersections(PabloUniform &octree, long expectedCount)
+{
+    octree.computeIntersections();
+
+    log::cout() << " Computed " << octree.getNumIntersections() << " intersections" << std::endl;
+    if (expectedCount >= 0 && static_cast<long>(octree.getNumIntersections()) != expectedCount) {
+        log::cout() << " Wrong number of intersections." << std::endl;
+        return 1;
+    }
+
+    int dimension = octree.getDim();
+    int nFaces = 2 * dimension;
+    double domainBoundaryArea = nFaces * std::pow(octree.getL(), dimension - 1);
+
+    double faceArea = 0.;
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        faceArea += nFaces * octree.getArea(i);
+    }
+
+    double boundaryArea = 0.;
+    double internalArea = 0.;
+    for (uint32_t i = 0; i < octree.getNumIntersections(); ++i) {
+        Intersection *intersection = octree.getIntersection(i);
+
+        u32vector owners = octree.getOwners(intersection);
+        if (octree.getFace(intersection) >= nFaces) {
+            log::cout() << " Wrong face for intersection " << i << "." << std::endl;
+            return 1;
+        }
+
+        if (octree.getBound(intersection)) {
+            if (owners[0] != owners[1] || octree.getIsGhost(intersection)) {
+                log::cout() << " Wrong owners for boundary intersection " << i << "." << std::endl;
+                return 1;
+            }
+
+            boundaryArea += octree.getArea(intersection);
+        } else {
+            if (owners[0] == owners[1]) {
+                log::cout() << " Wrong owners for internal intersection " << i << "." << std::endl;
+                return 1;
+            }
+
+            uint8_t finerLevel = std::max(octree.getLevel(owners[0]), octree.getLevel(owners[1]));
+            if (octree.getLevel(intersection) != finerLevel || octree.getLevel(owners[octree.getFiner(intersection)]) != finerLevel) {
+                log::cout() << " Wrong finer owner for internal intersection " << i << "." << std::endl;
+                return 1;
+            }
+
+            internalArea += octree.getArea(intersection);
+        }
+    }
+
+    double tolerance = 1e-12;
+    if (std::abs(boundaryArea - domainBoundaryArea) > tolerance) {
+        log::cout() << " Wrong area of boundary intersections." << std::endl;
+        return 1;
+    }
+
+    if (std::abs(internalArea - 0.5 * (faceArea - domainBoundaryArea)) > tolerance) {
+        log::cout() << " Wrong area of internal intersections." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing intersections of a 2D octree.
+*/
+int subtest_001()
+{
+    PabloUniform octree(0., 0., 0., 1., 2);
+    for (int iter = 0; iter < 3; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+
+    // Uniform octree
+    if (checkIntersections(octree, 2 * 8 * 7 + 4 * 8) != 0) {
+        return 1;
+    }
+
+    // Non-uniform octree
+    for (int iter = 0; iter < 3; ++iter) {
+        for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+            std::array<double, 3> center = octree.getCenter(i);
+            if (center[0] + center[1] < 0.6) {
+                octree.setMarker(i, 1);
+            } else if (center[0] > 0.75) {
+                octree.setMarker(i, -1);
+            }
+        }
+        octree.adapt();
+
+        if (checkIntersections(octree, -1) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing intersections of a 3D octree.
+*/
+int subtest_002()
+{
+    PabloUniform octree(0., 0., 0., 1., 3);
+    for (int iter = 0; iter < 2; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+
+    // Uniform octree
+    if (checkIntersections(octree, 3 * 16 * 3 + 6 * 16) != 0) {
+        return 1;
+    }
+
+    // Non-uniform octree
+    for (int iter = 0; iter < 2; ++iter) {
+        for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+            std::array<double, 3> center = octree.getCenter(i);
+            if (center[0] + center[1] + center[2] < 0.8) {
+                octree.setMarker(i, 1);
+            }
+        }
+        octree.adapt();
+
+        if (checkIntersections(octree, -1) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    int nProcs;
+    int rank;
+#if BITPIT_ENABLE_MPI==1
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#else
+    nProcs = 1;
+    rank   = 0;
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_SEPARATE, false, nProcs, rank);
+    log::cout() << log::fileVerbosity(log::INFO);
+    log::cout() << log::disableConsole();
+
+    // Run the subtests
+    log::cout() << "Testing octree intersections" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
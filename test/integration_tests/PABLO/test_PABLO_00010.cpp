@@ -0,0 +1,216 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <vector>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Check the geometry of the octants of the specified octree.
+*
+* Geometry returned by the octree, both octant by octant and for all local
+* octants at once, is compared with the geometry evaluated converting the
+* logical geometry of the octants evaluated by the underlying ParaTree.
+*
+* \param octree is the octree
+* \result Returns zero if the geometry is valid, a non-zero value otherwise.
+*/
+int checkGeometry(const PabloUniform &octree)
+{
+    const ParaTree &tree = octree;
+
+    int dimension = octree.getDim();
+    double length = octree.getL();
+    darray3 origin = octree.getOrigin();
+
+    uint32_t nOctants = octree.getNumOctants();
+
+    std::vector<double> sizes(nOctants);
+    std::vector<double> areas(nOctants);
+    std::vector<double> volumes(nOctants);
+    std::array<std::vector<double>, 3> centers;
+    for (std::vector<double> &centerCoords : centers) {
+        centerCoords.resize(nOctants);
+    }
+
+    octree.getSizes(sizes.data());
+    octree.getAreas(areas.data());
+    octree.getVolumes(volumes.data());
+    octree.getCenters(centers[0].data(), centers[1].data(), centers[2].data());
+    log::cout() << " Geometry of " << nOctants << " octants evaluated" << std::endl;
+
+    for (uint32_t i = 0; i < nOctants; ++i) {
+        double expectedSize   = length * tree.getSize(i);
+        double expectedArea   = uipow(length, dimension - 1) * tree.getArea(i);
+        double expectedVolume = uipow(length, dimension) * tree.getVolume(i);
+
+        if (octree.getSize(i) != expectedSize || octree.getSize(octree.getOctant(i)) != expectedSize || sizes[i] != expectedSize) {
+            log::cout() << " Wrong size for octant " << i << "." << std::endl;
+            return 1;
+        }
+
+        if (octree.getArea(i) != expectedArea || octree.getArea(octree.getOctant(i)) != expectedArea || areas[i] != expectedArea) {
+            log::cout() << " Wrong area for octant " << i << "." << std::endl;
+            return 1;
+        }
+
+        if (octree.getVolume(i) != expectedVolume || octree.getVolume(octree.getOctant(i)) != expectedVolume || volumes[i] != expectedVolume) {
+            log::cout() << " Wrong volume for octant " << i << "." << std::endl;
+            return 1;
+        }
+
+        darray3 logicalCenter = tree.getCenter(i);
+        darray3 center = octree.getCenter(i);
+        for (int d = 0; d < 3; ++d) {
+            double expectedCenter = origin[d] + length * logicalCenter[d];
+            if (center[d] != expectedCenter || centers[d][i] != expectedCenter) {
+                log::cout() << " Wrong center for octant " << i << "." << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing geometry of the octants of a 2D octree.
+*/
+int subtest_001()
+{
+    PabloUniform octree(-1., 2., 0., 3.5, 2);
+    for (int iter = 0; iter < 6; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+
+    for (int iter = 0; iter < 3; ++iter) {
+        for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+            std::array<double, 3> center = octree.getCenter(i);
+            if (center[0] + center[1] < 2.5) {
+                octree.setMarker(i, 1);
+            }
+        }
+        octree.adapt();
+    }
+
+    if (checkGeometry(octree) != 0) {
+        return 1;
+    }
+
+    octree.setL(0.7);
+    if (checkGeometry(octree) != 0) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing geometry of the octants of a 3D octree.
+*/
+int subtest_002()
+{
+    PabloUniform octree(0.5, -0.25, 1., 2.5, 3);
+    for (int iter = 0; iter < 5; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        std::array<double, 3> center = octree.getCenter(i);
+        if (center[0] < 1. && center[2] > 2.) {
+            octree.setMarker(i, 1);
+        }
+    }
+    octree.adapt();
+
+    if (checkGeometry(octree) != 0) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    int nProcs;
+    int rank;
+#if BITPIT_ENABLE_MPI==1
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#else
+    nProcs = 1;
+    rank   = 0;
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_SEPARATE, false, nProcs, rank);
+    log::cout() << log::fileVerbosity(log::INFO);
+    log::cout() << log::disableConsole();
+
+    // Run the subtests
+    log::cout() << "Testing geometry of uniform octrees" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
@@ -0,0 +1,159 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Check if the weights of the local octants are balanced among the processes.
+*
+* \param pablo is the octree
+* \param weights are the weights of the local octants
+* \result Returns zero if the weights are balanced, a non-zero value otherwise.
+*/
+int checkBalancedWeights(const ParaTree &pablo, const std::vector<double> &weights)
+{
+    double localWeight = 0.;
+    double localMaxWeight = 0.;
+    for (double weight : weights) {
+        localWeight += weight;
+        localMaxWeight = std::max(weight, localMaxWeight);
+    }
+
+    double globalWeight;
+    double maxWeight;
+    MPI_Allreduce(&localWeight, &globalWeight, 1, MPI_DOUBLE, MPI_SUM, pablo.getComm());
+    MPI_Allreduce(&localMaxWeight, &maxWeight, 1, MPI_DOUBLE, MPI_MAX, pablo.getComm());
+
+    double averageWeight = globalWeight / pablo.getNproc();
+
+    log::cout() << "Weight of the partition = " << localWeight << " (average weight = " << averageWeight << ")" << std::endl;
+    if (std::abs(localWeight - averageWeight) > maxWeight) {
+        log::cout() << "Partition weight is not balanced!" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing weighted load balance of a 2D octree.
+*/
+int subtest_001()
+{
+    // Instantation of a 2D para_tree object
+    ParaTree pablo(2);
+
+    // Refine globally
+    for (int iter = 0; iter < 5; ++iter) {
+        pablo.adaptGlobalRefine();
+    }
+
+    // Weighted load balance of a serial tree
+    //
+    // Octants on the left half of the domain are heavier than octants on the
+    // right half of the domain.
+    log::cout() << "Load balance of the serial tree" << std::endl;
+
+    std::vector<double> weights(pablo.getNumOctants());
+    for (uint32_t i = 0; i < pablo.getNumOctants(); ++i) {
+        weights[i] = (pablo.getCenter(i)[0] < 0.5) ? 4. : 1.;
+    }
+
+    pablo.loadBalance(&weights);
+
+    weights.resize(pablo.getNumOctants());
+    for (uint32_t i = 0; i < pablo.getNumOctants(); ++i) {
+        weights[i] = (pablo.getCenter(i)[0] < 0.5) ? 4. : 1.;
+    }
+
+    int status = checkBalancedWeights(pablo, weights);
+    if (status != 0) {
+        return status;
+    }
+
+    // Weighted load balance of a distributed tree
+    //
+    // Octants on the bottom half of the domain are heavier than octants on
+    // the top half of the domain.
+    log::cout() << "Load balance of the distributed tree" << std::endl;
+
+    for (uint32_t i = 0; i < pablo.getNumOctants(); ++i) {
+        weights[i] = (pablo.getCenter(i)[1] < 0.5) ? 3. : 0.5;
+    }
+
+    pablo.loadBalance(&weights);
+
+    weights.resize(pablo.getNumOctants());
+    for (uint32_t i = 0; i < pablo.getNumOctants(); ++i) {
+        weights[i] = (pablo.getCenter(i)[1] < 0.5) ? 3. : 0.5;
+    }
+
+    status = checkBalancedWeights(pablo, weights);
+    if (status != 0) {
+        return status;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+    MPI_Init(&argc,&argv);
+
+    // Initialize the logger
+    int nProcs;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+    log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+    // Run the subtests
+    log::cout() << "Testing weighted load balance" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return status;
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+    MPI_Finalize();
+}
@@ -0,0 +1,173 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Evaluate a checksum of the octants of the specified tree.
+*
+* \param octree is the octree
+* \param[out] nGlobalOctants on output will contain the global number of
+* octants
+* \param[out] checksum on output will contain the checksum of the octants
+*/
+void evalChecksum(const PabloUniform &octree, uint64_t *nGlobalOctants, double *checksum)
+{
+    double localChecksum = 0.;
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        std::array<double, 3> center = octree.getCenter(i);
+        localChecksum += octree.getVolume(i) * (1. + center[0] + 2. * center[1] + 3. * center[2]);
+    }
+
+    uint64_t nLocalOctants = octree.getNumOctants();
+    MPI_Allreduce(&nLocalOctants, nGlobalOctants, 1, MPI_UINT64_T, MPI_SUM, octree.getComm());
+    MPI_Allreduce(&localChecksum, checksum, 1, MPI_DOUBLE, MPI_SUM, octree.getComm());
+}
+
+/*!
+* Subtest 001
+*
+* Testing collective dump and restore of a 3D octree using a different number
+* of processes.
+*
+* \param rank is the rank of the process
+*/
+int subtest_001(int rank)
+{
+    // Create the octree
+    PabloUniform octree(-1., 2., 0.5, 4., 3);
+
+    for (int iter = 0; iter < 3; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        if (octree.getCenter(i)[0] < 0.) {
+            octree.setMarker(i, 1);
+        }
+    }
+    octree.adapt();
+
+    octree.loadBalance();
+
+    uint64_t nGlobalOctants;
+    double checksum;
+    evalChecksum(octree, &nGlobalOctants, &checksum);
+    log::cout() << " Original octants : " << nGlobalOctants << ", checksum : " << checksum << std::endl;
+
+    // Dump the tree
+    octree.dumpCollective("Pablo_parallel_00008_dump.dat");
+
+    // Restore the tree using all the processes
+    {
+        PabloUniform octreeRestored;
+        octreeRestored.restoreCollective("Pablo_parallel_00008_dump.dat");
+
+        uint64_t nRestoredOctants;
+        double restoredChecksum;
+        evalChecksum(octreeRestored, &nRestoredOctants, &restoredChecksum);
+        log::cout() << " Restored octants (all processes) : " << nRestoredOctants << ", checksum : " << restoredChecksum << std::endl;
+
+        if (nRestoredOctants != nGlobalOctants || std::abs(restoredChecksum - checksum) > 1e-10 * std::abs(checksum)) {
+            log::cout() << " Restored tree doesn't match the original one." << std::endl;
+            return 1;
+        }
+
+        if (octreeRestored.getNumOctants() != octree.getNumOctants()) {
+            log::cout() << " Restored partition doesn't match the original one." << std::endl;
+            return 1;
+        }
+
+        if (octreeRestored.getL() != octree.getL() || octreeRestored.getOrigin() != octree.getOrigin()) {
+            log::cout() << " Restored geometry doesn't match the original one." << std::endl;
+            return 1;
+        }
+    }
+
+    // Restore the tree using a subset of the processes
+    MPI_Comm subCommunicator;
+    MPI_Comm_split(MPI_COMM_WORLD, (rank < 2) ? 0 : MPI_UNDEFINED, rank, &subCommunicator);
+    if (subCommunicator != MPI_COMM_NULL) {
+        PabloUniform octreeRestored(ParaTree::DEFAULT_LOG_FILE, subCommunicator);
+        octreeRestored.restoreCollective("Pablo_parallel_00008_dump.dat");
+
+        uint64_t nRestoredOctants;
+        double restoredChecksum;
+        evalChecksum(octreeRestored, &nRestoredOctants, &restoredChecksum);
+        log::cout() << " Restored octants (two processes) : " << nRestoredOctants << ", checksum : " << restoredChecksum << std::endl;
+
+        if (nRestoredOctants != nGlobalOctants || std::abs(restoredChecksum - checksum) > 1e-10 * std::abs(checksum)) {
+            log::cout() << " Restored tree doesn't match the original one." << std::endl;
+            return 1;
+        }
+
+        // The restored tree can be adapted and balanced
+        octreeRestored.adaptGlobalRefine();
+        octreeRestored.loadBalance();
+
+        MPI_Comm_free(&subCommunicator);
+    }
+
+    // Done
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+    MPI_Init(&argc,&argv);
+
+    // Initialize the logger
+    int nProcs;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+    log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+    // Run the subtests
+    log::cout() << "Testing parallel collective octree dump and restore." << std::endl;
+
+    int status;
+    try {
+        status = subtest_001(rank);
+        if (status != 0) {
+            return status;
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+    MPI_Finalize();
+}
@@ -0,0 +1,196 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Refine the octants close to the specified point.
+*
+* \param octree is the octree
+* \param point is the point
+* \param radius is the radius of the refinement region
+*/
+void refineNearPoint(PabloUniform *octree, const std::array<double, 3> &point, double radius)
+{
+    for (uint32_t i = 0; i < octree->getNumOctants(); ++i) {
+        std::array<double, 3> center = octree->getCenter(i);
+        double distance = std::sqrt(std::pow(center[0] - point[0], 2) + std::pow(center[1] - point[1], 2));
+        if (distance < radius + 0.5 * octree->getSize(i)) {
+            octree->setMarker(i, 1);
+        }
+    }
+    octree->adapt();
+}
+
+/*!
+* Evaluate a checksum of the octants of the specified tree.
+*
+* \param octree is the octree
+* \param[out] nGlobalOctants on output will contain the global number of
+* octants
+* \param[out] checksum on output will contain the checksum of the octants
+*/
+void evalChecksum(const PabloUniform &octree, uint64_t *nGlobalOctants, double *checksum)
+{
+    double localChecksum = 0.;
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        std::array<double, 3> center = octree.getCenter(i);
+        localChecksum += octree.getVolume(i) * (1. + center[0] + 2. * center[1]);
+    }
+
+    uint64_t nLocalOctants = octree.getNumOctants();
+    MPI_Allreduce(&nLocalOctants, nGlobalOctants, 1, MPI_UINT64_T, MPI_SUM, octree.getComm());
+    MPI_Allreduce(&localChecksum, checksum, 1, MPI_DOUBLE, MPI_SUM, octree.getComm());
+}
+
+/*!
+* Subtest 001
+*
+* Testing 2:1 balance of a partitioned 2D octree refined close to a point
+* located across the borders of the partitions.
+*
+* \param rank is the rank of the process
+*/
+int subtest_001(int rank)
+{
+    BITPIT_UNUSED(rank);
+
+    const std::array<double, 3> point = {{0.51, 0.49, 0.}};
+    const int nRefinements = 6;
+
+    // Create the partitioned octree
+    PabloUniform octree(0., 0., 0., 1., 2);
+    for (int iter = 0; iter < 3; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+    octree.loadBalance();
+
+    // Create a reference octree on every process
+    PabloUniform referenceOctree(0., 0., 0., 1., 2, ParaTree::DEFAULT_LOG_FILE, MPI_COMM_SELF);
+    for (int iter = 0; iter < 3; ++iter) {
+        referenceOctree.adaptGlobalRefine();
+    }
+
+    // Refine the octrees close to the point
+    for (int iter = 0; iter < nRefinements; ++iter) {
+        double radius = 0.02 / (iter + 1);
+
+        refineNearPoint(&octree, point, radius);
+        log::cout() << " Refinement " << iter << " : balance iterations " << octree.getBalanceIterationCount();
+        log::cout() << ", communication rounds " << octree.getBalanceCommunicationCount() << std::endl;
+
+        refineNearPoint(&referenceOctree, point, radius);
+    }
+
+    // The balanced octree should match the reference one
+    uint64_t nGlobalOctants;
+    double checksum;
+    evalChecksum(octree, &nGlobalOctants, &checksum);
+    log::cout() << " Partitioned octree octants : " << nGlobalOctants << ", checksum : " << checksum << std::endl;
+
+    uint64_t nReferenceOctants;
+    double referenceChecksum;
+    evalChecksum(referenceOctree, &nReferenceOctants, &referenceChecksum);
+    log::cout() << " Reference octree octants : " << nReferenceOctants << ", checksum : " << referenceChecksum << std::endl;
+
+    if (nGlobalOctants != nReferenceOctants || std::abs(checksum - referenceChecksum) > 1e-10 * std::abs(referenceChecksum)) {
+        log::cout() << " Balanced octree doesn't match the reference one." << std::endl;
+        return 1;
+    }
+
+    if (referenceOctree.getBalanceCommunicationCount() != 0) {
+        log::cout() << " Balance of a serial octree should not communicate." << std::endl;
+        return 1;
+    }
+
+    // Check the 2:1 balance across the faces, including the ghost octants
+    int nUnbalanced = 0;
+    std::vector<uint32_t> neighs;
+    std::vector<bool> isGhost;
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        int level = octree.getLevel(i);
+        for (uint8_t face = 0; face < octree.getNfaces(); ++face) {
+            octree.findNeighbours(i, face, 1, neighs, isGhost);
+            for (std::size_t k = 0; k < neighs.size(); ++k) {
+                int neighLevel;
+                if (isGhost[k]) {
+                    neighLevel = octree.getLevel(octree.getGhostOctant(neighs[k]));
+                } else {
+                    neighLevel = octree.getLevel(neighs[k]);
+                }
+
+                if (std::abs(level - neighLevel) > 1) {
+                    ++nUnbalanced;
+                }
+            }
+        }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &nUnbalanced, 1, MPI_INT, MPI_SUM, octree.getComm());
+    if (nUnbalanced != 0) {
+        log::cout() << " Found " << nUnbalanced << " unbalanced faces." << std::endl;
+        return 1;
+    }
+
+    // Done
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+    MPI_Init(&argc,&argv);
+
+    // Initialize the logger
+    int nProcs;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+    log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+    // Run the subtests
+    log::cout() << "Testing 2:1 balance of a partitioned octree." << std::endl;
+
+    int status;
+    try {
+        status = subtest_001(rank);
+        if (status != 0) {
+            return status;
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+    MPI_Finalize();
+}
@@ -0,0 +1,271 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <chrono>
+#include <memory>
+#include <random>
+
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Generate a list of random points inside the specified box.
+*
+* Points are generated using a fixed seed, hence all the processes will
+* generate the same points.
+*
+* \param nPoints is the number of points
+* \param origin is the origin of the box
+* \param length is the length of the box
+* \result The generated points.
+*/
+std::vector<std::array<double, 3>> generatePoints(std::size_t nPoints, const std::array<double, 3> &origin, double length)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-0.1, 1.1);
+
+    std::vector<std::array<double, 3>> points(nPoints);
+    for (std::array<double, 3> &point : points) {
+        for (int d = 0; d < 3; ++d) {
+            point[d] = origin[d] + length * distribution(generator);
+        }
+    }
+
+    return points;
+}
+
+/*!
+* Check that the batched location of the points matches the location of
+* the single points.
+*
+* \param octree is the octree
+* \param points are the points, in physical coordinates
+* \result Returns the number of points whose location doesn't match.
+*/
+int checkPointLocation(const PabloUniform &octree, const std::vector<std::array<double, 3>> &points)
+{
+    std::size_t nPoints = points.size();
+
+    // Physical coordinates
+    std::vector<uint32_t> ids(nPoints);
+    std::unique_ptr<bool[]> isGhost(new bool[nPoints]);
+    octree.getPointOwnerIdx(nPoints, points.data(), ids.data(), isGhost.get());
+
+    std::vector<uint32_t> internalIds(nPoints);
+    octree.getPointOwnerIdx(nPoints, points.data(), internalIds.data());
+
+    int nErrors = 0;
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        bool expectedIsGhost;
+        uint32_t expectedId = octree.getPointOwnerIdx(points[n], expectedIsGhost);
+        if (ids[n] != expectedId || isGhost[n] != expectedIsGhost) {
+            ++nErrors;
+        }
+
+        uint32_t expectedInternalId = octree.getPointOwnerIdx(points[n]);
+        if (internalIds[n] != expectedInternalId) {
+            ++nErrors;
+        }
+    }
+
+    // Logical coordinates
+    const ParaTree &tree = octree;
+
+    std::vector<std::array<double, 3>> logicalPoints(nPoints);
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        for (int d = 0; d < 3; ++d) {
+            logicalPoints[n][d] = (points[n][d] - octree.getOrigin()[d]) / octree.getL();
+        }
+    }
+
+    tree.getPointOwnerIdx(nPoints, logicalPoints.data(), ids.data(), isGhost.get());
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        bool expectedIsGhost;
+        uint32_t expectedId = tree.getPointOwnerIdx(logicalPoints[n], expectedIsGhost);
+        if (ids[n] != expectedId || isGhost[n] != expectedIsGhost) {
+            ++nErrors;
+        }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &nErrors, 1, MPI_INT, MPI_SUM, octree.getComm());
+
+    return nErrors;
+}
+
+/*!
+* Subtest 001
+*
+* Testing batched location of points in a 2D octree.
+*
+* \param rank is the rank of the process
+*/
+int subtest_001(int rank)
+{
+    BITPIT_UNUSED(rank);
+
+    std::array<double, 3> origin = {{-1., 2., 0.}};
+    double length = 4.;
+
+    // Create the octree
+    PabloUniform octree(origin[0], origin[1], origin[2], length, 2);
+    for (int iter = 0; iter < 5; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        std::array<double, 3> center = octree.getCenter(i);
+        if (center[0] < origin[0] + 0.3 * length && center[1] > origin[1] + 0.4 * length) {
+            octree.setMarker(i, 2);
+        }
+    }
+    octree.adapt();
+
+    std::vector<std::array<double, 3>> points = generatePoints(10000, origin, length);
+
+    // Serial octree
+    int nErrors = checkPointLocation(octree, points);
+    log::cout() << " Serial octree : " << nErrors << " mismatching points" << std::endl;
+    if (nErrors != 0) {
+        return 1;
+    }
+
+    // Partitioned octree
+    octree.loadBalance();
+
+    nErrors = checkPointLocation(octree, points);
+    log::cout() << " Partitioned octree : " << nErrors << " mismatching points" << std::endl;
+    if (nErrors != 0) {
+        return 1;
+    }
+
+    // Every point inside the domain should be located by exactly one process
+    std::size_t nPoints = points.size();
+    std::vector<uint32_t> ids(nPoints);
+    octree.getPointOwnerIdx(nPoints, points.data(), ids.data());
+
+    std::vector<int> nOwners(nPoints, 0);
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        if (ids[n] != std::numeric_limits<uint32_t>::max()) {
+            nOwners[n] = 1;
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, nOwners.data(), nPoints, MPI_INT, MPI_SUM, octree.getComm());
+
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        bool isInside = true;
+        for (int d = 0; d < 3; ++d) {
+            isInside &= (points[n][d] >= origin[d] && points[n][d] <= origin[d] + length);
+        }
+
+        if (isInside && nOwners[n] != 1) {
+            log::cout() << " Point " << n << " is owned by " << nOwners[n] << " processes." << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Evaluating the performance of the batched location of points.
+*
+* \param rank is the rank of the process
+*/
+int subtest_002(int rank)
+{
+    BITPIT_UNUSED(rank);
+
+    std::array<double, 3> origin = {{0., 0., 0.}};
+    double length = 1.;
+
+    PabloUniform octree(origin[0], origin[1], origin[2], length, 3);
+    for (int iter = 0; iter < 6; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+    octree.loadBalance();
+
+    std::vector<std::array<double, 3>> points = generatePoints(1000000, origin, length);
+    std::size_t nPoints = points.size();
+    std::vector<uint32_t> ids(nPoints);
+
+    std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        ids[n] = octree.getPointOwnerIdx(points[n]);
+    }
+    std::chrono::time_point<std::chrono::system_clock> end = std::chrono::system_clock::now();
+    std::chrono::duration<double> singleElapsed = end - start;
+
+    start = std::chrono::system_clock::now();
+    octree.getPointOwnerIdx(nPoints, points.data(), ids.data());
+    end = std::chrono::system_clock::now();
+    std::chrono::duration<double> batchElapsed = end - start;
+
+    log::cout() << " Location of " << nPoints << " points : single " << singleElapsed.count() << " s, batched " << batchElapsed.count() << " s" << std::endl;
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+    MPI_Init(&argc,&argv);
+
+    // Initialize the logger
+    int nProcs;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+    log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+    // Run the subtests
+    log::cout() << "Testing batched location of points." << std::endl;
+
+    int status;
+    try {
+        status = subtest_001(rank);
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002(rank);
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+    MPI_Finalize();
+}
@@ -0,0 +1,404 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <vector>
+
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Value associated with an octant, used to check that user data follow
+* the octants they belong to.
+*/
+double evalOctantValue(const ParaTree &tree, uint32_t idx)
+{
+    return double(tree.getMorton(idx)) + 0.25 * tree.getLevel(idx);
+}
+
+/*!
+* Number of values associated with an octant, used to check that variable
+* size data keep their size when moved among the processes.
+*/
+std::size_t evalOctantDataSize(const ParaTree &tree, uint32_t idx)
+{
+    return 1 + tree.getMorton(idx) % 3;
+}
+
+/*!
+* Driver for load balance of fixed size data, data of ranges of octants are
+* moved with block copies.
+*/
+class RangeDataLB : public bitpit::DataLBInterface<RangeDataLB> {
+
+public:
+    std::vector<double> &values;
+    std::vector<int> &levels;
+
+    long nRangeGathers;
+    long nRangeScatters;
+
+    size_t size(const uint32_t e) const
+    {
+        BITPIT_UNUSED(e);
+
+        return fixedSize();
+    }
+
+    size_t fixedSize() const
+    {
+        return sizeof(double) + sizeof(int);
+    }
+
+    void move(const uint32_t from, const uint32_t to)
+    {
+        values[to] = values[from];
+        levels[to] = levels[from];
+    }
+
+    template<class Buffer>
+    void gather(Buffer & buff, const uint32_t e)
+    {
+        buff << values[e];
+        buff << levels[e];
+    }
+
+    template<class Buffer>
+    void scatter(Buffer & buff, const uint32_t e)
+    {
+        buff >> values[e];
+        buff >> levels[e];
+    }
+
+    template<class Buffer>
+    void gather(Buffer & buff, const uint32_t begin, const uint32_t end)
+    {
+        buff.write(reinterpret_cast<const char *>(values.data() + begin), (end - begin) * sizeof(double));
+        buff.write(reinterpret_cast<const char *>(levels.data() + begin), (end - begin) * sizeof(int));
+        ++nRangeGathers;
+    }
+
+    template<class Buffer>
+    void scatter(Buffer & buff, const uint32_t begin, const uint32_t end)
+    {
+        buff.read(reinterpret_cast<char *>(values.data() + begin), (end - begin) * sizeof(double));
+        buff.read(reinterpret_cast<char *>(levels.data() + begin), (end - begin) * sizeof(int));
+        ++nRangeScatters;
+    }
+
+    void assign(uint32_t stride, uint32_t length)
+    {
+        for (uint32_t i = 0; i < length; i++) {
+            move(i + stride, i);
+        }
+    }
+
+    void resize(uint32_t newSize)
+    {
+        values.resize(newSize);
+        levels.resize(newSize);
+    }
+
+    void resizeGhost(uint32_t newSize)
+    {
+        BITPIT_UNUSED(newSize);
+    }
+
+    void shrink()
+    {
+    }
+
+    RangeDataLB(std::vector<double> &values_, std::vector<int> &levels_)
+        : values(values_), levels(levels_), nRangeGathers(0), nRangeScatters(0)
+    {
+    }
+};
+
+/*!
+* Driver for load balance of variable size data, only the single element
+* gather and scatter are provided.
+*/
+class ElementDataLB : public bitpit::DataLBInterface<ElementDataLB> {
+
+public:
+    std::vector<std::vector<double>> &data;
+
+    size_t size(const uint32_t e) const
+    {
+        return sizeof(std::size_t) + data[e].size() * sizeof(double);
+    }
+
+    size_t fixedSize() const
+    {
+        return 0;
+    }
+
+    void move(const uint32_t from, const uint32_t to)
+    {
+        data[to] = data[from];
+    }
+
+    template<class Buffer>
+    void gather(Buffer & buff, const uint32_t e)
+    {
+        buff << data[e].size();
+        for (double value : data[e]) {
+            buff << value;
+        }
+    }
+
+    template<class Buffer>
+    void scatter(Buffer & buff, const uint32_t e)
+    {
+        std::size_t nValues;
+        buff >> nValues;
+
+        data[e].resize(nValues);
+        for (double &value : data[e]) {
+            buff >> value;
+        }
+    }
+
+    void assign(uint32_t stride, uint32_t length)
+    {
+        for (uint32_t i = 0; i < length; i++) {
+            move(i + stride, i);
+        }
+    }
+
+    void resize(uint32_t newSize)
+    {
+        data.resize(newSize);
+    }
+
+    void resizeGhost(uint32_t newSize)
+    {
+        BITPIT_UNUSED(newSize);
+    }
+
+    void shrink()
+    {
+    }
+
+    ElementDataLB(std::vector<std::vector<double>> &data_)
+        : data(data_)
+    {
+    }
+};
+
+/*!
+* Check if an error occurred on any of the processes.
+*/
+bool checkGlobalError(bool error)
+{
+    int localError  = error ? 1 : 0;
+    int globalError = 0;
+    MPI_Allreduce(&localError, &globalError, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+    return (globalError != 0);
+}
+
+/*!
+* Subtest 001
+*
+* Testing load balance of fixed size data moved by ranges on a
+* two-dimensional tree.
+*/
+int subtest_001(int rank)
+{
+    log::cout() << "  Testing load balance of data moved by ranges on a 2D tree" << std::endl;
+
+    // Create a tree distributed among the processes
+    PabloUniform tree(2);
+    int idx = 0;
+    tree.setBalance(idx, true);
+
+    for (int i = 0; i < 6; ++i) {
+        tree.adaptGlobalRefine();
+    }
+
+    tree.loadBalance();
+
+    // Refine all the octants of the first process, this way many thousands of
+    // octants will be moved by the next load balance.
+    if (rank == 0) {
+        for (uint32_t i = 0; i < tree.getNumOctants(); ++i) {
+            tree.setMarker(i, 1);
+        }
+    }
+    tree.adapt();
+
+    if (rank == 0) {
+        for (uint32_t i = 0; i < tree.getNumOctants(); ++i) {
+            tree.setMarker(i, 1);
+        }
+    }
+    tree.adapt();
+
+    // Load balance with data
+    uint32_t nOctants = tree.getNumOctants();
+    std::vector<double> values(nOctants);
+    std::vector<int> levels(nOctants);
+    for (uint32_t i = 0; i < nOctants; ++i) {
+        values[i] = evalOctantValue(tree, i);
+        levels[i] = tree.getLevel(i);
+    }
+
+    RangeDataLB dataLB(values, levels);
+    tree.loadBalance(dataLB);
+
+    log::cout() << "   Octants after load balance " << tree.getNumOctants() << std::endl;
+
+    // Check data
+    bool error = (values.size() != tree.getNumOctants() || levels.size() != tree.getNumOctants());
+    if (!error) {
+        for (uint32_t i = 0; i < tree.getNumOctants(); ++i) {
+            if (values[i] != evalOctantValue(tree, i) || levels[i] != tree.getLevel(i)) {
+                log::cout() << "   Wrong data for octant " << i << std::endl;
+                error = true;
+                break;
+            }
+        }
+    }
+
+    if ((rank == 0 && dataLB.nRangeGathers < 2) || (rank != 0 && dataLB.nRangeScatters < 2)) {
+        log::cout() << "   Range methods of the data driver have not been used" << std::endl;
+        error = true;
+    }
+
+    if (checkGlobalError(error)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing load balance of variable size data moved element by element on a
+* three-dimensional tree.
+*/
+int subtest_002(int rank)
+{
+    log::cout() << "  Testing load balance of data moved by elements on a 3D tree" << std::endl;
+
+    // Create a tree distributed among the processes
+    PabloUniform tree(3);
+    int idx = 0;
+    tree.setBalance(idx, true);
+
+    for (int i = 0; i < 3; ++i) {
+        tree.adaptGlobalRefine();
+    }
+
+    tree.loadBalance();
+
+    // Refine the octants of the last process
+    if (rank == tree.getNproc() - 1) {
+        for (uint32_t i = 0; i < tree.getNumOctants(); ++i) {
+            tree.setMarker(i, 1);
+        }
+    }
+    tree.adapt();
+
+    // Load balance with data
+    uint32_t nOctants = tree.getNumOctants();
+    std::vector<std::vector<double>> data(nOctants);
+    for (uint32_t i = 0; i < nOctants; ++i) {
+        data[i].assign(evalOctantDataSize(tree, i), evalOctantValue(tree, i));
+    }
+
+    ElementDataLB dataLB(data);
+    tree.loadBalance(dataLB);
+
+    // Check data
+    bool error = (data.size() != tree.getNumOctants());
+    if (!error) {
+        for (uint32_t i = 0; i < tree.getNumOctants(); ++i) {
+            double expectedValue = evalOctantValue(tree, i);
+            if (data[i].size() != evalOctantDataSize(tree, i)) {
+                error = true;
+            } else {
+                for (double value : data[i]) {
+                    if (value != expectedValue) {
+                        error = true;
+                    }
+                }
+            }
+
+            if (error) {
+                log::cout() << "   Wrong data for octant " << i << std::endl;
+                break;
+            }
+        }
+    }
+
+    if (checkGlobalError(error)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+    MPI_Init(&argc,&argv);
+
+    // Initialize the logger
+    int nProcs;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+    log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+    // Run the subtests
+    log::cout() << "Testing load balance of user data in chunks." << std::endl;
+
+    int status;
+    try {
+        status = subtest_001(rank);
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002(rank);
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+    MPI_Finalize();
+}
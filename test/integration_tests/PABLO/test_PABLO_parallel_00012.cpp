@@ -0,0 +1,185 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_PABLO.hpp"
+
+using namespace bitpit;
+
+/*!
+* Check that every process owns some octants and that the weight of the
+* local octants is close to the average weight.
+*
+* \param octree is the octree
+* \param weights are the weights of the local octants
+* \param maxWeight is the maximum weight of a single octant
+* \result Returns the number of processes whose partition is not valid.
+*/
+int checkPartition(const PabloUniform &octree, const dvector &weights, double maxWeight)
+{
+    uint32_t nOctants = octree.getNumOctants();
+
+    double localWeight = 0.;
+    for (uint32_t i = 0; i < nOctants; ++i) {
+        localWeight += weights[i];
+    }
+
+    double globalWeight;
+    MPI_Allreduce(&localWeight, &globalWeight, 1, MPI_DOUBLE, MPI_SUM, octree.getComm());
+    double averageWeight = globalWeight / octree.getNproc();
+
+    int nErrors = 0;
+    if (nOctants == 0) {
+        log::cout() << " Rank " << octree.getRank() << " owns no octants." << std::endl;
+        ++nErrors;
+    } else if (std::abs(localWeight - averageWeight) > 2 * maxWeight) {
+        log::cout() << " Rank " << octree.getRank() << " has weight " << localWeight << ", expected " << averageWeight << std::endl;
+        ++nErrors;
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &nErrors, 1, MPI_INT, MPI_SUM, octree.getComm());
+
+    return nErrors;
+}
+
+/*!
+* Subtest 001
+*
+* Testing weighted partitioning with non-integer uniform weights.
+*
+* \param rank is the rank of the process
+*/
+int subtest_001(int rank)
+{
+    BITPIT_UNUSED(rank);
+
+    PabloUniform octree(0., 0., 0., 1., 3);
+    for (int iter = 0; iter < 4; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+    octree.loadBalance();
+
+    // Repeat the partitioning, each time the weights of the local octants
+    // are summed in a different order.
+    for (int iter = 0; iter < 3; ++iter) {
+        dvector weights(octree.getNumOctants(), 0.1);
+        octree.loadBalance(&weights);
+
+        weights.assign(octree.getNumOctants(), 0.1);
+        int nErrors = checkPartition(octree, weights, 0.1);
+        log::cout() << " Iteration " << iter << " : " << nErrors << " invalid partitions" << std::endl;
+        if (nErrors != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing weighted partitioning with non-integer non-uniform weights on a
+* non-uniform octree.
+*
+* \param rank is the rank of the process
+*/
+int subtest_002(int rank)
+{
+    BITPIT_UNUSED(rank);
+
+    PabloUniform octree(0., 0., 0., 1., 2);
+    for (int iter = 0; iter < 5; ++iter) {
+        octree.adaptGlobalRefine();
+    }
+
+    for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+        std::array<double, 3> center = octree.getCenter(i);
+        if (center[0] < 0.3 && center[1] > 0.4) {
+            octree.setMarker(i, 1);
+        }
+    }
+    octree.adapt();
+    octree.loadBalance();
+
+    for (int iter = 0; iter < 3; ++iter) {
+        dvector weights(octree.getNumOctants());
+        for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+            weights[i] = 0.1 * (1 + octree.getLevel(i) % 3);
+        }
+        octree.loadBalance(&weights);
+
+        weights.resize(octree.getNumOctants());
+        for (uint32_t i = 0; i < octree.getNumOctants(); ++i) {
+            weights[i] = 0.1 * (1 + octree.getLevel(i) % 3);
+        }
+        int nErrors = checkPartition(octree, weights, 0.3);
+        log::cout() << " Iteration " << iter << " : " << nErrors << " invalid partitions" << std::endl;
+        if (nErrors != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+    MPI_Init(&argc,&argv);
+
+    // Initialize the logger
+    int nProcs;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+    log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+    // Run the subtests
+    log::cout() << "Testing weighted partitioning." << std::endl;
+
+    int status;
+    try {
+        status = subtest_001(rank);
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002(rank);
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+    MPI_Finalize();
+}
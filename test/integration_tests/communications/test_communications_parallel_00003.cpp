@@ -0,0 +1,242 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+
+#include <chrono>
+#include <cstdint>
+
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_communications.hpp"
+
+using namespace bitpit;
+
+/*!
+ * Auxiliary function to evaluate the number of values to send
+ */
+std::size_t getSendCount(int srcRank, int dstRank)
+{
+	return (1000 * (srcRank + 1) + dstRank);
+}
+
+/*!
+ * Auxiliary function to evaluate the value to send
+ */
+double getSendValue(int srcRank, int dstRank, std::size_t n)
+{
+	return (srcRank + 0.5 * dstRank + 1e-3 * n);
+}
+
+/*!
+ * Test for bulk communications.
+ *
+ * Data is written into the send buffers in contiguous blocks of different
+ * types and read back from the receive buffers without copying it.
+ *
+ * \param rank is the rank of the process
+ * \param nProcs is the number of processes
+ */
+int subtest_001(int rank, int nProcs)
+{
+	DataCommunicator dataCommunicator(MPI_COMM_WORLD);
+
+	// Create the sends
+	//
+	// Each buffer contains a flag, a block of doubles and a block of integers.
+	// The flag forces some padding before the block of doubles.
+	for (int dstRank = 0; dstRank < nProcs; ++dstRank) {
+		dataCommunicator.setSend(dstRank, 0);
+
+		SendBuffer &sendBuffer = dataCommunicator.getSendBuffer(dstRank);
+		std::size_t nValues = getSendCount(rank, dstRank);
+
+		sendBuffer << static_cast<bool>(true);
+		sendBuffer << nValues;
+
+		double *values = sendBuffer.reserve<double>(nValues);
+		if (reinterpret_cast<std::uintptr_t>(values) % alignof(double) != 0) {
+			log::cout() << "Reserved block is not aligned." << std::endl;
+			return 1;
+		}
+
+		for (std::size_t n = 0; n < nValues; ++n) {
+			values[n] = getSendValue(rank, dstRank, n);
+		}
+
+		int32_t *indexes = sendBuffer.reserve<int32_t>(nValues);
+		for (std::size_t n = 0; n < nValues; ++n) {
+			indexes[n] = static_cast<int32_t>(n);
+		}
+
+		sendBuffer.squeeze();
+	}
+
+	dataCommunicator.discoverRecvs();
+	dataCommunicator.startAllRecvs();
+	dataCommunicator.startAllSends();
+
+	// Receive data
+	int nCompletedRecvs = 0;
+	while (nCompletedRecvs < dataCommunicator.getRecvCount()) {
+		int srcRank = dataCommunicator.waitAnyRecv();
+		RecvBuffer &recvBuffer = dataCommunicator.getRecvBuffer(srcRank);
+
+		bool flag;
+		recvBuffer >> flag;
+
+		std::size_t nValues;
+		recvBuffer >> nValues;
+		if (!flag || nValues != getSendCount(srcRank, rank)) {
+			log::cout() << "Wrong header received from " << srcRank << "." << std::endl;
+			return 1;
+		}
+
+		const double *values = recvBuffer.read<double>(nValues);
+		const int32_t *indexes = recvBuffer.read<int32_t>(nValues);
+		for (std::size_t n = 0; n < nValues; ++n) {
+			if (values[n] != getSendValue(srcRank, rank, n) || indexes[n] != static_cast<int32_t>(n)) {
+				log::cout() << "Wrong data received from " << srcRank << "." << std::endl;
+				return 1;
+			}
+		}
+
+		++nCompletedRecvs;
+	}
+
+	dataCommunicator.waitAllSends();
+
+	return 0;
+}
+
+/*!
+ * Compare the time needed to serialize data using stream operators and
+ * using bulk operations.
+ *
+ * \param rank is the rank of the process
+ * \param nProcs is the number of processes
+ */
+int subtest_002(int rank, int nProcs)
+{
+	const std::size_t N_VALUES = 1000000;
+
+	int dstRank = (rank + 1) % nProcs;
+
+	std::vector<double> data(N_VALUES);
+	for (std::size_t n = 0; n < N_VALUES; ++n) {
+		data[n] = 1e-3 * n;
+	}
+
+	for (int bulk = 0; bulk < 2; ++bulk) {
+		DataCommunicator dataCommunicator(MPI_COMM_WORLD);
+		dataCommunicator.setSend(dstRank, N_VALUES * sizeof(double));
+
+		std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
+
+		SendBuffer &sendBuffer = dataCommunicator.getSendBuffer(dstRank);
+		if (bulk) {
+			double *values = sendBuffer.reserve<double>(N_VALUES);
+			for (std::size_t n = 0; n < N_VALUES; ++n) {
+				values[n] = data[n];
+			}
+		} else {
+			for (std::size_t n = 0; n < N_VALUES; ++n) {
+				sendBuffer << data[n];
+			}
+		}
+
+		std::chrono::time_point<std::chrono::system_clock> end = std::chrono::system_clock::now();
+		double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+		log::cout() << (bulk ? "Bulk" : "Stream") << " serialization of " << N_VALUES << " values: " << elapsed << " ms" << std::endl;
+
+		dataCommunicator.discoverRecvs();
+		dataCommunicator.startAllRecvs();
+		dataCommunicator.startAllSends();
+
+		int srcRank = dataCommunicator.waitAnyRecv();
+		RecvBuffer &recvBuffer = dataCommunicator.getRecvBuffer(srcRank);
+
+		start = std::chrono::system_clock::now();
+
+		double sum = 0.;
+		if (bulk) {
+			const double *values = recvBuffer.read<double>(N_VALUES);
+			for (std::size_t n = 0; n < N_VALUES; ++n) {
+				sum += values[n];
+			}
+		} else {
+			for (std::size_t n = 0; n < N_VALUES; ++n) {
+				double value;
+				recvBuffer >> value;
+				sum += value;
+			}
+		}
+
+		end = std::chrono::system_clock::now();
+		elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+		log::cout() << (bulk ? "Bulk" : "Stream") << " deserialization of " << N_VALUES << " values: " << elapsed << " ms (checksum " << sum << ")" << std::endl;
+
+		dataCommunicator.waitAllSends();
+	}
+
+	return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+	MPI_Init(&argc,&argv);
+
+	// Initialize the logger
+	int nProcs;
+	int	rank;
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+	log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+	log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+	// Run the subtests
+	log::cout() << "Testing bulk parallel communications" << std::endl;
+
+	int status;
+	try {
+		status = subtest_001(rank, nProcs);
+		if (status != 0) {
+			return status;
+		}
+
+		status = subtest_002(rank, nProcs);
+		if (status != 0) {
+			return status;
+		}
+	} catch (const std::exception &exception) {
+		log::cout() << exception.what();
+		exit(1);
+	}
+
+	MPI_Finalize();
+}
@@ -0,0 +1,403 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <cmath>
+#include <vector>
+#if BITPIT_ENABLE_MPI==1
+#   include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_discretization.hpp"
+#include "bitpit_volcartesian.hpp"
+
+using namespace bitpit;
+
+/*!
+ * Evaluates a polynomial field of the specified degree.
+ *
+ * \param degree is the degree of the field
+ * \param point is the point where the field will be evaluated
+ * \result The value of the field.
+ */
+double evalField(int degree, const std::array<double, 3> &point)
+{
+    double x = point[0];
+    double y = point[1];
+    double z = point[2];
+
+    double value = 1. + x - 2. * y + 0.5 * z;
+    if (degree >= 2) {
+        value += x * y + 0.3 * z * z - x * x - 0.5 * y * z;
+    }
+
+    return value;
+}
+
+/*!
+ * Assembles the least-squares reconstructions of all the cells of a
+ * Cartesian patch and checks that polynomial fields are reproduced
+ * exactly.
+ *
+ * The stencil of each cell contains the cells whose distance, measured
+ * in cells, is not greater than the degree of the reconstruction. The
+ * same reconstruction object is reused for all the cells.
+ *
+ * \param dimensions is the number of space dimensions
+ * \param degree is the degree of the reconstruction
+ * \param nCells1D is the number of cells along each direction
+ * \result Returns zero if the test is successful, a non-zero value otherwise.
+ */
+int testReconstruction(int dimensions, uint8_t degree, int nCells1D)
+{
+    log::cout() << "Testing " << dimensions << "D reconstruction of degree " << (int) degree << std::endl;
+
+    // Generate patch
+    std::array<double, 3> patchOrigin = {{-1., -1., -1.}};
+    double length = 2.;
+    double h = length / nCells1D;
+
+    VolCartesian patch(dimensions, patchOrigin, length, h);
+    patch.switchMemoryMode(VolCartesian::MEMORY_NORMAL);
+
+    std::vector<long> cellIds;
+    std::vector<std::array<double, 3>> cellCentroids;
+    for (const Cell &cell : patch.getCells()) {
+        long cellId = cell.getId();
+        cellIds.push_back(cellId);
+        cellCentroids.push_back(patch.evalCellCentroid(cellId));
+    }
+    std::size_t nCells = cellIds.size();
+
+    // Build the stencils
+    std::vector<std::vector<std::size_t>> stencils(nCells);
+    for (std::size_t i = 0; i < nCells; ++i) {
+        for (std::size_t j = 0; j < nCells; ++j) {
+            double distance = 0.;
+            for (int d = 0; d < dimensions; ++d) {
+                distance = std::max(std::abs(cellCentroids[j][d] - cellCentroids[i][d]), distance);
+            }
+
+            if (distance <= (degree + 0.5) * h) {
+                stencils[i].push_back(j);
+            }
+        }
+    }
+
+    // Assemble the reconstructions
+    std::vector<ReconstructionKernel> kernels(nCells);
+
+    Reconstruction reconstruction(degree, dimensions);
+    for (std::size_t i = 0; i < nCells; ++i) {
+        const std::array<double, 3> &origin = cellCentroids[i];
+
+        reconstruction.clear(false);
+        reconstruction.addPointValueEquation(Reconstruction::TYPE_CONSTRAINT, origin, origin);
+        for (std::size_t j : stencils[i]) {
+            if (j == i) {
+                continue;
+            }
+
+            reconstruction.addPointValueEquation(Reconstruction::TYPE_LEAST_SQUARE, origin, cellCentroids[j]);
+        }
+
+        reconstruction.assemble();
+        kernels[i] = reconstruction;
+    }
+
+    // Check polynomial reproduction
+    double maxError = 0.;
+    for (std::size_t i = 0; i < nCells; ++i) {
+        const std::array<double, 3> &origin = cellCentroids[i];
+
+        std::vector<double> values;
+        values.push_back(evalField(degree, origin));
+        for (std::size_t j : stencils[i]) {
+            if (j == i) {
+                continue;
+            }
+
+            values.push_back(evalField(degree, cellCentroids[j]));
+        }
+
+        ReconstructionPolynomial polynomial;
+        kernels[i].assemblePolynomial(origin, values.data(), &polynomial);
+
+        std::array<double, 3> point = origin;
+        for (int d = 0; d < dimensions; ++d) {
+            point[d] += 0.3 * h;
+        }
+
+        double value;
+        polynomial.computeValue(point, 0, &value);
+        maxError = std::max(std::abs(value - evalField(degree, point)), maxError);
+    }
+
+    log::cout() << "  Maximum reconstruction error " << maxError << std::endl;
+    if (maxError > 1e-8) {
+        log::cout() << "  Error in reproduction of polynomial fields" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+ * Assembles the least-squares reconstructions of all the cells of a
+ * Cartesian patch using a kernel pool and checks them against the
+ * reconstructions assembled one cell at a time.
+ *
+ * The degree of the reconstructions alternates between one and two, hence
+ * the pool contains kernels with different degrees and different numbers
+ * of equations. The stencil of each cell contains the cells whose distance,
+ * measured in cells, is not greater than the degree of the reconstruction.
+ *
+ * \param dimensions is the number of space dimensions
+ * \param nCells1D is the number of cells along each direction
+ * \param nThreads is the number of threads used for assembling the pool
+ * \result Returns zero if the test is successful, a non-zero value otherwise.
+ */
+int testPooledReconstruction(int dimensions, int nCells1D, int nThreads)
+{
+    log::cout() << "Testing " << dimensions << "D pooled reconstructions using " << nThreads << " threads" << std::endl;
+
+    // Generate patch
+    std::array<double, 3> patchOrigin = {{-1., -1., -1.}};
+    double length = 2.;
+    double h = length / nCells1D;
+
+    VolCartesian patch(dimensions, patchOrigin, length, h);
+    patch.switchMemoryMode(VolCartesian::MEMORY_NORMAL);
+
+    std::vector<std::array<double, 3>> cellCentroids;
+    for (const Cell &cell : patch.getCells()) {
+        cellCentroids.push_back(patch.evalCellCentroid(cell.getId()));
+    }
+    std::size_t nCells = cellCentroids.size();
+
+    // Build the stencils
+    std::vector<uint8_t> degrees(nCells);
+    std::vector<std::vector<std::size_t>> stencils(nCells);
+    std::vector<int> nEquations(nCells);
+    for (std::size_t i = 0; i < nCells; ++i) {
+        degrees[i] = static_cast<uint8_t>(1 + i % 2);
+        for (std::size_t j = 0; j < nCells; ++j) {
+            double distance = 0.;
+            for (int d = 0; d < dimensions; ++d) {
+                distance = std::max(std::abs(cellCentroids[j][d] - cellCentroids[i][d]), distance);
+            }
+
+            if (distance <= (degrees[i] + 0.5) * h) {
+                stencils[i].push_back(j);
+            }
+        }
+        nEquations[i] = static_cast<int>(stencils[i].size());
+    }
+
+    // Add the equations of a cell to the specified assembler
+    auto addCellEquations = [&cellCentroids, &stencils](std::size_t i, ReconstructionAssembler *assembler) {
+        const std::array<double, 3> &origin = cellCentroids[i];
+
+        assembler->addPointValueEquation(ReconstructionAssembler::TYPE_CONSTRAINT, origin, origin);
+        for (std::size_t j : stencils[i]) {
+            if (j == i) {
+                continue;
+            }
+
+            assembler->addPointValueEquation(ReconstructionAssembler::TYPE_LEAST_SQUARE, origin, cellCentroids[j]);
+        }
+    };
+
+    // Assemble the pool
+    ReconstructionKernelPool pool(dimensions, nCells, degrees.data(), nEquations.data());
+    pool.assemble(addCellEquations, nThreads);
+
+    // Check the pool against the reconstructions assembled one at a time
+    double maxWeightDifference = 0.;
+    double maxError = 0.;
+    for (std::size_t i = 0; i < nCells; ++i) {
+        const ReconstructionKernel &pooledKernel = pool.getKernel(i);
+
+        Reconstruction reconstruction(degrees[i], dimensions);
+        addCellEquations(i, &reconstruction);
+        reconstruction.assemble();
+
+        int nWeights = pooledKernel.getCoefficientCount() * pooledKernel.getEquationCount();
+        const double *pooledWeights = pooledKernel.getPolynomialWeights();
+        const double *weights = reconstruction.getPolynomialWeights();
+        for (int k = 0; k < nWeights; ++k) {
+            maxWeightDifference = std::max(std::abs(pooledWeights[k] - weights[k]), maxWeightDifference);
+        }
+
+        // Linear fields are reproduced by reconstructions of any degree
+        const std::array<double, 3> &origin = cellCentroids[i];
+
+        std::vector<double> values;
+        values.push_back(evalField(1, origin));
+        for (std::size_t j : stencils[i]) {
+            if (j == i) {
+                continue;
+            }
+
+            values.push_back(evalField(1, cellCentroids[j]));
+        }
+
+        ReconstructionPolynomial polynomial;
+        pooledKernel.assemblePolynomial(origin, values.data(), &polynomial);
+
+        std::array<double, 3> point = origin;
+        for (int d = 0; d < dimensions; ++d) {
+            point[d] += 0.3 * h;
+        }
+
+        double value;
+        polynomial.computeValue(point, 0, &value);
+        maxError = std::max(std::abs(value - evalField(1, point)), maxError);
+    }
+
+    log::cout() << "  Maximum weight difference " << maxWeightDifference << std::endl;
+    log::cout() << "  Maximum reconstruction error " << maxError << std::endl;
+    if (maxWeightDifference > 1e-12) {
+        log::cout() << "  Pooled kernels don't match the kernels assembled one at a time" << std::endl;
+        return 1;
+    } else if (maxError > 1e-8) {
+        log::cout() << "  Error in reproduction of polynomial fields" << std::endl;
+        return 1;
+    }
+
+    // A kernel copied out of the pool owns its weights
+    ReconstructionKernel kernel = pool.getKernel(0);
+    if (kernel.getPolynomialWeights() == pool.getKernel(0).getPolynomialWeights()) {
+        log::cout() << "  Kernel copied out of the pool shares the weights of the pool" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+ * Subtest 001
+ *
+ * Testing assembly of least-squares reconstructions in 2D cartesian
+ * configurations.
+ */
+int subtest_001()
+{
+    for (uint8_t degree = 1; degree <= 2; ++degree) {
+        int status = testReconstruction(2, degree, 16);
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * Subtest 002
+ *
+ * Testing assembly of least-squares reconstructions in 3D cartesian
+ * configurations.
+ */
+int subtest_002()
+{
+    for (uint8_t degree = 1; degree <= 2; ++degree) {
+        int status = testReconstruction(3, degree, 8);
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * Subtest 003
+ *
+ * Testing assembly of least-squares reconstructions with a kernel pool,
+ * both serially and with multiple threads.
+ */
+int subtest_003()
+{
+    for (int nThreads : {1, 4}) {
+        int status = testPooledReconstruction(2, 12, nThreads);
+        if (status != 0) {
+            return status;
+        }
+
+        status = testPooledReconstruction(3, 6, nThreads);
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * Main program.
+ */
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    log::cout() << "Testing assembly of reconstruction kernels" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+
+        status = subtest_003();
+        if (status != 0) {
+            return (30 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
@@ -0,0 +1,271 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#if BITPIT_ENABLE_MPI==1
+#   include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_discretization.hpp"
+
+using namespace bitpit;
+
+/*!
+ * Evaluates the value and the derivative of a polynomial starting from its
+ * coefficients.
+ *
+ * The coefficients are ordered as in ReconstructionPolynomial: constant
+ * term, first degree terms and second degree terms (squares first, then
+ * mixed products).
+ *
+ * \param degree is the degree used for the evaluation
+ * \param dimensions is the number of space dimensions
+ * \param coeffs are the coefficients of the polynomial
+ * \param origin is the origin of the polynomial
+ * \param point is the point where the polynomial will be evaluated
+ * \param direction is the direction of the derivative
+ * \param[out] value on output will contain the value of the polynomial
+ * \param[out] derivative on output will contain the derivative of the
+ * polynomial
+ */
+void evalPolynomial(int degree, int dimensions, const double *coeffs,
+                    const std::array<double, 3> &origin, const std::array<double, 3> &point,
+                    const std::array<double, 3> &direction, double *value, double *derivative)
+{
+    std::array<double, 3> distance;
+    for (int d = 0; d < 3; ++d) {
+        distance[d] = point[d] - origin[d];
+    }
+
+    *value      = coeffs[0];
+    *derivative = 0.;
+    if (degree < 1) {
+        return;
+    }
+
+    int n = 1;
+    for (int i = 0; i < dimensions; ++i) {
+        *value      += coeffs[n] * distance[i];
+        *derivative += coeffs[n] * direction[i];
+        ++n;
+    }
+
+    if (degree < 2) {
+        return;
+    }
+
+    for (int i = 0; i < dimensions; ++i) {
+        *value      += coeffs[n] * 0.5 * distance[i] * distance[i];
+        *derivative += coeffs[n] * distance[i] * direction[i];
+        ++n;
+    }
+
+    for (int i = 0; i < dimensions; ++i) {
+        for (int j = i + 1; j < dimensions; ++j) {
+            *value      += coeffs[n] * distance[i] * distance[j];
+            *derivative += coeffs[n] * (distance[i] * direction[j] + distance[j] * direction[i]);
+            ++n;
+        }
+    }
+}
+
+/*!
+ * Evaluates a polynomial with random coefficients at random points and
+ * compares values, derivatives and gradients against a reference
+ * evaluation.
+ *
+ * \param dimensions is the number of space dimensions
+ * \param degree is the degree of the polynomial
+ * \param nFields is the number of fields of the polynomial
+ * \result Returns zero if the test is successful, a non-zero value otherwise.
+ */
+int testEvaluation(uint8_t dimensions, uint8_t degree, int nFields)
+{
+    log::cout() << "Testing evaluation of " << (int) dimensions << "D polynomials of degree " << (int) degree << std::endl;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> distribution(-1., 1.);
+
+    // Initialize the polynomial
+    std::array<double, 3> origin = {{0.1, -0.2, 0.3}};
+    for (int d = dimensions; d < 3; ++d) {
+        origin[d] = 0.;
+    }
+
+    ReconstructionPolynomial polynomial(degree, dimensions, origin, nFields);
+    for (int k = 0; k < nFields; ++k) {
+        double *coeffs = polynomial.getCoefficients(k);
+        for (int i = 0; i < polynomial.getCoefficientCount(); ++i) {
+            coeffs[i] = distribution(generator);
+        }
+    }
+
+    // Compare the evaluations with the reference ones
+    const int nPoints = 64;
+
+    std::vector<double> values(nFields);
+    std::vector<double> derivatives(nFields);
+    std::vector<std::array<double, 3>> gradients(nFields);
+
+    double maxError = 0.;
+    for (int n = 0; n < nPoints; ++n) {
+        std::array<double, 3> point = origin;
+        std::array<double, 3> direction = {{0., 0., 0.}};
+        for (int d = 0; d < dimensions; ++d) {
+            point[d]    += distribution(generator);
+            direction[d] = distribution(generator);
+        }
+
+        for (int evalDegree = 0; evalDegree <= degree; ++evalDegree) {
+            polynomial.computeValues(evalDegree, point, nFields, values.data());
+            polynomial.computeDerivatives(evalDegree, point, direction, nFields, derivatives.data());
+            polynomial.computeGradients(evalDegree, point, nFields, gradients.data());
+
+            for (int k = 0; k < nFields; ++k) {
+                double expectedValue;
+                double expectedDerivative;
+                evalPolynomial(evalDegree, dimensions, polynomial.getCoefficients(k), origin, point, direction,
+                               &expectedValue, &expectedDerivative);
+
+                double gradientDerivative = 0.;
+                for (int d = 0; d < dimensions; ++d) {
+                    gradientDerivative += gradients[k][d] * direction[d];
+                }
+
+                maxError = std::max(std::abs(values[k] - expectedValue), maxError);
+                maxError = std::max(std::abs(derivatives[k] - expectedDerivative), maxError);
+                maxError = std::max(std::abs(gradientDerivative - expectedDerivative), maxError);
+            }
+        }
+    }
+
+    log::cout() << "  Maximum evaluation error " << maxError << std::endl;
+    if (maxError > 1e-12) {
+        log::cout() << "  Error in evaluation of the polynomial" << std::endl;
+        return 1;
+    }
+
+    // Time the evaluation of the values
+    const int nEvaluations = 200000;
+
+    std::array<double, 3> point = origin;
+    for (int d = 0; d < dimensions; ++d) {
+        point[d] += 0.25;
+    }
+
+    double checksum = 0.;
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    for (int n = 0; n < nEvaluations; ++n) {
+        point[0] += 1e-7;
+        polynomial.computeValues(point, nFields, values.data());
+        checksum += values[0];
+    }
+    std::chrono::time_point<std::chrono::steady_clock> end = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(end - start).count();
+
+    log::cout() << "  Performed " << nEvaluations << " evaluations of " << nFields << " fields in " << elapsed << " s";
+    log::cout() << " (checksum " << checksum << ")" << std::endl;
+
+    return 0;
+}
+
+/*!
+ * Subtest 001
+ *
+ * Testing evaluation of polynomials in 2D.
+ */
+int subtest_001()
+{
+    for (uint8_t degree = 1; degree <= 2; ++degree) {
+        int status = testEvaluation(2, degree, 5);
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * Subtest 002
+ *
+ * Testing evaluation of polynomials in 3D.
+ */
+int subtest_002()
+{
+    for (uint8_t degree = 1; degree <= 2; ++degree) {
+        int status = testEvaluation(3, degree, 5);
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+ * Main program.
+ */
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    log::cout() << "Testing evaluation of reconstruction polynomials" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
@@ -0,0 +1,276 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <cmath>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+#include <vector>
+
+#include "bitpit_common.hpp"
+#include "bitpit_operators.hpp"
+
+using namespace bitpit;
+
+/*!
+* Fill a vector with reproducible values.
+*
+* \param n is the number of elements
+* \param seed is the seed used to generate the values
+* \result The vector with the generated values.
+*/
+std::vector<double> generateVector(std::size_t n, int seed)
+{
+    std::vector<double> values(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        values[i] = std::sin(0.1 * (i + 1) * seed) + 2.;
+    }
+
+    return values;
+}
+
+/*!
+* Subtest 001
+*
+* Testing expression operators for std::vector.
+*/
+int subtest_001()
+{
+    using namespace expression;
+
+    const double TOLERANCE = 1e-12;
+
+    std::size_t n = 1001;
+    std::vector<double> a = generateVector(n, 1);
+    std::vector<double> b = generateVector(n, 2);
+    std::vector<double> c = generateVector(n, 3);
+
+    // Fused expressions are evaluated with the same operations of the
+    // standard operators, hence the results should be identical.
+    log::cout() << "** expressions for std::vector" << std::endl;
+
+    std::vector<double> expected = a + 2. * b - c;
+    std::vector<double> result = lazy(a) + 2. * lazy(b) - lazy(c);
+    if (result != expected) {
+        log::cout() << "   Wrong result for a + 2 * b - c" << std::endl;
+        return 1;
+    }
+
+    expected = (a - 1.) / 2. + a * b / c;
+    result = (lazy(a) - 1.) / 2. + lazy(a) * lazy(b) / lazy(c);
+    if (result != expected) {
+        log::cout() << "   Wrong result for (a - 1) / 2 + a * b / c" << std::endl;
+        return 1;
+    }
+
+    expected = -1. * a + 3.;
+    assign(&result, -lazy(a) + 3.);
+    if (result != expected) {
+        log::cout() << "   Wrong result for -a + 3" << std::endl;
+        return 1;
+    }
+
+    // Assignment to one of the operands
+    log::cout() << "** assignment and increment" << std::endl;
+
+    expected = a + b;
+    result = a;
+    assign(&result, lazy(result) + lazy(b));
+    if (result != expected) {
+        log::cout() << "   Wrong result for the assignment of a + b to a" << std::endl;
+        return 1;
+    }
+
+    expected += 0.5 * c;
+    increment(&result, 0.5 * lazy(c));
+    if (result != expected) {
+        log::cout() << "   Wrong result for the increment by 0.5 * c" << std::endl;
+        return 1;
+    }
+
+    // Reductions
+    log::cout() << "** reductions" << std::endl;
+
+    double dot = dotProduct(lazy(a), lazy(b) - lazy(c));
+    double expectedDot = ::dotProduct(a, b - c);
+    if (std::abs(dot - expectedDot) > TOLERANCE * std::abs(expectedDot)) {
+        log::cout() << "   Wrong dot product: " << dot << " instead of " << expectedDot << std::endl;
+        return 1;
+    }
+
+    double norm = norm2(lazy(a) - lazy(b));
+    double expectedNorm = ::norm2(a - b);
+    if (std::abs(norm - expectedNorm) > TOLERANCE * expectedNorm) {
+        log::cout() << "   Wrong norm: " << norm << " instead of " << expectedNorm << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing expression operators for std::array.
+*/
+int subtest_002()
+{
+    using namespace expression;
+
+    const double TOLERANCE = 1e-12;
+
+    log::cout() << "** expressions for std::array" << std::endl;
+
+    // Projection of a point on a plane
+    std::array<double, 3> point  = {{1., 2., 3.}};
+    std::array<double, 3> origin = {{0.5, -1., 0.25}};
+    std::array<double, 3> normal = {{1., 1., 1.}};
+    normal /= ::norm2(normal);
+
+    std::array<double, 3> expected = point - ::dotProduct(point - origin, normal) * normal;
+    std::array<double, 3> result = lazy(point) - dotProduct(lazy(point) - lazy(origin), lazy(normal)) * lazy(normal);
+    if (::norm2(result - expected) > TOLERANCE) {
+        log::cout() << "   Wrong projection: " << result << " instead of " << expected << std::endl;
+        return 1;
+    }
+
+    // Linear interpolation between two points
+    expected = origin + 0.25 * (point - origin);
+    assign(&result, lazy(origin) + 0.25 * (lazy(point) - lazy(origin)));
+    if (result != expected) {
+        log::cout() << "   Wrong interpolation: " << result << " instead of " << expected << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 003
+*
+* Testing expression operators on large vectors and on many small arrays.
+*/
+int subtest_003()
+{
+    using namespace expression;
+
+    log::cout() << "** large vectors and many small arrays" << std::endl;
+
+    // Level set style update of large vectors
+    std::size_t n = 1000000;
+    std::vector<double> a = generateVector(n, 1);
+    std::vector<double> b = generateVector(n, 2);
+    std::vector<double> c = generateVector(n, 3);
+
+    int nRepetitions = 4;
+
+    std::vector<double> result;
+    double standardNorm = 0.;
+    for (int k = 0; k < nRepetitions; ++k) {
+        result = a + 2. * b - c;
+        standardNorm += ::norm2(result - a);
+    }
+
+    double expressionNorm = 0.;
+    for (int k = 0; k < nRepetitions; ++k) {
+        assign(&result, lazy(a) + 2. * lazy(b) - lazy(c));
+        expressionNorm += norm2(lazy(result) - lazy(a));
+    }
+
+    if (std::abs(standardNorm - expressionNorm) > 1e-10 * standardNorm) {
+        log::cout() << "   Results of standard and expression operators don't match for std::vector" << std::endl;
+        return 1;
+    }
+
+    // CG style evaluation of projections
+    std::size_t nPoints = 1000000;
+    std::array<double, 3> origin = {{0.5, -1., 0.25}};
+    std::array<double, 3> normal = {{0., 0.6, 0.8}};
+
+    std::array<double, 3> standardSum = {{0., 0., 0.}};
+    for (std::size_t i = 0; i < nPoints; ++i) {
+        std::array<double, 3> point = {{double(i % 7), double(i % 11), double(i % 13)}};
+        standardSum += point - ::dotProduct(point - origin, normal) * normal;
+    }
+
+    std::array<double, 3> expressionSum = {{0., 0., 0.}};
+    for (std::size_t i = 0; i < nPoints; ++i) {
+        std::array<double, 3> point = {{double(i % 7), double(i % 11), double(i % 13)}};
+        increment(&expressionSum, lazy(point) - dotProduct(lazy(point) - lazy(origin), lazy(normal)) * lazy(normal));
+    }
+
+    if (::norm2(standardSum - expressionSum) > 1e-10 * ::norm2(standardSum)) {
+        log::cout() << "   Results of standard and expression operators don't match for std::array" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    log::cout() << "Testing expression operators" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+
+        status = subtest_003();
+        if (status != 0) {
+            return (30 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
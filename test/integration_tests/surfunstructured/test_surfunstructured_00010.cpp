@@ -0,0 +1,213 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <chrono>
+#include <random>
+
+#include <bitpit_CG.hpp>
+#include <bitpit_surfunstructured.hpp>
+
+using namespace bitpit;
+
+/*!
+* Creates a thin cylinder whose sections are clustered towards one of the
+* ends, this generates a strongly anisotropic surface with a non-uniform
+* distribution of the cells.
+*
+* \param nSectors is the number of sectors of the cylinder
+* \param nSections is the number of sections of the cylinder
+* \param patch is the patch that will contain the surface
+*/
+void createCylinder(int nSectors, int nSections, SurfUnstructured *patch)
+{
+    const double length = 100.;
+    const double radius = 0.1;
+
+    for (int j = 0; j < nSections; ++j) {
+        double t = static_cast<double>(j) / (nSections - 1);
+        double z = length * t * t;
+        for (int i = 0; i < nSectors; ++i) {
+            double theta = 2. * BITPIT_PI * i / nSectors;
+            patch->addVertex({{radius * std::cos(theta), radius * std::sin(theta), z}}, j * nSectors + i);
+        }
+    }
+
+    for (int j = 0; j < nSections - 1; ++j) {
+        for (int i = 0; i < nSectors; ++i) {
+            long v0 = j * nSectors + i;
+            long v1 = j * nSectors + (i + 1) % nSectors;
+            long v2 = v1 + nSectors;
+            long v3 = v0 + nSectors;
+
+            patch->addCell(ElementType::TRIANGLE, std::vector<long>({{v0, v1, v2}}));
+            patch->addCell(ElementType::TRIANGLE, std::vector<long>({{v0, v2, v3}}));
+        }
+    }
+}
+
+// Subtest 001
+//
+// Comparison of the split strategies of the skd-tree
+int subtest_001()
+{
+    std::chrono::time_point<std::chrono::system_clock> start;
+    std::chrono::time_point<std::chrono::system_clock> end;
+
+    log::cout() << "** ================================================================= **" << std::endl;
+    log::cout() << "** Subtest #001 - Comparison of the skd-tree split strategies        **" << std::endl;
+    log::cout() << "** ================================================================= **" << std::endl;
+
+    // Create the surface
+    log::cout() << std::endl;
+    log::cout() << "Creating surface..." << std::endl;
+
+#if BITPIT_ENABLE_MPI
+    std::unique_ptr<SurfUnstructured> surfaceMesh(new SurfUnstructured (2, MPI_COMM_NULL));
+#else
+    std::unique_ptr<SurfUnstructured> surfaceMesh(new SurfUnstructured (2));
+#endif
+    surfaceMesh->setVertexAutoIndexing(false);
+    createCylinder(32, 1000, surfaceMesh.get());
+
+    log::cout() << "    Number of vertices: " << surfaceMesh->getVertexCount() << std::endl;
+    log::cout() << "    Number of elements : " << surfaceMesh->getCellCount() << std::endl;
+
+    // Generate the points
+    std::size_t nPoints = 1000;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> radialDistribution(-0.2, 0.2);
+    std::uniform_real_distribution<double> axialDistribution(0., 1.);
+
+    std::vector<std::array<double, 3>> points(nPoints);
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        double t = axialDistribution(generator);
+        points[n] = {{radialDistribution(generator), radialDistribution(generator), 100. * t * t}};
+    }
+
+    // Build the trees and evaluate the distances
+    std::vector<PatchSkdTree::SplitStrategy> strategies = {PatchSkdTree::SPLIT_WEIGHTED_MEAN, PatchSkdTree::SPLIT_SAH};
+    std::vector<std::string> strategyNames = {"weighted mean", "SAH"};
+
+    std::vector<std::vector<double>> distances(strategies.size(), std::vector<double>(nPoints));
+    for (std::size_t k = 0; k < strategies.size(); ++k) {
+        log::cout() << std::endl;
+        log::cout() << "Building skd-tree using " << strategyNames[k] << " split strategy..." << std::endl;
+
+        SurfaceSkdTree searchTree(surfaceMesh.get());
+        searchTree.setSplitStrategy(strategies[k]);
+
+        start = std::chrono::system_clock::now();
+        searchTree.build();
+        end = std::chrono::system_clock::now();
+        int elapsedBuild = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+        log::cout() << "    Maximum tree depth................. " << searchTree.evalMaxDepth() << std::endl;
+        log::cout() << "    Number of leaves................... " << searchTree.getLeafCount() << std::endl;
+        log::cout() << "    Minimum leaf cell count............ " << searchTree.getLeafMinCellCount() << std::endl;
+        log::cout() << "    Maximum leaf cell count............ " << searchTree.getLeafMaxCellCount() << std::endl;
+        log::cout() << "    Average leaf cell count............ " << searchTree.evalLeafMeanCellCount() << std::endl;
+        log::cout() << "    SAH cost........................... " << searchTree.evalSAHCost() << std::endl;
+        log::cout() << "    Elapsed time for skd-tree build.... " << elapsedBuild << " ms" << std::endl;
+
+        if (searchTree.getNode(0).getCellCount() != static_cast<std::size_t>(surfaceMesh->getCellCount())) {
+            log::cout() << "    <<< Root node doesn't contain all the cells >>>" << std::endl;
+            return 1;
+        }
+
+        start = std::chrono::system_clock::now();
+        for (std::size_t n = 0; n < nPoints; ++n) {
+            long cellId;
+            searchTree.findPointClosestCell(points[n], &cellId, &(distances[k][n]));
+        }
+        end = std::chrono::system_clock::now();
+        int elapsedQueries = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+        log::cout() << "    Elapsed time for distance queries.. " << elapsedQueries << " ms" << std::endl;
+    }
+
+    // Check the distances
+    //
+    // Trees built with different strategies should give the same distances.
+    // A small subset of the points is also checked against the brute force
+    // evaluation of the distance.
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        if (!utils::DoubleFloatingEqual()(distances[0][n], distances[1][n])) {
+            log::cout() << "    <<< Distances evaluated with different strategies don't match >>>" << std::endl;
+            return 1;
+        }
+
+        if (n % 100 != 0) {
+            continue;
+        }
+
+        double expectedDistance = std::numeric_limits<double>::max();
+        std::array<std::array<double, 3>, 3> cellVertexCoords;
+        for (const Cell &cell : surfaceMesh->getCells()) {
+            surfaceMesh->getCellVertexCoordinates(cell.getId(), cellVertexCoords.data());
+            expectedDistance = std::min(cell.evalPointDistance(points[n], cellVertexCoords.data()), expectedDistance);
+        }
+
+        if (!utils::DoubleFloatingEqual()(distances[1][n], expectedDistance)) {
+            log::cout() << "    <<< Distance doesn't match brute force evaluation >>>" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    int status = 0;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
@@ -0,0 +1,317 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <chrono>
+#include <random>
+
+#include <bitpit_CG.hpp>
+#include <bitpit_surfunstructured.hpp>
+
+using namespace bitpit;
+
+/*!
+* Creates a cylinder.
+*
+* \param nSectors is the number of sectors of the cylinder
+* \param nSections is the number of sections of the cylinder
+* \param patch is the patch that will contain the surface
+*/
+void createCylinder(int nSectors, int nSections, SurfUnstructured *patch)
+{
+    const double length = 10.;
+    const double radius = 1.;
+
+    for (int j = 0; j < nSections; ++j) {
+        double z = length * j / (nSections - 1);
+        for (int i = 0; i < nSectors; ++i) {
+            double theta = 2. * BITPIT_PI * i / nSectors;
+            patch->addVertex({{radius * std::cos(theta), radius * std::sin(theta), z}}, j * nSectors + i);
+        }
+    }
+
+    for (int j = 0; j < nSections - 1; ++j) {
+        for (int i = 0; i < nSectors; ++i) {
+            long v0 = j * nSectors + i;
+            long v1 = j * nSectors + (i + 1) % nSectors;
+            long v2 = v1 + nSectors;
+            long v3 = v0 + nSectors;
+
+            patch->addCell(ElementType::TRIANGLE, std::vector<long>({{v0, v1, v2}}));
+            patch->addCell(ElementType::TRIANGLE, std::vector<long>({{v0, v2, v3}}));
+        }
+    }
+}
+
+/*!
+* Checks the specified tree against a tree built from scratch.
+*
+* The check verifies that the tree contains all the cells of the patch,
+* that the bounding box of each node contains the bounding boxes of its
+* children and that the distances evaluated using the tree match the ones
+* evaluated using a tree built from scratch.
+*
+* \param patch is the patch
+* \param tree is the tree that will be checked
+* \param points are the points used for evaluating the distances
+* \result Returns zero if the check is successful, a non-zero value
+* otherwise.
+*/
+int checkTree(const SurfUnstructured &patch, const SurfaceSkdTree &tree, const std::vector<std::array<double, 3>> &points)
+{
+    // Check the cells
+    const SkdNode &root = tree.getNode(0);
+    if (root.getCellCount() != static_cast<std::size_t>(patch.getCellCount())) {
+        log::cout() << "    <<< Tree doesn't contain all the cells of the patch >>>" << std::endl;
+        return 1;
+    }
+
+    std::vector<long> treeCellIds = root.getCells();
+    std::sort(treeCellIds.begin(), treeCellIds.end());
+    if (std::unique(treeCellIds.begin(), treeCellIds.end()) != treeCellIds.end()) {
+        log::cout() << "    <<< Tree contains duplicate cells >>>" << std::endl;
+        return 1;
+    }
+
+    for (long cellId : treeCellIds) {
+        if (!patch.getCells().exists(cellId)) {
+            log::cout() << "    <<< Tree contains cells that don't belong to the patch >>>" << std::endl;
+            return 1;
+        }
+    }
+
+    // Check the bounding boxes
+    for (std::size_t nodeId = 0; nodeId < tree.getNodeCount(); ++nodeId) {
+        const SkdNode &node = tree.getNode(nodeId);
+        for (int i = SkdNode::CHILD_BEGIN; i != SkdNode::CHILD_END; ++i) {
+            std::size_t childId = node.getChildId(static_cast<SkdNode::ChildLocation>(i));
+            if (childId == SkdNode::NULL_ID) {
+                continue;
+            }
+
+            const SkdNode &child = tree.getNode(childId);
+            if (child.isEmpty()) {
+                continue;
+            }
+
+            for (int d = 0; d < 3; ++d) {
+                if (child.getBoxMin()[d] < node.getBoxMin()[d] || child.getBoxMax()[d] > node.getBoxMax()[d]) {
+                    log::cout() << "    <<< Node bounding box doesn't contain the bounding box of its children >>>" << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // Check the distances
+    SurfaceSkdTree referenceTree(&patch);
+    referenceTree.build();
+
+    for (const std::array<double, 3> &point : points) {
+        long cellId;
+        double distance;
+        tree.findPointClosestCell(point, &cellId, &distance);
+
+        long expectedCellId;
+        double expectedDistance;
+        referenceTree.findPointClosestCell(point, &expectedCellId, &expectedDistance);
+
+        if (!utils::DoubleFloatingEqual()(distance, expectedDistance)) {
+            log::cout() << "    <<< Distance doesn't match the one evaluated with a tree built from scratch >>>" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Subtest 001
+//
+// Refit and update of the skd-tree
+int subtest_001()
+{
+    std::chrono::time_point<std::chrono::system_clock> start;
+    std::chrono::time_point<std::chrono::system_clock> end;
+
+    log::cout() << "** ================================================================= **" << std::endl;
+    log::cout() << "** Subtest #001 - Refit and update of the skd-tree                   **" << std::endl;
+    log::cout() << "** ================================================================= **" << std::endl;
+
+    // Create the surface
+    log::cout() << std::endl;
+    log::cout() << "Creating surface..." << std::endl;
+
+#if BITPIT_ENABLE_MPI
+    std::unique_ptr<SurfUnstructured> surfaceMesh(new SurfUnstructured (2, MPI_COMM_NULL));
+#else
+    std::unique_ptr<SurfUnstructured> surfaceMesh(new SurfUnstructured (2));
+#endif
+    surfaceMesh->setVertexAutoIndexing(false);
+
+    const int nSectors  = 64;
+    const int nSections = 250;
+    createCylinder(nSectors, nSections, surfaceMesh.get());
+
+    log::cout() << "    Number of vertices: " << surfaceMesh->getVertexCount() << std::endl;
+    log::cout() << "    Number of elements : " << surfaceMesh->getCellCount() << std::endl;
+
+    // Generate the points
+    std::size_t nPoints = 200;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> radialDistribution(-2., 2.);
+    std::uniform_real_distribution<double> axialDistribution(-1., 11.);
+
+    std::vector<std::array<double, 3>> points(nPoints);
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        points[n] = {{radialDistribution(generator), radialDistribution(generator), axialDistribution(generator)}};
+    }
+
+    // Build the tree
+    log::cout() << std::endl;
+    log::cout() << "Building skd-tree..." << std::endl;
+
+    SurfaceSkdTree searchTree(surfaceMesh.get());
+
+    start = std::chrono::system_clock::now();
+    searchTree.build();
+    end = std::chrono::system_clock::now();
+    int elapsedBuild = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    log::cout() << "    Elapsed time for skd-tree build.... " << elapsedBuild << " us" << std::endl;
+
+    // Morph the surface and refit the tree
+    log::cout() << std::endl;
+    log::cout() << "Refitting skd-tree..." << std::endl;
+
+    for (Vertex &vertex : surfaceMesh->getVertices()) {
+        const std::array<double, 3> &coords = vertex.getCoords();
+        double scale = 1. + 0.2 * std::sin(coords[2]);
+        vertex.setCoords({{scale * coords[0], scale * coords[1], coords[2] + 0.1 * coords[0]}});
+    }
+
+    start = std::chrono::system_clock::now();
+    searchTree.refit();
+    end = std::chrono::system_clock::now();
+    int elapsedRefit = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    log::cout() << "    Elapsed time for skd-tree refit.... " << elapsedRefit << " us" << std::endl;
+
+    int status = checkTree(*surfaceMesh, searchTree, points);
+    if (status != 0) {
+        return status;
+    }
+
+    // Modify the surface and update the tree
+    //
+    // Cells of some sections are deleted and replaced by a different
+    // triangulation, some cells are added to close one end of the cylinder.
+    log::cout() << std::endl;
+    log::cout() << "Updating skd-tree..." << std::endl;
+
+    std::vector<adaption::Info> adaptionData;
+
+    adaptionData.emplace_back(adaption::TYPE_DELETION, adaption::ENTITY_CELL);
+    adaption::Info &deletionInfo = adaptionData.back();
+    for (int j = 100; j < 120; ++j) {
+        for (int i = 0; i < 2 * nSectors; ++i) {
+            deletionInfo.previous.push_back(2 * nSectors * j + i);
+        }
+    }
+    surfaceMesh->deleteCells(deletionInfo.previous);
+
+    adaptionData.emplace_back(adaption::TYPE_CREATION, adaption::ENTITY_CELL);
+    adaption::Info &creationInfo = adaptionData.back();
+    for (int j = 100; j < 120; ++j) {
+        for (int i = 0; i < nSectors; ++i) {
+            long v0 = j * nSectors + i;
+            long v1 = j * nSectors + (i + 1) % nSectors;
+            long v2 = v1 + nSectors;
+            long v3 = v0 + nSectors;
+
+            creationInfo.current.push_back(surfaceMesh->addCell(ElementType::TRIANGLE, std::vector<long>({{v0, v1, v3}}))->getId());
+            creationInfo.current.push_back(surfaceMesh->addCell(ElementType::TRIANGLE, std::vector<long>({{v1, v2, v3}}))->getId());
+        }
+    }
+
+    long capVertexId = nSectors * nSections;
+    surfaceMesh->addVertex({{0., 0., 0.}}, capVertexId);
+    for (int i = 0; i < nSectors; ++i) {
+        creationInfo.current.push_back(surfaceMesh->addCell(ElementType::TRIANGLE, std::vector<long>({{capVertexId, (i + 1) % nSectors, i}}))->getId());
+    }
+
+    start = std::chrono::system_clock::now();
+    searchTree.update(adaptionData);
+    end = std::chrono::system_clock::now();
+    int elapsedUpdate = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    log::cout() << "    Elapsed time for skd-tree update... " << elapsedUpdate << " us" << std::endl;
+    log::cout() << "    Number of leaves................... " << searchTree.getLeafCount() << std::endl;
+    log::cout() << "    Maximum leaf cell count............ " << searchTree.getLeafMaxCellCount() << std::endl;
+
+    status = checkTree(*surfaceMesh, searchTree, points);
+    if (status != 0) {
+        return status;
+    }
+
+    if (searchTree.getLeafMaxCellCount() > 1) {
+        log::cout() << "    <<< Updated leaves have not been split >>>" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    int status = 0;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
@@ -0,0 +1,276 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <chrono>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_voloctree.hpp"
+
+using namespace bitpit;
+
+/*!
+* Checks if the specified adaption info matches the specified view.
+*
+* \param info is the adaption info
+* \param view is the view
+* \result Returns true if the adaption info matches the view, false otherwise.
+*/
+bool compareInfo(const adaption::Info &info, const adaption::InfoView &view)
+{
+    if (info.type != view.type || info.entity != view.entity || info.rank != view.rank) {
+        return false;
+    }
+
+    if (info.previous.size() != view.previous.size() || info.current.size() != view.current.size()) {
+        return false;
+    }
+
+    for (std::size_t k = 0; k < info.previous.size(); ++k) {
+        if (info.previous[k] != view.previous[k]) {
+            return false;
+        }
+    }
+
+    for (std::size_t k = 0; k < info.current.size(); ++k) {
+        if (info.current[k] != view.current[k]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*!
+* Subtest 001
+*
+* Testing basic features of the compressed collection of adaption info.
+*/
+int subtest_001()
+{
+    log::cout() << "Testing compressed collection of adaption info..." << std::endl;
+
+    adaption::FlatInfoCollection collection;
+
+    // Shared items receive ids after other items have been created
+    std::size_t deletionId = collection.create(adaption::TYPE_DELETION, adaption::ENTITY_CELL);
+    collection.appendPrevious(deletionId, 10);
+
+    std::size_t refinementId = collection.create(adaption::TYPE_REFINEMENT, adaption::ENTITY_CELL);
+    collection.appendPrevious(refinementId, 11);
+    collection.appendCurrent(refinementId, 20);
+    collection.appendCurrent(refinementId, 21);
+
+    if (collection.create(adaption::TYPE_DELETION, adaption::ENTITY_CELL) != deletionId) {
+        log::cout() << "  Deletion items are not shared" << std::endl;
+        return 1;
+    }
+    collection.appendPrevious(deletionId, 12);
+    collection.appendPrevious(deletionId, 13);
+
+    if (collection.isFlushed()) {
+        log::cout() << "  Collection should have pending ids" << std::endl;
+        return 1;
+    }
+
+    collection.flush();
+
+    std::vector<adaption::Info> expectedInfos(2);
+    expectedInfos[0] = adaption::Info(adaption::TYPE_DELETION, adaption::ENTITY_CELL);
+    expectedInfos[0].previous = {10, 12, 13};
+    expectedInfos[1] = adaption::Info(adaption::TYPE_REFINEMENT, adaption::ENTITY_CELL);
+    expectedInfos[1].previous = {11};
+    expectedInfos[1].current  = {20, 21};
+
+    if (collection.size() != expectedInfos.size()) {
+        log::cout() << "  Wrong number of items in the collection" << std::endl;
+        return 1;
+    }
+
+    for (std::size_t n = 0; n < expectedInfos.size(); ++n) {
+        if (!compareInfo(expectedInfos[n], collection.at(n))) {
+            log::cout() << "  Item " << n << " doesn't match the expected one" << std::endl;
+            return 1;
+        }
+    }
+
+    // Append other collections
+    std::vector<adaption::Info> otherInfos = expectedInfos;
+    adaption::FlatInfoCollection otherCollection(std::move(otherInfos));
+    collection.append(std::move(otherCollection));
+    if (collection.size() != 2 * expectedInfos.size() || !otherCollection.empty()) {
+        log::cout() << "  Wrong number of items after appending a collection" << std::endl;
+        return 1;
+    }
+
+    // Dump the collection
+    std::vector<adaption::Info> dumpedInfos = collection.dump();
+    for (std::size_t n = 0; n < dumpedInfos.size(); ++n) {
+        const adaption::Info &expectedInfo = expectedInfos[n % expectedInfos.size()];
+        const adaption::Info &dumpedInfo   = dumpedInfos[n];
+        if (expectedInfo.type != dumpedInfo.type || expectedInfo.previous != dumpedInfo.previous || expectedInfo.current != dumpedInfo.current) {
+            log::cout() << "  Dumped item " << n << " doesn't match the expected one" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!collection.empty()) {
+        log::cout() << "  Collection should be empty after the dump" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing tracking of a global refinement using a compressed collection of
+* adaption info.
+*/
+int subtest_002()
+{
+    log::cout() << "Testing tracking of a global refinement..." << std::endl;
+
+    std::array<double, 3> origin = {{0., 0., 0.}};
+    double length = 1.;
+    double dh = 1. / 16;
+
+    // Create the patches
+#if BITPIT_ENABLE_MPI
+    VolOctree patch_vector(3, origin, length, dh, MPI_COMM_NULL);
+    VolOctree patch_flat(3, origin, length, dh, MPI_COMM_NULL);
+#else
+    VolOctree patch_vector(3, origin, length, dh);
+    VolOctree patch_flat(3, origin, length, dh);
+#endif
+    patch_vector.initializeAdjacencies();
+    patch_vector.initializeInterfaces();
+    patch_vector.update();
+
+    patch_flat.initializeAdjacencies();
+    patch_flat.initializeInterfaces();
+    patch_flat.update();
+
+    log::cout() << "  Number of cells before refinement: " << patch_flat.getCellCount() << std::endl;
+
+    // Refine the patches
+    for (const Cell &cell : patch_vector.getCells()) {
+        patch_vector.markCellForRefinement(cell.getId());
+    }
+
+    for (const Cell &cell : patch_flat.getCells()) {
+        patch_flat.markCellForRefinement(cell.getId());
+    }
+
+    auto vectorStart = std::chrono::high_resolution_clock::now();
+    std::vector<adaption::Info> vectorData = patch_vector.update(true);
+    auto vectorEnd = std::chrono::high_resolution_clock::now();
+
+    adaption::FlatInfoCollection flatData;
+    auto flatStart = std::chrono::high_resolution_clock::now();
+    patch_flat.update(&flatData);
+    auto flatEnd = std::chrono::high_resolution_clock::now();
+
+    log::cout() << "  Number of cells after refinement: " << patch_flat.getCellCount() << std::endl;
+
+    // Compare tracking data
+    if (vectorData.size() != flatData.size()) {
+        log::cout() << "  Number of tracked items doesn't match: " << vectorData.size() << " vs " << flatData.size() << std::endl;
+        return 1;
+    }
+
+    for (std::size_t n = 0; n < vectorData.size(); ++n) {
+        if (!compareInfo(vectorData[n], flatData[n])) {
+            log::cout() << "  Tracked item " << n << " doesn't match" << std::endl;
+            return 1;
+        }
+    }
+
+    // Statistics
+    std::size_t vectorStorageSize = vectorData.capacity() * sizeof(adaption::Info);
+    for (const adaption::Info &info : vectorData) {
+        vectorStorageSize += info.previous.capacity() * sizeof(long);
+        vectorStorageSize += info.current.capacity() * sizeof(long);
+    }
+
+    std::size_t flatStorageSize = flatData.evalStorageSize();
+
+    log::cout() << "  Number of tracked items: " << flatData.size() << std::endl;
+    log::cout() << "  Vector tracking: update time = " << std::chrono::duration<double>(vectorEnd - vectorStart).count() << " s"
+                << ", storage = " << vectorStorageSize << " bytes (heap allocations excluded)" << std::endl;
+    log::cout() << "  Flat tracking:   update time = " << std::chrono::duration<double>(flatEnd - flatStart).count() << " s"
+                << ", storage = " << flatStorageSize << " bytes" << std::endl;
+
+    if (flatStorageSize >= vectorStorageSize) {
+        log::cout() << "  Compressed collection doesn't reduce the storage" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    log::cout() << "Testing compressed tracking of octree patch adaption" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
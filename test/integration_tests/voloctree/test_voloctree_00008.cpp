@@ -0,0 +1,254 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <memory>
+#include <sstream>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_voloctree.hpp"
+
+using namespace bitpit;
+
+/*!
+* Create the patches used by the tests.
+*
+* The reference patch is uniform, the mapped patch is refined in a portion
+* of the domain, in this way reference cells are related to mapped cells
+* through all the mapping types.
+*
+* \param[out] referencePatch on output will contain the reference patch
+* \param[out] mappedPatch on output will contain the mapped patch
+*/
+void createPatches(std::unique_ptr<VolOctree> *referencePatch, std::unique_ptr<VolOctree> *mappedPatch)
+{
+    std::array<double, 3> origin = {{0., 0., 0.}};
+    double length = 1.;
+
+    // Reference patch
+#if BITPIT_ENABLE_MPI==1
+    referencePatch->reset(new VolOctree(2, origin, length, length / 16, MPI_COMM_NULL));
+#else
+    referencePatch->reset(new VolOctree(2, origin, length, length / 16));
+#endif
+    (*referencePatch)->update();
+
+    // Mapped patch
+#if BITPIT_ENABLE_MPI==1
+    mappedPatch->reset(new VolOctree(2, origin, length, length / 8, MPI_COMM_NULL));
+#else
+    mappedPatch->reset(new VolOctree(2, origin, length, length / 8));
+#endif
+    (*mappedPatch)->update();
+
+    for (int n = 0; n < 2; ++n) {
+        for (const Cell &cell : (*mappedPatch)->getCells()) {
+            if (!cell.isInterior()) {
+                continue;
+            }
+
+            long cellId = cell.getId();
+            std::array<double, 3> centroid = (*mappedPatch)->evalCellCentroid(cellId);
+            if (centroid[0] > 0.5) {
+                continue;
+            } else if (n > 0 && centroid[1] > 0.5) {
+                continue;
+            }
+
+            (*mappedPatch)->markCellForRefinement(cellId);
+        }
+        (*mappedPatch)->update();
+    }
+
+}
+
+/*!
+* Evaluate the source field.
+*
+* \param patch is the patch
+* \param[out] scalarField on output will contain the scalar fields
+* \param[out] vectorField on output will contain the vector fields
+*/
+void evalSourceFields(const VolOctree &patch, PiercedStorage<double, long> *scalarField, PiercedStorage<std::array<double, 3>, long> *vectorField)
+{
+    for (const Cell &cell : patch.getCells()) {
+        long cellId = cell.getId();
+        std::array<double, 3> centroid = patch.evalCellCentroid(cellId);
+
+        double value = 1. + centroid[0] + 2. * centroid[1];
+        scalarField->at(cellId, 0) = value;
+        scalarField->at(cellId, 1) = value * patch.evalCellVolume(cellId);
+        vectorField->at(cellId) = {{value, -value, 2. * value}};
+    }
+}
+
+/*!
+* Subtest 001
+*
+* Testing transfer of fields between octree patches.
+*/
+int subtest_001()
+{
+    const double TOLERANCE = 1e-12;
+
+    log::cout() << "Testing transfer of fields between octree patches..." << std::endl;
+
+    std::unique_ptr<VolOctree> referencePatch;
+    std::unique_ptr<VolOctree> mappedPatch;
+    createPatches(&referencePatch, &mappedPatch);
+
+#if BITPIT_ENABLE_MPI==1
+    VolOctreeMapper mapper(referencePatch.get(), mappedPatch.get(), MPI_COMM_WORLD);
+#else
+    VolOctreeMapper mapper(referencePatch.get(), mappedPatch.get());
+#endif
+    mapper.initialize();
+
+    // Source fields
+    PiercedStorage<double, long> sourceScalarField(2, &mappedPatch->getCells());
+    PiercedStorage<std::array<double, 3>, long> sourceVectorField(1, &mappedPatch->getCells());
+    evalSourceFields(*mappedPatch, &sourceScalarField, &sourceVectorField);
+
+    // Volume fraction transfer
+    VolumeTransferOperator transfer(&mapper, mapping::TRANSFER_VOLUME_FRACTION);
+    log::cout() << "  Number of rows: " << transfer.getRowCount() << std::endl;
+    log::cout() << "  Number of columns: " << transfer.getColumnCount() << std::endl;
+    log::cout() << "  Number of non-zeros: " << transfer.getNonZeroCount() << std::endl;
+
+    PiercedStorage<double, long> scalarField(2, &referencePatch->getCells());
+    PiercedStorage<std::array<double, 3>, long> vectorField(1, &referencePatch->getCells());
+    transfer.apply(sourceScalarField, &scalarField);
+    transfer.apply(sourceVectorField, &vectorField);
+
+    const PiercedStorage<mapping::Info> &mapping = mapper.getMapping();
+    for (const Cell &cell : referencePatch->getCells()) {
+        long cellId = cell.getId();
+        const mapping::Info &info = mapping[cellId];
+
+        double expectedValue = 0.;
+        if (info.type == mapping::TYPE_COARSENING) {
+            double volume = referencePatch->evalCellVolume(cellId);
+            for (long mappedId : info.ids) {
+                expectedValue += sourceScalarField.at(mappedId, 0) * mappedPatch->evalCellVolume(mappedId) / volume;
+            }
+        } else {
+            expectedValue = sourceScalarField.at(info.ids[0], 0);
+        }
+
+        if (std::abs(scalarField.at(cellId, 0) - expectedValue) > TOLERANCE) {
+            log::cout() << "  Transferred value of cell " << cellId << " doesn't match the expected one" << std::endl;
+            return 1;
+        }
+
+        std::array<double, 3> expectedVector = {{expectedValue, -expectedValue, 2. * expectedValue}};
+        if (norm2(vectorField.at(cellId) - expectedVector) > TOLERANCE) {
+            log::cout() << "  Transferred vector of cell " << cellId << " doesn't match the expected one" << std::endl;
+            return 1;
+        }
+    }
+
+    // Conservative transfer
+    VolumeTransferOperator conservativeTransfer(&mapper, mapping::TRANSFER_CONSERVATIVE);
+    conservativeTransfer.apply(sourceScalarField, &scalarField);
+
+    double sourceIntegral = 0.;
+    for (const Cell &cell : mappedPatch->getCells()) {
+        sourceIntegral += sourceScalarField.at(cell.getId(), 1);
+    }
+
+    double targetIntegral = 0.;
+    for (const Cell &cell : referencePatch->getCells()) {
+        targetIntegral += scalarField.at(cell.getId(), 1);
+    }
+
+    log::cout() << "  Source integral: " << sourceIntegral << std::endl;
+    log::cout() << "  Target integral: " << targetIntegral << std::endl;
+    if (std::abs(sourceIntegral - targetIntegral) > TOLERANCE) {
+        log::cout() << "  Conservative transfer doesn't preserve the integral" << std::endl;
+        return 1;
+    }
+
+    // Dump and restore
+    std::stringstream buffer;
+    transfer.dump(buffer);
+
+    VolumeTransferOperator restoredTransfer;
+    restoredTransfer.restore(buffer);
+    if (restoredTransfer.getNonZeroCount() != transfer.getNonZeroCount()) {
+        log::cout() << "  Restored operator doesn't match the original one" << std::endl;
+        return 1;
+    }
+
+    PiercedStorage<double, long> restoredScalarField(2, &referencePatch->getCells());
+    transfer.apply(sourceScalarField, &scalarField);
+    restoredTransfer.apply(sourceScalarField, &restoredScalarField);
+    for (const Cell &cell : referencePatch->getCells()) {
+        long cellId = cell.getId();
+        if (restoredScalarField.at(cellId, 0) != scalarField.at(cellId, 0)) {
+            log::cout() << "  Restored operator gives different results" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    log::cout() << "Testing transfer of fields between mapped octree patches" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
@@ -0,0 +1,214 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+
+#include <array>
+#include <cmath>
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_voloctree.hpp"
+
+using namespace bitpit;
+
+/*!
+* Evaluates the value associated with the specified point.
+*
+* \param point is the point
+* \result The value associated with the specified point.
+*/
+double evalPointValue(const std::array<double, 3> &point)
+{
+	return (point[0] + 100. * point[1] + 10000. * point[2]);
+}
+
+/*!
+* Checks the ghost update of the specified patch.
+*
+* \param patch is the patch
+* \result Returns zero if the check is successful, a non-zero value otherwise.
+*/
+int checkGhostUpdate(VolOctree *patch)
+{
+	int rank = patch->getRank();
+
+	// Check interior and border cells
+	const std::vector<std::size_t> &interiorRawIndexes = patch->getInteriorCellRawIndexes();
+	const std::vector<std::size_t> &borderRawIndexes = patch->getBorderCellRawIndexes();
+	if ((long) (interiorRawIndexes.size() + borderRawIndexes.size()) != patch->getInternalCellCount()) {
+		log::cout() << "  Interior and border cells do not match internal cells" << std::endl;
+		return 1;
+	}
+
+	std::vector<long> neighIds;
+	for (std::size_t rawIndex : interiorRawIndexes) {
+		const Cell &cell = patch->getCells().rawAt(rawIndex);
+
+		neighIds.clear();
+		patch->findCellNeighs(cell.getId(), &neighIds);
+		for (long neighId : neighIds) {
+			if (!patch->getCell(neighId).isInterior()) {
+				log::cout() << "  Interior cell " << cell.getId() << " has a ghost neighbour" << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	log::cout() << "  Interior cells: " << interiorRawIndexes.size() << ", border cells: " << borderRawIndexes.size() << std::endl;
+
+	// Initialize cell data
+	//
+	// The first field contains the value associated with the centroid, the
+	// second field contains the rank of the owner.
+	PiercedStorage<double, long> cellData(2, &(patch->getCells()));
+	for (const Cell &cell : patch->getCells()) {
+		long cellId = cell.getId();
+		if (cell.isInterior()) {
+			cellData.at(cellId, 0) = evalPointValue(patch->evalCellCentroid(cellId));
+			cellData.at(cellId, 1) = rank;
+		} else {
+			cellData.at(cellId, 0) = -1.;
+			cellData.at(cellId, 1) = -1.;
+		}
+	}
+
+	// Update ghost cells
+	//
+	// Interior cells are processed while the update is in progress.
+	patch->startGhostUpdate(cellData);
+	if (!patch->isGhostUpdateActive()) {
+		log::cout() << "  Ghost update is not active" << std::endl;
+		return 1;
+	}
+
+	double interiorSum = 0.;
+	for (std::size_t rawIndex : interiorRawIndexes) {
+		interiorSum += cellData.rawAt(rawIndex, 0);
+	}
+	log::cout() << "  Sum of interior values: " << interiorSum << std::endl;
+
+	patch->finishGhostUpdate();
+
+	for (const Cell &cell : patch->getCells()) {
+		if (cell.isInterior()) {
+			continue;
+		}
+
+		long cellId = cell.getId();
+		double expectedValue = evalPointValue(patch->evalCellCentroid(cellId));
+		int expectedRank = patch->getCellRank(cellId);
+		if (std::abs(cellData.at(cellId, 0) - expectedValue) > 1e-12 * std::abs(expectedValue) || cellData.at(cellId, 1) != expectedRank) {
+			log::cout() << "  Wrong data received for ghost cell " << cellId << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing nonblocking ghost updates on a partitioned 2D patch, before and
+* after its refinement.
+*/
+int subtest_001()
+{
+	std::array<double, 3> origin = {{0., 0., 0.}};
+	double length = 20;
+	double dh = 1.25;
+
+	log::cout() << "  >> 2D octree patch" << "\n";
+
+	// Create the patch
+	std::unique_ptr<VolOctree> patch = std::unique_ptr<VolOctree>(new VolOctree(2, origin, length, dh, MPI_COMM_WORLD));
+	patch->initializeAdjacencies();
+	patch->update();
+
+	// Partition the patch
+	patch->partition(false);
+
+	// Check the update
+	int status = checkGhostUpdate(patch.get());
+	if (status != 0) {
+		return status;
+	}
+
+	// Refine the cells near the origin and check the update again
+	for (const Cell &cell : patch->getCells()) {
+		if (!cell.isInterior()) {
+			continue;
+		}
+
+		std::array<double, 3> centroid = patch->evalCellCentroid(cell.getId());
+		if (centroid[0] < 0.5 * length && centroid[1] < 0.5 * length) {
+			patch->markCellForRefinement(cell.getId());
+		}
+	}
+	patch->update(false);
+
+	log::cout() << "  >> 2D octree patch after refinement" << "\n";
+
+	status = checkGhostUpdate(patch.get());
+	if (status != 0) {
+		return status;
+	}
+
+	return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+	MPI_Init(&argc,&argv);
+
+	// Initialize the logger
+	int nProcs;
+	int	rank;
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+	log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+	log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+	// Run the subtests
+	log::cout() << "Testing nonblocking ghost updates" << std::endl;
+
+	int status;
+	try {
+		status = subtest_001();
+		if (status != 0) {
+			return status;
+		}
+	} catch (const std::exception &exception) {
+		log::cout() << exception.what();
+		exit(1);
+	}
+
+	MPI_Finalize();
+
+	return status;
+}
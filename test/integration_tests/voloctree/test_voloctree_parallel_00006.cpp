@@ -0,0 +1,262 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_voloctree.hpp"
+
+using namespace bitpit;
+
+/*!
+* Create the patches used by the tests.
+*
+* The reference patch is uniform, the mapped patch is refined in a portion
+* of the domain and is partitioned after the refinement, in this way the
+* two patches have different partitionings.
+*
+* \param[out] referencePatch on output will contain the reference patch
+* \param[out] mappedPatch on output will contain the mapped patch
+*/
+void createPatches(std::unique_ptr<VolOctree> *referencePatch, std::unique_ptr<VolOctree> *mappedPatch)
+{
+	std::array<double, 3> origin = {{0., 0., 0.}};
+	double length = 1.;
+
+	// Reference patch
+	referencePatch->reset(new VolOctree(2, origin, length, length / 16, MPI_COMM_WORLD));
+	(*referencePatch)->initializeAdjacencies();
+	(*referencePatch)->update();
+	(*referencePatch)->partition(false);
+
+	// Mapped patch
+	mappedPatch->reset(new VolOctree(2, origin, length, length / 8, MPI_COMM_WORLD));
+	(*mappedPatch)->initializeAdjacencies();
+	(*mappedPatch)->update();
+	(*mappedPatch)->partition(false);
+
+	for (int n = 0; n < 2; ++n) {
+		for (const Cell &cell : (*mappedPatch)->getCells()) {
+			if (!cell.isInterior()) {
+				continue;
+			}
+
+			long cellId = cell.getId();
+			std::array<double, 3> centroid = (*mappedPatch)->evalCellCentroid(cellId);
+			if (centroid[0] > 0.5) {
+				continue;
+			} else if (n > 0 && centroid[1] > 0.5) {
+				continue;
+			}
+
+			(*mappedPatch)->markCellForRefinement(cellId);
+		}
+		(*mappedPatch)->update();
+	}
+
+	(*mappedPatch)->partition(false);
+}
+
+/*!
+* Evaluate the source fields.
+*
+* \param patch is the patch
+* \param[out] scalarField on output will contain the scalar fields
+* \param[out] vectorField on output will contain the vector fields
+*/
+void evalSourceFields(const VolOctree &patch, PiercedStorage<double, long> *scalarField, PiercedStorage<std::array<double, 3>, long> *vectorField)
+{
+	for (const Cell &cell : patch.getCells()) {
+		long cellId = cell.getId();
+		std::array<double, 3> centroid = patch.evalCellCentroid(cellId);
+
+		scalarField->at(cellId, 0) = 1. + centroid[0] + 2. * centroid[1];
+		scalarField->at(cellId, 1) = scalarField->at(cellId, 0) * patch.evalCellVolume(cellId);
+		vectorField->at(cellId) = centroid;
+	}
+}
+
+/*!
+* Subtest 001
+*
+* Testing transfer of fields between patches with different partitionings.
+*/
+int subtest_001()
+{
+	const double TOLERANCE = 1e-12;
+
+	log::cout() << "Testing transfer of fields between patches with different partitionings..." << std::endl;
+
+	std::unique_ptr<VolOctree> referencePatch;
+	std::unique_ptr<VolOctree> mappedPatch;
+	createPatches(&referencePatch, &mappedPatch);
+
+	VolOctreeMapper mapper(referencePatch.get(), mappedPatch.get(), MPI_COMM_WORLD);
+	mapper.initialize();
+	if (mapper.checkPartition()) {
+		log::cout() << "  Patches should have different partitionings" << std::endl;
+		return 1;
+	}
+
+	// Source fields
+	//
+	// The vector field contains the centroids of the source cells.
+	PiercedStorage<double, long> sourceScalarField(2, &mappedPatch->getCells());
+	PiercedStorage<std::array<double, 3>, long> sourceVectorField(1, &mappedPatch->getCells());
+	evalSourceFields(*mappedPatch, &sourceScalarField, &sourceVectorField);
+
+	// Volume fraction transfer
+	//
+	// Repeated applications reuse the persistent exchange.
+	VolumeTransferOperator transfer(&mapper, mapping::TRANSFER_VOLUME_FRACTION);
+	log::cout() << "  Number of rows: " << transfer.getRowCount() << std::endl;
+	log::cout() << "  Number of columns: " << transfer.getColumnCount() << std::endl;
+
+	PiercedStorage<double, long> scalarField(2, &referencePatch->getCells());
+	PiercedStorage<std::array<double, 3>, long> vectorField(1, &referencePatch->getCells());
+	for (int n = 0; n < 3; ++n) {
+		transfer.apply(sourceScalarField, &scalarField);
+		transfer.apply(sourceVectorField, &vectorField);
+	}
+
+	if (transfer.getRowCount() != (std::size_t) referencePatch->getInternalCellCount()) {
+		log::cout() << "  Not all the interior cells have been mapped" << std::endl;
+		return 1;
+	}
+
+	// The transferred centroid is the centroid of the reference cell when the
+	// mapped cells are finer than the reference cell, otherwise it is the
+	// centroid of the coarser mapped cell that contains the reference cell.
+	// Since the scalar field is linear, its transferred value should match
+	// the value evaluated at the transferred centroid.
+	for (const Cell &cell : referencePatch->getCells()) {
+		if (!cell.isInterior()) {
+			continue;
+		}
+
+		long cellId = cell.getId();
+		const std::array<double, 3> &transferredCentroid = vectorField.at(cellId);
+		double expectedValue = 1. + transferredCentroid[0] + 2. * transferredCentroid[1];
+		if (std::abs(scalarField.at(cellId, 0) - expectedValue) > TOLERANCE) {
+			log::cout() << "  Transferred value of cell " << cellId << " doesn't match the expected one" << std::endl;
+			return 1;
+		}
+
+		std::array<double, 3> centroid = referencePatch->evalCellCentroid(cellId);
+		double cellSize = referencePatch->evalCellSize(cellId);
+		bool isAncestorCentroid = false;
+		for (double ancestorSize = cellSize; ancestorSize <= 1.; ancestorSize *= 2.) {
+			isAncestorCentroid = true;
+			for (int d = 0; d < 2; ++d) {
+				double position = transferredCentroid[d] / ancestorSize - 0.5;
+				if (std::abs(position - std::round(position)) > TOLERANCE) {
+					isAncestorCentroid = false;
+				} else if (std::abs(transferredCentroid[d] - centroid[d]) > 0.5 * ancestorSize) {
+					isAncestorCentroid = false;
+				}
+			}
+
+			if (isAncestorCentroid) {
+				break;
+			}
+		}
+
+		if (!isAncestorCentroid) {
+			log::cout() << "  Transferred centroid of cell " << cellId << " is not the centroid of an ancestor" << std::endl;
+			return 1;
+		}
+	}
+
+	// Conservative transfer of a restored operator
+	std::stringstream buffer;
+	VolumeTransferOperator(&mapper, mapping::TRANSFER_CONSERVATIVE).dump(buffer);
+
+	VolumeTransferOperator conservativeTransfer;
+	conservativeTransfer.restore(buffer, MPI_COMM_WORLD);
+	conservativeTransfer.apply(sourceScalarField, &scalarField);
+
+	double sourceIntegral = 0.;
+	for (const Cell &cell : mappedPatch->getCells()) {
+		if (cell.isInterior()) {
+			sourceIntegral += sourceScalarField.at(cell.getId(), 1);
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &sourceIntegral, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+	double targetIntegral = 0.;
+	for (const Cell &cell : referencePatch->getCells()) {
+		if (cell.isInterior()) {
+			targetIntegral += scalarField.at(cell.getId(), 1);
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &targetIntegral, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+	log::cout() << "  Source integral: " << sourceIntegral << std::endl;
+	log::cout() << "  Target integral: " << targetIntegral << std::endl;
+	if (std::abs(sourceIntegral - targetIntegral) > TOLERANCE) {
+		log::cout() << "  Conservative transfer doesn't preserve the integral" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+	MPI_Init(&argc,&argv);
+
+	// Initialize the logger
+	int nProcs;
+	int	rank;
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+	log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+	log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+	// Run the subtests
+	log::cout() << "Testing transfer of fields between partitioned patches" << std::endl;
+
+	int status;
+	try {
+		status = subtest_001();
+		if (status != 0) {
+			return (10 + status);
+		}
+	} catch (const std::exception &exception) {
+		log::cout() << exception.what();
+		exit(1);
+	}
+
+	MPI_Finalize();
+
+	return status;
+}
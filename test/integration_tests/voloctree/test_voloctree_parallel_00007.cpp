@@ -0,0 +1,236 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <random>
+#include <vector>
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_voloctree.hpp"
+
+using namespace bitpit;
+
+/*!
+* Locates random points with the global point location of the specified
+* patch and checks the results against the local point location.
+*
+* \param patch is the patch
+* \param domainMin is the minimum point of the domain
+* \param domainMax is the maximum point of the domain
+* \param nPoints is the number of points each process will locate
+* \result Returns zero if the check is successful, a non-zero value otherwise.
+*/
+int checkGlobalPointLocation(const PatchKernel &patch, const std::array<double, 3> &domainMin, const std::array<double, 3> &domainMax, int nPoints)
+{
+	int rank = patch.getRank();
+	int nProcs = patch.getProcessorCount();
+	int dimension = patch.getDimension();
+
+	// Generate the points, some of them are outside the domain
+	std::mt19937 generator(17 + rank);
+	std::vector<std::array<double, 3>> points(nPoints);
+	for (std::array<double, 3> &point : points) {
+		point.fill(0.);
+		for (int d = 0; d < dimension; ++d) {
+			double delta = domainMax[d] - domainMin[d];
+			std::uniform_real_distribution<double> distribution(domainMin[d] - 0.1 * delta, domainMax[d] + 0.1 * delta);
+			point[d] = distribution(generator);
+		}
+	}
+
+	// Locate the points
+	std::vector<long> ids(nPoints);
+	std::vector<int> ranks(nPoints);
+	patch.locateGlobalPoints(nPoints, points.data(), ids.data(), ranks.data());
+
+	// Gather the results of all the processes
+	std::vector<std::array<double, 3>> globalPoints(nProcs * nPoints);
+	MPI_Allgather(points.data(), 3 * nPoints, MPI_DOUBLE, globalPoints.data(), 3 * nPoints, MPI_DOUBLE, MPI_COMM_WORLD);
+
+	std::vector<long> globalIds(nProcs * nPoints);
+	MPI_Allgather(ids.data(), nPoints, MPI_LONG, globalIds.data(), nPoints, MPI_LONG, MPI_COMM_WORLD);
+
+	std::vector<int> globalRanks(nProcs * nPoints);
+	MPI_Allgather(ranks.data(), nPoints, MPI_INT, globalRanks.data(), nPoints, MPI_INT, MPI_COMM_WORLD);
+
+	// Check the results
+	int nErrors = 0;
+	int nLocated = 0;
+	for (std::size_t k = 0; k < globalPoints.size(); ++k) {
+		const std::array<double, 3> &point = globalPoints[k];
+
+		bool isInsideDomain = true;
+		for (int d = 0; d < dimension; ++d) {
+			isInsideDomain &= (point[d] >= domainMin[d] && point[d] <= domainMax[d]);
+		}
+
+		if (isInsideDomain != (globalRanks[k] >= 0)) {
+			++nErrors;
+			continue;
+		}
+
+		long localId = patch.locatePoint(point);
+		bool isLocal = (localId != Cell::NULL_ID && patch.getCell(localId).isInterior());
+		if (isLocal) {
+			++nLocated;
+			if (globalRanks[k] != rank || globalIds[k] != localId) {
+				++nErrors;
+			}
+		} else if (globalRanks[k] == rank) {
+			++nErrors;
+		}
+	}
+
+	MPI_Allreduce(MPI_IN_PLACE, &nErrors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+	MPI_Allreduce(MPI_IN_PLACE, &nLocated, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+	log::cout() << "    Points located: " << nLocated << " / " << (nProcs * nPoints) << std::endl;
+	log::cout() << "    Errors: " << nErrors << std::endl;
+	if (nErrors != 0) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing global point location on a partitioned 2D patch.
+*/
+int subtest_001()
+{
+	std::array<double, 3> origin = {{0., 0., 0.}};
+	double length = 20;
+	double dh = 1;
+
+	log::cout() << "  >> 2D octree patch" << "\n";
+
+	// Create the patch
+	std::unique_ptr<VolOctree> patch_2D(new VolOctree(2, origin, length, dh, MPI_COMM_WORLD));
+	patch_2D->initializeAdjacencies();
+	patch_2D->update();
+
+	// Partition the patch
+	patch_2D->partition(false);
+
+	// Refine the cells near the origin
+	for (const Cell &cell : patch_2D->getCells()) {
+		if (!cell.isInterior()) {
+			continue;
+		}
+
+		long cellId = cell.getId();
+		std::array<double, 3> centroid = patch_2D->evalCellCentroid(cellId);
+		if (centroid[0] < 5. && centroid[1] < 5.) {
+			patch_2D->markCellForRefinement(cellId);
+		}
+	}
+	patch_2D->update(false);
+
+	// Check point location
+	std::array<double, 3> domainMin = origin;
+	std::array<double, 3> domainMax = {{length, length, 0.}};
+
+	int status = checkGlobalPointLocation(*patch_2D, domainMin, domainMax, 2000);
+	if (status != 0) {
+		return status;
+	}
+
+	return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing global point location on a partitioned 3D patch.
+*/
+int subtest_002()
+{
+	std::array<double, 3> origin = {{-4., 2., 1.}};
+	double length = 8;
+	double dh = 1;
+
+	log::cout() << "  >> 3D octree patch" << "\n";
+
+	// Create the patch
+	std::unique_ptr<VolOctree> patch_3D(new VolOctree(3, origin, length, dh, MPI_COMM_WORLD));
+	patch_3D->initializeAdjacencies();
+	patch_3D->update();
+
+	// Partition the patch
+	patch_3D->partition(false);
+
+	// Check point location
+	std::array<double, 3> domainMin = origin;
+	std::array<double, 3> domainMax = {{origin[0] + length, origin[1] + length, origin[2] + length}};
+
+	int status = checkGlobalPointLocation(*patch_3D, domainMin, domainMax, 2000);
+	if (status != 0) {
+		return status;
+	}
+
+	return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+	MPI_Init(&argc,&argv);
+
+	// Initialize the logger
+	int nProcs;
+	int	rank;
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+	log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+	log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+	// Run the subtests
+	log::cout() << "Testing global point location" << std::endl;
+
+	int status;
+	try {
+		status = subtest_001();
+		if (status != 0) {
+			return (10 + status);
+		}
+
+		status = subtest_002();
+		if (status != 0) {
+			return (20 + status);
+		}
+	} catch (const std::exception &exception) {
+		log::cout() << exception.what();
+		exit(1);
+	}
+
+	MPI_Finalize();
+
+	return status;
+}
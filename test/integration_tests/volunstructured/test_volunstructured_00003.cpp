@@ -0,0 +1,425 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <random>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_volunstructured.hpp"
+
+using namespace bitpit;
+
+/*!
+* Checks the location of the specified points.
+*
+* Locations evaluated by the patch are compared with the ones evaluated
+* by a brute force search.
+*
+* \param patch is the patch
+* \param points are the points to locate
+* \result Returns zero if the locations are correct, a non-zero value
+* otherwise.
+*/
+int checkLocations(const VolUnstructured &patch, const std::vector<std::array<double, 3>> &points)
+{
+    std::size_t nPoints = points.size();
+
+    std::vector<long> batchIds(nPoints);
+    patch.locatePoints(static_cast<int>(nPoints), points.data(), batchIds.data());
+
+    std::size_t nInsidePoints = 0;
+    for (std::size_t i = 0; i < nPoints; ++i) {
+        const std::array<double, 3> &point = points[i];
+
+        long bruteForceId = Cell::NULL_ID;
+        for (const Cell &cell : patch.getCells()) {
+            if (patch.isPointInside(cell.getId(), point)) {
+                bruteForceId = cell.getId();
+                break;
+            }
+        }
+
+        long id = patch.locatePoint(point);
+        if ((id == Cell::NULL_ID) != (bruteForceId == Cell::NULL_ID)) {
+            log::cout() << "  Point " << point << " located in cell " << id << ", expected cell " << bruteForceId << std::endl;
+            return 1;
+        } else if (id != Cell::NULL_ID && !patch.isPointInside(id, point)) {
+            log::cout() << "  Point " << point << " located in cell " << id << ", which doesn't contain the point" << std::endl;
+            return 1;
+        }
+
+        long batchId = batchIds[i];
+        if ((batchId == Cell::NULL_ID) != (bruteForceId == Cell::NULL_ID)) {
+            log::cout() << "  Point " << point << " batch located in cell " << batchId << ", expected cell " << bruteForceId << std::endl;
+            return 1;
+        } else if (batchId != Cell::NULL_ID && !patch.isPointInside(batchId, point)) {
+            log::cout() << "  Point " << point << " batch located in cell " << batchId << ", which doesn't contain the point" << std::endl;
+            return 1;
+        }
+
+        if (id != Cell::NULL_ID) {
+            ++nInsidePoints;
+        }
+    }
+
+    log::cout() << "  Points located inside the patch: " << nInsidePoints << "/" << nPoints << std::endl;
+
+    return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing point location on the reference elements.
+*/
+int subtest_001()
+{
+    log::cout() << "Testing point location on reference elements..." << std::endl;
+
+    std::vector<ElementType> types = {{ElementType::TETRA, ElementType::VOXEL, ElementType::HEXAHEDRON,
+                                       ElementType::WEDGE, ElementType::PYRAMID, ElementType::POLYHEDRON}};
+
+    for (ElementType type : types) {
+#if BITPIT_ENABLE_MPI
+        VolUnstructured patch(3, MPI_COMM_NULL);
+#else
+        VolUnstructured patch(3);
+#endif
+
+        std::vector<long> connect;
+        switch (type) {
+
+        case ElementType::TETRA:
+            patch.addVertex({{0., 0., 0.}}, 0);
+            patch.addVertex({{1., 0., 0.}}, 1);
+            patch.addVertex({{0., 1., 0.}}, 2);
+            patch.addVertex({{0., 0., 1.}}, 3);
+            connect = {{0, 1, 2, 3}};
+            break;
+
+        case ElementType::VOXEL:
+            patch.addVertex({{0., 0., 0.}}, 0);
+            patch.addVertex({{1., 0., 0.}}, 1);
+            patch.addVertex({{0., 1., 0.}}, 2);
+            patch.addVertex({{1., 1., 0.}}, 3);
+            patch.addVertex({{0., 0., 1.}}, 4);
+            patch.addVertex({{1., 0., 1.}}, 5);
+            patch.addVertex({{0., 1., 1.}}, 6);
+            patch.addVertex({{1., 1., 1.}}, 7);
+            connect = {{0, 1, 2, 3, 4, 5, 6, 7}};
+            break;
+
+        case ElementType::HEXAHEDRON:
+        case ElementType::POLYHEDRON:
+            patch.addVertex({{0., 0., 0.}}, 0);
+            patch.addVertex({{1., 0., 0.}}, 1);
+            patch.addVertex({{1., 1., 0.}}, 2);
+            patch.addVertex({{0., 1., 0.}}, 3);
+            patch.addVertex({{0., 0., 1.}}, 4);
+            patch.addVertex({{1., 0., 1.}}, 5);
+            patch.addVertex({{1., 1., 1.}}, 6);
+            patch.addVertex({{0., 1., 1.}}, 7);
+            if (type == ElementType::HEXAHEDRON) {
+                connect = {{0, 1, 2, 3, 4, 5, 6, 7}};
+            } else {
+                connect = {{6,
+                            4, 0, 3, 2, 1,
+                            4, 4, 5, 6, 7,
+                            4, 0, 1, 5, 4,
+                            4, 1, 2, 6, 5,
+                            4, 2, 3, 7, 6,
+                            4, 3, 0, 4, 7}};
+            }
+            break;
+
+        case ElementType::WEDGE:
+            patch.addVertex({{0., 0., 0.}}, 0);
+            patch.addVertex({{1., 0., 0.}}, 1);
+            patch.addVertex({{0., 1., 0.}}, 2);
+            patch.addVertex({{0., 0., 1.}}, 3);
+            patch.addVertex({{1., 0., 1.}}, 4);
+            patch.addVertex({{0., 1., 1.}}, 5);
+            connect = {{0, 1, 2, 3, 4, 5}};
+            break;
+
+        case ElementType::PYRAMID:
+            patch.addVertex({{0., 0., 0.}}, 0);
+            patch.addVertex({{1., 0., 0.}}, 1);
+            patch.addVertex({{1., 1., 0.}}, 2);
+            patch.addVertex({{0., 1., 0.}}, 3);
+            patch.addVertex({{0.5, 0.5, 1.}}, 4);
+            connect = {{0, 1, 2, 3, 4}};
+            break;
+
+        default:
+            break;
+
+        }
+
+        long cellId = patch.addCell(type, connect)->getId();
+
+        // Points inside and on the boundary of the cell are located
+        std::array<double, 3> centroid = patch.evalCellCentroid(cellId);
+        if (patch.locatePoint(centroid) != cellId) {
+            log::cout() << "  Centroid of element " << type << " not located" << std::endl;
+            return 1;
+        }
+
+        for (const long vertexId : patch.getCell(cellId).getVertexIds()) {
+            const std::array<double, 3> &vertexCoords = patch.getVertexCoords(vertexId);
+            if (patch.locatePoint(vertexCoords) != cellId) {
+                log::cout() << "  Vertex " << vertexId << " of element " << type << " not located" << std::endl;
+                return 1;
+            }
+        }
+
+        // Points outside the cell are not located
+        std::array<double, 3> outsidePoint = {{0.9, 0.9, 0.6}};
+        if (type == ElementType::VOXEL || type == ElementType::HEXAHEDRON || type == ElementType::POLYHEDRON) {
+            outsidePoint = {{1.1, 0.5, 0.5}};
+        }
+
+        if (patch.locatePoint(outsidePoint) != Cell::NULL_ID) {
+            log::cout() << "  Point " << outsidePoint << " wrongly located in element " << type << std::endl;
+            return 1;
+        }
+
+        log::cout() << "  Element " << type << " checked" << std::endl;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing point location on a three-dimensional patch made of distorted
+* hexahedra.
+*/
+int subtest_002()
+{
+    log::cout() << "Testing point location on a 3D patch..." << std::endl;
+
+    // Create the patch
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(3, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(3);
+#endif
+
+    const int N = 6;
+    const double h = 1. / N;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> perturbation(-0.2 * h, 0.2 * h);
+
+    for (int k = 0; k <= N; ++k) {
+        for (int j = 0; j <= N; ++j) {
+            for (int i = 0; i <= N; ++i) {
+                std::array<double, 3> coords = {{i * h, j * h, k * h}};
+                if (i > 0 && i < N && j > 0 && j < N && k > 0 && k < N) {
+                    for (int d = 0; d < 3; ++d) {
+                        coords[d] += perturbation(generator);
+                    }
+                }
+
+                patch.addVertex(coords, i + (N + 1) * (j + (N + 1) * k));
+            }
+        }
+    }
+
+    for (int k = 0; k < N; ++k) {
+        for (int j = 0; j < N; ++j) {
+            for (int i = 0; i < N; ++i) {
+                long v0 = i + (N + 1) * (j + (N + 1) * k);
+                long v1 = v0 + 1;
+                long v2 = v1 + (N + 1);
+                long v3 = v0 + (N + 1);
+                long offset = (N + 1) * (N + 1);
+
+                std::vector<long> connect = {{v0, v1, v2, v3, v0 + offset, v1 + offset, v2 + offset, v3 + offset}};
+                patch.addCell(ElementType::HEXAHEDRON, connect);
+            }
+        }
+    }
+
+    patch.initializeAdjacencies();
+
+    log::cout() << "  Cell count: " << patch.getCellCount() << std::endl;
+
+    // Generate the points
+    //
+    // Points are generated along a line, this way consecutive points are
+    // close to each other.
+    std::size_t nPoints = 2000;
+
+    std::vector<std::array<double, 3>> points(nPoints);
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        double t = static_cast<double>(n) / (nPoints - 1);
+
+        points[n][0] = -0.1 + 1.2 * t;
+        points[n][1] = 0.5 + 0.45 * std::sin(8 * BITPIT_PI * t);
+        points[n][2] = 0.5 + 0.45 * std::cos(6 * BITPIT_PI * t);
+    }
+
+    // Check locations
+    int status = checkLocations(patch, points);
+    if (status != 0) {
+        return status;
+    }
+
+    // Translating the patch resets the search tree
+    patch.translate({{1., 0., 0.}});
+    if (patch.locatePoint({{1.5, 0.5, 0.5}}) == Cell::NULL_ID) {
+        log::cout() << "  Point not located after translating the patch" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 003
+*
+* Testing point location on a two-dimensional patch.
+*/
+int subtest_003()
+{
+    log::cout() << "Testing point location on a 2D patch..." << std::endl;
+
+    // Create the patch
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(2, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(2);
+#endif
+
+    patch.setVertexAutoIndexing(false);
+
+    patch.addVertex({{0.00000000, 0.00000000, 0.00000000}},  1);
+    patch.addVertex({{0.00000000, 1.00000000, 0.00000000}},  2);
+    patch.addVertex({{1.00000000, 1.00000000, 0.00000000}},  3);
+    patch.addVertex({{1.00000000, 0.00000000, 0.00000000}},  4);
+    patch.addVertex({{1.00000000, 0.50000000, 0.00000000}},  5);
+    patch.addVertex({{0.25992107, 1.00000000, 0.00000000}},  6);
+    patch.addVertex({{0.58740113, 1.00000000, 0.00000000}},  7);
+    patch.addVertex({{0.00000000, 0.75000000, 0.00000000}},  8);
+    patch.addVertex({{0.00000000, 0.50000000, 0.00000000}},  9);
+    patch.addVertex({{0.00000000, 0.25000000, 0.00000000}}, 10);
+    patch.addVertex({{0.25992107, 0.00000000, 0.00000000}}, 11);
+    patch.addVertex({{0.58740113, 0.00000000, 0.00000000}}, 12);
+    patch.addVertex({{0.42807699, 0.41426491, 0.00000000}}, 13);
+    patch.addVertex({{0.30507278, 0.69963441, 0.00000000}}, 14);
+    patch.addVertex({{0.64032722, 0.68239464, 0.00000000}}, 15);
+    patch.addVertex({{0.24229808, 0.24179558, 0.00000000}}, 16);
+    patch.addVertex({{0.67991107, 0.28835559, 0.00000000}}, 17);
+    patch.addVertex({{0.22034760, 0.48841527, 0.00000000}}, 18);
+    patch.addVertex({{0.43952167, 0.18888322, 0.00000000}}, 19);
+
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{ 3,  7, 15}}));
+    patch.addCell(ElementType::QUAD,     std::vector<long>({{ 1, 11, 16, 10}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{ 8,  9, 18}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{ 8, 18, 14}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{ 3, 15,  5}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{ 9, 10, 18}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{10, 16, 18}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{ 4, 17, 12}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{ 4,  5, 17}}));
+    patch.addCell(ElementType::QUAD,     std::vector<long>({{13, 17, 15, 14}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{11, 12, 19}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{13, 19, 17}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{12, 17, 19}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{13, 14, 18}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{ 5, 15, 17}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{11, 19, 16}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{13, 16, 19}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{13, 18, 16}}));
+    patch.addCell(ElementType::TRIANGLE, std::vector<long>({{14, 15,  7}}));
+    patch.addCell(ElementType::POLYGON,  std::vector<long>({{ 5, 14,  7,  6, 2, 8}}));
+
+    patch.initializeAdjacencies();
+
+    // Generate the points
+    std::size_t nPoints = 1000;
+
+    std::mt19937 generator(2);
+    std::uniform_real_distribution<double> distribution(-0.1, 1.1);
+
+    std::vector<std::array<double, 3>> points(nPoints);
+    for (std::size_t n = 0; n < nPoints; ++n) {
+        points[n] = {{distribution(generator), distribution(generator), 0.}};
+    }
+
+    // Check locations
+    return checkLocations(patch, points);
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    log::cout() << "Testing point location on unstructured patches" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+
+        status = subtest_003();
+        if (status != 0) {
+            return (30 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
@@ -0,0 +1,329 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_volunstructured.hpp"
+
+using namespace bitpit;
+
+/*!
+* Locality statistics of the cell storage.
+*/
+struct LocalityStats {
+    std::size_t bandwidth;
+    double meanDistance;
+};
+
+/*!
+* Generates a structured hexahedral grid whose cells and vertices are
+* inserted in random order.
+*
+* \param n is the number of cells along each direction
+* \param patch is the patch that will be filled
+*/
+void generateShuffledGrid(int n, VolUnstructured *patch)
+{
+    std::mt19937 generator(1);
+
+    auto vertexId = [n](int i, int j, int k) {
+        return static_cast<long>(i + (n + 1) * (j + (n + 1) * k));
+    };
+
+    std::vector<long> vertexIds((n + 1) * (n + 1) * (n + 1));
+    std::iota(vertexIds.begin(), vertexIds.end(), 0);
+    std::shuffle(vertexIds.begin(), vertexIds.end(), generator);
+    for (long id : vertexIds) {
+        long i = id % (n + 1);
+        long j = (id / (n + 1)) % (n + 1);
+        long k = id / ((n + 1) * (n + 1));
+        patch->addVertex({{double(i) / n, double(j) / n, double(k) / n}}, id);
+    }
+
+    std::vector<long> cellIds(n * n * n);
+    std::iota(cellIds.begin(), cellIds.end(), 0);
+    std::shuffle(cellIds.begin(), cellIds.end(), generator);
+    for (long id : cellIds) {
+        int i = static_cast<int>(id % n);
+        int j = static_cast<int>((id / n) % n);
+        int k = static_cast<int>(id / (n * n));
+
+        std::vector<long> connect = {vertexId(i,     j,     k),     vertexId(i + 1, j,     k),
+                                     vertexId(i + 1, j + 1, k),     vertexId(i,     j + 1, k),
+                                     vertexId(i,     j,     k + 1), vertexId(i + 1, j,     k + 1),
+                                     vertexId(i + 1, j + 1, k + 1), vertexId(i,     j + 1, k + 1)};
+
+        patch->addCell(ElementType::HEXAHEDRON, connect, id);
+    }
+}
+
+/*!
+* Evaluates the locality statistics of the cell storage.
+*
+* Cells are identified by their position in the storage, a matrix with
+* the sparsity pattern defined by the adjacencies is then used to evaluate
+* the bandwidth and the mean distance between adjacent cells.
+*
+* \param patch is the patch
+* \result The locality statistics of the cell storage.
+*/
+LocalityStats evalLocalityStats(const VolUnstructured &patch)
+{
+    const PiercedVector<Cell> &cells = patch.getCells();
+
+    std::size_t nAdjacencies = 0;
+
+    LocalityStats stats;
+    stats.bandwidth = 0;
+    stats.meanDistance = 0.;
+
+    std::size_t row = 0;
+    for (auto itr = cells.cbegin(); itr != cells.cend(); ++itr) {
+        const long *adjacencies = itr->getAdjacencies();
+        int nCellAdjacencies = itr->getAdjacencyCount();
+        for (int k = 0; k < nCellAdjacencies; ++k) {
+            std::size_t column = cells.evalFlatIndex(adjacencies[k]);
+            std::size_t distance = (column > row) ? (column - row) : (row - column);
+
+            stats.bandwidth = std::max(distance, stats.bandwidth);
+            stats.meanDistance += distance;
+        }
+
+        nAdjacencies += nCellAdjacencies;
+        ++row;
+    }
+    stats.meanDistance /= nAdjacencies;
+
+    return stats;
+}
+
+/*!
+* Subtest 001
+*
+* Testing reordering of cells.
+*/
+int subtest_001()
+{
+    log::cout() << "Testing reordering of cells..." << std::endl;
+
+    const int N = 24;
+
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(3, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(3);
+#endif
+    patch.setExpert(true);
+    generateShuffledGrid(N, &patch);
+    patch.initializeAdjacencies();
+
+    // Data attached to the cells
+    PiercedStorage<long> cellData(1, &patch.getCells(), PiercedSyncMaster::SYNC_MODE_JOURNALED);
+    for (const Cell &cell : patch.getCells()) {
+        cellData[cell.getId()] = cell.getId();
+    }
+
+    // Original statistics
+    LocalityStats originalStats = evalLocalityStats(patch);
+    log::cout() << "  Original ordering: bandwidth = " << originalStats.bandwidth
+                << ", mean distance = " << originalStats.meanDistance << std::endl;
+
+    // Reorder the cells
+    std::vector<std::pair<PatchKernel::ReorderingStrategy, std::string>> strategies = {
+        {PatchKernel::REORDERING_MORTON,  "Morton"},
+        {PatchKernel::REORDERING_HILBERT, "Hilbert"},
+        {PatchKernel::REORDERING_RCM,     "RCM"}
+    };
+
+    for (const auto &entry : strategies) {
+        PatchKernel::ReorderingStrategy strategy = entry.first;
+        const std::string &name = entry.second;
+
+        if (!patch.reorderCells(strategy)) {
+            log::cout() << "  Unable to reorder the cells using strategy " << name << std::endl;
+            return 1;
+        }
+
+        LocalityStats stats = evalLocalityStats(patch);
+        log::cout() << "  " << name << " ordering: bandwidth = " << stats.bandwidth
+                    << ", mean distance = " << stats.meanDistance << std::endl;
+
+        // Check the data attached to the cells
+        for (const Cell &cell : patch.getCells()) {
+            if (cellData[cell.getId()] != cell.getId()) {
+                log::cout() << "  Data attached to cell " << cell.getId() << " was not reordered" << std::endl;
+                return 1;
+            }
+        }
+
+        // Check the locality
+        if (strategy == PatchKernel::REORDERING_RCM) {
+            if (stats.bandwidth >= originalStats.bandwidth) {
+                log::cout() << "  RCM ordering doesn't reduce the bandwidth" << std::endl;
+                return 1;
+            }
+        } else {
+            if (stats.meanDistance >= originalStats.meanDistance) {
+                log::cout() << "  " << name << " ordering doesn't reduce the mean distance" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing reordering and renumbering of cells and vertices.
+*/
+int subtest_002()
+{
+    log::cout() << "Testing reordering and renumbering of cells and vertices..." << std::endl;
+
+    const int N = 8;
+
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(3, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(3);
+#endif
+    patch.setExpert(true);
+    generateShuffledGrid(N, &patch);
+
+    // Delete some cells and their orphan vertices, the storage of cells and
+    // vertices will contain holes
+    for (long id = 0; id < N * N * N; id += 7) {
+        patch.deleteCell(id);
+    }
+    patch.deleteOrphanVertices();
+
+    patch.initializeAdjacencies();
+
+    // Data attached to the cells
+    PiercedStorage<long> cellData(1, &patch.getCells(), PiercedSyncMaster::SYNC_MODE_JOURNALED);
+    for (const Cell &cell : patch.getCells()) {
+        cellData[cell.getId()] = cell.getId();
+    }
+
+    double originalVolume = 0.;
+    for (const Cell &cell : patch.getCells()) {
+        originalVolume += patch.evalCellVolume(cell.getId());
+    }
+
+    if (!patch.reorder(PatchKernel::REORDERING_HILBERT)) {
+        log::cout() << "  Unable to reorder the patch" << std::endl;
+        return 1;
+    }
+
+    for (const Cell &cell : patch.getCells()) {
+        if (cellData[cell.getId()] != cell.getId()) {
+            log::cout() << "  Data attached to cell " << cell.getId() << " was not reordered" << std::endl;
+            return 1;
+        }
+    }
+
+    // The first vertex should belong to the first cell
+    const Cell &firstCell = *(patch.getCells().cbegin());
+    long firstVertexId = patch.getVertices().cbegin()->getId();
+    if (firstCell.getVertexIds()[0] != firstVertexId) {
+        log::cout() << "  The first vertex is not the first vertex of the first cell" << std::endl;
+        return 1;
+    }
+
+    // Renumber the patch following the storage order
+    patch.consecutiveRenumber(0, 0, 0);
+
+    long expectedCellId = 0;
+    for (const Cell &cell : patch.getCells()) {
+        if (cell.getId() != expectedCellId) {
+            log::cout() << "  Cell ids don't follow the storage order" << std::endl;
+            return 1;
+        }
+        ++expectedCellId;
+    }
+
+    double volume = 0.;
+    for (const Cell &cell : patch.getCells()) {
+        volume += patch.evalCellVolume(cell.getId());
+    }
+
+    log::cout() << "  Volume before reordering: " << originalVolume << std::endl;
+    log::cout() << "  Volume after reordering:  " << volume << std::endl;
+    if (std::abs(volume - originalVolume) > 1e-12) {
+        log::cout() << "  Volume of the patch changed after reordering" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    log::cout() << "Testing reordering of unstructured patches" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
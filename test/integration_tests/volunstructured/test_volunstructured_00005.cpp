@@ -0,0 +1,381 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <chrono>
+#include <vector>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_volunstructured.hpp"
+
+using namespace bitpit;
+
+/*!
+* Evaluates the coordinates of the vertices of a structured grid.
+*
+* \param n is the number of cells along each direction
+* \result The coordinates of the vertices of the grid.
+*/
+std::vector<std::array<double, 3>> evalGridVertices(int n)
+{
+    std::vector<std::array<double, 3>> coords;
+    coords.reserve((n + 1) * (n + 1) * (n + 1));
+    for (int k = 0; k <= n; ++k) {
+        for (int j = 0; j <= n; ++j) {
+            for (int i = 0; i <= n; ++i) {
+                coords.push_back({{double(i) / n, double(j) / n, double(k) / n}});
+            }
+        }
+    }
+
+    return coords;
+}
+
+/*!
+* Evaluates the connectivity of the cells of a structured hexahedral grid.
+*
+* \param n is the number of cells along each direction
+* \result The connectivity of the cells of the grid.
+*/
+std::vector<long> evalGridConnectivity(int n)
+{
+    auto vertexId = [n](int i, int j, int k) {
+        return static_cast<long>(i + (n + 1) * (j + (n + 1) * k));
+    };
+
+    std::vector<long> connectivity;
+    connectivity.reserve(8 * n * n * n);
+    for (int k = 0; k < n; ++k) {
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                connectivity.insert(connectivity.end(), {
+                    vertexId(i,     j,     k),     vertexId(i + 1, j,     k),
+                    vertexId(i + 1, j + 1, k),     vertexId(i,     j + 1, k),
+                    vertexId(i,     j,     k + 1), vertexId(i + 1, j,     k + 1),
+                    vertexId(i + 1, j + 1, k + 1), vertexId(i,     j + 1, k + 1)
+                });
+            }
+        }
+    }
+
+    return connectivity;
+}
+
+/*!
+* Subtest 001
+*
+* Testing bulk insertion of vertices and cells.
+*/
+int subtest_001()
+{
+    log::cout() << "Testing bulk insertion of vertices and cells..." << std::endl;
+
+    const int N = 48;
+
+    std::vector<std::array<double, 3>> coords = evalGridVertices(N);
+    std::vector<long> connectivity = evalGridConnectivity(N);
+
+    std::size_t nVertices = coords.size();
+    std::size_t nCells    = N * N * N;
+
+    // Insertion of one entity at the time
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patchSingle(3, MPI_COMM_NULL);
+#else
+    VolUnstructured patchSingle(3);
+#endif
+    patchSingle.setExpert(true);
+
+    auto singleStart = std::chrono::high_resolution_clock::now();
+    for (const std::array<double, 3> &vertexCoords : coords) {
+        patchSingle.addVertex(vertexCoords);
+    }
+
+    for (std::size_t n = 0; n < nCells; ++n) {
+        std::vector<long> cellConnect(connectivity.begin() + 8 * n, connectivity.begin() + 8 * (n + 1));
+        patchSingle.addCell(ElementType::HEXAHEDRON, cellConnect);
+    }
+    auto singleEnd = std::chrono::high_resolution_clock::now();
+
+    // Bulk insertion
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patchBulk(3, MPI_COMM_NULL);
+#else
+    VolUnstructured patchBulk(3);
+#endif
+    patchBulk.setExpert(true);
+
+    std::vector<ElementType> types(nCells, ElementType::HEXAHEDRON);
+    std::vector<long> connectOffsets(nCells + 1);
+    for (std::size_t n = 0; n <= nCells; ++n) {
+        connectOffsets[n] = static_cast<long>(8 * n);
+    }
+
+    auto bulkStart = std::chrono::high_resolution_clock::now();
+    long firstVertexId = patchBulk.addVertices(nVertices, coords.data());
+    long firstCellId   = patchBulk.addCells(nCells, types.data(), connectOffsets.data(), connectivity.data());
+    auto bulkEnd = std::chrono::high_resolution_clock::now();
+
+    double singleTime = std::chrono::duration<double>(singleEnd - singleStart).count();
+    double bulkTime   = std::chrono::duration<double>(bulkEnd - bulkStart).count();
+
+    log::cout() << "  Number of vertices: " << nVertices << std::endl;
+    log::cout() << "  Number of cells: " << nCells << std::endl;
+    log::cout() << "  Single insertion time: " << singleTime << " s" << std::endl;
+    log::cout() << "  Bulk insertion time: " << bulkTime << " s"
+                << " (speedup = " << (singleTime / bulkTime) << ")" << std::endl;
+
+    // Check the ids
+    if (firstVertexId != 0 || firstCellId != 0) {
+        log::cout() << "  Bulk insertion didn't generate the expected ids" << std::endl;
+        return 1;
+    }
+
+    // Check the entities
+    if (patchBulk.getVertexCount() != patchSingle.getVertexCount() ||
+            patchBulk.getInternalVertexCount() != patchSingle.getInternalVertexCount()) {
+        log::cout() << "  Number of vertices doesn't match" << std::endl;
+        return 1;
+    }
+
+    if (patchBulk.getCellCount() != patchSingle.getCellCount() ||
+            patchBulk.getInternalCellCount() != patchSingle.getInternalCellCount()) {
+        log::cout() << "  Number of cells doesn't match" << std::endl;
+        return 1;
+    }
+
+    for (const Vertex &vertex : patchSingle.getVertices()) {
+        long id = vertex.getId();
+        if (patchBulk.getVertexCoords(id) != vertex.getCoords()) {
+            log::cout() << "  Coordinates of vertex " << id << " don't match" << std::endl;
+            return 1;
+        }
+    }
+
+    for (const Cell &cell : patchSingle.getCells()) {
+        long id = cell.getId();
+        const Cell &bulkCell = patchBulk.getCell(id);
+        if (bulkCell.getType() != cell.getType()) {
+            log::cout() << "  Type of cell " << id << " doesn't match" << std::endl;
+            return 1;
+        }
+
+        ConstProxyVector<long> vertexIds     = cell.getVertexIds();
+        ConstProxyVector<long> bulkVertexIds = bulkCell.getVertexIds();
+        if (!std::equal(vertexIds.begin(), vertexIds.end(), bulkVertexIds.begin())) {
+            log::cout() << "  Connectivity of cell " << id << " doesn't match" << std::endl;
+            return 1;
+        }
+    }
+
+    // Check the bounding box
+    std::array<double, 3> singleMin, singleMax;
+    std::array<double, 3> bulkMin, bulkMax;
+    patchSingle.getBoundingBox(singleMin, singleMax);
+    patchBulk.getBoundingBox(bulkMin, bulkMax);
+    if (singleMin != bulkMin || singleMax != bulkMax) {
+        log::cout() << "  Bounding box doesn't match" << std::endl;
+        return 1;
+    }
+
+    // Check the alteration tracking
+    patchSingle.initializeAdjacencies();
+    patchSingle.initializeInterfaces();
+    patchBulk.initializeAdjacencies();
+    patchBulk.initializeInterfaces();
+    if (patchBulk.getInterfaceCount() != patchSingle.getInterfaceCount()) {
+        log::cout() << "  Number of interfaces doesn't match" << std::endl;
+        return 1;
+    }
+
+    // New entities should follow the existing ones
+    std::array<double, 3> extraCoords = {{2., 2., 2.}};
+    if (patchBulk.addVertices(1, &extraCoords) != static_cast<long>(nVertices)) {
+        log::cout() << "  Bulk insertion didn't generate contiguous ids" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing bulk insertion of cells with mixed types.
+*/
+int subtest_002()
+{
+    log::cout() << "Testing bulk insertion of cells with mixed types..." << std::endl;
+
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(2, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(2);
+#endif
+    patch.setExpert(true);
+
+    // Vertices
+    std::vector<std::array<double, 3>> coords = {{
+        {{0., 0., 0.}}, {{1., 0., 0.}}, {{2., 0., 0.}},
+        {{0., 1., 0.}}, {{1., 1., 0.}}, {{2., 1., 0.}},
+        {{3., 0.5, 0.}}
+    }};
+
+    long firstVertexId = patch.addVertices(coords.size(), coords.data(), 10);
+    if (firstVertexId != 10) {
+        log::cout() << "  Vertices were not assigned the requested ids" << std::endl;
+        return 1;
+    }
+
+    // Cells
+    std::vector<ElementType> types = {ElementType::QUAD, ElementType::TRIANGLE, ElementType::POLYGON};
+    std::vector<long> connectOffsets = {0, 4, 7, 12};
+    std::vector<long> connectivity = {10, 11, 14, 13,
+                                      11, 12, 14,
+                                      4, 12, 16, 15, 14};
+
+    long firstCellId = patch.addCells(types.size(), types.data(), connectOffsets.data(), connectivity.data(), 5);
+    if (firstCellId != 5) {
+        log::cout() << "  Cells were not assigned the requested ids" << std::endl;
+        return 1;
+    }
+
+    double area = 0.;
+    for (long id = 5; id < 8; ++id) {
+        area += patch.evalCellVolume(id);
+        log::cout() << "  Cell " << id << " has type " << patch.getCell(id).getType()
+                    << " and area " << patch.evalCellVolume(id) << std::endl;
+    }
+
+    if (std::abs(area - 2.5) > 1e-12) {
+        log::cout() << "  Total area doesn't match the expected one" << std::endl;
+        return 1;
+    }
+
+    // Cells with a dimension higher than the patch should be rejected
+    ElementType invalidType = ElementType::TETRA;
+    std::vector<long> invalidOffsets = {0, 4};
+    std::vector<long> invalidConnectivity = {10, 11, 13, 14};
+    if (patch.addCells(1, &invalidType, invalidOffsets.data(), invalidConnectivity.data()) != Cell::NULL_ID) {
+        log::cout() << "  Cells with invalid dimension were added" << std::endl;
+        return 1;
+    }
+
+    // Assigned ids cannot be used
+    bool duplicateDetected = false;
+    try {
+        patch.addCells(1, types.data(), connectOffsets.data(), connectivity.data(), 7);
+    } catch (const std::runtime_error &) {
+        duplicateDetected = true;
+    }
+
+    if (!duplicateDetected) {
+        log::cout() << "  Cells with duplicate ids were added" << std::endl;
+        return 1;
+    }
+
+    // Ranges overlapping assigned ids should be rejected without altering
+    // the patch, hence the ids before the overlap should still be available
+    long nVertices = patch.getVertexCount();
+    duplicateDetected = false;
+    try {
+        patch.addVertices(3, coords.data(), 8);
+    } catch (const std::runtime_error &) {
+        duplicateDetected = true;
+    }
+
+    if (!duplicateDetected || patch.getVertexCount() != nVertices) {
+        log::cout() << "  Vertices with overlapping ids were added" << std::endl;
+        return 1;
+    }
+
+    if (patch.addVertices(2, coords.data(), 8) != 8) {
+        log::cout() << "  Ids preceding an overlapping range are no longer available" << std::endl;
+        return 1;
+    }
+
+    long nCells = patch.getCellCount();
+    duplicateDetected = false;
+    try {
+        patch.addCells(3, types.data(), connectOffsets.data(), connectivity.data(), 3);
+    } catch (const std::runtime_error &) {
+        duplicateDetected = true;
+    }
+
+    if (!duplicateDetected || patch.getCellCount() != nCells) {
+        log::cout() << "  Cells with overlapping ids were added" << std::endl;
+        return 1;
+    }
+
+    if (patch.addCells(2, types.data(), connectOffsets.data(), connectivity.data(), 3) != 3) {
+        log::cout() << "  Ids preceding an overlapping range are no longer available" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    log::cout() << "Testing bulk insertion in unstructured patches" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
@@ -0,0 +1,508 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+#if BITPIT_ENABLE_MPI==1
+#include <mpi.h>
+#endif
+
+#include "bitpit_common.hpp"
+#include "bitpit_volunstructured.hpp"
+
+using namespace bitpit;
+
+/*!
+* Generates a structured hexahedral grid.
+*
+* \param n is the number of cells along each direction
+* \param patch is the patch that will be filled
+*/
+void generateGrid(int n, VolUnstructured *patch)
+{
+    std::vector<std::array<double, 3>> coords;
+    coords.reserve((n + 1) * (n + 1) * (n + 1));
+    for (int k = 0; k <= n; ++k) {
+        for (int j = 0; j <= n; ++j) {
+            for (int i = 0; i <= n; ++i) {
+                coords.push_back({{double(i) / n, double(j) / n, double(k) / n}});
+            }
+        }
+    }
+
+    auto vertexId = [n](int i, int j, int k) {
+        return static_cast<long>(i + (n + 1) * (j + (n + 1) * k));
+    };
+
+    std::size_t nCells = n * n * n;
+    std::vector<ElementType> types(nCells, ElementType::HEXAHEDRON);
+    std::vector<long> connectOffsets(nCells + 1);
+    std::vector<long> connectivity;
+    connectivity.reserve(8 * nCells);
+    connectOffsets[0] = 0;
+    for (int k = 0; k < n; ++k) {
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                connectivity.insert(connectivity.end(), {
+                    vertexId(i,     j,     k),     vertexId(i + 1, j,     k),
+                    vertexId(i + 1, j + 1, k),     vertexId(i,     j + 1, k),
+                    vertexId(i,     j,     k + 1), vertexId(i + 1, j,     k + 1),
+                    vertexId(i + 1, j + 1, k + 1), vertexId(i,     j + 1, k + 1)
+                });
+                connectOffsets[1 + i + n * (j + n * k)] = connectivity.size();
+            }
+        }
+    }
+
+    patch->addVertices(coords.size(), coords.data());
+    patch->addCells(nCells, types.data(), connectOffsets.data(), connectivity.data());
+}
+
+/*!
+* Checks the bulk evaluation of the geometry against the evaluation of the
+* geometry of each single element.
+*
+* \param patch is the patch
+* \result Returns zero if the check is successful, a non-zero value otherwise.
+*/
+int checkBulkGeometry(const VolUnstructured &patch)
+{
+    const double TOLERANCE = 1e-12;
+
+    PiercedStorage<std::array<double, 3>, long> centroids(1, &patch.getCells());
+    PiercedStorage<double, long> volumes(1, &patch.getCells());
+    PiercedStorage<double, long> areas(1, &patch.getInterfaces());
+    PiercedStorage<std::array<double, 3>, long> normals(1, &patch.getInterfaces());
+
+    patch.evalCellCentroids(&centroids);
+    patch.evalCellVolumes(&volumes);
+    patch.evalInterfaceAreas(&areas);
+    patch.evalInterfaceNormals(&normals);
+
+    for (const Cell &cell : patch.getCells()) {
+        long id = cell.getId();
+        if (norm2(centroids[id] - patch.evalCellCentroid(id)) > TOLERANCE) {
+            log::cout() << "  Centroid of cell " << id << " doesn't match" << std::endl;
+            return 1;
+        }
+
+        if (std::abs(volumes[id] - patch.evalCellVolume(id)) > TOLERANCE) {
+            log::cout() << "  Volume of cell " << id << " doesn't match" << std::endl;
+            return 1;
+        }
+    }
+
+    for (const Interface &interface : patch.getInterfaces()) {
+        long id = interface.getId();
+        if (std::abs(areas[id] - patch.evalInterfaceArea(id)) > TOLERANCE) {
+            log::cout() << "  Area of interface " << id << " doesn't match" << std::endl;
+            return 1;
+        }
+
+        if (norm2(normals[id] - patch.evalInterfaceNormal(id)) > TOLERANCE) {
+            log::cout() << "  Normal of interface " << id << " doesn't match" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing bulk evaluation of the geometry of a hexahedral grid.
+*/
+int subtest_001()
+{
+    log::cout() << "Testing bulk evaluation of the geometry of a hexahedral grid..." << std::endl;
+
+    const int N = 32;
+
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(3, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(3);
+#endif
+    patch.setExpert(true);
+    generateGrid(N, &patch);
+    patch.initializeAdjacencies();
+    patch.initializeInterfaces();
+
+    int status = checkBulkGeometry(patch);
+    if (status != 0) {
+        return status;
+    }
+
+    // Timing
+    PiercedStorage<double, long> volumes(1, &patch.getCells());
+
+    auto singleStart = std::chrono::high_resolution_clock::now();
+    for (const Cell &cell : patch.getCells()) {
+        long id = cell.getId();
+        volumes[id] = patch.evalCellVolume(id);
+    }
+    auto singleEnd = std::chrono::high_resolution_clock::now();
+
+    auto bulkStart = std::chrono::high_resolution_clock::now();
+    patch.evalCellVolumes(&volumes);
+    auto bulkEnd = std::chrono::high_resolution_clock::now();
+
+    double singleTime = std::chrono::duration<double>(singleEnd - singleStart).count();
+    double bulkTime   = std::chrono::duration<double>(bulkEnd - bulkStart).count();
+
+    log::cout() << "  Number of cells: " << patch.getCellCount() << std::endl;
+    log::cout() << "  Single evaluation of volumes: " << singleTime << " s" << std::endl;
+    log::cout() << "  Bulk evaluation of volumes: " << bulkTime << " s"
+                << " (speedup = " << (singleTime / bulkTime) << ")" << std::endl;
+
+    return 0;
+}
+
+/*!
+* Subtest 002
+*
+* Testing bulk evaluation of the geometry of cells with mixed types.
+*/
+int subtest_002()
+{
+    log::cout() << "Testing bulk evaluation of the geometry of cells with mixed types..." << std::endl;
+
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(3, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(3);
+#endif
+    patch.setExpert(true);
+
+    std::vector<std::array<double, 3>> coords = {{
+        {{0., 0., 0.}}, {{1., 0., 0.}}, {{0., 1., 0.}}, {{0., 0., 1.}},
+        {{2., 0., 0.}}, {{3., 0., 0.}}, {{3., 1., 0.}}, {{2., 1., 0.}}, {{2.5, 0.5, 1.}},
+        {{4., 0., 0.}}, {{5., 0., 0.}}, {{4., 1., 0.}}, {{4., 0., 2.}}, {{5., 0., 2.}}, {{4., 1., 2.}}
+    }};
+    patch.addVertices(coords.size(), coords.data());
+
+    std::vector<ElementType> types = {ElementType::TETRA, ElementType::PYRAMID, ElementType::WEDGE};
+    std::vector<long> connectOffsets = {0, 4, 9, 15};
+    std::vector<long> connectivity = {0, 1, 2, 3,
+                                      4, 5, 6, 7, 8,
+                                      9, 10, 11, 12, 13, 14};
+    patch.addCells(types.size(), types.data(), connectOffsets.data(), connectivity.data());
+    patch.initializeAdjacencies();
+    patch.initializeInterfaces();
+
+    return checkBulkGeometry(patch);
+}
+
+/*!
+* Subtest 003
+*
+* Testing the cell geometry cache.
+*/
+int subtest_003()
+{
+    log::cout() << "Testing the cell geometry cache..." << std::endl;
+
+    const int N = 8;
+    const double TOLERANCE = 1e-12;
+
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(3, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(3);
+#endif
+    patch.setExpert(true);
+    generateGrid(N, &patch);
+
+    // Initial cache
+    const PiercedStorage<double, long> &cachedVolumes = patch.getCachedCellVolumes();
+    for (const Cell &cell : patch.getCells()) {
+        long id = cell.getId();
+        if (std::abs(cachedVolumes[id] - patch.evalCellVolume(id)) > TOLERANCE) {
+            log::cout() << "  Cached volume of cell " << id << " doesn't match" << std::endl;
+            return 1;
+        }
+    }
+
+    // The cache should be updated after the patch is transformed
+    patch.scale(2.);
+    patch.translate(1., 0., 0.);
+
+    const PiercedStorage<std::array<double, 3>, long> &cachedCentroids = patch.getCachedCellCentroids();
+    for (const Cell &cell : patch.getCells()) {
+        long id = cell.getId();
+        if (norm2(cachedCentroids[id] - patch.evalCellCentroid(id)) > TOLERANCE) {
+            log::cout() << "  Cached centroid of cell " << id << " was not updated after a transformation" << std::endl;
+            return 1;
+        }
+
+        if (std::abs(patch.getCachedCellVolumes()[id] - 8. / (N * N * N)) > TOLERANCE) {
+            log::cout() << "  Cached volume of cell " << id << " was not updated after a transformation" << std::endl;
+            return 1;
+        }
+    }
+
+    // The cache should be updated after cells are deleted and added
+    patch.deleteCell(0);
+    patch.squeezeCells();
+
+    std::vector<long> tetraConnect = {0, 1, N + 1, (N + 1) * (N + 1)};
+    long tetraId = patch.addCell(ElementType::TETRA, tetraConnect).getId();
+    patch.update();
+
+    long nCachedCells = 0;
+    for (const Cell &cell : patch.getCells()) {
+        long id = cell.getId();
+        if (std::abs(patch.getCachedCellVolumes()[id] - patch.evalCellVolume(id)) > TOLERANCE) {
+            log::cout() << "  Cached volume of cell " << id << " was not updated after an alteration" << std::endl;
+            return 1;
+        }
+        ++nCachedCells;
+    }
+
+    log::cout() << "  Cached volume of the new tetrahedron: " << patch.getCachedCellVolumes()[tetraId] << std::endl;
+    if (nCachedCells != patch.getCellCount()) {
+        log::cout() << "  Number of cached cells doesn't match" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 004
+*
+* Testing bulk evaluation of the geometry of a distorted three-dimensional
+* grid made of hexahedra and tetrahedra.
+*/
+int subtest_004()
+{
+    log::cout() << "Testing bulk evaluation of the geometry of a distorted grid of hexahedra and tetrahedra..." << std::endl;
+
+    const int N = 10;
+
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(3, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(3);
+#endif
+    patch.setExpert(true);
+
+    // Vertices are randomly displaced to obtain non-planar faces
+    std::mt19937 generator(4);
+    std::uniform_real_distribution<double> displacement(-0.2 / N, 0.2 / N);
+
+    std::vector<std::array<double, 3>> coords;
+    for (int k = 0; k <= N; ++k) {
+        for (int j = 0; j <= N; ++j) {
+            for (int i = 0; i <= N; ++i) {
+                std::array<double, 3> point = {{double(i) / N, double(j) / N, double(k) / N}};
+                for (int d = 0; d < 3; ++d) {
+                    point[d] += displacement(generator);
+                }
+                coords.push_back(point);
+            }
+        }
+    }
+    long firstVertexId = patch.addVertices(coords.size(), coords.data());
+
+    auto vertexId = [N, firstVertexId](int i, int j, int k) {
+        return firstVertexId + static_cast<long>(i + (N + 1) * (j + (N + 1) * k));
+    };
+
+    // Cells in the upper half of the grid are split into six tetrahedra
+    std::vector<ElementType> types;
+    std::vector<long> connectOffsets = {0};
+    std::vector<long> connectivity;
+    for (int k = 0; k < N; ++k) {
+        for (int j = 0; j < N; ++j) {
+            for (int i = 0; i < N; ++i) {
+                std::array<long, 8> hexa = {{
+                    vertexId(i,     j,     k),     vertexId(i + 1, j,     k),
+                    vertexId(i + 1, j + 1, k),     vertexId(i,     j + 1, k),
+                    vertexId(i,     j,     k + 1), vertexId(i + 1, j,     k + 1),
+                    vertexId(i + 1, j + 1, k + 1), vertexId(i,     j + 1, k + 1)
+                }};
+
+                if (k < N / 2) {
+                    types.push_back(ElementType::HEXAHEDRON);
+                    connectivity.insert(connectivity.end(), hexa.begin(), hexa.end());
+                    connectOffsets.push_back(connectivity.size());
+                } else {
+                    const int tetras[6][4] = {{0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6},
+                                              {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+                    for (const auto &tetra : tetras) {
+                        types.push_back(ElementType::TETRA);
+                        for (int n = 0; n < 4; ++n) {
+                            connectivity.push_back(hexa[tetra[n]]);
+                        }
+                        connectOffsets.push_back(connectivity.size());
+                    }
+                }
+            }
+        }
+    }
+    patch.addCells(types.size(), types.data(), connectOffsets.data(), connectivity.data());
+    patch.initializeAdjacencies();
+    patch.initializeInterfaces();
+
+    log::cout() << "  Number of cells: " << patch.getCellCount() << std::endl;
+    log::cout() << "  Number of interfaces: " << patch.getInterfaceCount() << std::endl;
+
+    return checkBulkGeometry(patch);
+}
+
+/*!
+* Subtest 005
+*
+* Testing bulk evaluation of the geometry of a distorted two-dimensional
+* grid made of triangles, quadrilaterals and polygons.
+*/
+int subtest_005()
+{
+    log::cout() << "Testing bulk evaluation of the geometry of a distorted grid of triangles, quadrilaterals and polygons..." << std::endl;
+
+    const int N = 24;
+
+#if BITPIT_ENABLE_MPI
+    VolUnstructured patch(2, MPI_COMM_NULL);
+#else
+    VolUnstructured patch(2);
+#endif
+    patch.setExpert(true);
+
+    // Vertices are randomly displaced to obtain irregular elements
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<double> displacement(-0.2 / N, 0.2 / N);
+
+    std::vector<std::array<double, 3>> coords;
+    for (int j = 0; j <= N; ++j) {
+        for (int i = 0; i <= N; ++i) {
+            coords.push_back({{double(i) / N + displacement(generator), double(j) / N + displacement(generator), 0.}});
+        }
+    }
+    long firstVertexId = patch.addVertices(coords.size(), coords.data());
+
+    auto vertexId = [N, firstVertexId](int i, int j) {
+        return firstVertexId + static_cast<long>(i + (N + 1) * j);
+    };
+
+    // Cells are alternatively quadrilaterals, pairs of triangles and
+    // polygons with a vertex in the middle of the bottom edge
+    for (int j = 0; j < N; ++j) {
+        for (int i = 0; i < N; ++i) {
+            long v0 = vertexId(i, j);
+            long v1 = vertexId(i + 1, j);
+            long v2 = vertexId(i + 1, j + 1);
+            long v3 = vertexId(i, j + 1);
+
+            switch ((i + j) % 3) {
+
+            case 0:
+                patch.addCell(ElementType::QUAD, std::vector<long>({{v0, v1, v2, v3}}));
+                break;
+
+            case 1:
+                patch.addCell(ElementType::TRIANGLE, std::vector<long>({{v0, v1, v2}}));
+                patch.addCell(ElementType::TRIANGLE, std::vector<long>({{v0, v2, v3}}));
+                break;
+
+            default:
+                if (j == 0) {
+                    long vm = patch.addVertex(0.5 * (patch.getVertexCoords(v0) + patch.getVertexCoords(v1)))->getId();
+                    patch.addCell(ElementType::POLYGON, std::vector<long>({{5, v0, vm, v1, v2, v3}}));
+                } else {
+                    patch.addCell(ElementType::QUAD, std::vector<long>({{v0, v1, v2, v3}}));
+                }
+                break;
+
+            }
+        }
+    }
+    patch.initializeAdjacencies();
+    patch.initializeInterfaces();
+
+    log::cout() << "  Number of cells: " << patch.getCellCount() << std::endl;
+    log::cout() << "  Number of interfaces: " << patch.getInterfaceCount() << std::endl;
+
+    return checkBulkGeometry(patch);
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+#if BITPIT_ENABLE_MPI==1
+    MPI_Init(&argc,&argv);
+#else
+    BITPIT_UNUSED(argc);
+    BITPIT_UNUSED(argv);
+#endif
+
+    // Initialize the logger
+    log::manager().initialize(log::MODE_COMBINE);
+
+    // Run the subtests
+    log::cout() << "Testing bulk evaluation of the geometry of unstructured patches" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+
+        status = subtest_003();
+        if (status != 0) {
+            return (30 + status);
+        }
+
+        status = subtest_004();
+        if (status != 0) {
+            return (40 + status);
+        }
+
+        status = subtest_005();
+        if (status != 0) {
+            return (50 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+#if BITPIT_ENABLE_MPI==1
+    MPI_Finalize();
+#endif
+
+    return status;
+}
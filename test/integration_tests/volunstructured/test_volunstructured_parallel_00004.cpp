@@ -0,0 +1,301 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <array>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_volunstructured.hpp"
+
+using namespace bitpit;
+
+/*!
+* Creates a partitioned Cartesian mesh made of unstructured cells.
+*
+* The mesh is created on the first process and then partitioned in slices
+* along the x direction.
+*
+* \param dimension is the dimension of the patch
+* \param nCells1D is the number of cells along each direction
+* \param domainMin is the minimum point of the domain
+* \param domainMax is the maximum point of the domain
+* \result The partitioned patch.
+*/
+std::unique_ptr<VolUnstructured> createPartitionedPatch(int dimension, int nCells1D, const std::array<double, 3> &domainMin, const std::array<double, 3> &domainMax)
+{
+    int rank;
+    int nProcs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+
+    std::unique_ptr<VolUnstructured> patch(new VolUnstructured(dimension, MPI_COMM_WORLD));
+    patch->setVertexAutoIndexing(false);
+
+    // Fill the patch
+    int nVertices1D = nCells1D + 1;
+    int nVerticesZ  = (dimension == 3) ? nVertices1D : 1;
+    int nCellsZ     = (dimension == 3) ? nCells1D : 1;
+
+    std::array<double, 3> spacing = (domainMax - domainMin) / ((double) nCells1D);
+
+    std::unordered_map<long, int> cellRanks;
+    if (rank == 0) {
+        for (int k = 0; k < nVerticesZ; ++k) {
+            for (int j = 0; j < nVertices1D; ++j) {
+                for (int i = 0; i < nVertices1D; ++i) {
+                    long vertexId = i + nVertices1D * (j + nVertices1D * k);
+                    std::array<double, 3> coords = domainMin;
+                    coords[0] += i * spacing[0];
+                    coords[1] += j * spacing[1];
+                    coords[2] += k * spacing[2];
+                    patch->addVertex(coords, vertexId);
+                }
+            }
+        }
+
+        for (int k = 0; k < nCellsZ; ++k) {
+            for (int j = 0; j < nCells1D; ++j) {
+                for (int i = 0; i < nCells1D; ++i) {
+                    long v0 = i + nVertices1D * (j + nVertices1D * k);
+                    long v1 = v0 + 1;
+                    long v2 = v0 + nVertices1D + 1;
+                    long v3 = v0 + nVertices1D;
+
+                    long cellId;
+                    if (dimension == 2) {
+                        cellId = patch->addCell(ElementType::QUAD, std::vector<long>({{v0, v1, v2, v3}}))->getId();
+                    } else {
+                        long offset = nVertices1D * nVertices1D;
+                        cellId = patch->addCell(ElementType::HEXAHEDRON, std::vector<long>({{v0, v1, v2, v3, v0 + offset, v1 + offset, v2 + offset, v3 + offset}}))->getId();
+                    }
+
+                    cellRanks[cellId] = (i * nProcs) / nCells1D;
+                }
+            }
+        }
+    }
+
+    patch->initializeAdjacencies();
+
+    // Partition the patch
+    patch->partition(cellRanks, false, true);
+
+    return patch;
+}
+
+/*!
+* Locates random points with the global point location of the specified
+* patch and checks the results against the local point location.
+*
+* \param patch is the patch
+* \param domainMin is the minimum point of the domain
+* \param domainMax is the maximum point of the domain
+* \param nPoints is the number of points each process will locate
+* \result Returns zero if the check is successful, a non-zero value otherwise.
+*/
+int checkGlobalPointLocation(const PatchKernel &patch, const std::array<double, 3> &domainMin, const std::array<double, 3> &domainMax, int nPoints)
+{
+    int rank = patch.getRank();
+    int nProcs = patch.getProcessorCount();
+    int dimension = patch.getDimension();
+
+    // Generate the points, some of them are outside the domain
+    std::mt19937 generator(29 + rank);
+    std::vector<std::array<double, 3>> points(nPoints);
+    for (std::array<double, 3> &point : points) {
+        point = domainMin;
+        for (int d = 0; d < dimension; ++d) {
+            double delta = domainMax[d] - domainMin[d];
+            std::uniform_real_distribution<double> distribution(domainMin[d] - 0.1 * delta, domainMax[d] + 0.1 * delta);
+            point[d] = distribution(generator);
+        }
+    }
+
+    // Locate the points
+    std::vector<long> ids(nPoints);
+    std::vector<int> ranks(nPoints);
+    patch.locateGlobalPoints(nPoints, points.data(), ids.data(), ranks.data());
+
+    // Gather the results of all the processes
+    std::vector<std::array<double, 3>> globalPoints(nProcs * nPoints);
+    MPI_Allgather(points.data(), 3 * nPoints, MPI_DOUBLE, globalPoints.data(), 3 * nPoints, MPI_DOUBLE, MPI_COMM_WORLD);
+
+    std::vector<long> globalIds(nProcs * nPoints);
+    MPI_Allgather(ids.data(), nPoints, MPI_LONG, globalIds.data(), nPoints, MPI_LONG, MPI_COMM_WORLD);
+
+    std::vector<int> globalRanks(nProcs * nPoints);
+    MPI_Allgather(ranks.data(), nPoints, MPI_INT, globalRanks.data(), nPoints, MPI_INT, MPI_COMM_WORLD);
+
+    // Check the results
+    int nErrors = 0;
+    int nLocated = 0;
+    for (std::size_t k = 0; k < globalPoints.size(); ++k) {
+        const std::array<double, 3> &point = globalPoints[k];
+
+        bool isInsideDomain = true;
+        for (int d = 0; d < dimension; ++d) {
+            isInsideDomain &= (point[d] >= domainMin[d] && point[d] <= domainMax[d]);
+        }
+
+        if (isInsideDomain != (globalRanks[k] >= 0)) {
+            ++nErrors;
+            continue;
+        }
+
+        long localId = patch.locatePoint(point);
+        bool isLocal = (localId != Cell::NULL_ID && patch.getCell(localId).isInterior());
+        if (isLocal) {
+            ++nLocated;
+            if (globalRanks[k] != rank || globalIds[k] != localId) {
+                ++nErrors;
+            }
+        } else if (globalRanks[k] == rank) {
+            ++nErrors;
+        }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, &nErrors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &nLocated, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+    log::cout() << "    Points located: " << nLocated << " / " << (nProcs * nPoints) << std::endl;
+    log::cout() << "    Errors: " << nErrors << std::endl;
+    if (nErrors != 0) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing global point location on a partitioned 2D patch.
+*/
+int subtest_001()
+{
+    log::cout() << "  >> 2D unstructured patch" << std::endl;
+
+    std::array<double, 3> domainMin = {{-1., 0.5, 0.}};
+    std::array<double, 3> domainMax = {{ 2., 1.5, 0.}};
+    std::unique_ptr<VolUnstructured> patch_2D = createPartitionedPatch(2, 24, domainMin, domainMax);
+
+    return checkGlobalPointLocation(*patch_2D, domainMin, domainMax, 2000);
+}
+
+/*!
+* Subtest 002
+*
+* Testing global point location on a partitioned 3D patch.
+*/
+int subtest_002()
+{
+    log::cout() << "  >> 3D unstructured patch" << std::endl;
+
+    std::array<double, 3> domainMin = {{0., 0., 0.}};
+    std::array<double, 3> domainMax = {{1., 2., 1.}};
+    std::unique_ptr<VolUnstructured> patch_3D = createPartitionedPatch(3, 8, domainMin, domainMax);
+
+    return checkGlobalPointLocation(*patch_3D, domainMin, domainMax, 1000);
+}
+
+/*!
+* Subtest 003
+*
+* Testing global point location on a partitioned 2D patch that is moved
+* between two locations.
+*/
+int subtest_003()
+{
+    log::cout() << "  >> 2D unstructured patch moved between two locations" << std::endl;
+
+    std::array<double, 3> domainMin = {{0., 0., 0.}};
+    std::array<double, 3> domainMax = {{1., 1., 0.}};
+    std::unique_ptr<VolUnstructured> patch_2D = createPartitionedPatch(2, 16, domainMin, domainMax);
+
+    // Locate the points twice, the second location reuses the boxes of the
+    // partitions evaluated by the first one
+    for (int i = 0; i < 2; ++i) {
+        int status = checkGlobalPointLocation(*patch_2D, domainMin, domainMax, 500);
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    // Locate the points after moving the patch
+    std::array<double, 3> translation = {{2., -1., 0.}};
+    patch_2D->translate(translation);
+
+    domainMin += translation;
+    domainMax += translation;
+
+    return checkGlobalPointLocation(*patch_2D, domainMin, domainMax, 500);
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+    MPI_Init(&argc,&argv);
+
+    // Initialize the logger
+    int nProcs;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+    log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+    // Run the subtests
+    log::cout() << "Testing global point location" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+
+        status = subtest_002();
+        if (status != 0) {
+            return (20 + status);
+        }
+
+        status = subtest_003();
+        if (status != 0) {
+            return (30 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+    MPI_Finalize();
+
+    return status;
+}
@@ -0,0 +1,178 @@
+/*---------------------------------------------------------------------------*\
+ *
+ *  bitpit
+ *
+ *  Copyright (C) 2015-2021 OPTIMAD engineering Srl
+ *
+ *  -------------------------------------------------------------------------
+ *  License
+ *  This file is part of bitpit.
+ *
+ *  bitpit is free software: you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License v3 (LGPL)
+ *  as published by the Free Software Foundation.
+ *
+ *  bitpit is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ *  License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with bitpit. If not, see <http://www.gnu.org/licenses/>.
+ *
+\*---------------------------------------------------------------------------*/
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <mpi.h>
+
+#include "bitpit_common.hpp"
+#include "bitpit_volunstructured.hpp"
+
+using namespace bitpit;
+
+/*!
+* Checks the raw indexes of the interior and border cells of the specified
+* patch against the raw indexes obtained scanning the internal cells.
+*
+* \param patch is the patch
+* \result Returns zero if the check is successful, a non-zero value otherwise.
+*/
+int checkCellRawIndexes(const PatchKernel &patch)
+{
+    std::vector<std::size_t> expectedRawIndexes;
+    PatchKernel::CellConstIterator endItr = patch.internalCellConstEnd();
+    for (PatchKernel::CellConstIterator itr = patch.internalCellConstBegin(); itr != endItr; ++itr) {
+        expectedRawIndexes.push_back(itr.getRawIndex());
+    }
+    std::sort(expectedRawIndexes.begin(), expectedRawIndexes.end());
+
+    const std::vector<std::size_t> &interiorRawIndexes = patch.getInteriorCellRawIndexes();
+    const std::vector<std::size_t> &borderRawIndexes = patch.getBorderCellRawIndexes();
+
+    std::vector<std::size_t> rawIndexes(interiorRawIndexes);
+    std::sort(rawIndexes.begin(), rawIndexes.end());
+
+    log::cout() << "    Interior cells: " << interiorRawIndexes.size() << ", border cells: " << borderRawIndexes.size() << std::endl;
+    if (!borderRawIndexes.empty()) {
+        log::cout() << "    A patch without ghosts should not have border cells" << std::endl;
+        return 1;
+    } else if (rawIndexes != expectedRawIndexes) {
+        log::cout() << "    Raw indexes of the interior cells don't match the internal cells" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*!
+* Subtest 001
+*
+* Testing raw indexes of interior and border cells on a patch that is not
+* partitioned while cells are added and deleted.
+*/
+int subtest_001()
+{
+    log::cout() << "  >> 2D unstructured patch that is not partitioned" << std::endl;
+
+    int nCells1D = 8;
+    int nVertices1D = nCells1D + 1;
+
+    VolUnstructured patch(2, MPI_COMM_NULL);
+    patch.setVertexAutoIndexing(false);
+
+    for (int j = 0; j < nVertices1D; ++j) {
+        for (int i = 0; i < nVertices1D; ++i) {
+            long vertexId = i + nVertices1D * j;
+            patch.addVertex({{(double) i, (double) j, 0.}}, vertexId);
+        }
+    }
+
+    std::vector<long> cellIds;
+    for (int j = 0; j < nCells1D; ++j) {
+        for (int i = 0; i < nCells1D / 2; ++i) {
+            long v0 = i + nVertices1D * j;
+            cellIds.push_back(patch.addCell(ElementType::QUAD, std::vector<long>({{v0, v0 + 1, v0 + nVertices1D + 1, v0 + nVertices1D}}))->getId());
+        }
+    }
+
+    log::cout() << "  Initial cells" << std::endl;
+    int status = checkCellRawIndexes(patch);
+    if (status != 0) {
+        return status;
+    }
+
+    // Add cells
+    for (int j = 0; j < nCells1D; ++j) {
+        for (int i = nCells1D / 2; i < nCells1D; ++i) {
+            long v0 = i + nVertices1D * j;
+            cellIds.push_back(patch.addCell(ElementType::QUAD, std::vector<long>({{v0, v0 + 1, v0 + nVertices1D + 1, v0 + nVertices1D}}))->getId());
+        }
+    }
+
+    log::cout() << "  After adding cells" << std::endl;
+    status = checkCellRawIndexes(patch);
+    if (status != 0) {
+        return status;
+    }
+
+    // Delete cells
+    for (std::size_t k = 0; k < cellIds.size(); k += 3) {
+        patch.deleteCell(cellIds[k]);
+    }
+
+    log::cout() << "  After deleting cells" << std::endl;
+    status = checkCellRawIndexes(patch);
+    if (status != 0) {
+        return status;
+    }
+
+    // Add cells that fill the holes left by the deleted cells
+    for (std::size_t k = 0; k < cellIds.size(); k += 6) {
+        patch.addCell(ElementType::TRIANGLE, std::vector<long>({{0, 1, nVertices1D}}));
+    }
+
+    log::cout() << "  After adding cells in the holes" << std::endl;
+    status = checkCellRawIndexes(patch);
+    if (status != 0) {
+        return status;
+    }
+
+    return 0;
+}
+
+/*!
+* Main program.
+*/
+int main(int argc, char *argv[])
+{
+    MPI_Init(&argc,&argv);
+
+    // Initialize the logger
+    int nProcs;
+    int rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    log::manager().initialize(log::MODE_COMBINE, true, nProcs, rank);
+    log::cout().setDefaultVisibility(log::VISIBILITY_GLOBAL);
+
+    // Run the subtests
+    log::cout() << "Testing raw indexes of interior and border cells" << std::endl;
+
+    int status;
+    try {
+        status = subtest_001();
+        if (status != 0) {
+            return (10 + status);
+        }
+    } catch (const std::exception &exception) {
+        log::cout() << exception.what();
+        exit(1);
+    }
+
+    MPI_Finalize();
+
+    return status;
+}